@@ -0,0 +1,114 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * End-to-end benchmarks of fetching from a loopback server: requests per second and latency
+ * percentiles of synchronous, pooled and asynchronous fetches.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#include <cstdint>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include <restpp/restpp.hpp>
+
+#include "loopback_server.hpp"
+
+using restpp::bench::latency_recorder;
+using restpp::bench::loopback_server;
+
+namespace
+{
+/// <summary>
+/// Fails the benchmark on a transport error or an unexpected status.
+/// </summary>
+bool check(benchmark::State& state, const boost::system::error_code& ec, const restpp::response& res)
+{
+    if (!ec && res.status_code == 200)
+        return true;
+    state.SkipWithError(ec ? ec.message().c_str() : "unexpected status");
+    return false;
+}
+
+/// <summary>
+/// A connection per request, closed afterwards: what <c>fetch</c> without a client does.
+/// </summary>
+void BM_fetch_sync(benchmark::State& state)
+{
+    const restpp::uri target(loopback_server::instance().url(static_cast<std::size_t>(state.range(0))));
+    latency_recorder latencies;
+    for (auto _ : state)
+    {
+        const auto start = latency_recorder::clock::now();
+        const auto res = restpp::fetch(target);
+        latencies.add(latency_recorder::clock::now() - start);
+        if (!check(state, {}, res))
+            break;
+    }
+    state.SetItemsProcessed(state.iterations());
+    latencies.report(state);
+}
+BENCHMARK(BM_fetch_sync)->Arg(64)->Arg(16 * 1024)->UseRealTime();
+
+/// <summary>
+/// Requests one after the other over a pooled keep-alive connection, into a reused response.
+/// </summary>
+void BM_fetch_pooled(benchmark::State& state)
+{
+    const restpp::uri target(loopback_server::instance().url(static_cast<std::size_t>(state.range(0))));
+    restpp::client client;
+    restpp::options options;
+    restpp::response res;
+    latency_recorder latencies;
+    for (auto _ : state)
+    {
+        const auto start = latency_recorder::clock::now();
+        const auto ec = restpp::fetch(client, target, options, res);
+        latencies.add(latency_recorder::clock::now() - start);
+        if (!check(state, ec, res))
+            break;
+    }
+    state.SetItemsProcessed(state.iterations());
+    latencies.report(state);
+}
+BENCHMARK(BM_fetch_pooled)->Arg(64)->Arg(16 * 1024)->UseRealTime();
+
+/// <summary>
+/// Batches of concurrent asynchronous requests through a client; every iteration completes a
+/// batch. Latencies are those of the individual requests.
+/// </summary>
+void BM_fetch_async(benchmark::State& state)
+{
+    const restpp::uri target(loopback_server::instance().url(64));
+    const auto concurrency = static_cast<int>(state.range(0));
+    restpp::client client;
+    latency_recorder latencies;
+    for (auto _ : state)
+    {
+        int pending = concurrency;
+        bool failed = false;
+        for (int i = 0; i < concurrency; ++i)
+        {
+            const auto start = latency_recorder::clock::now();
+            restpp::async_fetch(client, target, restpp::options(), [&, start](boost::system::error_code ec, restpp::response res) {
+                latencies.add(latency_recorder::clock::now() - start);
+                failed = failed || !check(state, ec, res);
+                --pending;
+            });
+        }
+        client.run_until([&] { return pending == 0; });
+        if (failed)
+            break;
+    }
+    state.SetItemsProcessed(state.iterations() * concurrency);
+    latencies.report(state);
+}
+BENCHMARK(BM_fetch_async)->Arg(1)->Arg(8)->Arg(32)->UseRealTime();
+} // namespace
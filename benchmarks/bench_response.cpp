@@ -0,0 +1,86 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Benchmarks of parsing whole responses, with bodies of various sizes and framings.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include <benchmark/benchmark.h>
+
+#include <restpp/core/details/http_parser.hpp>
+
+namespace
+{
+/// <summary>
+/// A response with a body of the given size, framed with Content-Length or sent in chunks of
+/// at most 16 KiB.
+/// </summary>
+std::string sample_response(std::size_t body_size, bool chunked)
+{
+    std::string message = "HTTP/1.1 200 OK\r\n"
+                          "Content-Type: application/octet-stream\r\n"
+                          "Connection: keep-alive\r\n";
+    if (!chunked)
+        return message.append("Content-Length: ").append(std::to_string(body_size)).append("\r\n\r\n").append(body_size, 'x');
+
+    message.append("Transfer-Encoding: chunked\r\n\r\n");
+    for (std::size_t left = body_size; left > 0;)
+    {
+        const std::size_t size = std::min<std::size_t>(left, 16 * 1024);
+        char header[32];
+        std::snprintf(header, sizeof(header), "%zx\r\n", size);
+        message.append(header).append(size, 'x').append("\r\n");
+        left -= size;
+    }
+    return message.append("0\r\n\r\n");
+}
+
+/// <summary>
+/// Parses the response as it would come off the socket, in reads of 16 KiB, gathering the body
+/// into a string as a fetch does.
+/// </summary>
+void parse_response(benchmark::State& state, bool chunked)
+{
+    const auto body_size = static_cast<std::size_t>(state.range(0));
+    const std::string message = sample_response(body_size, chunked);
+    restpp::details::response_parser parser;
+    boost::system::error_code ec;
+    std::string body;
+
+    for (auto _ : state)
+    {
+        parser.reset();
+        body.clear();
+        std::size_t at = 0;
+        while (!parser.is_done() && !ec)
+        {
+            const std::size_t available = std::min<std::size_t>(message.size() - at, 16 * 1024);
+            at += parser.parse(message.data() + at, available, ec, [&](std::string_view piece) {
+                body.append(piece);
+                return true;
+            });
+        }
+        benchmark::DoNotOptimize(body.data());
+    }
+    if (ec)
+        state.SkipWithError(ec.message().c_str());
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * message.size()));
+}
+
+void BM_response_parse(benchmark::State& state) { parse_response(state, false); }
+BENCHMARK(BM_response_parse)->Arg(0)->Arg(1024)->Arg(64 * 1024)->Arg(1024 * 1024);
+
+void BM_response_parse_chunked(benchmark::State& state) { parse_response(state, true); }
+BENCHMARK(BM_response_parse_chunked)->Arg(1024)->Arg(64 * 1024)->Arg(1024 * 1024);
+} // namespace
@@ -0,0 +1,148 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Benchmarks of the embedded server: requests per second served over keep-alive connections,
+ * one request at a time through the client and in pipelined batches over a raw socket, and the
+ * router's dispatch of requests to their routes.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#include <cstdint>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include <restpp/restpp.hpp>
+#include <restpp/core/server.hpp>
+
+#include "loopback_server.hpp"
+
+using restpp::bench::latency_recorder;
+
+namespace
+{
+/// <summary>
+/// A server on a single I/O thread answering every request with a small text body, started
+/// on first use and shared by the benchmarks of the process.
+/// </summary>
+restpp::server& hello_server()
+{
+    static restpp::server server(
+        [] {
+            restpp::server_config config;
+            config.address = "127.0.0.1";
+            config.port = 0;
+            config.executor.io_threads = 1;
+            return config;
+        }(),
+        [](restpp::server_request&, restpp::server_response& res) {
+            res.headers.add(restpp::field::content_type, "text/plain");
+            res.body.assign("Hello, World!");
+        });
+    return server;
+}
+
+void BM_server_keep_alive(benchmark::State& state)
+{
+    const restpp::uri target("http://127.0.0.1:" + std::to_string(hello_server().port()) + "/hello");
+    restpp::client client;
+    restpp::options options;
+    restpp::response res;
+    latency_recorder latencies;
+    for (auto _ : state)
+    {
+        const auto start = latency_recorder::clock::now();
+        const auto ec = restpp::fetch(client, target, options, res);
+        latencies.add(latency_recorder::clock::now() - start);
+        if (ec || res.status_code != 200)
+        {
+            state.SkipWithError(ec ? ec.message().c_str() : "unexpected status");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+    latencies.report(state);
+}
+BENCHMARK(BM_server_keep_alive)->UseRealTime();
+
+/// <summary>
+/// Batches of pipelined requests written at once, and read back with the response parser, so
+/// that what is measured is mostly the server's parsing, dispatching and writing.
+/// </summary>
+void BM_server_pipelined(benchmark::State& state)
+{
+    const auto depth = static_cast<int>(state.range(0));
+    boost::asio::io_context io_context;
+    boost::asio::ip::tcp::socket socket(io_context);
+    socket.connect({boost::asio::ip::address_v4::loopback(), hello_server().port()});
+    socket.set_option(boost::asio::ip::tcp::no_delay(true));
+
+    std::string batch;
+    for (int i = 0; i < depth; ++i)
+        batch.append("GET /hello HTTP/1.1\r\nHost: 127.0.0.1\r\nUser-Agent: restpp-bench\r\n\r\n");
+
+    restpp::details::flat_buffer buffer;
+    restpp::details::response_parser parser;
+    boost::system::error_code ec;
+    for (auto _ : state)
+    {
+        boost::asio::write(socket, boost::asio::buffer(batch), ec);
+        for (int received = 0; received < depth && !ec;)
+        {
+            parser.reset();
+            while (!parser.is_done() && !ec)
+            {
+                buffer.consume(parser.parse(buffer.data(), buffer.size(), ec, [](std::string_view) {}));
+                if (parser.is_done() || ec)
+                    break;
+                const std::size_t n = socket.read_some(buffer.prepare(16 * 1024), ec);
+                buffer.commit(n);
+            }
+            ++received;
+        }
+        if (ec)
+        {
+            state.SkipWithError(ec.message().c_str());
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * depth);
+}
+BENCHMARK(BM_server_pipelined)->Arg(1)->Arg(16)->UseRealTime();
+
+/// <summary>
+/// Dispatch by a router of as many routes as the argument, each a literal, a parameter and a
+/// literal, which should take about as long whatever the number of routes.
+/// </summary>
+void BM_router_dispatch(benchmark::State& state)
+{
+    const auto routes = static_cast<int>(state.range(0));
+    restpp::router router;
+    std::int64_t served = 0;
+    for (int i = 0; i < routes; ++i)
+    {
+        router.get("/api/v1/resource" + std::to_string(i) + "/{id}/items",
+                   [&served](restpp::server_request&, restpp::server_response&) { ++served; });
+    }
+
+    restpp::server_request req;
+    req.method = "GET";
+    req.target = "/api/v1/resource" + std::to_string(routes / 2) + "/42/items?limit=10";
+    restpp::server_response res;
+    for (auto _ : state)
+    {
+        router(req, res);
+        benchmark::DoNotOptimize(req.params);
+    }
+    if (served != static_cast<std::int64_t>(state.iterations()))
+        state.SkipWithError("request not routed");
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_router_dispatch)->Arg(10)->Arg(1000)->Arg(10000);
+} // namespace
@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+# Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+# Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+#
+# Compares two runs of restpp_bench written with --benchmark_out_format=json, such as the
+# baseline of the last release and the current build, and fails when a benchmark got slower
+# than the threshold allows.
+#
+#   compare.py baseline.json current.json [--threshold 10]
+
+import argparse
+import json
+import sys
+
+# Metrics compared, and whether a larger value is an improvement
+METRICS = (("real_time", False), ("p50_us", False), ("p99_us", False))
+
+
+def load(path):
+    """Maps every benchmark to its results, preferring the median of repeated runs."""
+    with open(path) as f:
+        data = json.load(f)
+    results = {}
+    for run in data["benchmarks"]:
+        if run.get("run_type") == "aggregate":
+            if run.get("aggregate_name") != "median":
+                continue
+            results[run["run_name"]] = run
+        else:
+            results.setdefault(run.get("run_name", run["name"]), run)
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="percentage a metric may get worse by before failing (default 10)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+    regressions = 0
+    print(f"{'benchmark':<44}{'metric':<12}{'baseline':>14}{'current':>14}{'change':>10}")
+    for name in sorted(baseline.keys() & current.keys()):
+        for metric, higher_is_better in METRICS:
+            if metric not in baseline[name] or metric not in current[name]:
+                continue
+            old, new = float(baseline[name][metric]), float(current[name][metric])
+            if old == 0:
+                continue
+            change = (new - old) / old * 100
+            worse = -change if higher_is_better else change
+            flag = ""
+            if worse > args.threshold:
+                regressions += 1
+                flag = "  REGRESSION"
+            print(f"{name:<44}{metric:<12}{old:>14.2f}{new:>14.2f}{change:>+9.1f}%{flag}")
+
+    for name in sorted(baseline.keys() - current.keys()):
+        print(f"{name:<44}missing from the current run")
+    if regressions:
+        print(f"\n{regressions} metric(s) regressed by more than {args.threshold}%")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,191 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * A minimal HTTP/1.1 server on the loopback interface, serving the end-to-end benchmarks.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_BENCH_LOOPBACK_SERVER_HPP
+#define RESTPP_BENCH_LOOPBACK_SERVER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace restpp
+{
+namespace bench
+{
+/// <summary>
+/// Serves "GET /bytes/N" with a body of N bytes over keep-alive connections, on a thread of its
+/// own. Responses are built once per size, so the server costs as little as possible of what
+/// is measured.
+/// </summary>
+class loopback_server
+{
+public:
+    loopback_server()
+        : _acceptor(_io_context, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0))
+    {
+        accept();
+        _thread = std::thread([this] { _io_context.run(); });
+    }
+
+    loopback_server(const loopback_server&) = delete;
+    loopback_server& operator=(const loopback_server&) = delete;
+
+    ~loopback_server()
+    {
+        _io_context.stop();
+        _thread.join();
+    }
+
+    /// <summary>
+    /// The server shared by every benchmark of the process, started on first use.
+    /// </summary>
+    static loopback_server& instance()
+    {
+        static loopback_server server;
+        return server;
+    }
+
+    std::string url(std::size_t body_size) const
+    {
+        return "http://127.0.0.1:" + std::to_string(_acceptor.local_endpoint().port()) + "/bytes/" +
+               std::to_string(body_size);
+    }
+
+private:
+    class session : public std::enable_shared_from_this<session>
+    {
+    public:
+        session(loopback_server& server, boost::asio::ip::tcp::socket socket)
+            : _server(server), _socket(std::move(socket))
+        {
+        }
+
+        void read()
+        {
+            boost::asio::async_read_until(
+                _socket,
+                boost::asio::dynamic_buffer(_input),
+                "\r\n\r\n",
+                [self = shared_from_this()](boost::system::error_code ec, std::size_t size) {
+                    if (!ec)
+                        self->respond(size);
+                });
+        }
+
+    private:
+        void respond(std::size_t head_size)
+        {
+            const std::string_view head(_input.data(), head_size);
+            const auto path_start = head.find(' ') + 1;
+            const auto path = head.substr(path_start, head.find(' ', path_start) - path_start);
+            std::size_t size = 0;
+            if (path.compare(0, 7, "/bytes/") == 0)
+                size = std::stoul(std::string(path.substr(7)));
+            _close = head.find("Connection: close") != std::string_view::npos;
+            _input.erase(0, head_size);
+
+            boost::asio::async_write(_socket,
+                                     boost::asio::buffer(_server.response_of(size, _close)),
+                                     [self = shared_from_this()](boost::system::error_code ec, std::size_t) {
+                                         if (!ec && !self->_close)
+                                             self->read();
+                                     });
+        }
+
+        loopback_server& _server;
+        boost::asio::ip::tcp::socket _socket;
+        std::string _input;
+        bool _close = false;
+    };
+
+    void accept()
+    {
+        _acceptor.async_accept([this](boost::system::error_code ec, boost::asio::ip::tcp::socket socket) {
+            if (ec)
+                return;
+            socket.set_option(boost::asio::ip::tcp::no_delay(true), ec);
+            std::make_shared<session>(*this, std::move(socket))->read();
+            accept();
+        });
+    }
+
+    /// <summary>
+    /// The response carrying a body of the given size. Only used on the server thread.
+    /// </summary>
+    const std::string& response_of(std::size_t size, bool close)
+    {
+        auto& response = _responses[{size, close}];
+        if (response.empty())
+        {
+            response = "HTTP/1.1 200 OK\r\nServer: restpp-bench\r\nContent-Type: application/octet-stream\r\n";
+            response.append(close ? "Connection: close\r\n" : "Connection: keep-alive\r\n");
+            response.append("Content-Length: ").append(std::to_string(size)).append("\r\n\r\n");
+            response.append(size, 'x');
+        }
+        return response;
+    }
+
+    boost::asio::io_context _io_context;
+    boost::asio::ip::tcp::acceptor _acceptor;
+    std::map<std::pair<std::size_t, bool>, std::string> _responses;
+    std::thread _thread;
+};
+
+/// <summary>
+/// Collects the latency of every request of a benchmark and reports its percentiles, in
+/// microseconds, as the p50_us and p99_us counters.
+/// </summary>
+class latency_recorder
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    void add(clock::duration latency)
+    {
+        _samples.push_back(std::chrono::duration<double, std::micro>(latency).count());
+    }
+
+    void report(benchmark::State& state)
+    {
+        if (_samples.empty())
+            return;
+        std::sort(_samples.begin(), _samples.end());
+        state.counters["p50_us"] = percentile(0.50);
+        state.counters["p99_us"] = percentile(0.99);
+    }
+
+private:
+    double percentile(double rank) const
+    {
+        const auto index = static_cast<std::size_t>(rank * static_cast<double>(_samples.size() - 1) + 0.5);
+        return _samples[std::min(index, _samples.size() - 1)];
+    }
+
+    std::vector<double> _samples;
+};
+
+} // namespace bench
+} // namespace restpp
+
+#endif // RESTPP_BENCH_LOOPBACK_SERVER_HPP
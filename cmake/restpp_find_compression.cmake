@@ -0,0 +1,30 @@
+function(restpp_find_compression)
+    if(TARGET restpp_compression_internal)
+        return()
+    endif()
+
+    add_library(restpp_compression_internal INTERFACE)
+    if(RESTPP_EXCLUDE_COMPRESSION)
+        target_compile_definitions(restpp_compression_internal INTERFACE RESTPP_EXCLUDE_COMPRESSION)
+        return()
+    endif()
+
+    find_package(ZLIB REQUIRED)
+    target_link_libraries(restpp_compression_internal INTERFACE ZLIB::ZLIB)
+
+    if(RESTPP_WITH_BROTLI OR RESTPP_WITH_ZSTD)
+        find_package(PkgConfig REQUIRED)
+    endif()
+    if(RESTPP_WITH_BROTLI)
+        pkg_search_module(BROTLIDEC REQUIRED libbrotlidec)
+        target_compile_definitions(restpp_compression_internal INTERFACE RESTPP_WITH_BROTLI)
+        target_include_directories(restpp_compression_internal INTERFACE "$<BUILD_INTERFACE:${BROTLIDEC_INCLUDE_DIRS}>")
+        target_link_libraries(restpp_compression_internal INTERFACE ${BROTLIDEC_LDFLAGS})
+    endif()
+    if(RESTPP_WITH_ZSTD)
+        pkg_search_module(ZSTD REQUIRED libzstd)
+        target_compile_definitions(restpp_compression_internal INTERFACE RESTPP_WITH_ZSTD)
+        target_include_directories(restpp_compression_internal INTERFACE "$<BUILD_INTERFACE:${ZSTD_INCLUDE_DIRS}>")
+        target_link_libraries(restpp_compression_internal INTERFACE ${ZSTD_LDFLAGS})
+    endif()
+endfunction()
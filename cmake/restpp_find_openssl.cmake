@@ -19,8 +19,9 @@ function(restpp_find_openssl)
       find_package(PkgConfig)
       pkg_search_module(OPENSSL openssl)
     endif()
+    add_library(restpp_openssl_internal INTERFACE)
     if(OPENSSL_FOUND)
-      target_link_libraries(restpp PRIVATE ${OPENSSL_LDFLAGS})
+      target_link_libraries(restpp_openssl_internal INTERFACE ${OPENSSL_LDFLAGS})
     else()
       find_package(OpenSSL 1.0.0 REQUIRED)
     endif()
@@ -36,7 +37,6 @@ function(restpp_find_openssl)
       }
     " _SSL_LEAK_SUPPRESS_AVAILABLE)
 
-    add_library(restpp_openssl_internal INTERFACE)
     if(TARGET OpenSSL::SSL)
         target_link_libraries(restpp_openssl_internal INTERFACE OpenSSL::SSL)
     else()
@@ -0,0 +1,30 @@
+function(restpp_library)
+    if(TARGET restpp_internal)
+        return()
+    endif()
+
+    # The headers with the options they were configured for, linked by every target built on them
+    add_library(restpp_internal INTERFACE)
+    target_include_directories(restpp_internal INTERFACE "$<BUILD_INTERFACE:${PROJECT_SOURCE_DIR}/include>")
+
+    restpp_find_boost()
+    target_link_libraries(restpp_internal INTERFACE restpp_boost_internal)
+
+    if(RESTPP_EXCLUDE_FRAMEWORK)
+        target_compile_definitions(restpp_internal INTERFACE RESTPP_EXCLUDE_FRAMEWORK)
+    endif()
+
+    if(RESTPP_UTF8_STRINGS)
+        target_compile_definitions(restpp_internal INTERFACE RESTPP_UTF8_STRINGS)
+    endif()
+
+    if(RESTPP_EXCLUDE_SSL)
+        target_compile_definitions(restpp_internal INTERFACE RESTPP_EXCLUDE_SSL)
+    else()
+        restpp_find_openssl()
+        target_link_libraries(restpp_internal INTERFACE restpp_openssl_internal)
+    endif()
+
+    restpp_find_compression()
+    target_link_libraries(restpp_internal INTERFACE restpp_compression_internal)
+endfunction()
@@ -0,0 +1,54 @@
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <restpp/restpp.hpp>
+
+// Streams the numbers up to 10, one line at a time: every line waits for the previous one to be
+// sent, so a slow client slows the counter down instead of filling memory.
+struct counter : std::enable_shared_from_this<counter>
+{
+    explicit counter(restpp::response_stream out) : out(std::move(out)) {}
+
+    void next()
+    {
+        if (value == 10)
+            return out.end();
+
+        line = std::to_string(value++) + "\n";
+        out.write(line, [self = shared_from_this()](boost::system::error_code ec) {
+            if (!ec)
+                self->next();
+        });
+    }
+
+    restpp::response_stream out;
+    std::string line;
+    int value = 0;
+};
+
+int main()
+{
+    restpp::server_config config;
+    config.port = 8080;
+
+    restpp::server server(config, [](restpp::server_request& req, restpp::server_response& res) {
+        if (req.path() == "/hello")
+        {
+            res.headers.add(restpp::field::content_type, "text/plain");
+            res.body = "Hello, World!";
+        }
+        else if (req.path() == "/count")
+        {
+            std::make_shared<counter>(res.stream())->next();
+        }
+        else
+        {
+            res.status_code = 404;
+        }
+    });
+
+    std::cout << "Listening on port " << server.port() << ", press enter to stop\n";
+    std::cin.get();
+    return 0;
+}
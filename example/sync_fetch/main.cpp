@@ -19,6 +19,13 @@ int main()
     // fetch(Tchar)
     // fetch(Tchar, options)
 
+    // Fetch a local resource, mapped into memory rather than read
+    auto res1 = restpp::fetch("file:///etc/hostname");
+    if (res1.error)
+        std::cout << "Error: " << res1.error.message() << '\n';
+    else
+        std::cout << "Hostname: " << res1.content() << '\n';
+
     // Fetch a local resource
     // ----------------------
     // fetch(rstpp::request)
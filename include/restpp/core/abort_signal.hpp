@@ -0,0 +1,128 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Aborting requests that are in flight, in the manner of the AbortController of the Fetch API.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_ABORT_SIGNAL_HPP
+#define RESTPP_ABORT_SIGNAL_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace restpp
+{
+class abort_controller;
+
+/// <summary>
+/// The receiving end of an <c>abort_controller</c>, set in <c>options::signal</c>. Any number of
+/// requests may share a signal; aborting it fails every one of them still in flight with
+/// <c>restpp::error::aborted</c>, and those started afterwards right away. A default constructed
+/// signal never fires.
+/// </summary>
+class abort_signal
+{
+public:
+    using listener = std::function<void()>;
+
+    abort_signal() = default;
+
+    explicit operator bool() const { return _state != nullptr; }
+
+    bool aborted() const
+    {
+        if (!_state)
+            return false;
+        std::lock_guard<std::mutex> lock(_state->mutex);
+        return _state->aborted;
+    }
+
+    /// <summary>
+    /// Registers a function called once when the signal fires, on the thread aborting it. It is
+    /// called right away when the signal has already fired.
+    /// </summary>
+    /// <returns>An id for <c>unsubscribe</c>, or 0 when the function was already called.</returns>
+    std::uint64_t subscribe(listener on_abort) const
+    {
+        if (!_state)
+            return 0;
+        {
+            std::lock_guard<std::mutex> lock(_state->mutex);
+            if (!_state->aborted)
+            {
+                const std::uint64_t id = _state->next_id++;
+                _state->listeners.emplace(id, std::move(on_abort));
+                return id;
+            }
+        }
+        on_abort();
+        return 0;
+    }
+
+    void unsubscribe(std::uint64_t id) const
+    {
+        if (!_state || id == 0)
+            return;
+        std::lock_guard<std::mutex> lock(_state->mutex);
+        _state->listeners.erase(id);
+    }
+
+private:
+    friend class abort_controller;
+
+    struct state
+    {
+        std::mutex mutex;
+        bool aborted = false;
+        std::uint64_t next_id = 1;
+        std::unordered_map<std::uint64_t, listener> listeners;
+    };
+
+    explicit abort_signal(std::shared_ptr<state> shared) : _state(std::move(shared)) {}
+
+    std::shared_ptr<state> _state;
+};
+
+/// <summary>
+/// Aborts the requests given its signal. Thread-safe; aborting more than once does nothing.
+/// </summary>
+class abort_controller
+{
+public:
+    abort_controller() : _state(std::make_shared<abort_signal::state>()) {}
+
+    abort_signal signal() const { return abort_signal(_state); }
+
+    void abort()
+    {
+        std::unordered_map<std::uint64_t, abort_signal::listener> listeners;
+        {
+            std::lock_guard<std::mutex> lock(_state->mutex);
+            if (_state->aborted)
+                return;
+            _state->aborted = true;
+            listeners.swap(_state->listeners);
+        }
+        for (auto& entry : listeners)
+            entry.second();
+    }
+
+private:
+    std::shared_ptr<abort_signal::state> _state;
+};
+
+} // namespace restpp
+
+#endif // RESTPP_ABORT_SIGNAL_HPP
@@ -15,14 +15,19 @@
 #ifndef ASYNCRT_UTILS_HPP
 #define ASYNCRT_UTILS_HPP
 
+#include <charconv>
+#include <chrono>
 #include <cstdint>
 #include <limits.h>
 #include <random>
 #include <string>
+#include <string_view>
 #include <system_error>
 #include <memory>
+#include <type_traits>
 
 #include <restpp/core/details/basic_types.hpp>
+#include <restpp/core/details/http_date.hpp>
 
 #ifndef _WIN32
 #include <sys/time.h>
@@ -220,9 +225,25 @@ inline utility::string_t to_string_t(const T t)
 #endif
 }
 
+/// <summary>
+/// Integers other than bool and characters, which print and scan with <c>to_chars</c> and
+/// <c>from_chars</c> rather than through a stream and its locale.
+/// </summary>
+template<typename T>
+constexpr bool is_charconv_integer = std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                                     !std::is_same_v<T, char> && !std::is_same_v<T, wchar_t> &&
+                                     !std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t> &&
+                                     !std::is_same_v<T, signed char> && !std::is_same_v<T, unsigned char>;
+
 template<typename Source>
 utility::string_t print_string(const Source& val)
 {
+    if constexpr (is_charconv_integer<Source>)
+    {
+        char digits[24];
+        const char* end = std::to_chars(digits, digits + sizeof(digits), val).ptr;
+        return utility::string_t(static_cast<const char*>(digits), end);
+    }
     utility::ostringstream_t oss;
     oss.imbue(std::locale::classic());
     oss << val;
@@ -245,6 +266,30 @@ inline const utf8string& print_utf8string(const utf8string& val) { return val; }
 template<typename Target>
 Target scan_string(const utility::string_t& str)
 {
+    if constexpr (is_charconv_integer<Target>)
+    {
+        // Like the stream: leading white space is skipped and what does not parse reads as zero
+        std::size_t at = 0;
+        while (at < str.size() && (str[at] == ' ' || str[at] == '\t' || str[at] == '\n' || str[at] == '\r'))
+            ++at;
+#ifdef _UTF16_STRINGS
+        char digits[24];
+        std::size_t size = 0;
+        for (; at < str.size() && size < sizeof(digits) && str[at] < 0x80; ++at)
+            digits[size++] = static_cast<char>(str[at]);
+        const char* begin = digits;
+        const char* end = digits + size;
+#else
+        const char* begin = str.data() + at;
+        const char* end = str.data() + str.size();
+#endif
+        if (begin != end && *begin == '+')
+            ++begin;
+        Target t{};
+        if (std::from_chars(begin, end, t).ec != std::errc{})
+            t = Target{};
+        return t;
+    }
     Target t;
     utility::istringstream_t iss(str);
     iss.imbue(std::locale::classic());
@@ -285,7 +330,8 @@ namespace details
 /// <summary>
 /// Cross platform RAII container for setting thread local locale.
 /// </summary>
-class scoped_c_thread_locale
+class RESTPP_DEPRECATED("Formatting and parsing no longer depend on the locale; use std::to_chars and "
+                        "std::from_chars.") scoped_c_thread_locale
 {
 public:
     _ASYNCRTIMP scoped_c_thread_locale();
@@ -557,7 +603,7 @@ public:
     /// <summary>
     /// Returns the current UTC time.
     /// </summary>
-    static _ASYNCRTIMP datetime __cdecl utc_now();
+    static datetime __cdecl utc_now();
 
     /// <summary>
     /// An invalid UTC timestamp value.
@@ -590,19 +636,19 @@ public:
     /// Creates <c>datetime</c> from a string representing time in UTC in RFC 1123 or ISO 8601 format.
     /// </summary>
     /// <returns>Returns a <c>datetime</c> of zero if not successful.</returns>
-    static _ASYNCRTIMP datetime __cdecl from_string(const utility::string_t& timestring, date_format format = RFC_1123);
+    static datetime __cdecl from_string(const utility::string_t& timestring, date_format format = RFC_1123);
 
     /// <summary>
     /// Creates <c>datetime</c> from a string representing time in UTC in RFC 1123 or ISO 8601 format.
     /// </summary>
     /// <returns>Returns <c>datetime::maximum()</c> if not successful.</returns>
-    static _ASYNCRTIMP datetime __cdecl from_string_maximum_error(const utility::string_t& timestring,
-                                                                  date_format format = RFC_1123);
+    static datetime __cdecl from_string_maximum_error(const utility::string_t& timestring,
+                                                      date_format format = RFC_1123);
 
     /// <summary>
     /// Returns a string representation of the <c>datetime</c>.
     /// </summary>
-    _ASYNCRTIMP utility::string_t to_string(date_format format = RFC_1123) const;
+    utility::string_t to_string(date_format format = RFC_1123) const;
 
     /// <summary>
     /// Returns the integral time value.
@@ -667,6 +713,52 @@ inline int operator-(datetime t1, datetime t2)
     return static_cast<int>(diff);
 }
 
+namespace details
+{
+/// <summary>
+/// Ticks of a <c>datetime</c> from 1601-01-01, where it counts from, to 1970-01-01.
+/// </summary>
+constexpr datetime::interval_type unix_epoch_ticks = 11644473600ULL * 10000000ULL;
+} // namespace details
+
+inline datetime __cdecl datetime::utc_now()
+{
+    const auto now = std::chrono::floor<restpp::details::date_ticks>(std::chrono::system_clock::now().time_since_epoch());
+    return datetime(static_cast<interval_type>(now.count()) + details::unix_epoch_ticks);
+}
+
+inline datetime __cdecl datetime::from_string_maximum_error(const utility::string_t& timestring, date_format format)
+{
+#ifdef _UTF16_STRINGS
+    std::string narrow(timestring.size(), '\0');
+    for (std::size_t i = 0; i < timestring.size(); ++i)
+        narrow[i] = timestring[i] < 0x80 ? static_cast<char>(timestring[i]) : '\0';
+    const std::string_view text(narrow);
+#else
+    const std::string_view text(timestring);
+#endif
+    const auto parsed = format == RFC_1123 ? restpp::details::parse_http_date_ticks(text)
+                                           : restpp::details::parse_iso8601_date_ticks(text);
+    if (!parsed || parsed->count() < -static_cast<std::int64_t>(details::unix_epoch_ticks))
+        return maximum();
+    return datetime(static_cast<interval_type>(parsed->count()) + details::unix_epoch_ticks);
+}
+
+inline datetime __cdecl datetime::from_string(const utility::string_t& timestring, date_format format)
+{
+    const datetime result = from_string_maximum_error(timestring, format);
+    return result == maximum() ? datetime() : result;
+}
+
+inline utility::string_t datetime::to_string(date_format format) const
+{
+    const restpp::details::date_ticks since_epoch(static_cast<std::int64_t>(m_interval - details::unix_epoch_ticks));
+    char text[restpp::details::max_date_size];
+    const char* end = format == RFC_1123 ? restpp::details::write_http_date(text, since_epoch)
+                                         : restpp::details::write_iso8601_date(text, since_epoch);
+    return utility::string_t(static_cast<const char*>(text), end);
+}
+
 /// <summary>
 /// Nonce string generator class.
 /// </summary>
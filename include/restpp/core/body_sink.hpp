@@ -0,0 +1,129 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Consumers of streamed response bodies.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_BODY_SINK_HPP
+#define RESTPP_BODY_SINK_HPP
+
+#include <cerrno>
+#include <functional>
+#include <ostream>
+#include <string_view>
+
+#include <boost/system/error_code.hpp>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace restpp
+{
+
+/// <summary>
+/// Receives the body of a response piece by piece as it arrives, instead of having it
+/// accumulated in <c>response::body</c>. No more data is read from the connection until the
+/// sink accepted the current piece, so a slow consumer throttles the transfer and memory stays
+/// bounded by <c>options::chunk_size</c> whatever the size of the body.
+///
+/// The views handed to a sink point into the receive buffer and are only valid during the call
+/// (or, for asynchronous sinks, until the completion is invoked).
+/// </summary>
+class body_sink
+{
+public:
+    /// <summary>
+    /// Consumes a piece of body synchronously. Returning false aborts the transfer.
+    /// </summary>
+    using write_handler = std::function<bool(std::string_view data)>;
+
+    /// <summary>
+    /// Consumes a piece of body asynchronously, then invokes <c>done</c> exactly once. Passing
+    /// an error to <c>done</c> aborts the transfer.
+    /// </summary>
+    using async_write_handler =
+        std::function<void(std::string_view data, std::function<void(boost::system::error_code)> done)>;
+
+    /// <summary>
+    /// An empty sink: the body is accumulated in the response.
+    /// </summary>
+    body_sink() = default;
+
+    body_sink(write_handler handler) : _write(std::move(handler)) {}
+
+    /// <summary>
+    /// Creates a sink that consumes every piece asynchronously.
+    /// </summary>
+    static body_sink from_async(async_write_handler handler)
+    {
+        body_sink sink;
+        sink._async_write = std::move(handler);
+        return sink;
+    }
+
+    /// <summary>
+    /// Creates a sink that writes the body to the given stream, which must outlive the request.
+    /// </summary>
+    static body_sink to_stream(std::ostream& stream)
+    {
+        return body_sink([&stream](std::string_view data) {
+            stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+            return static_cast<bool>(stream);
+        });
+    }
+
+    /// <summary>
+    /// Creates a sink that writes the body to the given file descriptor, which is not closed.
+    /// </summary>
+    static body_sink to_fd(int fd)
+    {
+        return body_sink([fd](std::string_view data) {
+            while (!data.empty())
+            {
+#ifdef _WIN32
+                const int written = ::_write(fd, data.data(), static_cast<unsigned int>(data.size()));
+#else
+                const auto written = ::write(fd, data.data(), data.size());
+#endif
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return false;
+                }
+                data.remove_prefix(static_cast<std::size_t>(written));
+            }
+            return true;
+        });
+    }
+
+    explicit operator bool() const { return _write || _async_write; }
+
+    bool is_async() const { return static_cast<bool>(_async_write); }
+
+    bool write(std::string_view data) const { return _write(data); }
+
+    void async_write(std::string_view data, std::function<void(boost::system::error_code)> done) const
+    {
+        _async_write(data, std::move(done));
+    }
+
+private:
+    write_handler _write;
+    async_write_handler _async_write;
+};
+
+} // namespace restpp
+
+#endif // RESTPP_BODY_SINK_HPP
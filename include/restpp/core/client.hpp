@@ -0,0 +1,395 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Client session that keeps connections alive across requests.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_CLIENT_HPP
+#define RESTPP_CLIENT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include <restpp/core/executor.hpp>
+#include <restpp/core/http_cache.hpp>
+#include <restpp/core/observer.hpp>
+#include <restpp/core/policy.hpp>
+#include <restpp/core/tls_config.hpp>
+#include <restpp/core/details/connection_pool.hpp>
+#include <restpp/core/details/content_decoder.hpp>
+#include <restpp/core/details/dns_cache.hpp>
+#include <restpp/core/details/fetch_policy.hpp>
+#include <restpp/core/details/h2_session.hpp>
+#include <restpp/core/details/single_flight.hpp>
+#include <restpp/core/details/tls_context.hpp>
+
+namespace restpp
+{
+
+/// <summary>
+/// Settings shared by every request made through a <c>client</c>.
+/// </summary>
+struct client_config
+{
+    /// <summary>
+    /// Keep connections open after a response so later requests to the same origin skip the
+    /// DNS lookup and TCP handshake. When disabled every request is sent with "Connection: close".
+    /// </summary>
+    bool keep_alive = true;
+
+    /// <summary>
+    /// Maximum number of idle connections kept per (scheme, host, port).
+    /// </summary>
+    std::size_t max_idle_per_host = 8;
+
+    /// <summary>
+    /// Maximum number of requests in flight at once to the same (scheme, host, port), and so of
+    /// the HTTP/1.1 connections busy with them. Requests past it wait for one to complete, in
+    /// order, and stop waiting once aborted or past their deadline. Requests to an HTTP/2 server
+    /// count as well, though they share its connection. Zero, the default, sets no limit.
+    /// Batches of <c>fetch_all</c> are limited by <c>fetch_all_config::max_per_host</c> instead.
+    /// </summary>
+    std::size_t max_connections_per_host = 0;
+
+    /// <summary>
+    /// Idle connections older than this are closed. A client on its own I/O context or on an
+    /// executor closes them from a timer; one on a caller supplied I/O context closes them as
+    /// other connections are handed back, and otherwise through <c>close_idle_connections()</c>.
+    /// </summary>
+    std::chrono::steady_clock::duration idle_timeout = std::chrono::seconds(30);
+
+    /// <summary>
+    /// How long resolved addresses are reused. The system resolver does not report record TTLs,
+    /// so this is the age after which a host is always resolved again. Zero disables the cache.
+    /// </summary>
+    std::chrono::steady_clock::duration dns_max_age = std::chrono::seconds(60);
+
+    /// <summary>
+    /// A cached host used within this long of its expiry is resolved again in the background,
+    /// without delaying the request that noticed it.
+    /// </summary>
+    std::chrono::steady_clock::duration dns_refresh_ahead = std::chrono::seconds(10);
+
+    /// <summary>
+    /// Maximum number of hosts kept in the DNS cache.
+    /// </summary>
+    std::size_t dns_max_entries = 1024;
+
+    /// <summary>
+    /// Offer HTTP/2 to https servers through ALPN. Requests to a server that accepts it are
+    /// multiplexed as streams over a single connection instead of using one connection each.
+    /// </summary>
+    bool http2 = true;
+
+    /// <summary>
+    /// Settings of the TLS context used for https requests.
+    /// </summary>
+    tls_config tls;
+
+    /// <summary>
+    /// Where the client gets memory for its requests. The client keeps a pool on top of it, so
+    /// after the first few requests the memory of finished requests is reused rather than given
+    /// back. Defaults to the global heap; must outlive the client.
+    /// </summary>
+    std::pmr::memory_resource* memory_resource = nullptr;
+
+    /// <summary>
+    /// Threads of an executor the client creates for itself when <c>executor.io_threads</c> is
+    /// not zero. Defaults to zero, which leaves the client on a single private I/O context.
+    /// </summary>
+    executor_config executor{0};
+
+    /// <summary>
+    /// The HTTP cache requests look in before going to the network, and store their responses
+    /// in. None by default; one cache may be shared by several clients.
+    /// </summary>
+    std::shared_ptr<http_cache> cache;
+
+    /// <summary>
+    /// Told about every request the client makes and how it went, for metrics. None by default.
+    /// </summary>
+    std::shared_ptr<fetch_observer> observer;
+
+    /// <summary>
+    /// Coalesce identical requests: a GET or HEAD made while the same one is in flight, with the
+    /// same URI and headers, waits for the response to that one instead of being sent, and every
+    /// fetch sharing it gets the same response. Suits many workers asking for the same resource
+    /// at once, such as when a popular cache entry expires. Off by default.
+    /// </summary>
+    bool coalesce = false;
+
+    /// <summary>
+    /// Sends idempotent requests that failed in a transient way again. Off by default.
+    /// </summary>
+    retry_policy retry;
+
+    /// <summary>
+    /// Sends a backup of slow GET requests, the first answer winning. Off by default.
+    /// </summary>
+    hedge_policy hedge;
+
+    /// <summary>
+    /// Limits the requests in flight to each host to what its latency shows it can take. Off
+    /// by default.
+    /// </summary>
+    concurrency_policy concurrency;
+
+    /// <summary>
+    /// Whether requests wait for a slot under a limit of requests in flight to their host.
+    /// </summary>
+    bool limits_concurrency() const { return concurrency.adaptive || max_connections_per_host != 0; }
+
+    /// <summary>
+    /// Whether requests go through any of the retry, hedging or concurrency policies.
+    /// </summary>
+    bool uses_policies() const { return retry.max_attempts > 1 || hedge.enabled || limits_concurrency(); }
+};
+
+namespace details
+{
+/// <summary>
+/// The connections of a client that live on one I/O context. They are only opened, used and
+/// handed back on that context.
+/// </summary>
+struct client_shard
+{
+    client_shard(boost::asio::io_context& io_context, const client_config& config)
+        : io_context(io_context)
+        , pool(config.keep_alive ? config.max_idle_per_host : 0, config.idle_timeout)
+        , h2_pool(config.idle_timeout)
+    {
+    }
+
+    boost::asio::io_context& io_context;
+    connection_pool pool;
+    h2_session_pool h2_pool;
+    decoder_pool decoders;
+};
+} // namespace details
+
+/// <summary>
+/// A session holding the pool of keep-alive connections used by <c>fetch(client&amp;, ...)</c> and
+/// <c>async_fetch(client&amp;, ...)</c>. A client may be shared between threads.
+///
+/// A client either owns a private I/O context, which synchronous fetches drive on the calling
+/// thread, or runs on an I/O context supplied by the caller. In the latter case asynchronous
+/// operations complete on the threads running that context, and the client must outlive them.
+///
+/// A client may instead run on the I/O contexts of an executor, its own or a shared one. Each
+/// request goes to the next context in turn, along with the connections it uses, and completes on
+/// that context's thread.
+/// </summary>
+class client
+{
+public:
+    explicit client(client_config config = {})
+        : _config(config)
+        , _memory(memory_options(), config.memory_resource ? config.memory_resource : std::pmr::new_delete_resource())
+        , _owned_io_context(config.executor.io_threads == 0 ? std::make_unique<boost::asio::io_context>() : nullptr)
+        , _owned_executor(config.executor.io_threads != 0 ? std::make_unique<restpp::executor>(config.executor) : nullptr)
+        , _executor(_owned_executor.get())
+        , _dns(std::make_shared<details::dns_cache>(config.dns_max_age, config.dns_refresh_ahead, config.dns_max_entries))
+    {
+        if (_executor)
+            make_shards();
+        else
+            _shards.push_back(std::make_unique<details::client_shard>(*_owned_io_context, _config));
+        for (auto& shard : _shards)
+            shard->pool.sweep_on(shard->io_context);
+    }
+
+    explicit client(boost::asio::io_context& io_context, client_config config = {})
+        : _config(config)
+        , _memory(memory_options(), config.memory_resource ? config.memory_resource : std::pmr::new_delete_resource())
+        , _dns(std::make_shared<details::dns_cache>(config.dns_max_age, config.dns_refresh_ahead, config.dns_max_entries))
+    {
+        _shards.push_back(std::make_unique<details::client_shard>(io_context, _config));
+    }
+
+    /// <summary>
+    /// Creates a client running on the I/O contexts of an executor, which must outlive it.
+    /// <c>config.executor</c> is ignored.
+    /// </summary>
+    explicit client(restpp::executor& executor, client_config config = {})
+        : _config(config)
+        , _memory(memory_options(), config.memory_resource ? config.memory_resource : std::pmr::new_delete_resource())
+        , _executor(&executor)
+        , _dns(std::make_shared<details::dns_cache>(config.dns_max_age, config.dns_refresh_ahead, config.dns_max_entries))
+    {
+        make_shards();
+        for (auto& shard : _shards)
+            shard->pool.sweep_on(shard->io_context);
+    }
+
+    client(const client&) = delete;
+    client& operator=(const client&) = delete;
+
+    ~client()
+    {
+        // Handlers of the executor's threads may still touch the pools being destroyed
+        if (_owned_executor)
+            _owned_executor->stop();
+    }
+
+    const client_config& config() const { return _config; }
+
+    /// <summary>
+    /// Closes every idle connection held by the client, including HTTP/2 connections that have
+    /// no request in flight.
+    /// </summary>
+    void close_idle_connections()
+    {
+        for (auto& shard : _shards)
+        {
+            shard->pool.clear();
+            shard->h2_pool.close_idle();
+        }
+    }
+
+    /// <summary>
+    /// The I/O context of the client, or the first one of its executor.
+    /// </summary>
+    boost::asio::io_context& io_context() { return _shards.front()->io_context; }
+
+    /// <summary>
+    /// Whether the client runs on its own private I/O context.
+    /// </summary>
+    bool owns_io_context() const { return _owned_io_context != nullptr; }
+
+    /// <summary>
+    /// The executor the client runs on, or nullptr when it runs on a single I/O context.
+    /// </summary>
+    restpp::executor* executor() { return _executor; }
+
+    /// <summary>
+    /// The connections of the client on its first I/O context.
+    /// </summary>
+    details::connection_pool& pool() { return _shards.front()->pool; }
+
+    /// <summary>
+    /// The pooled memory resource requests made through the client are served from.
+    /// </summary>
+    std::pmr::memory_resource* memory() { return &_memory; }
+
+    /// <summary>
+    /// The HTTP/2 connections of the client on its first I/O context, shared by all requests to
+    /// the same origin.
+    /// </summary>
+    details::h2_session_pool& h2_pool() { return _shards.front()->h2_pool; }
+
+    /// <summary>
+    /// The shard the next request goes to. Shards are taken in turns.
+    /// </summary>
+    details::client_shard& next_shard()
+    {
+        if (_shards.size() == 1)
+            return *_shards.front();
+        return *_shards[_next_shard.fetch_add(1, std::memory_order_relaxed) % _shards.size()];
+    }
+
+    std::size_t shard_count() const { return _shards.size(); }
+
+    details::client_shard& shard(std::size_t index) { return *_shards[index % _shards.size()]; }
+
+    /// <summary>
+    /// The DNS cache of the client. Background refreshes hold it weakly, so it may safely go
+    /// away with the client while one is in flight.
+    /// </summary>
+    const std::shared_ptr<details::dns_cache>& dns() const { return _dns; }
+
+    /// <summary>
+    /// The requests in flight that others with identical ones wait for, when coalescing.
+    /// </summary>
+    details::single_flight& flights() { return _flights; }
+
+    /// <summary>
+    /// What the retry, hedging and concurrency policies learnt of each host.
+    /// </summary>
+    details::host_policies& hosts() { return _hosts; }
+
+#ifndef RESTPP_EXCLUDE_SSL
+    /// <summary>
+    /// The TLS context shared by every https connection of the client. It is created, and the
+    /// certificate store loaded, on first use.
+    /// </summary>
+    details::tls_context& tls_context()
+    {
+        std::call_once(_tls_once, [this] {
+            tls_config config = _config.tls;
+            if (_config.http2 && std::find(config.alpn.begin(), config.alpn.end(), "h2") == config.alpn.end())
+                config.alpn.insert(config.alpn.begin(), "h2");
+            _tls_context = std::make_unique<details::tls_context>(config);
+        });
+        return *_tls_context;
+    }
+#endif
+
+    /// <summary>
+    /// Runs the client's private I/O context on the calling thread until <c>done</c> returns true.
+    /// Threads blocked in a synchronous fetch take turns driving the context, so the handlers of
+    /// every pending request make progress whichever thread happens to run them.
+    /// </summary>
+    template<typename Predicate>
+    void run_until(Predicate done)
+    {
+        std::lock_guard<std::mutex> lock(_run_mutex);
+        while (!done())
+        {
+            if (_owned_io_context->stopped())
+                _owned_io_context->restart();
+            _owned_io_context->run_one();
+        }
+    }
+
+private:
+    static std::pmr::pool_options memory_options()
+    {
+        std::pmr::pool_options options;
+        options.largest_required_pool_block = 64 * 1024;
+        return options;
+    }
+
+    void make_shards()
+    {
+        for (std::size_t i = 0; i < _executor->size(); ++i)
+            _shards.push_back(std::make_unique<details::client_shard>(_executor->io_context(i), _config));
+    }
+
+    client_config _config;
+    // Declared before the contexts: handlers still queued on them hold memory from the pool
+    std::pmr::synchronized_pool_resource _memory;
+    std::unique_ptr<boost::asio::io_context> _owned_io_context;
+    std::unique_ptr<restpp::executor> _owned_executor;
+    restpp::executor* _executor = nullptr;
+    std::mutex _run_mutex;
+    std::shared_ptr<details::dns_cache> _dns;
+    details::single_flight _flights;
+    details::host_policies _hosts{_config.concurrency, _config.max_connections_per_host};
+#ifndef RESTPP_EXCLUDE_SSL
+    // Declared before the pools, whose connections are created from it
+    std::once_flag _tls_once;
+    std::unique_ptr<details::tls_context> _tls_context;
+#endif
+    std::vector<std::unique_ptr<details::client_shard>> _shards;
+    std::atomic<std::size_t> _next_shard{0};
+};
+
+} // namespace restpp
+
+#endif // RESTPP_CLIENT_HPP
@@ -20,6 +20,7 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <string_view>
 
 #ifndef _WIN32
 #ifndef __STDC_LIMIT_MACROS
@@ -32,7 +33,9 @@
 
 namespace utility
 {
-#ifdef _WIN32
+// Strings are wide on Windows unless RESTPP_UTF8_STRINGS asks for UTF-8 std::string everywhere,
+// which the client needs and which spares transcoding at every API boundary
+#if defined(_WIN32) && !defined(RESTPP_UTF8_STRINGS)
 #define _UTF16_STRINGS
 #endif
 
@@ -76,6 +79,8 @@ typedef std::stringstream stringstream_t;
 #define ucerr std::cerr
 #endif // endif _UTF16_STRINGS
 
+typedef std::basic_string_view<char_t> string_view_t;
+
 #ifndef _TURN_OFF_PLATFORM_STRING
 // The 'U' macro can be used to create a string or character literal of the platform type, i.e. utility::char_t.
 // If you are using a library causing conflicts with 'U' macro, it can be turned off by defining the macro
@@ -0,0 +1,402 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * The caching rules of RFC 9111: which responses may be stored, how long they stay fresh, and
+ * which stored response answers a request.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_CACHE_POLICY_HPP
+#define RESTPP_CACHE_POLICY_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <restpp/core/headers.hpp>
+#include <restpp/core/options.hpp>
+#include <restpp/core/details/content_decoder.hpp>
+#include <restpp/core/details/http_date.hpp>
+
+namespace restpp
+{
+namespace details
+{
+inline std::string_view trim_whitespace(std::string_view text)
+{
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+        text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t'))
+        text.remove_suffix(1);
+    return text;
+}
+
+/// <summary>
+/// Calls <c>visit</c> with every element of the comma separated lists held by the fields of the
+/// given name. Commas within quoted strings do not split elements; empty elements are skipped.
+/// </summary>
+template<typename Visitor>
+void for_each_list_element(const headers& fields, field id, Visitor visit)
+{
+    for (std::size_t i = 0; i < fields.size(); ++i)
+    {
+        if (fields.id_at(i) != id)
+            continue;
+        const std::string_view list = fields.at(i).second;
+        std::size_t start = 0;
+        bool quoted = false;
+        for (std::size_t at = 0; at <= list.size(); ++at)
+        {
+            if (at < list.size())
+            {
+                if (list[at] == '"')
+                    quoted = !quoted;
+                else if (list[at] == '\\' && quoted)
+                    ++at;
+                if (at < list.size() && (quoted || list[at] != ','))
+                    continue;
+            }
+            const auto element = trim_whitespace(list.substr(start, at - start));
+            if (!element.empty())
+                visit(element);
+            start = at + 1;
+        }
+    }
+}
+
+/// <summary>
+/// Parses the delta-seconds of a directive. Values too large to represent are taken as the
+/// largest one, 2^31 seconds, as RFC 9111 asks.
+/// </summary>
+inline std::optional<std::chrono::seconds> parse_delta_seconds(std::string_view text)
+{
+    constexpr std::int64_t largest = 2147483648;
+    if (text.empty())
+        return std::nullopt;
+    std::int64_t value = 0;
+    for (char c : text)
+    {
+        if (c < '0' || c > '9')
+            return std::nullopt;
+        value = std::min(value * 10 + (c - '0'), largest);
+    }
+    return std::chrono::seconds(value);
+}
+
+/// <summary>
+/// The directives of the Cache-Control fields of a request or response. Directives qualified
+/// with field names, such as <c>no-cache="Set-Cookie"</c>, are applied to the whole response.
+/// </summary>
+struct cache_control
+{
+    bool no_store = false;
+    bool no_cache = false;
+    bool is_private = false;
+    bool is_public = false;
+    bool must_revalidate = false;
+    bool proxy_revalidate = false;
+    bool only_if_cached = false;
+    std::optional<std::chrono::seconds> max_age;
+    std::optional<std::chrono::seconds> s_maxage;
+    std::optional<std::chrono::seconds> max_stale;
+    std::optional<std::chrono::seconds> min_fresh;
+};
+
+inline cache_control parse_cache_control(const headers& fields)
+{
+    cache_control cc;
+    for_each_list_element(fields, field::cache_control, [&](std::string_view element) {
+        std::string_view name = element;
+        std::string_view value;
+        if (const auto equals = element.find('='); equals != std::string_view::npos)
+        {
+            name = trim_whitespace(element.substr(0, equals));
+            value = trim_whitespace(element.substr(equals + 1));
+            if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+                value = value.substr(1, value.size() - 2);
+        }
+
+        // A malformed age makes the response stale rather than fresh forever
+        const auto seconds = [&] { return parse_delta_seconds(value).value_or(std::chrono::seconds(0)); };
+        if (iequals(name, "no-store"))
+            cc.no_store = true;
+        else if (iequals(name, "no-cache"))
+            cc.no_cache = true;
+        else if (iequals(name, "private"))
+            cc.is_private = true;
+        else if (iequals(name, "public"))
+            cc.is_public = true;
+        else if (iequals(name, "must-revalidate"))
+            cc.must_revalidate = true;
+        else if (iequals(name, "proxy-revalidate"))
+            cc.proxy_revalidate = true;
+        else if (iequals(name, "only-if-cached"))
+            cc.only_if_cached = true;
+        else if (iequals(name, "max-age"))
+            cc.max_age = seconds();
+        else if (iequals(name, "s-maxage"))
+            cc.s_maxage = seconds();
+        else if (iequals(name, "min-fresh"))
+            cc.min_fresh = seconds();
+        else if (iequals(name, "max-stale"))
+            cc.max_stale = value.empty() ? std::chrono::seconds::max() : seconds();
+    });
+
+    // HTTP/1.0 caches only know of "Pragma: no-cache", which Cache-Control overrides
+    if (!fields.contains(field::cache_control))
+    {
+        for_each_list_element(fields, field::pragma, [&](std::string_view element) {
+            if (iequals(element, "no-cache"))
+                cc.no_cache = true;
+        });
+    }
+    return cc;
+}
+
+/// <summary>
+/// Status codes whose responses may be stored on the strength of a heuristic lifetime, without
+/// explicit freshness information.
+/// </summary>
+inline bool is_heuristically_cacheable(int status_code)
+{
+    switch (status_code)
+    {
+        case 200:
+        case 203:
+        case 204:
+        case 300:
+        case 301:
+        case 308:
+        case 404:
+        case 405:
+        case 410:
+        case 414:
+        case 501: return true;
+        default: return false;
+    }
+}
+
+/// <summary>
+/// The request fields a Vary header names, in lower case. A lone "*" means that no request can
+/// be matched.
+/// </summary>
+inline std::vector<std::string> vary_names(const headers& fields)
+{
+    std::vector<std::string> names;
+    for_each_list_element(fields, field::vary, [&](std::string_view element) {
+        std::string name(element);
+        for (char& c : name)
+            c = ascii_tolower(c);
+        names.push_back(std::move(name));
+    });
+    return names;
+}
+
+/// <summary>
+/// The value a request sends for the given field, with every occurrence joined by commas. The
+/// Accept-Encoding added to requests that decode their responses counts as sent.
+/// </summary>
+inline std::string request_field_value(const options& request, std::string_view name)
+{
+    std::string value;
+    bool found = false;
+    for (const auto& [key, field_value] : request.headers)
+    {
+        if (!iequals(key, name))
+            continue;
+        if (found)
+            value.append(", ");
+        value.append(trim_whitespace(field_value));
+        found = true;
+    }
+    if (!found && request.decode_content && iequals(name, "accept-encoding"))
+        value = accepted_encodings();
+    return value;
+}
+
+/// <summary>
+/// Whether the request may be answered from the cache, or its response stored there. Requests
+/// with a body sink are streamed, and range or conditional requests are left to the application.
+/// </summary>
+inline bool is_cacheable_request(const options& request)
+{
+    return request.method == "GET" && !request.sink && !request.headers.contains(field::range) &&
+           !request.headers.contains(field::if_none_match) && !request.headers.contains(field::if_modified_since) &&
+           !request.headers.contains("If-Match") && !request.headers.contains("If-Unmodified-Since");
+}
+
+/// <summary>
+/// Whether a request of a method that changes the resource invalidates what is stored of it,
+/// once it succeeded.
+/// </summary>
+inline bool is_unsafe_method(std::string_view method)
+{
+    return method != "GET" && method != "HEAD" && method != "OPTIONS" && method != "TRACE";
+}
+
+/// <summary>
+/// A response held by the cache, along with the request fields it was selected by and what its
+/// freshness derives from. Shared between the cache and the requests reading it, so it is never
+/// modified once stored.
+/// </summary>
+struct cached_response
+{
+    int status_code = 0;
+    restpp::headers headers;
+    std::string body;
+
+    /// <summary>
+    /// The lower-case names and the values of the request fields named by Vary.
+    /// </summary>
+    std::vector<std::pair<std::string, std::string>> vary;
+
+    std::chrono::system_clock::time_point request_time;
+    std::chrono::system_clock::time_point response_time;
+
+    std::chrono::seconds lifetime{0};
+    std::chrono::seconds initial_age{0};
+    bool no_cache = false;
+    bool must_revalidate = false;
+
+    /// <summary>
+    /// Works out the freshness lifetime and age the response had on arrival (RFC 9111, sections
+    /// 4.2.1 to 4.2.3) from its headers and the times of the exchange.
+    /// </summary>
+    void derive(bool shared)
+    {
+        using std::chrono::seconds;
+        const auto cc = parse_cache_control(headers);
+        const auto date_field = headers.get(field::date);
+        const auto date = (date_field ? parse_http_date(*date_field) : std::nullopt).value_or(response_time);
+
+        lifetime = seconds(0);
+        if (shared && cc.s_maxage)
+            lifetime = *cc.s_maxage;
+        else if (cc.max_age)
+            lifetime = *cc.max_age;
+        else if (const auto expires = headers.get(field::expires))
+        {
+            // Invalid dates, "0" among them, stand for a time in the past
+            if (const auto when = parse_http_date(*expires))
+                lifetime = std::max(std::chrono::duration_cast<seconds>(*when - date), seconds(0));
+        }
+        else if (const auto modified = headers.get(field::last_modified); modified && is_heuristically_cacheable(status_code))
+        {
+            // A tenth of the time since the last change, as is common practice, up to a day
+            if (const auto when = parse_http_date(*modified))
+                lifetime = std::clamp(std::chrono::duration_cast<seconds>(date - *when) / 10, seconds(0), seconds(86400));
+        }
+
+        const auto age_field = headers.get(field::age);
+        const auto age_value = (age_field ? parse_delta_seconds(*age_field) : std::nullopt).value_or(seconds(0));
+        const auto apparent_age = std::max(std::chrono::duration_cast<seconds>(response_time - date), seconds(0));
+        const auto response_delay = std::max(std::chrono::duration_cast<seconds>(response_time - request_time), seconds(0));
+        initial_age = std::max(apparent_age, age_value + response_delay);
+
+        no_cache = cc.no_cache;
+        must_revalidate = cc.must_revalidate || (shared && (cc.proxy_revalidate || cc.s_maxage));
+    }
+
+    std::chrono::seconds current_age(std::chrono::system_clock::time_point now) const
+    {
+        const auto resident = std::chrono::duration_cast<std::chrono::seconds>(now - response_time);
+        return initial_age + std::max(resident, std::chrono::seconds(0));
+    }
+
+    bool has_validators() const { return headers.contains(field::etag) || headers.contains(field::last_modified); }
+
+    /// <summary>
+    /// Whether the request sends the same values of the fields named by Vary as the one this
+    /// response answered.
+    /// </summary>
+    bool matches(const options& request) const
+    {
+        for (const auto& [name, value] : vary)
+        {
+            if (request_field_value(request, name) != value)
+                return false;
+        }
+        return true;
+    }
+
+    /// <summary>
+    /// Roughly the memory the response holds, charged against the budget of the cache.
+    /// </summary>
+    std::size_t footprint() const
+    {
+        std::size_t bytes = sizeof(cached_response) + body.size();
+        for (const auto& [name, value] : headers)
+            bytes += name.size() + value.size() + 16;
+        for (const auto& [name, value] : vary)
+            bytes += name.size() + value.size() + sizeof(vary.front());
+        return bytes;
+    }
+};
+
+/// <summary>
+/// Whether a response to the request may be stored (RFC 9111, section 3).
+/// </summary>
+inline bool is_storable(const options& request, int status_code, const headers& fields, bool shared)
+{
+    if (!is_cacheable_request(request) || status_code < 200 || status_code == 206 || status_code == 304)
+        return false;
+
+    const auto request_cc = parse_cache_control(request.headers);
+    const auto cc = parse_cache_control(fields);
+    if (request_cc.no_store || cc.no_store || (shared && cc.is_private))
+        return false;
+    if (shared && request.headers.contains(field::authorization) && !cc.is_public && !cc.must_revalidate && !cc.s_maxage)
+        return false;
+
+    const auto vary = vary_names(fields);
+    if (std::find(vary.begin(), vary.end(), "*") != vary.end())
+        return false;
+
+    return cc.is_public || cc.max_age || (shared && cc.s_maxage) || fields.contains(field::expires) ||
+           is_heuristically_cacheable(status_code);
+}
+
+/// <summary>
+/// Updates the headers of a stored response with those of the 304 that validated it (RFC 9111,
+/// section 3.2). Fields of the 304 replace every stored field of the same name, except for
+/// those describing the framing of the stored body.
+/// </summary>
+inline headers merge_not_modified(const headers& stored, const headers& update)
+{
+    const auto keeps_stored = [](field id, std::string_view name) {
+        return id == field::content_length || id == field::content_encoding || id == field::transfer_encoding ||
+               id == field::connection || id == field::keep_alive || iequals(name, "Content-Range");
+    };
+
+    headers merged;
+    for (std::size_t i = 0; i < stored.size(); ++i)
+    {
+        const auto [name, value] = stored.at(i);
+        if (keeps_stored(stored.id_at(i), name) || !update.contains(name))
+            merged.add(name, value);
+    }
+    for (std::size_t i = 0; i < update.size(); ++i)
+    {
+        const auto [name, value] = update.at(i);
+        if (!keeps_stored(update.id_at(i), name))
+            merged.add(name, value);
+    }
+    return merged;
+}
+
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_CACHE_POLICY_HPP
@@ -0,0 +1,474 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Where the HTTP cache keeps its responses: a sharded in-memory LRU and a directory of files.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_CACHE_STORE_HPP
+#define RESTPP_CACHE_STORE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <restpp/core/details/cache_policy.hpp>
+#include <restpp/core/details/file_source.hpp>
+
+namespace restpp
+{
+namespace details
+{
+/// <summary>
+/// The responses stored for one request target, one for every combination of the request
+/// fields they vary on.
+/// </summary>
+using cached_variants = std::vector<std::shared_ptr<const cached_response>>;
+
+inline std::size_t footprint(const std::string& key, const cached_variants& variants)
+{
+    std::size_t bytes = key.size() + 64;
+    for (const auto& variant : variants)
+        bytes += variant->footprint();
+    return bytes;
+}
+
+/// <summary>
+/// One stripe of the in-memory tier: a least recently used list of targets under its own lock,
+/// holding at most its share of the memory budget.
+/// </summary>
+class memory_cache_shard
+{
+public:
+    explicit memory_cache_shard(std::size_t budget) : _budget(budget) {}
+
+    memory_cache_shard(const memory_cache_shard&) = delete;
+    memory_cache_shard& operator=(const memory_cache_shard&) = delete;
+
+    bool find(std::string_view key, cached_variants& variants)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        const auto it = _index.find(key);
+        if (it == _index.end())
+            return false;
+        _lru.splice(_lru.begin(), _lru, it->second);
+        variants = it->second->variants;
+        return true;
+    }
+
+    /// <summary>
+    /// Stores the variants of a target, evicting the least recently used targets to make room.
+    /// Targets larger than the whole shard are not kept.
+    /// </summary>
+    void put(const std::string& key, cached_variants variants)
+    {
+        const std::size_t bytes = footprint(key, variants);
+        std::lock_guard<std::mutex> lock(_mutex);
+        erase_locked(key);
+        if (bytes > _budget)
+            return;
+        while (_bytes + bytes > _budget && !_lru.empty())
+            erase_locked(_lru.back().key);
+
+        _lru.push_front(node{key, std::move(variants), bytes});
+        _index.emplace(_lru.front().key, _lru.begin());
+        _bytes += bytes;
+    }
+
+    void erase(std::string_view key)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        erase_locked(key);
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _index.clear();
+        _lru.clear();
+        _bytes = 0;
+    }
+
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _bytes;
+    }
+
+private:
+    struct node
+    {
+        std::string key;
+        cached_variants variants;
+        std::size_t bytes;
+    };
+
+    void erase_locked(std::string_view key)
+    {
+        const auto it = _index.find(key);
+        if (it == _index.end())
+            return;
+        const auto position = it->second;
+        _bytes -= position->bytes;
+        _index.erase(it);
+        _lru.erase(position);
+    }
+
+    mutable std::mutex _mutex;
+    std::list<node> _lru;
+    std::unordered_map<std::string_view, std::list<node>::iterator> _index;
+    std::size_t _bytes = 0;
+    std::size_t _budget;
+};
+
+/// <summary>
+/// The in-memory tier. Targets are spread over independently locked shards by the hash of their
+/// key, so concurrent requests seldom contend for the same lock.
+/// </summary>
+class memory_cache
+{
+public:
+    memory_cache(std::size_t budget, std::size_t shards)
+    {
+        shards = std::max<std::size_t>(shards, 1);
+        for (std::size_t i = 0; i < shards; ++i)
+            _shards.push_back(std::make_unique<memory_cache_shard>(budget / shards));
+    }
+
+    memory_cache_shard& shard(std::string_view key)
+    {
+        return *_shards[std::hash<std::string_view>()(key) % _shards.size()];
+    }
+
+    void clear()
+    {
+        for (auto& shard : _shards)
+            shard->clear();
+    }
+
+    std::size_t size() const
+    {
+        std::size_t bytes = 0;
+        for (const auto& shard : _shards)
+            bytes += shard->size();
+        return bytes;
+    }
+
+private:
+    std::vector<std::unique_ptr<memory_cache_shard>> _shards;
+};
+
+/// <summary>
+/// Writes the variants of a target in the format of the disk tier. Numbers are in the byte
+/// order of the machine, so cache directories are not meant to move between architectures.
+/// </summary>
+inline std::string serialize_variants(const std::string& key, const cached_variants& variants)
+{
+    std::string out;
+    const auto number = [&out](auto value) {
+        char bytes[sizeof(value)];
+        std::memcpy(bytes, &value, sizeof(value));
+        out.append(bytes, sizeof(value));
+    };
+    const auto text = [&](std::string_view value) {
+        number(static_cast<std::uint64_t>(value.size()));
+        out.append(value);
+    };
+    const auto time = [&](std::chrono::system_clock::time_point value) {
+        number(static_cast<std::int64_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(value.time_since_epoch()).count()));
+    };
+
+    out.append("RPC1");
+    text(key);
+    number(static_cast<std::uint32_t>(variants.size()));
+    for (const auto& variant : variants)
+    {
+        number(static_cast<std::int32_t>(variant->status_code));
+        time(variant->request_time);
+        time(variant->response_time);
+        number(static_cast<std::uint32_t>(variant->vary.size()));
+        for (const auto& [name, value] : variant->vary)
+        {
+            text(name);
+            text(value);
+        }
+        number(static_cast<std::uint32_t>(variant->headers.size()));
+        for (const auto& [name, value] : variant->headers)
+        {
+            text(name);
+            text(value);
+        }
+        text(variant->body);
+    }
+    return out;
+}
+
+/// <summary>
+/// Reads back what <c>serialize_variants</c> wrote for the given key.
+/// </summary>
+/// <returns>False when the data is truncated, malformed or belongs to another key.</returns>
+inline bool parse_variants(std::string_view data, const std::string& key, bool shared, cached_variants& variants)
+{
+    bool ok = true;
+    const auto take = [&](std::size_t size) {
+        if (!ok || data.size() < size)
+        {
+            ok = false;
+            return std::string_view();
+        }
+        const auto piece = data.substr(0, size);
+        data.remove_prefix(size);
+        return piece;
+    };
+    const auto number = [&](auto value) {
+        const auto bytes = take(sizeof(value));
+        if (ok)
+            std::memcpy(&value, bytes.data(), sizeof(value));
+        return value;
+    };
+    const auto text = [&] {
+        const auto size = number(std::uint64_t(0));
+        return take(size > data.size() ? data.size() + 1 : static_cast<std::size_t>(size));
+    };
+    const auto time = [&] {
+        return std::chrono::system_clock::time_point(std::chrono::milliseconds(number(std::int64_t(0))));
+    };
+
+    if (take(4) != "RPC1" || text() != key)
+        return false;
+    const auto count = number(std::uint32_t(0));
+    variants.clear();
+    for (std::uint32_t i = 0; ok && i < count; ++i)
+    {
+        auto variant = std::make_shared<cached_response>();
+        variant->status_code = number(std::int32_t(0));
+        variant->request_time = time();
+        variant->response_time = time();
+        for (auto fields = number(std::uint32_t(0)); ok && fields > 0; --fields)
+        {
+            std::string name(text());
+            variant->vary.emplace_back(std::move(name), std::string(text()));
+        }
+        for (auto fields = number(std::uint32_t(0)); ok && fields > 0; --fields)
+        {
+            const auto name = text();
+            variant->headers.add(name, text());
+        }
+        variant->body = std::string(text());
+        variant->derive(shared);
+        variants.push_back(std::move(variant));
+    }
+    return ok && data.empty();
+}
+
+/// <summary>
+/// The disk tier: one file per target in a directory, read back through a memory mapping and
+/// evicted least recently used first once the files go over their budget. Files are written
+/// under a temporary name and renamed into place, so readers never see one half written.
+///
+/// The directory is scanned when the cache is created, so responses stored by earlier runs are
+/// served again.
+/// </summary>
+class disk_cache
+{
+public:
+    disk_cache(std::string directory, std::uint64_t budget) : _directory(std::move(directory)), _budget(budget)
+    {
+        namespace fs = std::filesystem;
+        std::error_code ec;
+        fs::create_directories(_directory, ec);
+
+        struct found
+        {
+            fs::file_time_type time;
+            std::string name;
+            std::uint64_t size;
+        };
+        std::vector<found> files;
+        for (fs::directory_iterator it(_directory, ec), end; !ec && it != end; it.increment(ec))
+        {
+            const auto& path = it->path();
+            if (path.extension() == ".tmp")
+                fs::remove(path, ec);
+            else if (path.extension() == ".cache")
+                files.push_back({it->last_write_time(ec), path.filename().string(), it->file_size(ec)});
+            ec.clear();
+        }
+        std::sort(files.begin(), files.end(), [](const found& a, const found& b) { return a.time < b.time; });
+        for (auto& file : files)
+            insert_locked(std::move(file.name), file.size);
+        evict_locked();
+    }
+
+    disk_cache(const disk_cache&) = delete;
+    disk_cache& operator=(const disk_cache&) = delete;
+
+    bool load(const std::string& key, bool shared, cached_variants& variants)
+    {
+        const std::string name = file_name(key);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            const auto it = _index.find(name);
+            if (it == _index.end())
+                return false;
+            _lru.splice(_lru.begin(), _lru, it->second);
+        }
+
+        // A file renamed over or removed meanwhile stays readable through the mapping
+        boost::system::error_code ec;
+        mapped_file file;
+        file.open(path_of(name), ec);
+        if (!ec && parse_variants(file.data(), key, shared, variants))
+            return true;
+        variants.clear();
+        return false;
+    }
+
+    void store(const std::string& key, const cached_variants& variants)
+    {
+        const std::string data = serialize_variants(key, variants);
+        if (data.size() > _budget)
+            return erase(key);
+
+        const std::string name = file_name(key);
+        const std::string temporary = path_of(name) + "." + std::to_string(_next_temporary++) + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            out.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!out.flush())
+            {
+                std::error_code ec;
+                std::filesystem::remove(temporary, ec);
+                return;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::error_code ec;
+        std::filesystem::rename(temporary, path_of(name), ec);
+        if (ec)
+        {
+            std::filesystem::remove(temporary, ec);
+            return;
+        }
+        erase_index_locked(name);
+        insert_locked(name, data.size());
+        evict_locked();
+    }
+
+    void erase(const std::string& key)
+    {
+        const std::string name = file_name(key);
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (erase_index_locked(name))
+        {
+            std::error_code ec;
+            std::filesystem::remove(path_of(name), ec);
+        }
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        while (!_lru.empty())
+            remove_locked(_lru.back().name);
+    }
+
+    std::uint64_t size() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _bytes;
+    }
+
+private:
+    struct node
+    {
+        std::string name;
+        std::uint64_t size;
+    };
+
+    /// <summary>
+    /// The file holding a target: the FNV-1a hash of its key. The key is stored in the file too,
+    /// so a colliding target is told apart, and merely replaces the other one.
+    /// </summary>
+    static std::string file_name(const std::string& key)
+    {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (char c : key)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+        static constexpr char digits[] = "0123456789abcdef";
+        std::string name(16, '0');
+        for (int i = 15; i >= 0; --i, hash >>= 4)
+            name[static_cast<std::size_t>(i)] = digits[hash & 0xF];
+        return name + ".cache";
+    }
+
+    std::string path_of(const std::string& name) const { return (std::filesystem::path(_directory) / name).string(); }
+
+    void insert_locked(std::string name, std::uint64_t size)
+    {
+        _lru.push_front(node{std::move(name), size});
+        _index.emplace(_lru.front().name, _lru.begin());
+        _bytes += size;
+    }
+
+    bool erase_index_locked(const std::string& name)
+    {
+        const auto it = _index.find(name);
+        if (it == _index.end())
+            return false;
+        _bytes -= it->second->size;
+        _lru.erase(it->second);
+        _index.erase(it);
+        return true;
+    }
+
+    void remove_locked(std::string name)
+    {
+        std::error_code ec;
+        std::filesystem::remove(path_of(name), ec);
+        erase_index_locked(name);
+    }
+
+    void evict_locked()
+    {
+        while (_bytes > _budget && !_lru.empty())
+            remove_locked(_lru.back().name);
+    }
+
+    std::string _directory;
+    std::uint64_t _budget;
+    mutable std::mutex _mutex;
+    std::list<node> _lru;
+    std::unordered_map<std::string, std::list<node>::iterator> _index;
+    std::uint64_t _bytes = 0;
+    std::atomic<std::uint64_t> _next_temporary{0};
+};
+
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_CACHE_STORE_HPP
@@ -0,0 +1,496 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Pool of idle HTTP/1.1 keep-alive connections shared by the requests of a client.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_CONNECTION_POOL_HPP
+#define RESTPP_CONNECTION_POOL_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+
+#include <boost/asio.hpp>
+#ifndef RESTPP_EXCLUDE_SSL
+#include <boost/asio/ssl.hpp>
+#endif
+
+#include <restpp/core/details/flat_buffer.hpp>
+
+namespace restpp
+{
+namespace details
+{
+/// <summary>
+/// Identifies the origin a connection is bound to. Connections are only reused for requests
+/// that target the very same scheme, host and port.
+/// </summary>
+struct connection_key
+{
+    std::string scheme;
+    std::string host;
+    int port = 0;
+
+    bool operator<(const connection_key& other) const
+    {
+        return std::tie(scheme, host, port) < std::tie(other.scheme, other.host, other.port);
+    }
+};
+
+/// <summary>
+/// A single transport connection to a remote host, along with the bytes that were read past
+/// the end of the last response. The connection is a stream in Asio's sense: reads and writes
+/// go through TLS when it was created with an SSL context, and straight to the socket otherwise,
+/// which is a Unix domain socket for http+unix URIs.
+/// </summary>
+class connection
+{
+public:
+    using clock = std::chrono::steady_clock;
+    using executor_type = boost::asio::ip::tcp::socket::executor_type;
+
+    explicit connection(boost::asio::io_context& io_context) : _socket(io_context) {}
+
+#ifndef RESTPP_EXCLUDE_SSL
+    using tls_stream = boost::asio::ssl::stream<boost::asio::ip::tcp::socket>;
+
+    /// <summary>
+    /// Creates a TLS connection. <c>session_key</c> names the server in the TLS session cache.
+    /// </summary>
+    connection(boost::asio::io_context& io_context, boost::asio::ssl::context& context, std::string session_key)
+        : _socket(io_context)
+        , _tls(std::make_unique<tls_stream>(io_context, context))
+        , _session_key(std::move(session_key))
+    {
+    }
+
+    /// <summary>
+    /// The TLS stream over the socket, or nullptr for a plain connection.
+    /// </summary>
+    tls_stream* tls() { return _tls.get(); }
+
+    const std::string& session_key() const { return _session_key; }
+
+    /// <summary>
+    /// Records what the TLS handshake negotiated.
+    /// </summary>
+    void on_handshake()
+    {
+        SSL* ssl = _tls->native_handle();
+        const unsigned char* protocol = nullptr;
+        unsigned int size = 0;
+        SSL_get0_alpn_selected(ssl, &protocol, &size);
+        _alpn.assign(reinterpret_cast<const char*>(protocol), protocol ? size : 0);
+        _tls_resumed = SSL_session_reused(ssl) == 1;
+    }
+
+    boost::asio::ip::tcp::socket& socket() { return _tls ? _tls->next_layer() : _socket; }
+#else
+    boost::asio::ip::tcp::socket& socket() { return _socket; }
+#endif
+
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+    using local_socket = boost::asio::local::stream_protocol::socket;
+
+    struct local_t
+    {
+    };
+
+    /// <summary>
+    /// Creates a connection over a Unix domain socket, connected through <c>local()</c>.
+    /// </summary>
+    connection(boost::asio::io_context& io_context, local_t)
+        : _socket(io_context), _local(std::make_unique<local_socket>(io_context))
+    {
+    }
+
+    /// <summary>
+    /// The Unix domain socket of the connection, or nullptr for a TCP one.
+    /// </summary>
+    local_socket* local() { return _local.get(); }
+#endif
+
+    connection(const connection&) = delete;
+    connection& operator=(const connection&) = delete;
+
+    executor_type get_executor() { return _socket.get_executor(); }
+
+    template<typename MutableBufferSequence, typename ReadHandler>
+    void async_read_some(const MutableBufferSequence& buffers, ReadHandler&& handler)
+    {
+#ifndef RESTPP_EXCLUDE_SSL
+        if (_tls)
+        {
+            _tls->async_read_some(buffers, std::forward<ReadHandler>(handler));
+            return;
+        }
+#endif
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+        if (_local)
+        {
+            _local->async_read_some(buffers, std::forward<ReadHandler>(handler));
+            return;
+        }
+#endif
+        _socket.async_read_some(buffers, std::forward<ReadHandler>(handler));
+    }
+
+    template<typename ConstBufferSequence, typename WriteHandler>
+    void async_write_some(const ConstBufferSequence& buffers, WriteHandler&& handler)
+    {
+#ifndef RESTPP_EXCLUDE_SSL
+        if (_tls)
+        {
+            _tls->async_write_some(buffers, std::forward<WriteHandler>(handler));
+            return;
+        }
+#endif
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+        if (_local)
+        {
+            _local->async_write_some(buffers, std::forward<WriteHandler>(handler));
+            return;
+        }
+#endif
+        _socket.async_write_some(buffers, std::forward<WriteHandler>(handler));
+    }
+
+    /// <summary>
+    /// Application protocol selected through ALPN; empty for plain connections or when the
+    /// server did not pick one.
+    /// </summary>
+    const std::string& alpn() const { return _alpn; }
+
+    /// <summary>
+    /// Whether the TLS handshake resumed a cached session.
+    /// </summary>
+    bool tls_resumed() const { return _tls_resumed; }
+
+    flat_buffer& buffer() { return _buffer; }
+
+    /// <summary>
+    /// Number of requests already completed over this connection.
+    /// </summary>
+    std::size_t requests_served() const { return _requests_served; }
+
+    /// <summary>
+    /// Time at which the connection was handed back to the pool.
+    /// </summary>
+    clock::time_point idle_since() const { return _idle_since; }
+
+    /// <summary>
+    /// Whether the last response over the connection was an HTTP/1.1 one that kept it open.
+    /// Only such connections have requests pipelined on them.
+    /// </summary>
+    bool pipelinable() const { return _pipelinable; }
+
+    void set_pipelinable(bool pipelinable) { _pipelinable = pipelinable; }
+
+    void mark_idle()
+    {
+        ++_requests_served;
+        _idle_since = clock::now();
+    }
+
+    /// <summary>
+    /// Checks, without blocking, that the peer did not close or write to the connection while it
+    /// was idle. An idle HTTP/1.1 connection must have nothing to read; EOF means the server
+    /// dropped it and unsolicited bytes mean its framing can no longer be trusted.
+    /// </summary>
+    bool is_healthy()
+    {
+        if (_buffer.size() != 0)
+            return false;
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+        if (_local)
+            return is_idle(*_local);
+#endif
+        return is_idle(socket());
+    }
+
+    /// <summary>
+    /// Closes the socket. TLS connections are not sent a close_notify, which would mean waiting
+    /// on the peer; HTTP framing already tells both ends where the last message ended.
+    /// </summary>
+    void close()
+    {
+#ifndef RESTPP_EXCLUDE_SSL
+        // Without this OpenSSL takes the missing close_notify for a failure and marks the
+        // session as not resumable when the stream is freed
+        if (_tls)
+            SSL_set_shutdown(_tls->native_handle(), SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+#endif
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+        if (_local)
+            return shut(*_local);
+#endif
+        shut(socket());
+    }
+
+private:
+    template<typename Socket>
+    static bool is_idle(Socket& sock)
+    {
+        if (!sock.is_open())
+            return false;
+
+        boost::system::error_code ec;
+        sock.non_blocking(true, ec);
+        if (ec)
+            return false;
+
+        char probe;
+        sock.receive(boost::asio::buffer(&probe, 1), Socket::message_peek, ec);
+
+        boost::system::error_code restore_ec;
+        sock.non_blocking(false, restore_ec);
+
+        return ec == boost::asio::error::would_block && !restore_ec;
+    }
+
+    template<typename Socket>
+    static void shut(Socket& sock)
+    {
+        boost::system::error_code ec;
+        sock.shutdown(Socket::shutdown_both, ec);
+        sock.close(ec);
+    }
+
+    boost::asio::ip::tcp::socket _socket;
+#ifndef RESTPP_EXCLUDE_SSL
+    std::unique_ptr<tls_stream> _tls;
+    std::string _session_key;
+#endif
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+    std::unique_ptr<local_socket> _local;
+#endif
+    std::string _alpn;
+    bool _tls_resumed = false;
+    flat_buffer _buffer;
+    std::size_t _requests_served = 0;
+    bool _pipelinable = false;
+    clock::time_point _idle_since = clock::now();
+};
+
+/// <summary>
+/// Thread-safe store of idle keep-alive connections grouped by origin.
+///
+/// Connections past the idle timeout are closed by a sweep. A pool given an I/O context through
+/// <c>sweep_on</c> runs it from a timer, armed only while the pool holds connections. Any other
+/// pool sweeps whenever a connection is handed back, at most once per idle timeout, so that the
+/// timer does not keep a caller's <c>io_context::run()</c> from returning. Such a pool holds the
+/// idle connections of a client that stopped making requests until <c>clear()</c>.
+/// </summary>
+class connection_pool
+{
+public:
+    connection_pool(std::size_t max_idle_per_host, connection::clock::duration idle_timeout)
+        : _max_idle_per_host(max_idle_per_host), _idle_timeout(idle_timeout)
+    {
+    }
+
+    connection_pool(const connection_pool&) = delete;
+    connection_pool& operator=(const connection_pool&) = delete;
+
+    ~connection_pool()
+    {
+        {
+            std::unique_lock<std::mutex> guard(_guard->mutex);
+            _guard->alive = false;
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (_sweeper)
+                _sweeper->cancel();
+        }
+        clear();
+    }
+
+    /// <summary>
+    /// Sweeps the pool from a timer on the given I/O context, which must outlive it.
+    /// </summary>
+    void sweep_on(boost::asio::io_context& io_context)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _sweeper.emplace(io_context);
+    }
+
+    /// <summary>
+    /// Takes the most recently used healthy connection to the given origin out of the pool.
+    /// Expired and stale connections found along the way are closed.
+    /// </summary>
+    /// <returns>An idle connection, or nullptr if none is available.</returns>
+    std::unique_ptr<connection> acquire(const connection_key& key)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto it = _idle.find(key);
+        if (it == _idle.end())
+            return nullptr;
+
+        auto& idle = it->second;
+        const auto now = connection::clock::now();
+        while (!idle.empty())
+        {
+            std::unique_ptr<connection> conn = std::move(idle.back());
+            idle.pop_back();
+
+            // Empty entries are left in place, so handing the connection back allocates nothing
+            if (now - conn->idle_since() < _idle_timeout && conn->is_healthy())
+                return conn;
+            conn->close();
+        }
+        return nullptr;
+    }
+
+    /// <summary>
+    /// Hands a connection back to the pool once its response has been fully read. When the
+    /// origin already holds <c>max_idle_per_host</c> idle connections the oldest one is closed.
+    /// </summary>
+    void release(const connection_key& key, std::unique_ptr<connection> conn)
+    {
+        if (_max_idle_per_host == 0)
+        {
+            conn->close();
+            return;
+        }
+
+        conn->mark_idle();
+        const auto now = conn->idle_since();
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto& idle = _idle[key];
+        idle.push_back(std::move(conn));
+        while (idle.size() > _max_idle_per_host)
+        {
+            idle.front()->close();
+            idle.pop_front();
+        }
+
+        if (_sweeper)
+        {
+            if (!_sweep_armed)
+                arm_sweep(_idle_timeout);
+        }
+        else if (now - _last_sweep >= _idle_timeout)
+        {
+            _last_sweep = now;
+            evict(now);
+        }
+    }
+
+    /// <summary>
+    /// Closes every idle connection that exceeded the idle timeout.
+    /// </summary>
+    void evict_expired()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        evict(connection::clock::now());
+    }
+
+    /// <summary>
+    /// Closes every idle connection.
+    /// </summary>
+    void clear()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (auto& entry : _idle)
+        {
+            for (auto& conn : entry.second)
+                conn->close();
+        }
+        _idle.clear();
+    }
+
+    /// <summary>
+    /// Number of idle connections currently held for the given origin.
+    /// </summary>
+    std::size_t idle_count(const connection_key& key) const
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        auto it = _idle.find(key);
+        return it == _idle.end() ? 0 : it->second.size();
+    }
+
+private:
+    /// <summary>
+    /// Closes the expired connections, and drops the origins left without any. Returns how long
+    /// until the oldest remaining connection expires, or zero when none is left.
+    /// </summary>
+    connection::clock::duration evict(connection::clock::time_point now)
+    {
+        auto next = connection::clock::duration::zero();
+        for (auto it = _idle.begin(); it != _idle.end();)
+        {
+            auto& idle = it->second;
+            while (!idle.empty() && now - idle.front()->idle_since() >= _idle_timeout)
+            {
+                idle.front()->close();
+                idle.pop_front();
+            }
+            if (idle.empty())
+            {
+                it = _idle.erase(it);
+                continue;
+            }
+            const auto left = _idle_timeout - (now - idle.front()->idle_since());
+            if (next == connection::clock::duration::zero() || left < next)
+                next = left;
+            ++it;
+        }
+        return next;
+    }
+
+    void arm_sweep(connection::clock::duration after)
+    {
+        _sweep_armed = true;
+        _sweeper->expires_after(after);
+        _sweeper->async_wait([this, guard = _guard](const boost::system::error_code& ec) {
+            if (ec)
+                return;
+            std::unique_lock<std::mutex> alive(guard->mutex);
+            if (!guard->alive)
+                return;
+            std::unique_lock<std::mutex> lock(_mutex);
+            _sweep_armed = false;
+            const auto next = evict(connection::clock::now());
+            if (next != connection::clock::duration::zero())
+                arm_sweep(next);
+        });
+    }
+
+    const std::size_t _max_idle_per_host;
+    const connection::clock::duration _idle_timeout;
+
+    mutable std::mutex _mutex;
+    std::map<connection_key, std::deque<std::unique_ptr<connection>>> _idle;
+    std::optional<boost::asio::steady_timer> _sweeper;
+    bool _sweep_armed = false;
+    connection::clock::time_point _last_sweep = connection::clock::now();
+
+    // Held by a sweep while it runs, so that the pool is not destroyed under it, and cleared by
+    // the destructor so that a sweep already queued leaves the pool alone
+    struct sweep_guard
+    {
+        std::mutex mutex;
+        bool alive = true;
+    };
+    std::shared_ptr<sweep_guard> _guard = std::make_shared<sweep_guard>();
+};
+
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_CONNECTION_POOL_HPP
@@ -0,0 +1,483 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Incremental decoding of compressed response bodies.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_CONTENT_DECODER_HPP
+#define RESTPP_CONTENT_DECODER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <boost/system/error_code.hpp>
+
+#include <restpp/core/error.hpp>
+
+// zlib comes with every build but those defining RESTPP_EXCLUDE_COMPRESSION, which decode
+// nothing; brotli and zstd are opted into with RESTPP_WITH_BROTLI and RESTPP_WITH_ZSTD.
+#ifndef RESTPP_EXCLUDE_COMPRESSION
+#include <zlib.h>
+#define RESTPP_HAS_ZLIB
+#ifdef RESTPP_WITH_BROTLI
+#include <brotli/decode.h>
+#define RESTPP_HAS_BROTLI
+#endif
+#ifdef RESTPP_WITH_ZSTD
+#include <zstd.h>
+#define RESTPP_HAS_ZSTD
+#endif
+#endif
+
+namespace restpp
+{
+namespace details
+{
+enum class content_coding
+{
+    identity,
+    gzip,
+    deflate,
+    brotli,
+    zstd
+};
+
+/// <summary>
+/// The value of the Accept-Encoding header sent by requests that decode their responses: every
+/// coding this build can decode.
+/// </summary>
+inline constexpr std::string_view accepted_encodings()
+{
+#if !defined(RESTPP_HAS_ZLIB)
+    return "";
+#elif defined(RESTPP_HAS_BROTLI) && defined(RESTPP_HAS_ZSTD)
+    return "gzip, deflate, br, zstd";
+#elif defined(RESTPP_HAS_BROTLI)
+    return "gzip, deflate, br";
+#elif defined(RESTPP_HAS_ZSTD)
+    return "gzip, deflate, zstd";
+#else
+    return "gzip, deflate";
+#endif
+}
+
+/// <summary>
+/// Finds the coding named by a Content-Encoding header. Bodies in a coding this build does not
+/// decode, or in several codings applied one after the other, are left as they are.
+/// </summary>
+inline content_coding parse_content_coding(std::string_view value)
+{
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t'))
+        value.remove_prefix(1);
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t'))
+        value.remove_suffix(1);
+
+    const auto is = [value](std::string_view name) {
+        if (value.size() != name.size())
+            return false;
+        for (std::size_t i = 0; i < name.size(); ++i)
+        {
+            const char c = value[i] >= 'A' && value[i] <= 'Z' ? char(value[i] - 'A' + 'a') : value[i];
+            if (c != name[i])
+                return false;
+        }
+        return true;
+    };
+
+#ifdef RESTPP_HAS_ZLIB
+    if (is("gzip") || is("x-gzip"))
+        return content_coding::gzip;
+    if (is("deflate"))
+        return content_coding::deflate;
+#endif
+#ifdef RESTPP_HAS_BROTLI
+    if (is("br"))
+        return content_coding::brotli;
+#endif
+#ifdef RESTPP_HAS_ZSTD
+    if (is("zstd"))
+        return content_coding::zstd;
+#endif
+    (void)is;
+    return content_coding::identity;
+}
+
+#ifdef RESTPP_HAS_ZLIB
+/// <summary>
+/// An inflate stream, detecting the gzip and zlib wrappers from the first bytes.
+/// </summary>
+struct zlib_inflater
+{
+    zlib_inflater() { ready = inflateInit2(&stream, 15 + 32) == Z_OK; }
+    ~zlib_inflater()
+    {
+        if (ready)
+            inflateEnd(&stream);
+    }
+
+    zlib_inflater(const zlib_inflater&) = delete;
+    zlib_inflater& operator=(const zlib_inflater&) = delete;
+
+    z_stream stream{};
+    bool ready = false;
+};
+#endif
+
+#ifdef RESTPP_HAS_ZSTD
+struct zstd_context_deleter
+{
+    void operator()(ZSTD_DCtx* context) const { ZSTD_freeDCtx(context); }
+};
+
+using zstd_context = std::unique_ptr<ZSTD_DCtx, zstd_context_deleter>;
+#endif
+
+/// <summary>
+/// Decompression contexts left over by finished responses, handed to the next ones so that a
+/// busy client does not set up a new context, and its large window, for every response.
+/// Brotli decoders cannot be reset and are never pooled.
+/// </summary>
+class decoder_pool
+{
+public:
+    explicit decoder_pool(std::size_t max_idle = 64) : _max_idle(max_idle) {}
+
+    decoder_pool(const decoder_pool&) = delete;
+    decoder_pool& operator=(const decoder_pool&) = delete;
+
+#ifdef RESTPP_HAS_ZLIB
+    std::unique_ptr<zlib_inflater> take_inflater()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_inflaters.empty())
+            {
+                auto inflater = std::move(_inflaters.back());
+                _inflaters.pop_back();
+                return inflater;
+            }
+        }
+        return std::make_unique<zlib_inflater>();
+    }
+
+    void give_back(std::unique_ptr<zlib_inflater> inflater)
+    {
+        if (!inflater->ready || inflateReset2(&inflater->stream, 15 + 32) != Z_OK)
+            return;
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_inflaters.size() < _max_idle)
+            _inflaters.push_back(std::move(inflater));
+    }
+#endif
+
+#ifdef RESTPP_HAS_ZSTD
+    zstd_context take_zstd()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_zstd.empty())
+            {
+                auto context = std::move(_zstd.back());
+                _zstd.pop_back();
+                return context;
+            }
+        }
+        return zstd_context(ZSTD_createDCtx());
+    }
+
+    void give_back(zstd_context context)
+    {
+        if (!context || ZSTD_isError(ZSTD_DCtx_reset(context.get(), ZSTD_reset_session_only)))
+            return;
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_zstd.size() < _max_idle)
+            _zstd.push_back(std::move(context));
+    }
+#endif
+
+private:
+    const std::size_t _max_idle;
+    std::mutex _mutex;
+#ifdef RESTPP_HAS_ZLIB
+    std::vector<std::unique_ptr<zlib_inflater>> _inflaters;
+#endif
+#ifdef RESTPP_HAS_ZSTD
+    std::vector<zstd_context> _zstd;
+#endif
+};
+
+/// <summary>
+/// Decodes a response body as it arrives. Each piece read off the connection is handed to
+/// <c>feed</c>, then <c>next</c> is called until it returns false, producing at most
+/// <c>chunk_size</c> decoded bytes at a time; the compressed bytes are never accumulated.
+/// The output views point into a buffer of the decoder and are valid until the next call.
+/// </summary>
+class content_decoder
+{
+public:
+    explicit content_decoder(std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+        : _output(memory)
+    {
+    }
+
+    content_decoder(const content_decoder&) = delete;
+    content_decoder& operator=(const content_decoder&) = delete;
+
+    ~content_decoder() { reset(); }
+
+    /// <summary>
+    /// Whether a body is being decoded.
+    /// </summary>
+    explicit operator bool() const { return _coding != content_coding::identity; }
+
+    /// <summary>
+    /// Prepares to decode a body in the given coding, taking a context from the pool when one
+    /// is given. Identity bodies are left alone.
+    /// </summary>
+    void start(content_coding coding, decoder_pool* pool, std::size_t chunk_size)
+    {
+        reset();
+        _pool = pool;
+        switch (coding)
+        {
+#ifdef RESTPP_HAS_ZLIB
+            case content_coding::gzip:
+            case content_coding::deflate:
+                _inflater = pool ? pool->take_inflater() : std::make_unique<zlib_inflater>();
+                if (!_inflater->ready)
+                    return;
+                break;
+#endif
+#ifdef RESTPP_HAS_BROTLI
+            case content_coding::brotli:
+                _brotli = BrotliDecoderCreateInstance(nullptr, nullptr, nullptr);
+                if (!_brotli)
+                    return;
+                break;
+#endif
+#ifdef RESTPP_HAS_ZSTD
+            case content_coding::zstd:
+                _zstd = pool ? pool->take_zstd() : zstd_context(ZSTD_createDCtx());
+                if (!_zstd)
+                    return;
+                break;
+#endif
+            default: return;
+        }
+        _coding = coding;
+        _output.resize(chunk_size != 0 ? chunk_size : 16 * 1024);
+    }
+
+    /// <summary>
+    /// Hands over the next piece of the compressed body, which must stay valid until
+    /// <c>next</c> returned false.
+    /// </summary>
+    void feed(std::string_view input)
+    {
+        _input = input;
+        if (!_fed)
+        {
+            _first_input = input;
+            _fed = !input.empty();
+        }
+    }
+
+    /// <summary>
+    /// Decodes what it can of the input fed so far.
+    /// </summary>
+    /// <returns>False once the input is drained and no output is left.</returns>
+    bool next(std::string_view& output, boost::system::error_code& ec)
+    {
+        while (!_finished && (!_input.empty() || _more_output))
+        {
+            const std::size_t remaining = _input.size();
+            const std::size_t produced = step(ec);
+            if (ec)
+                return false;
+            if (produced != 0)
+            {
+                output = std::string_view(_output.data(), produced);
+                return true;
+            }
+            if (_input.size() == remaining)
+                break;
+        }
+        _more_output = false;
+        return false;
+    }
+
+    /// <summary>
+    /// Checks, once the whole body was fed, that the compressed stream was complete.
+    /// </summary>
+    void finish(boost::system::error_code& ec) const
+    {
+        if (_coding != content_coding::identity && _fed && !_finished)
+            ec = error::decoding_failed;
+    }
+
+    /// <summary>
+    /// Hands the context back to the pool.
+    /// </summary>
+    void reset()
+    {
+#ifdef RESTPP_HAS_ZLIB
+        if (_inflater)
+        {
+            if (_pool)
+                _pool->give_back(std::move(_inflater));
+            _inflater.reset();
+        }
+#endif
+#ifdef RESTPP_HAS_BROTLI
+        if (_brotli)
+        {
+            BrotliDecoderDestroyInstance(_brotli);
+            _brotli = nullptr;
+        }
+#endif
+#ifdef RESTPP_HAS_ZSTD
+        if (_zstd)
+        {
+            if (_pool)
+                _pool->give_back(std::move(_zstd));
+            _zstd.reset();
+        }
+#endif
+        _coding = content_coding::identity;
+        _input = {};
+        _first_input = {};
+        _fed = false;
+        _raw_deflate = false;
+        _more_output = false;
+        _finished = false;
+    }
+
+private:
+    /// <summary>
+    /// Runs the decompressor once over the input, filling at most the output buffer.
+    /// </summary>
+    std::size_t step(boost::system::error_code& ec)
+    {
+        switch (_coding)
+        {
+#ifdef RESTPP_HAS_ZLIB
+            case content_coding::gzip:
+            case content_coding::deflate:
+            {
+                z_stream& z = _inflater->stream;
+                z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(_input.data()));
+                z.avail_in = static_cast<uInt>(_input.size());
+                z.next_out = reinterpret_cast<Bytef*>(&_output[0]);
+                z.avail_out = static_cast<uInt>(_output.size());
+
+                const int rc = inflate(&z, Z_NO_FLUSH);
+                if (rc == Z_DATA_ERROR && _coding == content_coding::deflate && !_raw_deflate && z.total_out == 0 &&
+                    _input.data() == _first_input.data())
+                {
+                    // Some servers send deflate without the zlib wrapper the coding calls for
+                    _raw_deflate = true;
+                    if (inflateReset2(&z, -15) != Z_OK)
+                    {
+                        ec = error::decoding_failed;
+                        return 0;
+                    }
+                    return step(ec);
+                }
+                if (rc != Z_OK && rc != Z_STREAM_END && rc != Z_BUF_ERROR)
+                {
+                    ec = error::decoding_failed;
+                    return 0;
+                }
+
+                _input.remove_prefix(_input.size() - z.avail_in);
+                const std::size_t produced = _output.size() - z.avail_out;
+                _finished = rc == Z_STREAM_END;
+                _more_output = z.avail_out == 0;
+                return produced;
+            }
+#endif
+#ifdef RESTPP_HAS_BROTLI
+            case content_coding::brotli:
+            {
+                std::size_t available_in = _input.size();
+                const auto* next_in = reinterpret_cast<const std::uint8_t*>(_input.data());
+                std::size_t available_out = _output.size();
+                auto* next_out = reinterpret_cast<std::uint8_t*>(&_output[0]);
+
+                const auto rc =
+                    BrotliDecoderDecompressStream(_brotli, &available_in, &next_in, &available_out, &next_out, nullptr);
+                if (rc == BROTLI_DECODER_RESULT_ERROR)
+                {
+                    ec = error::decoding_failed;
+                    return 0;
+                }
+
+                _input.remove_prefix(_input.size() - available_in);
+                _finished = rc == BROTLI_DECODER_RESULT_SUCCESS;
+                _more_output = rc == BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT;
+                return _output.size() - available_out;
+            }
+#endif
+#ifdef RESTPP_HAS_ZSTD
+            case content_coding::zstd:
+            {
+                ZSTD_inBuffer in{_input.data(), _input.size(), 0};
+                ZSTD_outBuffer out{&_output[0], _output.size(), 0};
+                const std::size_t rc = ZSTD_decompressStream(_zstd.get(), &out, &in);
+                if (ZSTD_isError(rc))
+                {
+                    ec = error::decoding_failed;
+                    return 0;
+                }
+
+                _input.remove_prefix(in.pos);
+                _finished = rc == 0;
+                _more_output = out.pos == out.size;
+                return out.pos;
+            }
+#endif
+            default:
+                _input = {};
+                return 0;
+        }
+    }
+
+    content_coding _coding = content_coding::identity;
+    decoder_pool* _pool = nullptr;
+#ifdef RESTPP_HAS_ZLIB
+    std::unique_ptr<zlib_inflater> _inflater;
+#endif
+#ifdef RESTPP_HAS_BROTLI
+    BrotliDecoderState* _brotli = nullptr;
+#endif
+#ifdef RESTPP_HAS_ZSTD
+    zstd_context _zstd;
+#endif
+    std::pmr::string _output;
+    std::string_view _input;
+    std::string_view _first_input;
+    bool _fed = false;
+    bool _raw_deflate = false;
+    bool _more_output = false;
+    bool _finished = false;
+};
+
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_CONTENT_DECODER_HPP
@@ -0,0 +1,208 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Cache of resolved host addresses shared by the requests of a client.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_DNS_CACHE_HPP
+#define RESTPP_DNS_CACHE_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+namespace restpp
+{
+namespace details
+{
+/// <summary>
+/// Thread-safe map from "host:port" to the endpoints the resolver returned for it.
+///
+/// The system resolver does not report record TTLs, so entries live for a fixed maximum age.
+/// An entry that is used while close to expiring is refreshed in the background, so the hosts
+/// a client talks to all the time never wait on the resolver. Every lookup hands the endpoints
+/// out starting one further along, which spreads new connections over all addresses of a host.
+/// </summary>
+class dns_cache : public std::enable_shared_from_this<dns_cache>
+{
+public:
+    using clock = std::chrono::steady_clock;
+    using endpoint_list = std::vector<boost::asio::ip::tcp::endpoint>;
+
+    dns_cache(clock::duration max_age, clock::duration refresh_ahead, std::size_t max_entries)
+        : _max_age(max_age), _refresh_ahead(refresh_ahead), _max_entries(max_entries)
+    {
+    }
+
+    dns_cache(const dns_cache&) = delete;
+    dns_cache& operator=(const dns_cache&) = delete;
+
+    static std::string make_key(const std::string& host, const std::string& service) { return host + ":" + service; }
+
+    /// <summary>
+    /// Looks up the endpoints of a host. On a hit, <c>refresh</c> tells whether the caller should
+    /// start a background refresh; it is only ever set for one caller per refresh.
+    /// </summary>
+    /// <returns>True on a hit, with the endpoints rotated into <c>endpoints</c>.</returns>
+    bool lookup(const std::string& key, endpoint_list& endpoints, bool& refresh)
+    {
+        refresh = false;
+        if (_max_age == clock::duration::zero())
+            return false;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _entries.find(key);
+        if (it == _entries.end())
+            return false;
+
+        entry& e = it->second;
+        const auto now = clock::now();
+        if (now >= e.expires || e.endpoints.empty())
+        {
+            _entries.erase(it);
+            return false;
+        }
+
+        const std::size_t first = e.next++ % e.endpoints.size();
+        endpoints.clear();
+        endpoints.reserve(e.endpoints.size());
+        endpoints.insert(endpoints.end(), e.endpoints.begin() + static_cast<std::ptrdiff_t>(first), e.endpoints.end());
+        endpoints.insert(endpoints.end(), e.endpoints.begin(), e.endpoints.begin() + static_cast<std::ptrdiff_t>(first));
+
+        if (!e.refreshing && e.expires - now <= _refresh_ahead)
+        {
+            e.refreshing = true;
+            refresh = true;
+        }
+        return true;
+    }
+
+    /// <summary>
+    /// Stores freshly resolved endpoints, restarting the maximum age of the entry.
+    /// </summary>
+    void store(const std::string& key, const boost::asio::ip::tcp::resolver::results_type& results)
+    {
+        if (_max_age == clock::duration::zero() || results.empty())
+            return;
+
+        endpoint_list endpoints;
+        endpoints.reserve(results.size());
+        for (const auto& result : results)
+            endpoints.push_back(result.endpoint());
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _entries.find(key);
+        if (it == _entries.end())
+        {
+            make_room();
+            it = _entries.emplace(key, entry{}).first;
+        }
+        it->second.endpoints = std::move(endpoints);
+        it->second.expires = clock::now() + _max_age;
+        it->second.refreshing = false;
+    }
+
+    /// <summary>
+    /// Drops an entry, typically because none of its endpoints accepted a connection.
+    /// </summary>
+    void erase(const std::string& key)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries.erase(key);
+    }
+
+    /// <summary>
+    /// Resolves the host again on the given context and updates the entry once done. The cache
+    /// may be destroyed in the meantime; a failed refresh keeps the entry until it expires.
+    /// </summary>
+    void refresh(boost::asio::io_context& io_context, const std::string& host, const std::string& service)
+    {
+        auto resolver = std::make_shared<boost::asio::ip::tcp::resolver>(io_context);
+        std::weak_ptr<dns_cache> weak = shared_from_this();
+        std::string key = make_key(host, service);
+        resolver->async_resolve(
+            host,
+            service,
+            [resolver, weak, key = std::move(key)](const boost::system::error_code& ec,
+                                                   const boost::asio::ip::tcp::resolver::results_type& results) {
+                auto self = weak.lock();
+                if (!self)
+                    return;
+                if (!ec)
+                {
+                    self->store(key, results);
+                    return;
+                }
+
+                std::lock_guard<std::mutex> lock(self->_mutex);
+                auto it = self->_entries.find(key);
+                if (it != self->_entries.end())
+                    it->second.refreshing = false;
+            });
+    }
+
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _entries.size();
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries.clear();
+    }
+
+private:
+    struct entry
+    {
+        endpoint_list endpoints;
+        clock::time_point expires;
+        std::size_t next = 0;
+        bool refreshing = false;
+    };
+
+    /// <summary>
+    /// Called with the lock held before adding an entry to a full cache: expired entries go
+    /// first and, if there are none, an arbitrary one.
+    /// </summary>
+    void make_room()
+    {
+        if (_entries.size() < _max_entries || _entries.empty())
+            return;
+
+        const auto now = clock::now();
+        for (auto it = _entries.begin(); it != _entries.end();)
+            it = now >= it->second.expires ? _entries.erase(it) : std::next(it);
+
+        if (_entries.size() >= _max_entries)
+            _entries.erase(_entries.begin());
+    }
+
+    const clock::duration _max_age;
+    const clock::duration _refresh_ahead;
+    const std::size_t _max_entries;
+
+    mutable std::mutex _mutex;
+    std::unordered_map<std::string, entry> _entries;
+};
+
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_DNS_CACHE_HPP
@@ -0,0 +1,1464 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Asynchronous HTTP request/response exchange shared by fetch and async_fetch.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_FETCH_OP_HPP
+#define RESTPP_FETCH_OP_HPP
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <string_view>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/asio/coroutine.hpp>
+
+#include <restpp/core/error.hpp>
+#include <restpp/core/http_cache.hpp>
+#include <restpp/core/observer.hpp>
+#include <restpp/core/options.hpp>
+#include <restpp/core/response.hpp>
+#include <restpp/core/uri.hpp>
+#include <restpp/core/details/connection_pool.hpp>
+#include <restpp/core/details/content_decoder.hpp>
+#include <restpp/core/details/dns_cache.hpp>
+#include <restpp/core/details/fetch_policy.hpp>
+#include <restpp/core/details/fetch_watch.hpp>
+#include <restpp/core/details/file_source.hpp>
+#include <restpp/core/details/h2_session.hpp>
+#include <restpp/core/details/http_parser.hpp>
+#include <restpp/core/details/tls_context.hpp>
+
+namespace restpp
+{
+namespace details
+{
+// URIs go to the resolver, the request line and TLS as they are
+static_assert(std::is_same_v<utility::char_t, char>,
+              "the restpp client needs UTF-8 strings: define RESTPP_UTF8_STRINGS when building on Windows");
+
+/// <summary>
+/// Appends a number in decimal, without going through a temporary string.
+/// </summary>
+template<typename String>
+void append_decimal(String& out, std::uint64_t value)
+{
+    char digits[20];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, static_cast<std::size_t>(result.ptr - digits));
+}
+
+/// <summary>
+/// Appends the host of the URI as sent in Host and :authority, with the port unless it is the
+/// default one.
+/// </summary>
+template<typename String>
+void append_authority(String& out, const uri& _path)
+{
+    // The host of an http+unix URI is the path of the socket
+    if (_path.scheme() == "http+unix") {
+        out.append("localhost");
+        return;
+    }
+    out.append(_path.host());
+    const int port = _path.port();
+    if (port != (_path.scheme() == "https" ? 443 : 80)) {
+        out.append(":");
+        append_decimal(out, static_cast<std::uint64_t>(port));
+    }
+}
+
+inline std::string request_authority(const uri& _path)
+{
+    std::string authority;
+    append_authority(authority, _path);
+    return authority;
+}
+
+/// <summary>
+/// Serializes the request head into <c>request</c>. A body of known length is announced with
+/// Content-Length and any other with chunked transfer-encoding, unless the caller set those
+/// headers already. <c>extra</c> holds headers sent on top of those of the options, such as the
+/// validators of a cache.
+/// </summary>
+template<typename String>
+void build_request(String& request,
+                   const uri& _path,
+                   const options& _options,
+                   bool keep_alive,
+                   std::optional<std::uint64_t> body_length = {},
+                   const headers* extra = nullptr)
+{
+    // Form the HTTP request
+    request.clear();
+    request.reserve(256);
+    const auto resource = _path.resource();
+    request.append(_options.method).append(" ");
+    if (resource.front() != '/')
+        request.append("/");
+    request.append(resource).append(" HTTP/1.1\r\n");
+    if (!_options.headers.contains(field::host)) {
+        request.append("Host: ");
+        append_authority(request, _path);
+        request.append("\r\n");
+    }
+    if (!_options.headers.contains(field::connection))
+        request.append(keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+    if (_options.decode_content && !accepted_encodings().empty() && !_options.headers.contains(field::accept_encoding))
+        request.append("Accept-Encoding: ").append(accepted_encodings()).append("\r\n");
+    if (_options.body.type() == request_body::kind::chunked) {
+        if (!_options.headers.contains(field::transfer_encoding))
+            request.append("Transfer-Encoding: chunked\r\n");
+    } else if (_options.body && !_options.headers.contains(field::content_length)) {
+        request.append("Content-Length: ");
+        append_decimal(request, body_length.value_or(0));
+        request.append("\r\n");
+    }
+
+    // Add custom headers
+    for (const auto& [key, value] : _options.headers) {
+        request.append(key).append(": ").append(value).append("\r\n");
+    }
+    if (extra) {
+        for (const auto& [key, value] : *extra)
+            request.append(key).append(": ").append(value).append("\r\n");
+    }
+    request.append("\r\n");
+}
+
+/// <summary>
+/// The header fields of an HTTP/2 request: the pseudo-headers, then the headers of the options
+/// with lower-case names. Host becomes :authority, and the connection-specific headers HTTP/2
+/// forbids are dropped. Headers in <c>extra</c> are sent as well.
+/// </summary>
+inline h2_stream::field_list build_h2_fields(const uri& _path,
+                                            const options& _options,
+                                            std::optional<std::uint64_t> body_length = {},
+                                            const headers* extra = nullptr)
+{
+    h2_stream::field_list fields;
+    fields.reserve(_options.headers.size() + 4);
+
+    std::string path(_path.resource());
+    if (path.empty() || path.front() != '/')
+        path.insert(path.begin(), '/');
+    const auto host = _options.headers.get(field::host);
+
+    fields.emplace_back(":method", _options.method);
+    fields.emplace_back(":scheme", std::string(_path.scheme()));
+    fields.emplace_back(":authority", host ? std::string(*host) : request_authority(_path));
+    fields.emplace_back(":path", std::move(path));
+
+    for (std::size_t i = 0; i < _options.headers.size(); ++i) {
+        switch (_options.headers.id_at(i)) {
+            case field::host:
+            case field::connection:
+            case field::keep_alive:
+            case field::transfer_encoding:
+            case field::upgrade: continue;
+            default: break;
+        }
+
+        const auto [key, value] = _options.headers.at(i);
+        std::string name(key);
+        for (char& c : name)
+            c = ascii_tolower(c);
+        if (name == "proxy-connection" || (name == "te" && value != "trailers"))
+            continue;
+        fields.emplace_back(std::move(name), std::string(value));
+    }
+    if (body_length && !_options.headers.contains(field::content_length))
+        fields.emplace_back("content-length", std::to_string(*body_length));
+    if (_options.decode_content && !accepted_encodings().empty() && !_options.headers.contains(field::accept_encoding))
+        fields.emplace_back("accept-encoding", std::string(accepted_encodings()));
+    if (extra) {
+        for (const auto& [key, value] : *extra) {
+            std::string name(key);
+            for (char& c : name)
+                c = ascii_tolower(c);
+            fields.emplace_back(std::move(name), std::string(value));
+        }
+    }
+    return fields;
+}
+
+/// <summary>
+/// The peer closed the connection. Servers commonly close TLS connections without sending
+/// a close_notify, which is harmless as long as the HTTP framing says the message was complete.
+/// </summary>
+inline bool is_end_of_stream(const boost::system::error_code& ec)
+{
+#ifndef RESTPP_EXCLUDE_SSL
+    if (ec == boost::asio::ssl::error::stream_truncated)
+        return true;
+#endif
+    return ec == boost::asio::error::eof;
+}
+
+/// <summary>
+/// Errors a request sent over a pooled connection the server has meanwhile closed fails with.
+/// </summary>
+inline bool is_stale_connection_error(const boost::system::error_code& ec)
+{
+    return is_end_of_stream(ec) || ec == boost::asio::error::connection_reset ||
+           ec == boost::asio::error::broken_pipe;
+}
+
+/// <summary>
+/// Most of a body made room for before its bytes arrive. Content-Length is only what the server
+/// claims: a longer body grows as it comes in, so announcing more than is sent costs no more.
+/// </summary>
+constexpr std::size_t max_body_presize = 1024 * 1024;
+
+/// <summary>
+/// Makes room in a body for the next read of a Content-Length body: what remains of it, but no
+/// more than the body already holds or <c>max_body_presize</c>, so that it doubles as it
+/// arrives. Fails with <c>body_too_large</c> when the body would outgrow <c>limit</c>, or when
+/// there is no memory left for it.
+/// </summary>
+inline void grow_body(std::string& body, std::uint64_t remaining, std::uint64_t limit, boost::system::error_code& ec)
+{
+    if (remaining > limit || body.size() > limit - remaining)
+    {
+        ec = error::body_too_large;
+        return;
+    }
+    const auto step = std::min<std::uint64_t>(remaining, std::max(body.size(), max_body_presize));
+    try {
+        body.resize(body.size() + static_cast<std::size_t>(step));
+    } catch (const std::bad_alloc&) {
+        ec = error::body_too_large;
+    }
+}
+
+/// <summary>
+/// Appends a piece of body, failing with <c>body_too_large</c> like <c>grow_body</c>.
+/// </summary>
+inline bool append_body(std::string& body, std::string_view data, std::uint64_t limit, boost::system::error_code& ec)
+{
+    if (data.size() > limit || body.size() > limit - data.size())
+    {
+        ec = error::body_too_large;
+        return false;
+    }
+    try {
+        body.append(data);
+    } catch (const std::bad_alloc&) {
+        ec = error::body_too_large;
+        return false;
+    }
+    return true;
+}
+
+/// <summary>
+/// Copies the status and headers the parser has just read into the response, making room for
+/// a body of known length unless it goes elsewhere.
+/// </summary>
+inline void take_head(const response_parser& parser, response& res, bool reserve_body)
+{
+    res.status_code = parser.status_code();
+    const auto& fields = parser.fields();
+    res.headers.reserve(fields.size(), parser.header_block().size());
+    for (const auto& f : fields)
+        res.headers.add(f.name, f.value);
+    if (parser.framing() == body_framing::content_length && reserve_body)
+        res.body.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(parser.content_length(), max_body_presize)));
+}
+
+/// <summary>
+/// A range of buffers that gathered writes go through without copying the sequence itself.
+/// </summary>
+struct const_buffer_span
+{
+    const boost::asio::const_buffer* first;
+    const boost::asio::const_buffer* last;
+
+    const boost::asio::const_buffer* begin() const { return first; }
+    const boost::asio::const_buffer* end() const { return last; }
+};
+
+/// <summary>
+/// What a fetch uses of the client it runs through. Fetches made without a client have no
+/// pools nor DNS cache, and take their memory from the default resource.
+/// </summary>
+struct fetch_services
+{
+#ifndef RESTPP_EXCLUDE_SSL
+    using tls_context_t = tls_context;
+#else
+    using tls_context_t = void;
+#endif
+
+    connection_pool* pool = nullptr;
+    h2_session_pool* h2_pool = nullptr;
+    decoder_pool* decoders = nullptr;
+    std::shared_ptr<dns_cache> dns;
+    tls_context_t* tls = nullptr;
+    http_cache* cache = nullptr;
+    fetch_observer* observer = nullptr;
+    bool keep_alive = false;
+    std::pmr::memory_resource* memory = std::pmr::get_default_resource();
+};
+
+/// <summary>
+/// Everything a single fetch needs while it is in flight. Kept on the heap so the composed
+/// operation stays cheap to move between handlers.
+///
+/// The state comes from the memory resource of the client, which recycles it from one fetch to
+/// the next, and holds a monotonic arena the request head, the write list and the parsed header
+/// fields are carved from. Everything is released in one go when the fetch completes.
+/// </summary>
+struct fetch_state
+{
+    using tls_context_t = fetch_services::tls_context_t;
+
+    /// <summary>
+    /// Size of the arena kept inside the state; larger requests spill over to the resource of
+    /// the client.
+    /// </summary>
+    static constexpr std::size_t arena_size = 2048;
+
+    /// <summary>
+    /// Borrows the target and options, which must outlive the fetch.
+    /// </summary>
+    fetch_state(boost::asio::io_context& io_context, const fetch_services& services, const uri& target, const options& opts)
+        : fetch_state(io_context, services, std::nullopt, std::nullopt, &target, &opts)
+    {
+    }
+
+    fetch_state(boost::asio::io_context& io_context, const fetch_services& services, uri&& target, options&& opts)
+        : fetch_state(io_context, services, std::move(target), std::move(opts), nullptr, nullptr)
+    {
+    }
+
+    fetch_state(const fetch_state&) = delete;
+    fetch_state& operator=(const fetch_state&) = delete;
+
+    /// <summary>
+    /// Whether the URI must be fetched over TLS.
+    /// </summary>
+    static bool is_secure(const uri& target) { return target.scheme() == "https"; }
+
+    /// <summary>
+    /// Length of the request body, when it is known before sending it.
+    /// </summary>
+    std::optional<std::uint64_t> body_length() const
+    {
+        switch (opts.body.type())
+        {
+            case request_body::kind::buffers: return opts.body.buffers_size();
+            case request_body::kind::file: return file.size();
+            default: return std::nullopt;
+        }
+    }
+
+    boost::asio::io_context& io_context;
+    connection_pool* pool;
+    h2_session_pool* h2_pool;
+    decoder_pool* decoders;
+    std::shared_ptr<dns_cache> dns;
+    tls_context_t* tls;
+    http_cache* cache;
+    fetch_observer* observer;
+    bool keep_alive;
+    std::optional<uri> owned_target;
+    std::optional<options> owned_opts;
+    const uri& target;
+    const options& opts;
+    connection_key key;
+    std::string resolve_host;
+    std::string service;
+    std::string dns_key;
+    bool secure = false;
+    bool supported = false;
+
+    /// <summary>
+    /// Whether the URI names a file, read from a mapping of it, or a server listening on the
+    /// Unix domain socket at <c>socket_path</c>.
+    /// </summary>
+    bool local_file = false;
+    bool unix_socket = false;
+    std::string socket_path;
+    std::shared_ptr<const std::string_view> mapping;
+    cache_exchange cached;
+
+    /// <summary>
+    /// When the fetch started, and the phase being timed into the timings of the response.
+    /// </summary>
+    std::chrono::steady_clock::time_point started;
+    std::chrono::steady_clock::time_point phase_started;
+    fetch_phase timed_phase = fetch_phase::resolve;
+    bool timing_phase = false;
+
+    /// <summary>
+    /// Where the steps of the operation run: the I/O context itself, or a strand of it for
+    /// watched requests, whose timer and abort signal must not race with those steps.
+    /// </summary>
+    boost::asio::any_io_executor executor;
+    std::shared_ptr<fetch_watch> watch;
+
+    alignas(std::max_align_t) unsigned char arena_buffer[arena_size];
+    std::pmr::monotonic_buffer_resource arena;
+
+    std::optional<boost::asio::ip::tcp::resolver> resolver;
+    dns_cache::endpoint_list endpoints;
+    bool cached_endpoints = false;
+    std::unique_ptr<connection> conn;
+    bool reused = false;
+    int attempt = 0;
+
+    std::pmr::string request;
+    file_source file;
+    boost::system::error_code file_error;
+    std::pmr::vector<boost::asio::const_buffer> gather;
+    std::pmr::string chunk_header;
+    std::pmr::string body_chunk;
+    std::uint64_t body_offset = 0;
+    std::size_t body_index = 0;
+    bool head_pending = false;
+    bool body_done = true;
+    bool body_started = false;
+    bool send_file = false;
+    response_parser parser;
+    std::size_t received = 0;
+    std::string_view pending_body;
+    std::string_view sink_piece;
+    content_decoder decoder;
+    response res;
+
+    std::shared_ptr<h2_session> session;
+    std::shared_ptr<h2_stream> stream;
+    std::string h2_piece;
+    h2_event event;
+
+    /// <summary>
+    /// Set for an HTTP/1.1 request asking to switch protocols: when the server answers it with
+    /// 101, the connection is handed over here, with whatever followed the response head still
+    /// in its buffer, instead of going back to the pool.
+    /// </summary>
+    std::unique_ptr<connection>* upgrade = nullptr;
+
+private:
+    fetch_state(boost::asio::io_context& io_context,
+                const fetch_services& services,
+                std::optional<uri> owned_target,
+                std::optional<options> owned_opts,
+                const uri* borrowed_target,
+                const options* borrowed_opts)
+        : io_context(io_context)
+        , pool(services.pool)
+        , h2_pool(services.h2_pool)
+        , decoders(services.decoders)
+        , dns(services.dns)
+        , tls(services.tls)
+        , cache(services.cache)
+        , observer(services.observer)
+        , keep_alive(services.keep_alive)
+        , owned_target(std::move(owned_target))
+        , owned_opts(std::move(owned_opts))
+        , target(borrowed_target ? *borrowed_target : *this->owned_target)
+        , opts(borrowed_opts ? *borrowed_opts : *this->owned_opts)
+        , arena(arena_buffer, arena_size, services.memory)
+        , request(&arena)
+        , gather(&arena)
+        , chunk_header(&arena)
+        , body_chunk(&arena)
+        , parser(64 * 1024, &arena)
+        , decoder(&arena)
+    {
+        std::string_view host = target.host();
+        key = connection_key{std::string(target.scheme()), std::string(host), target.port()};
+
+        // IPv6 literals are bracketed in URIs but not when handed to the resolver
+        if (host.size() >= 2 && host.front() == '[' && host.back() == ']')
+            host = host.substr(1, host.size() - 2);
+        resolve_host = std::string(host);
+        service = std::to_string(target.port());
+        if (dns)
+            dns_key = dns_cache::make_key(resolve_host, service);
+
+        const auto scheme = target.scheme();
+        secure = scheme == "https";
+        local_file = scheme == "file";
+        unix_socket = scheme == "http+unix";
+        supported = scheme == "http" || (secure && tls != nullptr) ||
+                    (local_file && (host.empty() || host == "localhost"));
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+        if (unix_socket)
+        {
+            socket_path = uri::decode(host);
+            supported = !socket_path.empty();
+        }
+#endif
+        if (local_file)
+            cache = nullptr;
+
+        if (fetch_watch::needed(opts))
+        {
+            executor = boost::asio::make_strand(io_context);
+            watch = std::allocate_shared<fetch_watch>(
+                std::pmr::polymorphic_allocator<fetch_watch>(services.memory), executor, opts);
+        }
+        else
+            executor = io_context.get_executor();
+    }
+};
+
+/// <summary>
+/// Frees a state back to the memory resource it was allocated from.
+/// </summary>
+struct fetch_state_deleter
+{
+    std::pmr::memory_resource* memory = nullptr;
+
+    void operator()(fetch_state* state) const
+    {
+        state->~fetch_state();
+        memory->deallocate(state, sizeof(fetch_state), alignof(fetch_state));
+    }
+};
+
+using fetch_state_ptr = std::unique_ptr<fetch_state, fetch_state_deleter>;
+
+template<typename Target, typename Options>
+fetch_state_ptr make_fetch_state(boost::asio::io_context& io_context,
+                                 const fetch_services& services,
+                                 Target&& target,
+                                 Options&& opts)
+{
+    void* memory = services.memory->allocate(sizeof(fetch_state), alignof(fetch_state));
+    try {
+        auto* state = new (memory)
+            fetch_state(io_context, services, std::forward<Target>(target), std::forward<Options>(opts));
+        return fetch_state_ptr(state, fetch_state_deleter{services.memory});
+    } catch (...) {
+        services.memory->deallocate(memory, sizeof(fetch_state), alignof(fetch_state));
+        throw;
+    }
+}
+
+/// <summary>
+/// Composed operation performing one HTTP exchange, as a stream of an HTTP/2 connection when the
+/// server negotiated it and over an HTTP/1.1 connection otherwise. Completes with
+/// <c>void(boost::system::error_code, response)</c>.
+/// </summary>
+class fetch_op : boost::asio::coroutine
+{
+public:
+    explicit fetch_op(fetch_state_ptr state) : _state(std::move(state)) {}
+
+    template<typename Self>
+    void operator()(Self& self,
+                    const boost::system::error_code& ec,
+                    const boost::asio::ip::tcp::resolver::results_type& results)
+    {
+        if (!ec)
+        {
+            _state->endpoints.assign(results.begin(), results.end());
+            if (_state->dns)
+                _state->dns->store(_state->dns_key, results);
+        }
+        (*this)(self, ec, std::size_t(0));
+    }
+
+    template<typename Self>
+    void operator()(Self& self, const boost::system::error_code& ec, const boost::asio::ip::tcp::endpoint&)
+    {
+        (*this)(self, ec, std::size_t(0));
+    }
+
+    template<typename Self>
+    void operator()(Self& self, boost::system::error_code ec = {}, std::size_t bytes_transferred = 0)
+    {
+        fetch_state& s = *_state;
+
+        // Whatever the watch cut short fails, even when it was between two operations
+        if (!ec && s.watch && s.watch->error())
+            ec = boost::asio::error::operation_aborted;
+
+        BOOST_ASIO_CORO_REENTER(*this)
+        {
+            s.started = std::chrono::steady_clock::now();
+            if (s.observer)
+                s.observer->on_start(s.target, s.opts);
+            if (s.watch)
+                s.watch->start([&s] { cancel_io(s); });
+
+            if (!s.supported)
+            {
+                // Never complete from within the initiating function
+                BOOST_ASIO_CORO_YIELD boost::asio::post(s.io_context, std::move(self));
+                return complete(self, error::unsupported_scheme);
+            }
+
+            // Reads and file pieces of no size would never make progress
+            if (s.opts.chunk_size == 0)
+            {
+                BOOST_ASIO_CORO_YIELD boost::asio::post(s.io_context, std::move(self));
+                return complete(self, boost::asio::error::invalid_argument);
+            }
+
+            // Files are served from a mapping of them, without going through the cache
+            if (s.local_file)
+            {
+                BOOST_ASIO_CORO_YIELD boost::asio::post(s.io_context, std::move(self));
+                map_file(ec);
+                while (!ec && s.opts.sink && s.received < s.mapping->size())
+                {
+                    s.sink_piece = s.mapping->substr(s.received, s.opts.chunk_size);
+                    s.received += s.sink_piece.size();
+                    if (!s.opts.sink.is_async())
+                    {
+                        if (!s.opts.sink.write(s.sink_piece))
+                            ec = error::body_aborted;
+                        continue;
+                    }
+                    BOOST_ASIO_CORO_YIELD write_to_sink(self);
+                }
+                return complete(self, ec);
+            }
+
+            if (s.opts.body.type() == request_body::kind::file)
+                s.file.open(s.opts.body.path(), s.file_error);
+            if (s.file_error)
+            {
+                BOOST_ASIO_CORO_YIELD boost::asio::post(s.io_context, std::move(self));
+                return complete(self, s.file_error);
+            }
+
+            // Answer from the cache when it holds a fresh response
+            if (s.cache)
+                s.cache->lookup(s.target, s.opts, s.cached, s.res);
+            if (s.cached.lookup == cache_lookup::hit || s.cached.lookup == cache_lookup::unsatisfiable)
+            {
+                BOOST_ASIO_CORO_YIELD boost::asio::post(s.io_context, std::move(self));
+                return complete(self, {});
+            }
+
+            build_request(s.request, s.target, s.opts, s.keep_alive, s.body_length(), revalidation_headers());
+
+            for (;;)
+            {
+                // Join an HTTP/2 connection to the origin with room for another stream
+                s.session = s.keep_alive && s.h2_pool && !s.upgrade && s.attempt == 0 ? s.h2_pool->acquire(s.key) : nullptr;
+                s.reused = s.session != nullptr;
+
+                if (!s.session)
+                {
+                    s.conn = s.keep_alive && s.pool && s.attempt == 0 ? s.pool->acquire(s.key) : nullptr;
+                    s.reused = s.conn != nullptr;
+                }
+
+                if (!s.session && !s.conn)
+                {
+                    for (;;)
+                    {
+#ifdef BOOST_ASIO_HAS_LOCAL_SOCKETS
+                        if (s.unix_socket)
+                        {
+                            s.conn = std::make_unique<connection>(s.io_context, connection::local_t{});
+                            enter(fetch_phase::connect);
+                            BOOST_ASIO_CORO_YIELD s.conn->local()->async_connect(
+                                boost::asio::local::stream_protocol::endpoint(s.socket_path), std::move(self));
+                            if (ec)
+                                return complete(self, ec);
+                            break;
+                        }
+#endif
+
+                        // Resolve the host and port, unless the client has the addresses at hand
+                        s.cached_endpoints = lookup_endpoints();
+                        if (!s.cached_endpoints)
+                        {
+                            if (!s.resolver)
+                                s.resolver.emplace(s.io_context);
+                            enter(fetch_phase::resolve);
+                            BOOST_ASIO_CORO_YIELD s.resolver->async_resolve(s.resolve_host, s.service, std::move(self));
+                            if (ec)
+                                return complete(self, ec);
+                        }
+
+                        // Create the socket
+                        s.conn = make_connection();
+                        enter(fetch_phase::connect);
+                        BOOST_ASIO_CORO_YIELD boost::asio::async_connect(s.conn->socket(), s.endpoints, std::move(self));
+                        if (!ec)
+                            break;
+                        if (!s.cached_endpoints || ec == boost::asio::error::operation_aborted)
+                            return complete(self, ec);
+
+                        // The host may have moved since its addresses were cached
+                        s.dns->erase(s.dns_key);
+                        s.conn->close();
+                    }
+
+                    if (!s.unix_socket)
+                        s.conn->socket().set_option(boost::asio::ip::tcp::no_delay(true), ec);
+
+#ifndef RESTPP_EXCLUDE_SSL
+                    if (s.conn->tls())
+                    {
+                        s.tls->prepare(s.conn->tls()->native_handle(), s.resolve_host, s.conn->session_key(), ec);
+                        if (ec)
+                            return complete(self, ec);
+                        if (s.upgrade)
+                            tls_context::offer_http1_only(s.conn->tls()->native_handle());
+
+                        enter(fetch_phase::tls_handshake);
+                        BOOST_ASIO_CORO_YIELD s.conn->tls()->async_handshake(
+                            boost::asio::ssl::stream_base::client, std::move(self));
+                        if (ec)
+                            return complete(self, ec);
+                        s.conn->on_handshake();
+                        if (s.conn->alpn() == "h2" && !s.upgrade)
+                            start_session();
+                    }
+#endif
+                }
+
+                if (s.session)
+                {
+                    s.received = 0;
+                    s.stream = s.session->open(build_h2_fields(s.target, s.opts, s.body_length(), revalidation_headers()),
+                                               static_cast<bool>(s.opts.body));
+
+                    // The body goes out piece by piece, as fast as the flow control windows allow
+                    enter(fetch_phase::write);
+                    rewind_body();
+                    while (!s.body_done)
+                    {
+                        s.h2_piece = next_piece(ec);
+                        if (ec)
+                            break;
+                        BOOST_ASIO_CORO_YIELD send_to_stream(self);
+                        if (ec)
+                            break;
+                    }
+
+                    if (!ec)
+                        enter(fetch_phase::first_byte);
+                    while (!ec)
+                    {
+                        BOOST_ASIO_CORO_YIELD wait_for_stream(self);
+                        if (!s.event.ec)
+                            on_stream_event(ec);
+                        else
+                            ec = s.event.ec;
+                        if (ec)
+                            break;
+
+                        while (next_sink_piece(ec))
+                        {
+                            BOOST_ASIO_CORO_YIELD write_to_sink(self);
+                            if (ec)
+                                break;
+                        }
+                        if (ec || s.event.end)
+                            break;
+                    }
+
+                    // Streams the server refused never reached the application. Those lost with a
+                    // connection it had closed may have, and are only sent again when idempotent
+                    if (ec && s.received == 0 && s.attempt == 0 && can_resend_body() &&
+                        (ec == error::stream_refused ||
+                         (s.reused && is_stale_connection_error(ec) && is_idempotent(s.opts.method))))
+                    {
+                        s.session->cancel(s.stream);
+                        s.stream.reset();
+                        ++s.attempt;
+                        continue;
+                    }
+                    break;
+                }
+
+                // Send the request head, along with as much of the body as goes in the same write
+                enter(fetch_phase::write);
+                s.head_pending = true;
+                rewind_body();
+                while (next_write(ec))
+                {
+#ifdef RESTPP_HAS_SENDFILE
+                    if (s.send_file)
+                    {
+                        BOOST_ASIO_CORO_YIELD async_sendfile(
+                            s.conn->socket(), s.file, s.body_offset, s.file.size() - s.body_offset, std::move(self));
+                    }
+                    else
+#endif
+                    {
+                        BOOST_ASIO_CORO_YIELD boost::asio::async_write(
+                            *s.conn, const_buffer_span{s.gather.data(), s.gather.data() + s.gather.size()}, std::move(self));
+                    }
+                    s.res.timings.bytes_sent += bytes_transferred;
+                    if (ec)
+                        break;
+                }
+
+                if (!ec)
+                {
+                    s.received = 0;
+                    s.parser.reset(s.opts.method == "HEAD");
+                    enter(fetch_phase::first_byte);
+                    for (;;)
+                    {
+                        parse_buffered(ec);
+                        if (ec)
+                            break;
+
+                        if (!s.pending_body.empty())
+                        {
+                            // Wait for an asynchronous sink before parsing any further
+                            while (next_sink_piece(ec))
+                            {
+                                BOOST_ASIO_CORO_YIELD write_to_sink(self);
+                                if (ec)
+                                    break;
+                            }
+                            if (ec)
+                                break;
+                            continue;
+                        }
+
+                        if (s.parser.is_done())
+                            break;
+
+                        if (s.parser.body_remaining() != 0 && !s.opts.sink && !s.decoder)
+                        {
+                            // The rest of a Content-Length body goes straight into the response
+                            bytes_transferred = s.res.body.size();
+                            grow_body(s.res.body, s.parser.body_remaining(), s.opts.max_body_size, ec);
+                            if (ec)
+                                break;
+                            BOOST_ASIO_CORO_YIELD boost::asio::async_read(
+                                *s.conn,
+                                boost::asio::buffer(&s.res.body[bytes_transferred], s.res.body.size() - bytes_transferred),
+                                std::move(self));
+                            if (ec)
+                                break;
+                            s.received += bytes_transferred;
+                            s.res.timings.bytes_received += bytes_transferred;
+                            s.parser.skip_body(bytes_transferred);
+                            continue;
+                        }
+
+                        BOOST_ASIO_CORO_YIELD s.conn->async_read_some(
+                            s.conn->buffer().prepare(s.opts.chunk_size), std::move(self));
+                        if (ec)
+                            break;
+                        if (s.received == 0)
+                            enter(fetch_phase::transfer);
+                        s.received += bytes_transferred;
+                        s.res.timings.bytes_received += bytes_transferred;
+                        s.conn->buffer().commit(bytes_transferred);
+                    }
+                }
+
+                // A pooled connection may still be closed by the server between our health check
+                // and the request reaching it; in that case retry once over a fresh connection.
+                // Nothing tells whether the server acted on the request before closing, so only
+                // idempotent ones are sent again
+                if (ec && s.reused && s.received == 0 && can_resend_body() && is_stale_connection_error(ec) &&
+                    is_idempotent(s.opts.method))
+                {
+                    s.conn->close();
+                    ++s.attempt;
+                    continue;
+                }
+                break;
+            }
+
+            if (s.session)
+            {
+                if (!ec)
+                    s.decoder.finish(ec);
+                if (ec)
+                    return complete(self, ec);
+
+                s.res.alpn = "h2";
+                s.res.tls_resumed = s.session->tls_resumed();
+                if (!s.keep_alive)
+                    s.session->close();
+                return complete(self, {});
+            }
+
+            if (is_end_of_stream(ec))
+            {
+                ec = {};
+                s.parser.finish(ec);
+            }
+            if (!ec)
+                s.decoder.finish(ec);
+            if (ec)
+                return complete(self, ec);
+
+            s.res.alpn = s.conn->alpn();
+            s.res.tls_resumed = s.conn->tls_resumed();
+            if (s.upgrade && s.res.status_code == 101)
+                *s.upgrade = std::move(s.conn);
+            else if (s.keep_alive && s.parser.keep_alive() && s.pool)
+            {
+                s.conn->set_pipelinable(s.parser.version_minor() >= 1);
+                s.pool->release(s.key, std::move(s.conn));
+            }
+            else
+                s.conn->close();
+
+            complete(self, {});
+        }
+    }
+
+private:
+    /// <summary>
+    /// Takes the endpoints from the DNS cache of the client, starting a background refresh
+    /// when the entry is about to expire.
+    /// </summary>
+    bool lookup_endpoints()
+    {
+        fetch_state& s = *_state;
+        bool refresh = false;
+        if (!s.dns || !s.dns->lookup(s.dns_key, s.endpoints, refresh))
+            return false;
+        if (refresh)
+            s.dns->refresh(s.io_context, s.resolve_host, s.service);
+        return true;
+    }
+
+    /// <summary>
+    /// Maps the file of a file URI into memory as the response, or the source of what its
+    /// sink is handed. HEAD requests only get its length.
+    /// </summary>
+    void map_file(boost::system::error_code& ec)
+    {
+        fetch_state& s = *_state;
+        struct mapping
+        {
+            mapped_file file;
+            std::string_view data;
+        };
+
+        auto m = std::make_shared<mapping>();
+        m->file.open(uri::decode(s.target.path()), ec);
+        if (ec)
+            return;
+        m->data = m->file.data();
+
+        s.res.status_code = 200;
+        std::string length;
+        append_decimal(length, m->data.size());
+        s.res.headers.set(field::content_length, length);
+        if (s.opts.method == "HEAD")
+            m->data = {};
+
+        s.mapping = std::shared_ptr<const std::string_view>(m, &m->data);
+        if (!s.opts.sink && !m->data.empty())
+            s.res.mapped = s.mapping;
+    }
+
+    std::unique_ptr<connection> make_connection()
+    {
+        fetch_state& s = *_state;
+#ifndef RESTPP_EXCLUDE_SSL
+        if (s.secure)
+        {
+            return std::make_unique<connection>(
+                s.io_context, s.tls->context(), s.key.host + ":" + std::to_string(s.key.port));
+        }
+#endif
+        return std::make_unique<connection>(s.io_context);
+    }
+
+    void rewind_body()
+    {
+        fetch_state& s = *_state;
+        s.body_offset = 0;
+        s.body_index = 0;
+        s.body_done = !s.opts.body;
+    }
+
+    /// <summary>
+    /// A generated body cannot be sent a second time once the generator was called.
+    /// </summary>
+    bool can_resend_body() const { return _state->opts.body.replayable() || !_state->body_started; }
+
+    /// <summary>
+    /// Reads the next piece of a file body into <c>body_chunk</c>.
+    /// </summary>
+    std::string_view read_file_chunk(boost::system::error_code& ec)
+    {
+        fetch_state& s = *_state;
+        const std::uint64_t remaining = s.file.size() - s.body_offset;
+        const std::size_t size = remaining < s.opts.chunk_size ? static_cast<std::size_t>(remaining) : s.opts.chunk_size;
+        s.body_chunk.resize(size);
+        const std::size_t n = size == 0 ? 0 : s.file.read(s.body_offset, &s.body_chunk[0], size, ec);
+        s.body_offset += n;
+        s.body_done = s.body_offset == s.file.size();
+        return std::string_view(s.body_chunk.data(), n);
+    }
+
+    /// <summary>
+    /// Lines up the next HTTP/1.1 write in <c>gather</c>: the request head while it is pending,
+    /// followed by the body buffers, a piece of the file or the next chunk. Large files on plain
+    /// connections are left to <c>sendfile</c> once the head went out.
+    /// </summary>
+    /// <returns>False once everything was written.</returns>
+    bool next_write(boost::system::error_code& ec)
+    {
+        static constexpr std::string_view crlf = "\r\n";
+        static constexpr std::string_view last_chunk = "0\r\n\r\n";
+
+        fetch_state& s = *_state;
+        s.gather.clear();
+        s.send_file = false;
+        if (s.head_pending)
+        {
+            s.gather.push_back(boost::asio::buffer(s.request));
+            s.head_pending = false;
+        }
+        if (s.body_done)
+            return !s.gather.empty();
+
+        switch (s.opts.body.type())
+        {
+            case request_body::kind::buffers:
+            {
+                const auto& buffers = s.opts.body.buffers();
+                s.gather.insert(s.gather.end(), buffers.begin(), buffers.end());
+                s.body_done = true;
+                break;
+            }
+            case request_body::kind::file:
+            {
+#ifdef RESTPP_HAS_SENDFILE
+#ifndef RESTPP_EXCLUDE_SSL
+                const bool plain = s.conn->tls() == nullptr && !s.unix_socket;
+#else
+                const bool plain = !s.unix_socket;
+#endif
+                if (plain && s.file.size() - s.body_offset > s.opts.chunk_size)
+                {
+                    if (!s.gather.empty())
+                        return true;
+                    s.send_file = true;
+                    s.body_done = true;
+                    return true;
+                }
+#endif
+                const auto chunk = read_file_chunk(ec);
+                if (ec)
+                    return false;
+                s.gather.push_back(boost::asio::buffer(chunk));
+                break;
+            }
+            case request_body::kind::chunked:
+            {
+                std::string_view chunk;
+                s.body_started = true;
+                if (!s.opts.body.next_chunk(chunk))
+                {
+                    ec = error::request_aborted;
+                    return false;
+                }
+                if (chunk.empty())
+                {
+                    s.gather.push_back(boost::asio::buffer(last_chunk.data(), last_chunk.size()));
+                    s.body_done = true;
+                    break;
+                }
+
+                static constexpr char digits[] = "0123456789abcdef";
+                s.chunk_header.clear();
+                for (std::size_t size = chunk.size(); size != 0; size >>= 4)
+                    s.chunk_header.insert(s.chunk_header.begin(), digits[size & 0xF]);
+                s.chunk_header.append(crlf);
+                s.gather.push_back(boost::asio::buffer(s.chunk_header));
+                s.gather.push_back(boost::asio::buffer(chunk.data(), chunk.size()));
+                s.gather.push_back(boost::asio::buffer(crlf.data(), crlf.size()));
+                break;
+            }
+            default: s.body_done = true; break;
+        }
+        return !s.gather.empty();
+    }
+
+    /// <summary>
+    /// Produces the next piece of the body of an HTTP/2 request. The session frames it into
+    /// DATA frames, so every kind of body is handed over as a string.
+    /// </summary>
+    std::string next_piece(boost::system::error_code& ec)
+    {
+        fetch_state& s = *_state;
+        switch (s.opts.body.type())
+        {
+            case request_body::kind::buffers:
+            {
+                const auto& buffers = s.opts.body.buffers();
+                std::string piece;
+                if (s.body_index < buffers.size())
+                {
+                    const auto& buffer = buffers[s.body_index++];
+                    piece.assign(static_cast<const char*>(buffer.data()), buffer.size());
+                }
+                s.body_done = s.body_index >= buffers.size();
+                return piece;
+            }
+            case request_body::kind::file: return std::string(read_file_chunk(ec));
+            case request_body::kind::chunked:
+            {
+                std::string_view chunk;
+                s.body_started = true;
+                if (!s.opts.body.next_chunk(chunk))
+                    ec = error::request_aborted;
+                s.body_done = chunk.empty();
+                return std::string(chunk);
+            }
+            default: s.body_done = true; return {};
+        }
+    }
+
+    /// <summary>
+    /// Hands <c>body_chunk</c> to the stream and resumes the operation once it was framed.
+    /// </summary>
+    template<typename Self>
+    void send_to_stream(Self& self)
+    {
+        fetch_state& s = *_state;
+        auto session = s.session;
+        auto stream = s.stream;
+        const bool last = s.body_done;
+        std::string data = std::move(s.h2_piece);
+        s.res.timings.bytes_sent += data.size();
+        auto executor = boost::asio::get_associated_executor(self);
+        auto resume = std::make_shared<Self>(std::move(self));
+        session->async_send(stream, std::move(data), last, [resume, executor](boost::system::error_code ec) {
+            boost::asio::dispatch(executor, [resume, ec]() { (*resume)(ec, std::size_t(0)); });
+        });
+    }
+
+    /// <summary>
+    /// Turns a connection that negotiated HTTP/2 into a session, shared with later fetches to the
+    /// same origin when connections are kept alive.
+    /// </summary>
+    void start_session()
+    {
+        fetch_state& s = *_state;
+        s.session = std::make_shared<h2_session>(s.io_context, std::move(s.conn));
+        s.session->try_reserve();
+        s.session->start();
+        if (s.keep_alive && s.h2_pool)
+            s.h2_pool->add(s.key, s.session);
+    }
+
+    /// <summary>
+    /// Waits for the next events of the stream and resumes the operation on its executor.
+    /// </summary>
+    template<typename Self>
+    void wait_for_stream(Self& self)
+    {
+        fetch_state& s = *_state;
+        auto session = s.session;
+        auto stream = s.stream;
+        auto executor = boost::asio::get_associated_executor(self);
+        auto resume = std::make_shared<Self>(std::move(self));
+        session->async_wait(stream, s.event, [resume, executor]() {
+            boost::asio::dispatch(executor, [resume]() { (*resume)(boost::system::error_code(), std::size_t(0)); });
+        });
+    }
+
+    /// <summary>
+    /// Takes what a stream delivered into the response. Body data is appended to the response or
+    /// written to the sink; data for an asynchronous sink is left in <c>pending_body</c>.
+    /// </summary>
+    void on_stream_event(boost::system::error_code& ec)
+    {
+        fetch_state& s = *_state;
+        h2_event& e = s.event;
+        if (e.head)
+        {
+            enter(fetch_phase::transfer);
+            s.received = 1;
+            s.res.status_code = e.status;
+            s.res.headers = std::move(e.headers);
+            if (const auto length = s.res.headers.content_length(); length && !s.opts.sink && s.opts.method != "HEAD")
+            {
+                if (*length > s.opts.max_body_size)
+                {
+                    ec = error::body_too_large;
+                    return;
+                }
+                s.res.body.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(*length, max_body_presize)));
+            }
+            start_decoding();
+        }
+
+        s.res.timings.bytes_received += e.data.size();
+        if (!e.data.empty() && s.opts.method != "HEAD")
+        {
+            if (s.opts.sink.is_async())
+                s.pending_body = e.data;
+            else if (!take_body(e.data, ec) && !ec)
+                ec = error::body_aborted;
+        }
+
+        if (e.end)
+        {
+            for (const auto& [name, value] : e.trailers)
+                s.res.headers.add(name, value);
+        }
+    }
+
+    /// <summary>
+    /// Runs the parser over the bytes buffered on the connection. Body data goes straight from
+    /// the receive buffer to the sink, or is appended to the response, and the status line and
+    /// headers are captured as soon as they have been parsed. A piece of body meant for an
+    /// asynchronous sink pauses the parser and is left in <c>pending_body</c>.
+    /// </summary>
+    void parse_buffered(boost::system::error_code& ec)
+    {
+        fetch_state& s = *_state;
+        auto& buffer = s.conn->buffer();
+        bool has_head = s.parser.is_head_done();
+        bool aborted = false;
+        boost::system::error_code body_ec;
+
+        // The head is taken before the first piece of body, which may come with it
+        const auto on_head = [&] {
+            if (has_head)
+                return;
+            has_head = true;
+            take_head(s.parser, s.res, !s.opts.sink);
+            start_decoding();
+        };
+
+        std::size_t used = 0;
+        if (!s.opts.sink.is_async())
+        {
+            used = s.parser.parse(buffer.data(), buffer.size(), ec, [&](std::string_view data) {
+                on_head();
+                aborted = !take_body(data, body_ec);
+                return !aborted;
+            });
+        }
+        else
+        {
+            used = s.parser.parse(buffer.data(), buffer.size(), ec, [&](std::string_view data) {
+                on_head();
+                s.pending_body = data;
+                return false;
+            });
+        }
+
+        if (!ec && s.parser.is_head_done())
+            on_head();
+
+        // Consuming only moves the read position, so a pending view stays valid until the
+        // next read prepares the buffer again.
+        buffer.consume(used);
+        if (aborted)
+            ec = body_ec ? body_ec : make_error_code(error::body_aborted);
+    }
+
+    /// <summary>
+    /// Looks at the Content-Encoding of the response once its head arrived, and sets up the
+    /// decoder when the body is to be decoded.
+    /// </summary>
+    void start_decoding()
+    {
+        fetch_state& s = *_state;
+        if (!s.opts.decode_content || s.opts.method == "HEAD")
+            return;
+        if (const auto coding = s.res.headers.get(field::content_encoding))
+            s.decoder.start(parse_content_coding(*coding), s.decoders, s.opts.chunk_size);
+    }
+
+    /// <summary>
+    /// Appends a piece of body to the response or writes it to a synchronous sink.
+    /// </summary>
+    bool deliver_body(std::string_view data, boost::system::error_code& ec)
+    {
+        fetch_state& s = *_state;
+        if (!s.opts.sink)
+            return append_body(s.res.body, data, s.opts.max_body_size, ec);
+        return s.opts.sink.write(data);
+    }
+
+    /// <summary>
+    /// Takes a piece of body as it came over the wire, decoding it first when needed.
+    /// </summary>
+    /// <returns>False when the sink refused the body or it could not be decoded.</returns>
+    bool take_body(std::string_view data, boost::system::error_code& ec)
+    {
+        fetch_state& s = *_state;
+        if (!s.decoder)
+            return deliver_body(data, ec);
+
+        s.decoder.feed(data);
+        std::string_view decoded;
+        while (s.decoder.next(decoded, ec))
+        {
+            if (!deliver_body(decoded, ec))
+                return false;
+        }
+        return !ec;
+    }
+
+    /// <summary>
+    /// Lines up in <c>sink_piece</c> the next piece for the asynchronous sink: the pending body
+    /// itself, or what the decoder makes of it, a piece at a time.
+    /// </summary>
+    /// <returns>False once the pending body was handed over whole.</returns>
+    bool next_sink_piece(boost::system::error_code& ec)
+    {
+        fetch_state& s = *_state;
+        if (!s.decoder)
+        {
+            s.sink_piece = s.pending_body;
+            s.pending_body = {};
+            return !s.sink_piece.empty();
+        }
+
+        if (!s.pending_body.empty())
+        {
+            s.decoder.feed(s.pending_body);
+            s.pending_body = {};
+        }
+        return s.decoder.next(s.sink_piece, ec);
+    }
+
+    /// <summary>
+    /// Hands the next piece of body to the asynchronous sink and resumes the operation on its
+    /// executor once the sink is done with it.
+    /// </summary>
+    template<typename Self>
+    void write_to_sink(Self& self)
+    {
+        const std::string_view data = _state->sink_piece;
+        _state->sink_piece = {};
+
+        // The operation, and with it the state, moves into the completion below
+        const body_sink& sink = _state->opts.sink;
+        auto executor = boost::asio::get_associated_executor(self);
+        auto resume = std::make_shared<Self>(std::move(self));
+        sink.async_write(data, [resume, executor](boost::system::error_code ec) {
+            boost::asio::post(executor, [resume, ec]() { (*resume)(ec, std::size_t(0)); });
+        });
+    }
+
+    /// <summary>
+    /// Starts a phase of a watched request.
+    /// </summary>
+    void enter(fetch_phase phase)
+    {
+        fetch_state& s = *_state;
+        lap(std::chrono::steady_clock::now());
+        s.timed_phase = phase;
+        s.timing_phase = true;
+        if (s.watch)
+            s.watch->enter(phase);
+    }
+
+    /// <summary>
+    /// Adds the time spent in the current phase to the timings of the response.
+    /// </summary>
+    void lap(std::chrono::steady_clock::time_point now)
+    {
+        fetch_state& s = *_state;
+        auto& timings = s.res.timings;
+        if (s.timing_phase)
+        {
+            const auto elapsed = now - s.phase_started;
+            switch (s.timed_phase)
+            {
+                case fetch_phase::resolve: timings.resolve += elapsed; break;
+                case fetch_phase::connect: timings.connect += elapsed; break;
+                case fetch_phase::tls_handshake: timings.tls_handshake += elapsed; break;
+                case fetch_phase::write: timings.write += elapsed; break;
+                case fetch_phase::first_byte: timings.first_byte += elapsed; break;
+                case fetch_phase::transfer: timings.transfer += elapsed; break;
+            }
+        }
+        s.phase_started = now;
+    }
+
+    /// <summary>
+    /// Cuts short whatever the request is waiting on, once its watch fired. The stream or
+    /// connection is given up, so the operation completes as soon as it resumes.
+    /// </summary>
+    static void cancel_io(fetch_state& s)
+    {
+        if (s.resolver)
+            s.resolver->cancel();
+        if (s.stream)
+            s.session->cancel(s.stream);
+        else if (s.conn)
+            s.conn->close();
+    }
+
+    /// <summary>
+    /// The validators added to a request revalidating a stale cached response.
+    /// </summary>
+    const headers* revalidation_headers() const
+    {
+        return _state->cached.lookup == cache_lookup::revalidate ? &_state->cached.conditional : nullptr;
+    }
+
+    template<typename Self>
+    void complete(Self& self, boost::system::error_code ec)
+    {
+        if (_state->watch)
+        {
+            _state->watch->stop();
+            if (_state->watch->error())
+                ec = _state->watch->error();
+        }
+
+        fetch_state& s = *_state;
+        const auto now = std::chrono::steady_clock::now();
+        lap(now);
+        s.res.timings.total = now - s.started;
+        s.res.timings.reused_connection = s.reused;
+        s.res.timings.cached = s.cached.lookup == cache_lookup::hit;
+
+        response res;
+        if (!ec && s.cache)
+            s.cache->update(s.target, s.opts, s.cached, s.res);
+        if (!ec)
+            res = std::move(s.res);
+        else
+        {
+            res.timings = s.res.timings;
+            if (s.stream)
+                s.session->cancel(s.stream);
+            else if (s.conn)
+                s.conn->close();
+        }
+        if (s.observer)
+            s.observer->on_complete(s.target, s.opts, ec, res);
+        _state.reset();
+        self.complete(ec, std::move(res));
+    }
+
+    fetch_state_ptr _state;
+};
+
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_FETCH_OP_HPP
@@ -0,0 +1,394 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * What the retry, hedging and concurrency policies of a client know of each host.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_FETCH_POLICY_HPP
+#define RESTPP_FETCH_POLICY_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/asio/error.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <restpp/core/error.hpp>
+#include <restpp/core/options.hpp>
+#include <restpp/core/policy.hpp>
+#include <restpp/core/response.hpp>
+#include <restpp/core/uri.hpp>
+#include <restpp/core/details/http_date.hpp>
+
+namespace restpp
+{
+namespace details
+{
+/// <summary>
+/// Whether sending a request with this method twice has the effect of sending it once
+/// (RFC 9110, section 9.2.2).
+/// </summary>
+inline bool is_idempotent(std::string_view method)
+{
+    return method == "GET" || method == "HEAD" || method == "OPTIONS" || method == "TRACE" || method == "PUT" ||
+           method == "DELETE";
+}
+
+/// <summary>
+/// Whether a request may be sent again: an idempotent method, a body that can be replayed, and
+/// no sink that would have seen part of the first response.
+/// </summary>
+inline bool may_retry(const options& opts)
+{
+    return is_idempotent(opts.method) && opts.body.replayable() && !opts.sink;
+}
+
+/// <summary>
+/// Whether a request may be sent twice at the same time, for the first answer to win.
+/// </summary>
+inline bool may_hedge(const options& opts)
+{
+    return (opts.method == "GET" || opts.method == "HEAD" || opts.method == "OPTIONS") &&
+           opts.body.type() == request_body::kind::none && !opts.sink;
+}
+
+/// <summary>
+/// Whether a request failing with this error may succeed when sent again: the connection or
+/// stream broke, or a phase timed out. Aborts, deadlines and errors the request itself caused
+/// are final.
+/// </summary>
+inline bool is_transient_error(const boost::system::error_code& ec)
+{
+    namespace asio_error = boost::asio::error;
+    return ec == asio_error::connection_refused || ec == asio_error::connection_reset ||
+           ec == asio_error::connection_aborted || ec == asio_error::broken_pipe || ec == asio_error::eof ||
+           ec == asio_error::host_unreachable || ec == asio_error::network_unreachable ||
+           ec == asio_error::network_down || ec == asio_error::timed_out || ec == asio_error::try_again ||
+           ec == error::partial_message || ec == error::stream_refused || ec == error::stream_reset ||
+           ec == error::resolve_timed_out || ec == error::connect_timed_out || ec == error::handshake_timed_out ||
+           ec == error::first_byte_timed_out;
+}
+
+/// <summary>
+/// Whether a response tells the client to come back later.
+/// </summary>
+inline bool is_transient_status(int status)
+{
+    return status == 429 || status == 502 || status == 503 || status == 504;
+}
+
+/// <summary>
+/// How long a response asks to wait before the next request with Retry-After, in seconds or as
+/// a date. Zero when it does not.
+/// </summary>
+inline std::chrono::steady_clock::duration retry_after(const response& res)
+{
+    const auto value = res.headers.get(field::retry_after);
+    if (!value || value->empty())
+        return {};
+
+    unsigned long long seconds = 0;
+    if (std::all_of(value->begin(), value->end(), [](char c) { return c >= '0' && c <= '9'; }))
+    {
+        for (char c : *value)
+            seconds = std::min<unsigned long long>(seconds * 10 + static_cast<unsigned>(c - '0'), 86400);
+        return std::chrono::seconds(seconds);
+    }
+    if (const auto when = parse_http_date(*value))
+    {
+        const auto wait = *when - std::chrono::system_clock::now();
+        if (wait > std::chrono::system_clock::duration::zero())
+            return std::chrono::duration_cast<std::chrono::steady_clock::duration>(wait);
+    }
+    return {};
+}
+
+/// <summary>
+/// The wait before the given retry, the first being 1: a random time up to the exponential
+/// backoff of the policy, so that clients failing together do not all come back together.
+/// </summary>
+inline std::chrono::steady_clock::duration backoff_delay(const retry_policy& policy, int retry)
+{
+    using duration = std::chrono::steady_clock::duration;
+    const double ceiling = std::min(
+        static_cast<double>(policy.max_backoff.count()),
+        static_cast<double>(policy.initial_backoff.count()) * std::pow(policy.multiplier, std::max(retry - 1, 0)));
+    if (ceiling <= 0)
+        return {};
+
+    thread_local std::minstd_rand engine{std::random_device{}()};
+    std::uniform_real_distribution<double> jitter(0, ceiling);
+    return duration(static_cast<duration::rep>(jitter(engine)));
+}
+
+/// <summary>
+/// What the policies of a client learnt of one host: its recent latency, for the delay of
+/// hedged requests, and its concurrency limit with the requests waiting for a slot. The limit
+/// is the adaptive one when the concurrency policy is, and never more than the fixed maximum
+/// of requests in flight to a host when the client has one. Thread-safe.
+/// </summary>
+class host_policy
+{
+public:
+    using duration = std::chrono::steady_clock::duration;
+    using waiter = std::function<void()>;
+
+    /// <summary>
+    /// Latencies kept for the percentile, and responses after which the fastest recent one is
+    /// measured again, so that a host that became slower for good stops being compared to how
+    /// it used to be.
+    /// </summary>
+    static constexpr std::size_t latency_window = 256;
+    static constexpr std::size_t baseline_window = 256;
+
+    /// <summary>
+    /// <c>max_in_flight</c> caps the limit, zero leaving it uncapped.
+    /// </summary>
+    host_policy(const concurrency_policy& concurrency, std::size_t max_in_flight)
+        : _limit(static_cast<double>(clamp_limit(concurrency, concurrency.initial_limit)))
+        , _adaptive(concurrency.adaptive)
+        , _max_in_flight(max_in_flight)
+    {
+    }
+
+    host_policy(const host_policy&) = delete;
+    host_policy& operator=(const host_policy&) = delete;
+
+    /// <summary>
+    /// Records the latency of a successful response.
+    /// </summary>
+    void record_latency(duration latency)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _latencies[_next_latency] = latency;
+        _next_latency = (_next_latency + 1) % latency_window;
+        _latency_count = std::min(_latency_count + 1, latency_window);
+        _percentile_stale = true;
+    }
+
+    /// <summary>
+    /// How long to wait before hedging a request: the percentile of the recent latency of the
+    /// host, recomputed after every sixteenth new sample.
+    /// </summary>
+    duration hedge_delay(const hedge_policy& policy)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_latency_count < std::max<std::size_t>(policy.min_samples, 1))
+            return std::max(policy.initial_delay, policy.min_delay);
+
+        if (_percentile_stale && (++_since_percentile >= 16 || _percentile == duration::zero()))
+        {
+            std::vector<duration> sorted(_latencies.begin(), _latencies.begin() + _latency_count);
+            const auto rank = static_cast<std::size_t>(
+                std::clamp(policy.percentile, 0.0, 1.0) * static_cast<double>(sorted.size() - 1));
+            std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(rank), sorted.end());
+            _percentile = sorted[rank];
+            _percentile_stale = false;
+            _since_percentile = 0;
+        }
+        return std::max(_percentile, policy.min_delay);
+    }
+
+    /// <summary>
+    /// Takes a slot under the concurrency limit, or queues <c>w</c> to be called once one is
+    /// taken for it.
+    /// </summary>
+    /// <returns>0 when the slot was taken right away and <c>w</c> dropped, or an id for
+    /// <c>cancel</c>.</returns>
+    std::uint64_t acquire(waiter w)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_waiters.empty() && _in_flight < admitted())
+        {
+            ++_in_flight;
+            return 0;
+        }
+        _waiters.emplace_back(++_next_waiter, std::move(w));
+        return _next_waiter;
+    }
+
+    /// <summary>
+    /// Takes a request off the queue, dropping its waiter.
+    /// </summary>
+    /// <returns>false when a slot was already taken for it, which its waiter is called with and
+    /// which must be given back.</returns>
+    bool cancel(std::uint64_t id)
+    {
+        // Destroyed once the lock is released, as it may hold the last reference to the request
+        waiter dropped;
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = std::find_if(_waiters.begin(), _waiters.end(), [id](const auto& w) { return w.first == id; });
+        if (it == _waiters.end())
+            return false;
+        dropped = std::move(it->second);
+        _waiters.erase(it);
+        return true;
+    }
+
+    /// <summary>
+    /// Takes a slot if one is free right away, without queueing.
+    /// </summary>
+    bool try_acquire()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_waiters.empty() || _in_flight >= admitted())
+            return false;
+        ++_in_flight;
+        return true;
+    }
+
+    /// <summary>
+    /// Gives back a slot, adjusting the limit to how the request went: <c>sampled</c> is false
+    /// for requests cut short by the client, which say nothing of the host. Hands the freed
+    /// slots to the requests waiting for one.
+    /// </summary>
+    void release(const concurrency_policy& policy, bool sampled, bool dropped, duration latency)
+    {
+        std::vector<waiter> granted;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (sampled && _adaptive)
+                adjust(policy, dropped, latency);
+            --_in_flight;
+            while (!_waiters.empty() && _in_flight < admitted())
+            {
+                ++_in_flight;
+                granted.push_back(std::move(_waiters.front().second));
+                _waiters.pop_front();
+            }
+        }
+        for (auto& w : granted)
+            w();
+    }
+
+    /// <summary>
+    /// The current concurrency limit of the host.
+    /// </summary>
+    std::size_t limit() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return admitted();
+    }
+
+private:
+    /// <summary>
+    /// Brings a limit within the bounds of the policy, taken as at least 1, with a lower bound
+    /// past the upper one lowered to it, so that no setting leaves the clamp without a range.
+    /// </summary>
+    static std::size_t clamp_limit(const concurrency_policy& policy, std::size_t limit)
+    {
+        const std::size_t high = std::max<std::size_t>(policy.max_limit, 1);
+        const std::size_t low = std::min(std::max<std::size_t>(policy.min_limit, 1), high);
+        return std::clamp(limit, low, high);
+    }
+
+    std::size_t admitted() const
+    {
+        const std::size_t limit =
+            _adaptive ? std::max<std::size_t>(1, static_cast<std::size_t>(_limit)) : std::numeric_limits<std::size_t>::max();
+        return _max_in_flight != 0 ? std::min(limit, _max_in_flight) : limit;
+    }
+
+    /// <summary>
+    /// Additive increase, multiplicative decrease: a limit that is in use grows by about one per
+    /// window of fast responses, and every slow or failed one shrinks it.
+    /// </summary>
+    void adjust(const concurrency_policy& policy, bool dropped, duration latency)
+    {
+        if (!dropped)
+        {
+            _window_min = _window_samples == 0 ? latency : std::min(_window_min, latency);
+            _baseline = _baseline == duration::zero() ? latency : std::min(_baseline, latency);
+            if (++_window_samples >= baseline_window)
+            {
+                _baseline = _window_min;
+                _window_samples = 0;
+            }
+        }
+
+        const auto max_limit = static_cast<double>(clamp_limit(policy, policy.max_limit));
+        const auto min_limit = static_cast<double>(clamp_limit(policy, policy.min_limit));
+        if (dropped || static_cast<double>(latency.count()) > policy.tolerance * static_cast<double>(_baseline.count()))
+            _limit = std::max(min_limit, _limit * policy.backoff_ratio);
+        else if (static_cast<double>(_in_flight) * 2 >= _limit)
+            _limit = std::min(max_limit, _limit + 1 / _limit);
+    }
+
+    mutable std::mutex _mutex;
+
+    std::array<duration, latency_window> _latencies{};
+    std::size_t _next_latency = 0;
+    std::size_t _latency_count = 0;
+    duration _percentile{};
+    bool _percentile_stale = false;
+    std::size_t _since_percentile = 0;
+
+    double _limit;
+    const bool _adaptive;
+    const std::size_t _max_in_flight;
+    std::size_t _in_flight = 0;
+    std::deque<std::pair<std::uint64_t, waiter>> _waiters;
+    std::uint64_t _next_waiter = 0;
+    duration _baseline{};
+    duration _window_min{};
+    std::size_t _window_samples = 0;
+};
+
+/// <summary>
+/// The policy state of every host a client made requests to, by scheme, host and port.
+/// </summary>
+class host_policies
+{
+public:
+    host_policies(const concurrency_policy& concurrency, std::size_t max_in_flight)
+        : _concurrency(concurrency), _max_in_flight(max_in_flight)
+    {
+    }
+
+    std::shared_ptr<host_policy> at(const uri& target)
+    {
+        std::string key;
+        key.append(target.scheme()).append("://").append(target.host()).push_back(':');
+        key.append(std::to_string(target.port()));
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto& entry = _hosts[key];
+        if (!entry)
+            entry = std::make_shared<host_policy>(_concurrency, _max_in_flight);
+        return entry;
+    }
+
+private:
+    const concurrency_policy _concurrency;
+    const std::size_t _max_in_flight;
+    std::mutex _mutex;
+    std::unordered_map<std::string, std::shared_ptr<host_policy>> _hosts;
+};
+
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_FETCH_POLICY_HPP
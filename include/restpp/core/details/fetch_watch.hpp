@@ -0,0 +1,201 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Timeouts, deadline and abort signal of a request in flight.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_FETCH_WATCH_HPP
+#define RESTPP_FETCH_WATCH_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include <boost/asio.hpp>
+
+#include <restpp/core/abort_signal.hpp>
+#include <restpp/core/error.hpp>
+#include <restpp/core/options.hpp>
+
+namespace restpp
+{
+namespace details
+{
+/// <summary>
+/// The phases of a request, each of which may have a timeout of its own.
+/// </summary>
+enum class fetch_phase
+{
+    resolve,
+    connect,
+    tls_handshake,
+    write,
+    first_byte,
+    transfer
+};
+
+/// <summary>
+/// Watches over a request with a single timer, set to whichever comes first of the end of the
+/// current phase and the overall deadline, and listens to its abort signal. When either fires,
+/// <c>on_fire</c> cancels the I/O the request has in flight, which then completes with the error
+/// this reports.
+///
+/// The timer and the abort run on the executor of the request, so they never race with its own
+/// handlers, and are inert once <c>stop()</c> was called. A pending timer is just an entry in the
+/// timer queue of the I/O context, so thousands of them cost nothing more than their memory.
+/// </summary>
+class fetch_watch : public std::enable_shared_from_this<fetch_watch>
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    fetch_watch(boost::asio::any_io_executor executor, const options& opts)
+        : _executor(executor), _timer(executor), _timeouts(opts.timeouts), _signal(opts.signal)
+    {
+        if (_timeouts.total != clock::duration::zero())
+            _deadline = clock::now() + _timeouts.total;
+        if (opts.deadline)
+            _deadline = std::min(_deadline, *opts.deadline);
+    }
+
+    fetch_watch(const fetch_watch&) = delete;
+    fetch_watch& operator=(const fetch_watch&) = delete;
+
+    /// <summary>
+    /// Whether a request made with these options needs watching at all.
+    /// </summary>
+    static bool needed(const options& opts) { return opts.timeouts.any() || opts.deadline || opts.signal; }
+
+    void start(std::function<void()> on_fire)
+    {
+        _on_fire = std::move(on_fire);
+        if (_signal)
+        {
+            std::weak_ptr<fetch_watch> weak = shared_from_this();
+            _subscription = _signal.subscribe([weak] {
+                if (auto self = weak.lock())
+                    boost::asio::post(self->_executor, [self] { self->fire(error::aborted); });
+            });
+        }
+        rearm();
+    }
+
+    /// <summary>
+    /// Starts a phase, and with it the timeout of that phase.
+    /// </summary>
+    void enter(fetch_phase phase)
+    {
+        _phase = phase;
+        const auto limit = phase_timeout(phase);
+        _phase_end = limit != clock::duration::zero() ? clock::now() + limit : clock::time_point::max();
+        rearm();
+    }
+
+    /// <summary>
+    /// What the request failed with, once the watch fired.
+    /// </summary>
+    const boost::system::error_code& error() const { return _error; }
+
+    /// <summary>
+    /// Forgets the request, which is completing.
+    /// </summary>
+    void stop()
+    {
+        _on_fire = nullptr;
+        _signal.unsubscribe(_subscription);
+        _subscription = 0;
+        if (_armed != clock::time_point::max())
+        {
+            _armed = clock::time_point::max();
+            _timer.cancel();
+        }
+    }
+
+private:
+    clock::duration phase_timeout(fetch_phase phase) const
+    {
+        switch (phase)
+        {
+            case fetch_phase::resolve: return _timeouts.resolve;
+            case fetch_phase::connect: return _timeouts.connect;
+            case fetch_phase::tls_handshake: return _timeouts.tls_handshake;
+            case fetch_phase::first_byte: return _timeouts.first_byte;
+            default: return clock::duration::zero();
+        }
+    }
+
+    error::protocol_errors phase_error() const
+    {
+        switch (_phase)
+        {
+            case fetch_phase::resolve: return error::resolve_timed_out;
+            case fetch_phase::connect: return error::connect_timed_out;
+            case fetch_phase::tls_handshake: return error::handshake_timed_out;
+            default: return error::first_byte_timed_out;
+        }
+    }
+
+    void rearm()
+    {
+        if (!_on_fire)
+            return;
+
+        const auto when = std::min(_phase_end, _deadline);
+        if (when == _armed)
+            return;
+        _armed = when;
+        if (when == clock::time_point::max())
+        {
+            _timer.cancel();
+            return;
+        }
+
+        // Setting the expiry cancels the previous wait, which then completes as aborted
+        _timer.expires_at(when);
+        _timer.async_wait(boost::asio::bind_executor(
+            _executor, [self = shared_from_this(), when](const boost::system::error_code& ec) {
+                if (ec || self->_armed != when)
+                    return;
+                self->_armed = clock::time_point::max();
+                self->fire(clock::now() >= self->_deadline ? error::deadline_exceeded : self->phase_error());
+            }));
+    }
+
+    void fire(error::protocol_errors e)
+    {
+        if (_error || !_on_fire)
+            return;
+        _error = e;
+        _on_fire();
+    }
+
+    boost::asio::any_io_executor _executor;
+    boost::asio::steady_timer _timer;
+    const restpp::timeouts _timeouts;
+    abort_signal _signal;
+    std::uint64_t _subscription = 0;
+    std::function<void()> _on_fire;
+    boost::system::error_code _error;
+
+    fetch_phase _phase = fetch_phase::transfer;
+    clock::time_point _phase_end = clock::time_point::max();
+    clock::time_point _deadline = clock::time_point::max();
+    clock::time_point _armed = clock::time_point::max();
+};
+
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_FETCH_WATCH_HPP
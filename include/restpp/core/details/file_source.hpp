@@ -0,0 +1,281 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Files sent as request bodies, zero-copy transmission of them over sockets, and files mapped
+ * into memory.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_FILE_SOURCE_HPP
+#define RESTPP_FILE_SOURCE_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <boost/asio.hpp>
+#include <boost/asio/coroutine.hpp>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/sendfile.h>
+#define RESTPP_HAS_SENDFILE
+#endif
+
+namespace restpp
+{
+namespace details
+{
+/// <summary>
+/// A file opened for reading, with its size taken when it was opened.
+/// </summary>
+class file_source
+{
+public:
+    file_source() = default;
+
+    file_source(const file_source&) = delete;
+    file_source& operator=(const file_source&) = delete;
+
+    ~file_source() { close(); }
+
+    void open(const std::string& path, boost::system::error_code& ec)
+    {
+        close();
+#ifdef _WIN32
+        _fd = ::_open(path.c_str(), _O_RDONLY | _O_BINARY);
+        struct _stat64 st;
+        if (_fd >= 0 && ::_fstat64(_fd, &st) == 0)
+#else
+        _fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat st;
+        if (_fd >= 0 && ::fstat(_fd, &st) == 0)
+#endif
+        {
+            _size = static_cast<std::uint64_t>(st.st_size);
+            return;
+        }
+        ec = boost::system::error_code(errno, boost::system::system_category());
+        close();
+    }
+
+    bool is_open() const { return _fd >= 0; }
+
+    int native_handle() const { return _fd; }
+
+    std::uint64_t size() const { return _size; }
+
+    /// <summary>
+    /// Reads up to <c>size</c> bytes at the given offset. Reading nothing before the end of the
+    /// file means it was truncated while being sent, which is reported as an error.
+    /// </summary>
+    std::size_t read(std::uint64_t offset, char* data, std::size_t size, boost::system::error_code& ec)
+    {
+        for (;;)
+        {
+#ifdef _WIN32
+            const bool sought = ::_lseeki64(_fd, static_cast<__int64>(offset), SEEK_SET) >= 0;
+            const int n = sought ? ::_read(_fd, data, static_cast<unsigned int>(size)) : -1;
+#else
+            const auto n = ::pread(_fd, data, size, static_cast<off_t>(offset));
+#endif
+            if (n > 0)
+                return static_cast<std::size_t>(n);
+            if (n == 0)
+            {
+                ec = boost::asio::error::eof;
+                return 0;
+            }
+            if (errno != EINTR)
+            {
+                ec = boost::system::error_code(errno, boost::system::system_category());
+                return 0;
+            }
+        }
+    }
+
+    void close()
+    {
+        if (_fd < 0)
+            return;
+#ifdef _WIN32
+        ::_close(_fd);
+#else
+        ::close(_fd);
+#endif
+        _fd = -1;
+        _size = 0;
+    }
+
+private:
+    int _fd = -1;
+    std::uint64_t _size = 0;
+};
+
+/// <summary>
+/// A file mapped read-only into memory, so its contents are read straight from the page cache
+/// without being copied. Empty files map to an empty view.
+/// </summary>
+class mapped_file
+{
+public:
+    mapped_file() = default;
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    ~mapped_file() { close(); }
+
+    void open(const std::string& path, boost::system::error_code& ec)
+    {
+        close();
+        _file.open(path, ec);
+        if (ec || _file.size() == 0)
+            return;
+
+        const auto size = static_cast<std::size_t>(_file.size());
+#ifdef _WIN32
+        const auto handle = reinterpret_cast<HANDLE>(::_get_osfhandle(_file.native_handle()));
+        _mapping = ::CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* data = _mapping ? ::MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, size) : nullptr;
+        if (!data)
+        {
+            ec = boost::system::error_code(static_cast<int>(::GetLastError()), boost::system::system_category());
+            close();
+            return;
+        }
+#else
+        void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, _file.native_handle(), 0);
+        if (data == MAP_FAILED)
+        {
+            ec = boost::system::error_code(errno, boost::system::system_category());
+            close();
+            return;
+        }
+#endif
+        _data = std::string_view(static_cast<const char*>(data), size);
+    }
+
+    bool is_open() const { return _file.is_open(); }
+
+    std::string_view data() const { return _data; }
+
+    void close()
+    {
+        if (!_data.empty())
+        {
+#ifdef _WIN32
+            ::UnmapViewOfFile(_data.data());
+#else
+            ::munmap(const_cast<char*>(_data.data()), _data.size());
+#endif
+            _data = {};
+        }
+#ifdef _WIN32
+        if (_mapping)
+        {
+            ::CloseHandle(_mapping);
+            _mapping = nullptr;
+        }
+#endif
+        _file.close();
+    }
+
+private:
+    file_source _file;
+    std::string_view _data;
+#ifdef _WIN32
+    HANDLE _mapping = nullptr;
+#endif
+};
+
+#ifdef RESTPP_HAS_SENDFILE
+/// <summary>
+/// Sends part of a file over a plain TCP socket with <c>sendfile</c>, so the data goes from
+/// the page cache to the socket without being copied through user space. Completes with
+/// <c>void(boost::system::error_code, std::size_t)</c>.
+/// </summary>
+class sendfile_op : boost::asio::coroutine
+{
+public:
+    sendfile_op(boost::asio::ip::tcp::socket& socket, const file_source& file, std::uint64_t offset, std::uint64_t count)
+        : _socket(socket), _fd(file.native_handle()), _offset(static_cast<off_t>(offset)), _remaining(count)
+    {
+    }
+
+    template<typename Self>
+    void operator()(Self& self, boost::system::error_code ec = {})
+    {
+        BOOST_ASIO_CORO_REENTER(*this)
+        {
+            _socket.non_blocking(true, ec);
+            while (!ec && _remaining != 0)
+            {
+                // Waiting first also keeps the operation from completing inside its initiation
+                BOOST_ASIO_CORO_YIELD _socket.async_wait(boost::asio::ip::tcp::socket::wait_write, std::move(self));
+                while (!ec && _remaining != 0)
+                {
+                    const std::size_t count = _remaining < max_count ? static_cast<std::size_t>(_remaining) : max_count;
+                    const auto n = ::sendfile(_socket.native_handle(), _fd, &_offset, count);
+                    if (n > 0)
+                    {
+                        _remaining -= static_cast<std::uint64_t>(n);
+                        _sent += static_cast<std::size_t>(n);
+                    }
+                    else if (n == 0)
+                        ec = boost::asio::error::eof;
+                    else if (errno == EAGAIN || errno == EWOULDBLOCK)
+                        break;
+                    else if (errno != EINTR)
+                        ec = boost::system::error_code(errno, boost::system::system_category());
+                }
+            }
+            boost::system::error_code ignored;
+            _socket.non_blocking(false, ignored);
+            self.complete(ec, _sent);
+        }
+    }
+
+private:
+    static constexpr std::size_t max_count = 1u << 30;
+
+    boost::asio::ip::tcp::socket& _socket;
+    int _fd;
+    off_t _offset;
+    std::uint64_t _remaining;
+    std::size_t _sent = 0;
+};
+
+template<typename CompletionToken>
+auto async_sendfile(boost::asio::ip::tcp::socket& socket,
+                    const file_source& file,
+                    std::uint64_t offset,
+                    std::uint64_t count,
+                    CompletionToken&& token)
+{
+    return boost::asio::async_compose<CompletionToken, void(boost::system::error_code, std::size_t)>(
+        sendfile_op(socket, file, offset, count), token, socket);
+}
+#endif
+
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_FILE_SOURCE_HPP
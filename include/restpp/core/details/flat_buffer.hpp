@@ -0,0 +1,105 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Contiguous receive buffer used by connections.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_FLAT_BUFFER_HPP
+#define RESTPP_FLAT_BUFFER_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+#include <boost/asio/buffer.hpp>
+
+namespace restpp
+{
+namespace details
+{
+/// <summary>
+/// A single contiguous region of readable bytes followed by writable space. Unlike a
+/// streambuf, the readable bytes are always one span, so parsers can hand out views into it.
+/// Views stay valid until the next call to <c>prepare</c>.
+/// </summary>
+class flat_buffer
+{
+public:
+    flat_buffer() = default;
+
+    flat_buffer(const flat_buffer&) = delete;
+    flat_buffer& operator=(const flat_buffer&) = delete;
+
+    const char* data() const { return _storage.get() + _begin; }
+
+    std::size_t size() const { return _end - _begin; }
+
+    std::size_t capacity() const { return _capacity; }
+
+    /// <summary>
+    /// Returns at least <c>n</c> bytes of writable space after the readable bytes. Consumed
+    /// space at the front is reclaimed before the storage grows.
+    /// </summary>
+    boost::asio::mutable_buffer prepare(std::size_t n)
+    {
+        if (_capacity - _end < n)
+        {
+            const std::size_t readable = size();
+            if (_capacity - readable >= n)
+            {
+                std::memmove(_storage.get(), data(), readable);
+            }
+            else
+            {
+                std::size_t capacity = _capacity == 0 ? 4096 : _capacity;
+                while (capacity - readable < n)
+                    capacity *= 2;
+
+                std::unique_ptr<char[]> storage(new char[capacity]);
+                if (readable != 0)
+                    std::memcpy(storage.get(), data(), readable);
+                _storage = std::move(storage);
+                _capacity = capacity;
+            }
+            _begin = 0;
+            _end = readable;
+        }
+        return boost::asio::mutable_buffer(_storage.get() + _end, n);
+    }
+
+    /// <summary>
+    /// Moves <c>n</c> bytes of the prepared space into the readable bytes.
+    /// </summary>
+    void commit(std::size_t n) { _end += n; }
+
+    /// <summary>
+    /// Removes <c>n</c> bytes from the front of the readable bytes.
+    /// </summary>
+    void consume(std::size_t n)
+    {
+        _begin += n < size() ? n : size();
+        if (_begin == _end)
+            _begin = _end = 0;
+    }
+
+    void clear() { _begin = _end = 0; }
+
+private:
+    std::unique_ptr<char[]> _storage;
+    std::size_t _capacity = 0;
+    std::size_t _begin = 0;
+    std::size_t _end = 0;
+};
+
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_FLAT_BUFFER_HPP
@@ -0,0 +1,1174 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * HTTP/2 connections (RFC 9113) multiplexing the requests of a client as streams.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_H2_SESSION_HPP
+#define RESTPP_H2_SESSION_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include <restpp/core/error.hpp>
+#include <restpp/core/headers.hpp>
+#include <restpp/core/details/connection_pool.hpp>
+#include <restpp/core/details/hpack.hpp>
+
+namespace restpp
+{
+namespace details
+{
+namespace h2
+{
+enum frame_type : std::uint8_t
+{
+    data_frame = 0x0,
+    headers_frame = 0x1,
+    priority_frame = 0x2,
+    rst_stream_frame = 0x3,
+    settings_frame = 0x4,
+    push_promise_frame = 0x5,
+    ping_frame = 0x6,
+    goaway_frame = 0x7,
+    window_update_frame = 0x8,
+    continuation_frame = 0x9
+};
+
+enum frame_flags : std::uint8_t
+{
+    end_stream_flag = 0x1,
+    ack_flag = 0x1,
+    end_headers_flag = 0x4,
+    padded_flag = 0x8,
+    priority_flag = 0x20
+};
+
+enum settings_id : std::uint16_t
+{
+    header_table_size = 0x1,
+    enable_push = 0x2,
+    max_concurrent_streams = 0x3,
+    initial_window_size = 0x4,
+    max_frame_size = 0x5,
+    max_header_list_size = 0x6
+};
+
+enum error_code : std::uint32_t
+{
+    no_error = 0x0,
+    protocol_error = 0x1,
+    flow_control_error = 0x3,
+    frame_size_error = 0x6,
+    refused_stream = 0x7,
+    cancel = 0x8,
+    compression_error = 0x9
+};
+
+constexpr std::string_view client_preface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+constexpr std::size_t frame_header_size = 9;
+constexpr std::size_t default_max_frame_size = 16384;
+constexpr std::int64_t default_window_size = 65535;
+constexpr std::int64_t max_window_size = 0x7FFFFFFF;
+
+/// <summary>
+/// Receive window granted to the whole connection; streams are bounded by their own window.
+/// </summary>
+constexpr std::int64_t connection_window_size = 16 * 1024 * 1024;
+
+/// <summary>
+/// Largest response header block accepted, across CONTINUATION frames.
+/// </summary>
+constexpr std::size_t max_header_block_size = 256 * 1024;
+
+inline std::uint32_t read_u32(const std::uint8_t* p)
+{
+    return (std::uint32_t(p[0]) << 24) | (std::uint32_t(p[1]) << 16) | (std::uint32_t(p[2]) << 8) | std::uint32_t(p[3]);
+}
+
+inline void append_u32(std::string& out, std::uint32_t value)
+{
+    const char bytes[4] = {static_cast<char>(value >> 24), static_cast<char>(value >> 16), static_cast<char>(value >> 8),
+                           static_cast<char>(value)};
+    out.append(bytes, 4);
+}
+
+inline void append_frame_header(std::string& out, std::size_t length, frame_type type, std::uint8_t flags, std::uint32_t stream)
+{
+    const char header[5] = {static_cast<char>(length >> 16), static_cast<char>(length >> 8), static_cast<char>(length),
+                            static_cast<char>(type), static_cast<char>(flags)};
+    out.append(header, 5);
+    append_u32(out, stream & 0x7FFFFFFF);
+}
+
+/// <summary>
+/// The status code a :status pseudo-header carries, which must be exactly three digits
+/// (RFC 9113, section 8.3.2). -1 for any other value.
+/// </summary>
+inline int parse_status(std::string_view value)
+{
+    if (value.size() != 3)
+        return -1;
+    int status = 0;
+    for (char c : value)
+    {
+        if (c < '0' || c > '9')
+            return -1;
+        status = status * 10 + (c - '0');
+    }
+    return status;
+}
+} // namespace h2
+
+/// <summary>
+/// What an HTTP/2 stream hands to the operation waiting on it: everything that arrived since
+/// the previous wait.
+/// </summary>
+struct h2_event
+{
+    /// The final response head arrived; <c>status</c> and <c>headers</c> are set.
+    bool head = false;
+    int status = 0;
+    restpp::headers headers;
+
+    std::string data;
+
+    /// The response is complete; <c>trailers</c> holds the trailing fields, if any.
+    bool end = false;
+    restpp::headers trailers;
+
+    boost::system::error_code ec;
+};
+
+/// <summary>
+/// One request/response exchange on an HTTP/2 connection. Only touched on the strand of its
+/// session once submitted.
+/// </summary>
+struct h2_stream
+{
+    using field_list = std::vector<std::pair<std::string, std::string>>;
+
+    h2_stream(field_list fields, bool has_body) : request_fields(std::move(fields)), has_body(has_body) {}
+
+    std::uint32_t id = 0;
+    field_list request_fields;
+    bool has_body;
+
+    // Request body handed to the session and not yet framed, and who to tell once it was
+    std::string send_data;
+    bool send_last = false;
+    bool local_closed = false;
+    std::function<void(boost::system::error_code)> send_done;
+
+    int status = 0;
+    restpp::headers headers;
+    restpp::headers trailers;
+    bool head_ready = false;
+    bool head_delivered = false;
+    std::string data;
+    bool remote_closed = false;
+    boost::system::error_code ec;
+
+    std::int64_t send_window = h2::default_window_size;
+    std::int64_t recv_window = 0;
+    std::int64_t recv_unacked = 0;
+    bool finished = false;
+
+    h2_event* out = nullptr;
+    std::function<void()> waiter;
+};
+
+/// <summary>
+/// An HTTP/2 connection shared by any number of concurrent fetches, each running as a stream.
+///
+/// All state lives on a strand: TLS streams may not be read and written from two threads at
+/// once, and frames must be processed in order. Fetches submit their stream and then wait for
+/// events; the session resumes them on the I/O context once something arrived.
+///
+/// A session only keeps a read pending while it has streams in flight, so an idle session does
+/// not keep <c>io_context::run()</c> from returning. Frames the server sends meanwhile are read
+/// with the next request.
+/// </summary>
+class h2_session : public std::enable_shared_from_this<h2_session>
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    h2_session(boost::asio::io_context& io_context,
+               std::unique_ptr<connection> conn,
+               std::int64_t stream_window = 256 * 1024)
+        : _io_context(io_context)
+        , _strand(boost::asio::make_strand(io_context))
+        , _conn(std::move(conn))
+        , _stream_window(stream_window)
+        , _idle_since(clock::now().time_since_epoch().count())
+    {
+    }
+
+    h2_session(const h2_session&) = delete;
+    h2_session& operator=(const h2_session&) = delete;
+
+    /// <summary>
+    /// Sends the connection preface and our settings. Must be called once, right after the
+    /// session was created.
+    /// </summary>
+    void start()
+    {
+        boost::asio::dispatch(_strand, [self = shared_from_this()] {
+            std::string& out = self->_outbox;
+            out.append(h2::client_preface);
+
+            std::string settings;
+            append_setting(settings, h2::enable_push, 0);
+            append_setting(settings, h2::initial_window_size, static_cast<std::uint32_t>(self->_stream_window));
+            h2::append_frame_header(out, settings.size(), h2::settings_frame, 0, 0);
+            out.append(settings);
+
+            self->queue_window_update(0, h2::connection_window_size - h2::default_window_size);
+            self->flush();
+            self->read();
+        });
+    }
+
+    /// <summary>
+    /// Reserves room for one more stream. Called by the pool from any thread.
+    /// </summary>
+    bool try_reserve()
+    {
+        std::size_t load = _load.load();
+        do
+        {
+            if (!_usable.load() || load >= _peer_max_concurrent.load())
+                return false;
+        } while (!_load.compare_exchange_weak(load, load + 1));
+        return true;
+    }
+
+    /// <summary>
+    /// Whether new streams may be opened: the connection is up and the server did not send
+    /// GOAWAY.
+    /// </summary>
+    bool usable() const { return _usable.load(); }
+
+    /// <summary>
+    /// Number of streams reserved and not yet finished.
+    /// </summary>
+    std::size_t load() const { return _load.load(); }
+
+    clock::time_point idle_since() const { return clock::time_point(clock::duration(_idle_since.load())); }
+
+    bool tls_resumed() const { return _conn->tls_resumed(); }
+
+    /// <summary>
+    /// Opens a stream for a request, using a slot taken with try_reserve. The HEADERS frame is
+    /// sent as soon as the server's concurrency limit allows. A request with a body is then
+    /// sent with async_send.
+    /// </summary>
+    std::shared_ptr<h2_stream> open(h2_stream::field_list fields, bool has_body)
+    {
+        auto stream = std::make_shared<h2_stream>(std::move(fields), has_body);
+        boost::asio::dispatch(_strand, [self = shared_from_this(), stream] { self->submit(stream); });
+        return stream;
+    }
+
+    /// <summary>
+    /// Sends the next piece of the request body, the last one when <c>last</c> is set. <c>done</c>
+    /// is posted to the I/O context once the piece was framed, which may wait on the flow control
+    /// windows the server grants. Only one piece may be in flight at a time.
+    /// </summary>
+    void async_send(const std::shared_ptr<h2_stream>& stream,
+                    std::string data,
+                    bool last,
+                    std::function<void(boost::system::error_code)> done)
+    {
+        boost::asio::dispatch(_strand,
+                              [self = shared_from_this(), stream, data = std::move(data), last, done = std::move(done)]() mutable {
+                                  if (stream->finished)
+                                  {
+                                      const auto ec = stream->ec ? stream->ec : boost::system::error_code();
+                                      boost::asio::post(self->_io_context, [done = std::move(done), ec] { done(ec); });
+                                      return;
+                                  }
+                                  stream->send_data = std::move(data);
+                                  stream->send_last = last;
+                                  stream->send_done = std::move(done);
+                                  self->send_data(*stream);
+                                  self->flush();
+                              });
+    }
+
+    /// <summary>
+    /// Waits for events on the stream. <c>resume</c> is posted to the I/O context once
+    /// <c>out</c> was filled.
+    /// </summary>
+    void async_wait(const std::shared_ptr<h2_stream>& stream, h2_event& out, std::function<void()> resume)
+    {
+        boost::asio::dispatch(_strand, [self = shared_from_this(), stream, &out, resume = std::move(resume)]() mutable {
+            stream->out = &out;
+            stream->waiter = std::move(resume);
+            self->deliver(*stream);
+        });
+    }
+
+    /// <summary>
+    /// Abandons a stream, resetting it if the response is still arriving.
+    /// </summary>
+    void cancel(const std::shared_ptr<h2_stream>& stream)
+    {
+        boost::asio::dispatch(_strand, [self = shared_from_this(), stream] {
+            if (stream->finished)
+                return;
+            if (stream->id != 0)
+            {
+                self->queue_rst_stream(stream->id, h2::cancel);
+                self->flush();
+            }
+            stream->ec = boost::asio::error::operation_aborted;
+            self->finish(*stream);
+        });
+    }
+
+    /// <summary>
+    /// Closes the connection, failing the streams still in flight.
+    /// </summary>
+    void close()
+    {
+        _usable = false;
+        boost::asio::dispatch(_strand, [self = shared_from_this()] { self->fail(boost::asio::error::operation_aborted); });
+    }
+
+private:
+    static void append_setting(std::string& out, h2::settings_id id, std::uint32_t value)
+    {
+        out.push_back(static_cast<char>(id >> 8));
+        out.push_back(static_cast<char>(id));
+        h2::append_u32(out, value);
+    }
+
+    void submit(const std::shared_ptr<h2_stream>& stream)
+    {
+        if (_closed || _draining)
+        {
+            stream->ec = error::stream_refused;
+            finish(*stream);
+            return;
+        }
+
+        if (_streams.size() >= _peer_max_concurrent.load())
+            _queued.push_back(stream);
+        else
+            send_headers(stream);
+        flush();
+        read();
+    }
+
+    void send_headers(const std::shared_ptr<h2_stream>& stream)
+    {
+        if (_next_stream_id > 0x7FFFFFFF)
+        {
+            // Stream identifiers are exhausted; the next request goes to a new connection
+            _draining = true;
+            _usable = false;
+            stream->ec = error::stream_refused;
+            finish(*stream);
+            return;
+        }
+
+        stream->id = _next_stream_id;
+        _next_stream_id += 2;
+        stream->send_window = _peer_initial_window;
+        stream->recv_window = _stream_window;
+        _streams.emplace(stream->id, stream);
+
+        std::string block;
+        _encoder.begin_block(block);
+        for (const auto& field : stream->request_fields)
+            _encoder.encode(block, field.first, field.second);
+        stream->request_fields.clear();
+
+        // The block goes out as HEADERS followed by as many CONTINUATION frames as needed
+        std::string_view rest(block);
+        const std::size_t max_frame = _peer_max_frame_size;
+        std::uint8_t flags = stream->has_body ? 0 : h2::end_stream_flag;
+        h2::frame_type type = h2::headers_frame;
+        do
+        {
+            const std::size_t size = rest.size() < max_frame ? rest.size() : max_frame;
+            if (size == rest.size())
+                flags |= h2::end_headers_flag;
+            h2::append_frame_header(_outbox, size, type, flags, stream->id);
+            _outbox.append(rest.substr(0, size));
+            rest.remove_prefix(size);
+            type = h2::continuation_frame;
+            flags = 0;
+        } while (!rest.empty());
+
+        stream->local_closed = !stream->has_body;
+        send_data(*stream);
+    }
+
+    /// <summary>
+    /// Frames as much of the pending body of a stream as the flow control windows allow, and
+    /// lets the fetch know once all of it went out.
+    /// </summary>
+    void send_data(h2_stream& stream)
+    {
+        if (stream.id == 0 || !stream.send_done)
+            return;
+
+        std::string_view rest(stream.send_data);
+        while (!rest.empty() || (stream.send_last && !stream.local_closed))
+        {
+            std::int64_t size = static_cast<std::int64_t>(rest.size());
+            size = std::min(size, std::min(stream.send_window, _send_window));
+            size = std::min(size, static_cast<std::int64_t>(_peer_max_frame_size));
+            if (size <= 0 && !rest.empty())
+                break;
+
+            const bool end = stream.send_last && static_cast<std::size_t>(size) == rest.size();
+            h2::append_frame_header(_outbox, static_cast<std::size_t>(size), h2::data_frame, end ? h2::end_stream_flag : 0, stream.id);
+            _outbox.append(rest.substr(0, static_cast<std::size_t>(size)));
+            rest.remove_prefix(static_cast<std::size_t>(size));
+            stream.send_window -= size;
+            _send_window -= size;
+            stream.local_closed = end;
+        }
+        stream.send_data.erase(0, stream.send_data.size() - rest.size());
+
+        if (stream.send_data.empty())
+            complete_send(stream, {});
+    }
+
+    void complete_send(h2_stream& stream, const boost::system::error_code& ec)
+    {
+        if (!stream.send_done)
+            return;
+        boost::asio::post(_io_context, [done = std::move(stream.send_done), ec] { done(ec); });
+        stream.send_done = nullptr;
+    }
+
+    /// <summary>
+    /// Resumes the streams whose body was waiting on the connection window.
+    /// </summary>
+    void send_blocked_data()
+    {
+        for (auto& entry : _streams)
+        {
+            if (_send_window <= 0)
+                break;
+            send_data(*entry.second);
+        }
+    }
+
+    /// <summary>
+    /// Hands whatever arrived on the stream to its waiter, if there is one and there is news.
+    /// </summary>
+    void deliver(h2_stream& stream)
+    {
+        if (!stream.waiter)
+            return;
+
+        const bool head = stream.head_ready && !stream.head_delivered;
+        const bool end = stream.remote_closed || stream.ec;
+        if (!head && stream.data.empty() && !end)
+            return;
+
+        h2_event& out = *stream.out;
+        out = h2_event{};
+        if (head)
+        {
+            out.head = true;
+            out.status = stream.status;
+            out.headers = std::move(stream.headers);
+            stream.head_delivered = true;
+        }
+        out.data.swap(stream.data);
+        out.ec = stream.ec;
+        out.end = stream.remote_closed && !stream.ec;
+        if (out.end)
+            out.trailers = std::move(stream.trailers);
+
+        // The data now belongs to the fetch, so the server may send more
+        if (!stream.finished && !out.data.empty())
+        {
+            stream.recv_unacked += static_cast<std::int64_t>(out.data.size());
+            if (stream.recv_unacked >= _stream_window / 2)
+            {
+                queue_window_update(stream.id, stream.recv_unacked);
+                stream.recv_window += stream.recv_unacked;
+                stream.recv_unacked = 0;
+                flush();
+            }
+        }
+
+        stream.out = nullptr;
+        boost::asio::post(_io_context, std::move(stream.waiter));
+        stream.waiter = nullptr;
+    }
+
+    /// <summary>
+    /// Releases the slot of a stream that is done, one way or another.
+    /// </summary>
+    void finish(h2_stream& stream)
+    {
+        if (stream.finished)
+            return;
+        stream.finished = true;
+
+        // The fetch may have given up on the stream, leaving the map as its last owner
+        std::shared_ptr<h2_stream> hold;
+        auto it = _streams.find(stream.id);
+        if (it != _streams.end() && it->second.get() == &stream)
+        {
+            hold = std::move(it->second);
+            _streams.erase(it);
+        }
+
+        // The server may answer before it received the whole body, which then is not needed
+        if (stream.id != 0 && !stream.local_closed && !stream.ec && !_closed)
+            queue_rst_stream(stream.id, h2::no_error);
+        stream.send_data.clear();
+        complete_send(stream, stream.ec);
+
+        if (--_load == 0)
+            _idle_since = clock::now().time_since_epoch().count();
+
+        while (!_queued.empty() && _streams.size() < _peer_max_concurrent.load() && !_closed)
+        {
+            auto next = std::move(_queued.front());
+            _queued.pop_front();
+            if (!next->finished)
+                send_headers(next);
+        }
+        flush();
+        deliver(stream);
+
+        if (_draining && _streams.empty() && _queued.empty() && !_closed)
+            fail(error::stream_refused);
+        else
+            park();
+    }
+
+    void fail(const boost::system::error_code& ec)
+    {
+        if (_closed)
+            return;
+        _closed = true;
+        _usable = false;
+
+        std::map<std::uint32_t, std::shared_ptr<h2_stream>> streams;
+        std::deque<std::shared_ptr<h2_stream>> queued;
+        streams.swap(_streams);
+        queued.swap(_queued);
+        for (auto& entry : streams)
+        {
+            if (!entry.second->ec && !entry.second->remote_closed)
+                entry.second->ec = ec;
+            finish(*entry.second);
+        }
+        for (auto& stream : queued)
+        {
+            stream->ec = ec;
+            finish(*stream);
+        }
+        _conn->close();
+    }
+
+    void read()
+    {
+        if (_reading || _closed)
+            return;
+        _reading = true;
+        _conn->async_read_some(
+            _conn->buffer().prepare(h2::default_max_frame_size + h2::frame_header_size),
+            boost::asio::bind_executor(_strand,
+                                       [self = shared_from_this()](const boost::system::error_code& ec, std::size_t n) {
+                                           self->on_read(ec, n);
+                                       }));
+    }
+
+    void on_read(const boost::system::error_code& ec, std::size_t bytes_transferred)
+    {
+        _reading = false;
+        _parking = false;
+        if (ec == boost::asio::error::operation_aborted && !_closed)
+        {
+            // Parked while idle; a stream may have been opened in the meantime
+            if (!_streams.empty() || !_queued.empty())
+                read();
+            return;
+        }
+        if (ec)
+            return fail(ec);
+
+        auto& buffer = _conn->buffer();
+        buffer.commit(bytes_transferred);
+        while (!_closed && buffer.size() >= h2::frame_header_size)
+        {
+            const auto* p = reinterpret_cast<const std::uint8_t*>(buffer.data());
+            const std::size_t length = (std::size_t(p[0]) << 16) | (std::size_t(p[1]) << 8) | p[2];
+            if (length > h2::default_max_frame_size)
+                return connection_error(h2::frame_size_error);
+            if (buffer.size() < h2::frame_header_size + length)
+                break;
+
+            const auto type = static_cast<h2::frame_type>(p[3]);
+            const std::uint8_t flags = p[4];
+            const std::uint32_t stream_id = h2::read_u32(p + 5) & 0x7FFFFFFF;
+            handle_frame(type, flags, stream_id, p + h2::frame_header_size, length);
+            buffer.consume(h2::frame_header_size + length);
+        }
+
+        if (_closed)
+            return;
+        flush();
+        if (!_streams.empty() || !_queued.empty() || _continuation_stream != 0)
+            read();
+    }
+
+    /// <summary>
+    /// Stops reading when no stream is in flight. The pending read is cancelled, which is only
+    /// safe for TLS while no write is in progress.
+    /// </summary>
+    void park()
+    {
+        if (_closed || !_reading || _parking || _writing || !_streams.empty() || !_queued.empty())
+            return;
+        _parking = true;
+        boost::system::error_code ignored;
+        _conn->socket().cancel(ignored);
+    }
+
+    void handle_frame(h2::frame_type type, std::uint8_t flags, std::uint32_t stream_id, const std::uint8_t* p, std::size_t length)
+    {
+        // Nothing may come between the frames of a header block
+        if (_continuation_stream != 0 && (type != h2::continuation_frame || stream_id != _continuation_stream))
+            return connection_error(h2::protocol_error);
+
+        switch (type)
+        {
+            case h2::data_frame: return on_data(flags, stream_id, p, length);
+            case h2::headers_frame: return on_headers(flags, stream_id, p, length);
+            case h2::continuation_frame: return on_continuation(flags, stream_id, p, length);
+            case h2::rst_stream_frame: return on_rst_stream(stream_id, p, length);
+            case h2::settings_frame: return on_settings(flags, stream_id, p, length);
+            case h2::ping_frame: return on_ping(flags, stream_id, p, length);
+            case h2::goaway_frame: return on_goaway(stream_id, p, length);
+            case h2::window_update_frame: return on_window_update(stream_id, p, length);
+            case h2::push_promise_frame:
+                // Push is disabled in our settings
+                return connection_error(h2::protocol_error);
+            default:
+                // PRIORITY and unknown frame types are ignored
+                return;
+        }
+    }
+
+    /// <summary>
+    /// Strips the padding of a DATA or HEADERS frame.
+    /// </summary>
+    bool remove_padding(std::uint8_t flags, const std::uint8_t*& p, std::size_t& length)
+    {
+        if (!(flags & h2::padded_flag))
+            return true;
+        if (length == 0 || p[0] >= length)
+        {
+            connection_error(h2::protocol_error);
+            return false;
+        }
+        length -= std::size_t(p[0]) + 1;
+        ++p;
+        return true;
+    }
+
+    h2_stream* find_stream(std::uint32_t id)
+    {
+        auto it = _streams.find(id);
+        return it == _streams.end() ? nullptr : it->second.get();
+    }
+
+    void on_data(std::uint8_t flags, std::uint32_t stream_id, const std::uint8_t* p, std::size_t length)
+    {
+        if (stream_id == 0)
+            return connection_error(h2::protocol_error);
+
+        // The whole frame counts against the connection window, whatever happens to it
+        _recv_unacked += static_cast<std::int64_t>(length);
+        if (_recv_unacked >= h2::connection_window_size / 2)
+        {
+            queue_window_update(0, _recv_unacked);
+            _recv_unacked = 0;
+        }
+
+        const std::size_t frame_length = length;
+        if (!remove_padding(flags, p, length))
+            return;
+
+        h2_stream* stream = find_stream(stream_id);
+        if (!stream)
+            return;
+        if (!stream->head_ready)
+            return stream_error(*stream, h2::protocol_error);
+
+        stream->recv_window -= static_cast<std::int64_t>(frame_length);
+        if (stream->recv_window < 0)
+            return stream_error(*stream, h2::flow_control_error);
+
+        // Padding is never handed out, so it is acknowledged right away
+        stream->recv_unacked += static_cast<std::int64_t>(frame_length - length);
+        stream->data.append(reinterpret_cast<const char*>(p), length);
+
+        if (flags & h2::end_stream_flag)
+        {
+            stream->remote_closed = true;
+            finish(*stream);
+        }
+        else
+        {
+            deliver(*stream);
+        }
+    }
+
+    void on_headers(std::uint8_t flags, std::uint32_t stream_id, const std::uint8_t* p, std::size_t length)
+    {
+        if (stream_id == 0)
+            return connection_error(h2::protocol_error);
+        if (!remove_padding(flags, p, length))
+            return;
+        if (flags & h2::priority_flag)
+        {
+            if (length < 5)
+                return connection_error(h2::frame_size_error);
+            p += 5;
+            length -= 5;
+        }
+
+        _header_block.assign(reinterpret_cast<const char*>(p), length);
+        _header_end_stream = (flags & h2::end_stream_flag) != 0;
+        if (flags & h2::end_headers_flag)
+            return on_header_block(stream_id);
+        _continuation_stream = stream_id;
+    }
+
+    void on_continuation(std::uint8_t flags, std::uint32_t stream_id, const std::uint8_t* p, std::size_t length)
+    {
+        if (_continuation_stream == 0 || stream_id != _continuation_stream)
+            return connection_error(h2::protocol_error);
+        if (_header_block.size() + length > h2::max_header_block_size)
+            return connection_error(h2::protocol_error);
+
+        _header_block.append(reinterpret_cast<const char*>(p), length);
+        if (flags & h2::end_headers_flag)
+        {
+            _continuation_stream = 0;
+            on_header_block(stream_id);
+        }
+    }
+
+    void on_header_block(std::uint32_t stream_id)
+    {
+        h2_stream* stream = find_stream(stream_id);
+
+        // The block is decoded even for a stream we no longer track, to keep the table in sync
+        int status = 0;
+        restpp::headers fields;
+        const bool ok = _decoder.decode(reinterpret_cast<const std::uint8_t*>(_header_block.data()),
+                                        _header_block.size(),
+                                        [&](std::string_view name, std::string_view value) {
+                                            if (name == ":status")
+                                            {
+                                                status = h2::parse_status(value);
+                                            }
+                                            else if (name.empty() || name.front() != ':')
+                                            {
+                                                fields.add(name, value);
+                                            }
+                                        });
+        if (!ok)
+            return connection_error(h2::compression_error);
+        if (!stream)
+            return;
+
+        if (!stream->head_ready)
+        {
+            if (status >= 100 && status < 200)
+            {
+                // Interim response, the final one follows
+                if (_header_end_stream)
+                    stream_error(*stream, h2::protocol_error);
+                return;
+            }
+            if (status < 200 || status > 999)
+                return stream_error(*stream, h2::protocol_error);
+
+            stream->status = status;
+            stream->headers = std::move(fields);
+            stream->head_ready = true;
+        }
+        else
+        {
+            // Trailers must end the stream
+            if (!_header_end_stream)
+                return stream_error(*stream, h2::protocol_error);
+            stream->trailers = std::move(fields);
+        }
+
+        if (_header_end_stream)
+        {
+            stream->remote_closed = true;
+            finish(*stream);
+        }
+        else
+        {
+            deliver(*stream);
+        }
+    }
+
+    void on_rst_stream(std::uint32_t stream_id, const std::uint8_t* p, std::size_t length)
+    {
+        if (length != 4)
+            return connection_error(h2::frame_size_error);
+        h2_stream* stream = find_stream(stream_id);
+        if (!stream)
+            return;
+
+        const std::uint32_t code = h2::read_u32(p);
+        stream->ec = code == h2::refused_stream ? error::stream_refused : error::stream_reset;
+        finish(*stream);
+    }
+
+    void on_settings(std::uint8_t flags, std::uint32_t stream_id, const std::uint8_t* p, std::size_t length)
+    {
+        if (stream_id != 0)
+            return connection_error(h2::protocol_error);
+        if (flags & h2::ack_flag)
+            return;
+        if (length % 6 != 0)
+            return connection_error(h2::frame_size_error);
+
+        for (std::size_t i = 0; i < length; i += 6)
+        {
+            const auto id = static_cast<std::uint16_t>((p[i] << 8) | p[i + 1]);
+            const std::uint32_t value = h2::read_u32(p + i + 2);
+            switch (id)
+            {
+                case h2::header_table_size: _encoder.set_peer_max_table_size(value); break;
+                case h2::max_concurrent_streams: _peer_max_concurrent = value; break;
+                case h2::initial_window_size:
+                {
+                    if (value > h2::max_window_size)
+                        return connection_error(h2::flow_control_error);
+                    const std::int64_t delta = static_cast<std::int64_t>(value) - _peer_initial_window;
+                    _peer_initial_window = value;
+                    for (auto& entry : _streams)
+                        entry.second->send_window += delta;
+                    send_blocked_data();
+                    break;
+                }
+                case h2::max_frame_size:
+                    if (value < h2::default_max_frame_size || value > 0xFFFFFF)
+                        return connection_error(h2::protocol_error);
+                    _peer_max_frame_size = value;
+                    break;
+                default: break;
+            }
+        }
+
+        h2::append_frame_header(_outbox, 0, h2::settings_frame, h2::ack_flag, 0);
+
+        // A higher concurrency limit lets queued streams go
+        while (!_queued.empty() && _streams.size() < _peer_max_concurrent.load())
+        {
+            auto next = std::move(_queued.front());
+            _queued.pop_front();
+            if (!next->finished)
+                send_headers(next);
+        }
+    }
+
+    void on_ping(std::uint8_t flags, std::uint32_t stream_id, const std::uint8_t* p, std::size_t length)
+    {
+        if (stream_id != 0)
+            return connection_error(h2::protocol_error);
+        if (length != 8)
+            return connection_error(h2::frame_size_error);
+        if (flags & h2::ack_flag)
+            return;
+
+        h2::append_frame_header(_outbox, 8, h2::ping_frame, h2::ack_flag, 0);
+        _outbox.append(reinterpret_cast<const char*>(p), 8);
+    }
+
+    void on_goaway(std::uint32_t stream_id, const std::uint8_t* p, std::size_t length)
+    {
+        if (stream_id != 0)
+            return connection_error(h2::protocol_error);
+        if (length < 8)
+            return connection_error(h2::frame_size_error);
+
+        // Streams above the last one the server processed never reached the application and
+        // can safely be retried elsewhere
+        const std::uint32_t last_stream_id = h2::read_u32(p) & 0x7FFFFFFF;
+        _draining = true;
+        _usable = false;
+
+        std::vector<std::shared_ptr<h2_stream>> refused;
+        for (auto& entry : _streams)
+        {
+            if (entry.first > last_stream_id)
+                refused.push_back(entry.second);
+        }
+        for (auto& stream : _queued)
+            refused.push_back(stream);
+        _queued.clear();
+
+        for (auto& stream : refused)
+        {
+            stream->ec = error::stream_refused;
+            finish(*stream);
+        }
+        if (_streams.empty())
+            fail(error::stream_refused);
+    }
+
+    void on_window_update(std::uint32_t stream_id, const std::uint8_t* p, std::size_t length)
+    {
+        if (length != 4)
+            return connection_error(h2::frame_size_error);
+        const std::int64_t increment = h2::read_u32(p) & 0x7FFFFFFF;
+
+        if (stream_id == 0)
+        {
+            _send_window += increment;
+            if (_send_window > h2::max_window_size)
+                return connection_error(h2::flow_control_error);
+            return send_blocked_data();
+        }
+
+        h2_stream* stream = find_stream(stream_id);
+        if (!stream)
+            return;
+        stream->send_window += increment;
+        if (stream->send_window > h2::max_window_size)
+            return stream_error(*stream, h2::flow_control_error);
+        send_data(*stream);
+    }
+
+    void stream_error(h2_stream& stream, h2::error_code code)
+    {
+        queue_rst_stream(stream.id, code);
+        stream.ec = error::http2_protocol_error;
+        finish(stream);
+    }
+
+    void connection_error(h2::error_code code)
+    {
+        std::string payload;
+        h2::append_u32(payload, _last_processed_stream);
+        h2::append_u32(payload, code);
+        h2::append_frame_header(_outbox, payload.size(), h2::goaway_frame, 0, 0);
+        _outbox.append(payload);
+        flush();
+        fail(error::http2_protocol_error);
+    }
+
+    void queue_rst_stream(std::uint32_t stream_id, h2::error_code code)
+    {
+        h2::append_frame_header(_outbox, 4, h2::rst_stream_frame, 0, stream_id);
+        h2::append_u32(_outbox, code);
+    }
+
+    void queue_window_update(std::uint32_t stream_id, std::int64_t increment)
+    {
+        h2::append_frame_header(_outbox, 4, h2::window_update_frame, 0, stream_id);
+        h2::append_u32(_outbox, static_cast<std::uint32_t>(increment));
+    }
+
+    /// <summary>
+    /// Writes whatever frames were queued, one write at a time.
+    /// </summary>
+    void flush()
+    {
+        if (_writing || _outbox.empty() || _closed)
+            return;
+        _writing = true;
+        _sending.swap(_outbox);
+        boost::asio::async_write(
+            *_conn,
+            boost::asio::buffer(_sending),
+            boost::asio::bind_executor(_strand, [self = shared_from_this()](const boost::system::error_code& ec, std::size_t) {
+                self->_writing = false;
+                self->_sending.clear();
+                if (ec)
+                    return self->fail(ec);
+                self->flush();
+                self->park();
+            }));
+    }
+
+    boost::asio::io_context& _io_context;
+    boost::asio::strand<boost::asio::io_context::executor_type> _strand;
+    std::unique_ptr<connection> _conn;
+    const std::int64_t _stream_window;
+
+    hpack::encoder _encoder;
+    hpack::decoder _decoder;
+
+    std::map<std::uint32_t, std::shared_ptr<h2_stream>> _streams;
+    std::deque<std::shared_ptr<h2_stream>> _queued;
+    std::uint32_t _next_stream_id = 1;
+    std::uint32_t _last_processed_stream = 0;
+
+    std::int64_t _peer_initial_window = h2::default_window_size;
+    std::size_t _peer_max_frame_size = h2::default_max_frame_size;
+    std::int64_t _send_window = h2::default_window_size;
+    std::int64_t _recv_unacked = 0;
+
+    std::string _header_block;
+    bool _header_end_stream = false;
+    std::uint32_t _continuation_stream = 0;
+
+    std::string _outbox;
+    std::string _sending;
+    bool _writing = false;
+    bool _reading = false;
+    bool _parking = false;
+    bool _closed = false;
+    bool _draining = false;
+
+    // Read from other threads by the pool
+    std::atomic<bool> _usable{true};
+    std::atomic<std::size_t> _load{0};
+    std::atomic<std::size_t> _peer_max_concurrent{100};
+    std::atomic<clock::rep> _idle_since;
+};
+
+/// <summary>
+/// The HTTP/2 sessions of a client, grouped by origin. A fetch joins the first session with
+/// room for another stream; sessions idle for longer than the idle timeout are closed.
+/// </summary>
+class h2_session_pool
+{
+public:
+    explicit h2_session_pool(h2_session::clock::duration idle_timeout) : _idle_timeout(idle_timeout) {}
+
+    h2_session_pool(const h2_session_pool&) = delete;
+    h2_session_pool& operator=(const h2_session_pool&) = delete;
+
+    ~h2_session_pool() { clear(); }
+
+    /// <summary>
+    /// Finds a session to the origin and reserves a stream on it.
+    /// </summary>
+    std::shared_ptr<h2_session> acquire(const connection_key& key)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _sessions.find(key);
+        if (it == _sessions.end())
+            return nullptr;
+
+        auto& sessions = it->second;
+        const auto now = h2_session::clock::now();
+        std::shared_ptr<h2_session> found;
+        for (auto s = sessions.begin(); s != sessions.end();)
+        {
+            auto& session = *s;
+            if (!session->usable() || (session->load() == 0 && now - session->idle_since() >= _idle_timeout))
+            {
+                session->close();
+                s = sessions.erase(s);
+                continue;
+            }
+            if (!found && session->try_reserve())
+                found = session;
+            ++s;
+        }
+        if (sessions.empty())
+            _sessions.erase(it);
+        return found;
+    }
+
+    void add(const connection_key& key, std::shared_ptr<h2_session> session)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _sessions[key].push_back(std::move(session));
+    }
+
+    /// <summary>
+    /// Closes every session, failing the streams still in flight on them.
+    /// </summary>
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& entry : _sessions)
+        {
+            for (auto& session : entry.second)
+                session->close();
+        }
+        _sessions.clear();
+    }
+
+    /// <summary>
+    /// Closes the sessions that have no stream in flight.
+    /// </summary>
+    void close_idle()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto it = _sessions.begin(); it != _sessions.end();)
+        {
+            auto& sessions = it->second;
+            for (auto s = sessions.begin(); s != sessions.end();)
+            {
+                if ((*s)->load() == 0 || !(*s)->usable())
+                {
+                    (*s)->close();
+                    s = sessions.erase(s);
+                }
+                else
+                {
+                    ++s;
+                }
+            }
+            it = sessions.empty() ? _sessions.erase(it) : std::next(it);
+        }
+    }
+
+    std::size_t session_count(const connection_key& key) const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _sessions.find(key);
+        return it == _sessions.end() ? 0 : it->second.size();
+    }
+
+private:
+    const h2_session::clock::duration _idle_timeout;
+    mutable std::mutex _mutex;
+    std::map<connection_key, std::vector<std::shared_ptr<h2_session>>> _sessions;
+};
+
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_H2_SESSION_HPP
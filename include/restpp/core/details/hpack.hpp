@@ -0,0 +1,633 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * HPACK header compression for HTTP/2 (RFC 7541).
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_HPACK_HPP
+#define RESTPP_HPACK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace restpp
+{
+namespace details
+{
+namespace hpack
+{
+struct static_entry
+{
+    std::string_view name;
+    std::string_view value;
+};
+
+/// <summary>
+/// The static table of RFC 7541 appendix A. Index 1 is the first entry.
+/// </summary>
+constexpr static_entry static_table[] = {
+    {":authority", ""},
+    {":method", "GET"},
+    {":method", "POST"},
+    {":path", "/"},
+    {":path", "/index.html"},
+    {":scheme", "http"},
+    {":scheme", "https"},
+    {":status", "200"},
+    {":status", "204"},
+    {":status", "206"},
+    {":status", "304"},
+    {":status", "400"},
+    {":status", "404"},
+    {":status", "500"},
+    {"accept-charset", ""},
+    {"accept-encoding", "gzip, deflate"},
+    {"accept-language", ""},
+    {"accept-ranges", ""},
+    {"accept", ""},
+    {"access-control-allow-origin", ""},
+    {"age", ""},
+    {"allow", ""},
+    {"authorization", ""},
+    {"cache-control", ""},
+    {"content-disposition", ""},
+    {"content-encoding", ""},
+    {"content-language", ""},
+    {"content-length", ""},
+    {"content-location", ""},
+    {"content-range", ""},
+    {"content-type", ""},
+    {"cookie", ""},
+    {"date", ""},
+    {"etag", ""},
+    {"expect", ""},
+    {"expires", ""},
+    {"from", ""},
+    {"host", ""},
+    {"if-match", ""},
+    {"if-modified-since", ""},
+    {"if-none-match", ""},
+    {"if-range", ""},
+    {"if-unmodified-since", ""},
+    {"last-modified", ""},
+    {"link", ""},
+    {"location", ""},
+    {"max-forwards", ""},
+    {"proxy-authenticate", ""},
+    {"proxy-authorization", ""},
+    {"range", ""},
+    {"referer", ""},
+    {"refresh", ""},
+    {"retry-after", ""},
+    {"server", ""},
+    {"set-cookie", ""},
+    {"strict-transport-security", ""},
+    {"transfer-encoding", ""},
+    {"user-agent", ""},
+    {"vary", ""},
+    {"via", ""},
+    {"www-authenticate", ""},
+};
+
+constexpr std::size_t static_table_size = sizeof(static_table) / sizeof(static_table[0]);
+
+/// <summary>
+/// Huffman code of every octet and of EOS (256), from RFC 7541 appendix B, right aligned.
+/// </summary>
+constexpr std::uint32_t huffman_codes[257] = {
+    0x1ff8, 0x7fffd8, 0xfffffe2, 0xfffffe3, 0xfffffe4, 0xfffffe5, 0xfffffe6, 0xfffffe7,
+    0xfffffe8, 0xffffea, 0x3ffffffc, 0xfffffe9, 0xfffffea, 0x3ffffffd, 0xfffffeb, 0xfffffec,
+    0xfffffed, 0xfffffee, 0xfffffef, 0xffffff0, 0xffffff1, 0xffffff2, 0x3ffffffe, 0xffffff3,
+    0xffffff4, 0xffffff5, 0xffffff6, 0xffffff7, 0xffffff8, 0xffffff9, 0xffffffa, 0xffffffb,
+    0x14, 0x3f8, 0x3f9, 0xffa, 0x1ff9, 0x15, 0xf8, 0x7fa,
+    0x3fa, 0x3fb, 0xf9, 0x7fb, 0xfa, 0x16, 0x17, 0x18,
+    0x0, 0x1, 0x2, 0x19, 0x1a, 0x1b, 0x1c, 0x1d,
+    0x1e, 0x1f, 0x5c, 0xfb, 0x7ffc, 0x20, 0xffb, 0x3fc,
+    0x1ffa, 0x21, 0x5d, 0x5e, 0x5f, 0x60, 0x61, 0x62,
+    0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a,
+    0x6b, 0x6c, 0x6d, 0x6e, 0x6f, 0x70, 0x71, 0x72,
+    0xfc, 0x73, 0xfd, 0x1ffb, 0x7fff0, 0x1ffc, 0x3ffc, 0x22,
+    0x7ffd, 0x3, 0x23, 0x4, 0x24, 0x5, 0x25, 0x26,
+    0x27, 0x6, 0x74, 0x75, 0x28, 0x29, 0x2a, 0x7,
+    0x2b, 0x76, 0x2c, 0x8, 0x9, 0x2d, 0x77, 0x78,
+    0x79, 0x7a, 0x7b, 0x7ffe, 0x7fc, 0x3ffd, 0x1ffd, 0xffffffc,
+    0xfffe6, 0x3fffd2, 0xfffe7, 0xfffe8, 0x3fffd3, 0x3fffd4, 0x3fffd5, 0x7fffd9,
+    0x3fffd6, 0x7fffda, 0x7fffdb, 0x7fffdc, 0x7fffdd, 0x7fffde, 0xffffeb, 0x7fffdf,
+    0xffffec, 0xffffed, 0x3fffd7, 0x7fffe0, 0xffffee, 0x7fffe1, 0x7fffe2, 0x7fffe3,
+    0x7fffe4, 0x1fffdc, 0x3fffd8, 0x7fffe5, 0x3fffd9, 0x7fffe6, 0x7fffe7, 0xffffef,
+    0x3fffda, 0x1fffdd, 0xfffe9, 0x3fffdb, 0x3fffdc, 0x7fffe8, 0x7fffe9, 0x1fffde,
+    0x7fffea, 0x3fffdd, 0x3fffde, 0xfffff0, 0x1fffdf, 0x3fffdf, 0x7fffeb, 0x7fffec,
+    0x1fffe0, 0x1fffe1, 0x3fffe0, 0x1fffe2, 0x7fffed, 0x3fffe1, 0x7fffee, 0x7fffef,
+    0xfffea, 0x3fffe2, 0x3fffe3, 0x3fffe4, 0x7ffff0, 0x3fffe5, 0x3fffe6, 0x7ffff1,
+    0x3ffffe0, 0x3ffffe1, 0xfffeb, 0x7fff1, 0x3fffe7, 0x7ffff2, 0x3fffe8, 0x1ffffec,
+    0x3ffffe2, 0x3ffffe3, 0x3ffffe4, 0x7ffffde, 0x7ffffdf, 0x3ffffe5, 0xfffff1, 0x1ffffed,
+    0x7fff2, 0x1fffe3, 0x3ffffe6, 0x7ffffe0, 0x7ffffe1, 0x3ffffe7, 0x7ffffe2, 0xfffff2,
+    0x1fffe4, 0x1fffe5, 0x3ffffe8, 0x3ffffe9, 0xffffffd, 0x7ffffe3, 0x7ffffe4, 0x7ffffe5,
+    0xfffec, 0xfffff3, 0xfffed, 0x1fffe6, 0x3fffe9, 0x1fffe7, 0x1fffe8, 0x7ffff3,
+    0x3fffea, 0x3fffeb, 0x1ffffee, 0x1ffffef, 0xfffff4, 0xfffff5, 0x3ffffea, 0x7ffff4,
+    0x3ffffeb, 0x7ffffe6, 0x3ffffec, 0x3ffffed, 0x7ffffe7, 0x7ffffe8, 0x7ffffe9, 0x7ffffea,
+    0x7ffffeb, 0xffffffe, 0x7ffffec, 0x7ffffed, 0x7ffffee, 0x7ffffef, 0x7fffff0, 0x3ffffee,
+    0x3fffffff,
+};
+
+constexpr std::uint8_t huffman_lengths[257] = {
+    13, 23, 28, 28, 28, 28, 28, 28, 28, 24, 30, 28, 28, 30, 28, 28,
+    28, 28, 28, 28, 28, 28, 30, 28, 28, 28, 28, 28, 28, 28, 28, 28,
+    6, 10, 10, 12, 13, 6, 8, 11, 10, 10, 8, 11, 8, 6, 6, 6,
+    5, 5, 5, 6, 6, 6, 6, 6, 6, 6, 7, 8, 15, 6, 12, 10,
+    13, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 8, 7, 8, 13, 19, 13, 14, 6,
+    15, 5, 6, 5, 6, 5, 6, 6, 6, 5, 7, 7, 6, 6, 6, 5,
+    6, 7, 6, 5, 5, 6, 7, 7, 7, 7, 7, 15, 11, 14, 13, 28,
+    20, 22, 20, 20, 22, 22, 22, 23, 22, 23, 23, 23, 23, 23, 24, 23,
+    24, 24, 22, 23, 24, 23, 23, 23, 23, 21, 22, 23, 22, 23, 23, 24,
+    22, 21, 20, 22, 22, 23, 23, 21, 23, 22, 22, 24, 21, 22, 23, 23,
+    21, 21, 22, 21, 23, 22, 23, 23, 20, 22, 22, 22, 23, 22, 22, 23,
+    26, 26, 20, 19, 22, 23, 22, 25, 26, 26, 26, 27, 27, 26, 24, 25,
+    19, 21, 26, 27, 27, 26, 27, 24, 21, 21, 26, 26, 28, 27, 27, 27,
+    20, 24, 20, 21, 22, 21, 21, 23, 22, 22, 25, 25, 24, 24, 26, 23,
+    26, 27, 26, 26, 27, 27, 27, 27, 27, 28, 27, 27, 27, 27, 27, 26,
+    30,
+};
+
+/// <summary>
+/// Binary decoding tree of the Huffman code, built at compile time. A positive child is the
+/// index of an inner node, a negative one the leaf of symbol <c>-child - 1</c>, and zero a
+/// code that does not exist.
+/// </summary>
+struct huffman_tree
+{
+    std::int16_t children[256][2] = {};
+};
+
+constexpr huffman_tree make_huffman_tree()
+{
+    huffman_tree tree;
+    int nodes = 1;
+    for (int symbol = 0; symbol < 257; ++symbol)
+    {
+        int node = 0;
+        for (int bit = huffman_lengths[symbol] - 1; bit >= 0; --bit)
+        {
+            const int branch = (huffman_codes[symbol] >> bit) & 1;
+            if (bit == 0)
+            {
+                tree.children[node][branch] = static_cast<std::int16_t>(-symbol - 1);
+                break;
+            }
+            if (tree.children[node][branch] == 0)
+                tree.children[node][branch] = static_cast<std::int16_t>(nodes++);
+            node = tree.children[node][branch];
+        }
+    }
+    return tree;
+}
+
+inline constexpr huffman_tree huffman_decoding_tree = make_huffman_tree();
+
+/// <summary>
+/// Decodes a Huffman encoded string, appending it to <c>out</c>.
+/// </summary>
+/// <returns>False if the input is not valid Huffman code or is not padded as required.</returns>
+inline bool huffman_decode(const std::uint8_t* data, std::size_t size, std::string& out)
+{
+    int node = 0;
+    int pending_bits = 0;
+    bool pending_ones = true;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        for (int bit = 7; bit >= 0; --bit)
+        {
+            const int branch = (data[i] >> bit) & 1;
+            const int next = huffman_decoding_tree.children[node][branch];
+            ++pending_bits;
+            pending_ones = pending_ones && branch == 1;
+            if (next < 0)
+            {
+                if (next == -257)
+                    return false;
+                out.push_back(static_cast<char>(-next - 1));
+                node = 0;
+                pending_bits = 0;
+                pending_ones = true;
+            }
+            else if (next == 0)
+            {
+                return false;
+            }
+            else
+            {
+                node = next;
+            }
+        }
+    }
+
+    // Whatever is left must be a prefix of EOS, shorter than an octet
+    return pending_bits < 8 && pending_ones;
+}
+
+inline std::size_t huffman_encoded_size(std::string_view text)
+{
+    std::size_t bits = 0;
+    for (char c : text)
+        bits += huffman_lengths[static_cast<unsigned char>(c)];
+    return (bits + 7) / 8;
+}
+
+inline void huffman_encode(std::string_view text, std::string& out)
+{
+    std::uint64_t bits = 0;
+    int count = 0;
+    for (char c : text)
+    {
+        const auto symbol = static_cast<unsigned char>(c);
+        bits = (bits << huffman_lengths[symbol]) | huffman_codes[symbol];
+        count += huffman_lengths[symbol];
+        while (count >= 8)
+        {
+            count -= 8;
+            out.push_back(static_cast<char>(bits >> count));
+        }
+    }
+
+    // Pad with the most significant bits of EOS, which are all ones
+    if (count > 0)
+        out.push_back(static_cast<char>((bits << (8 - count)) | (0xFFu >> count)));
+}
+
+/// <summary>
+/// Appends an integer with an N-bit prefix. <c>flags</c> holds the bits of the first octet
+/// above the prefix.
+/// </summary>
+inline void encode_integer(std::string& out, std::uint8_t flags, int prefix_bits, std::uint64_t value)
+{
+    const std::uint64_t limit = (1u << prefix_bits) - 1;
+    if (value < limit)
+    {
+        out.push_back(static_cast<char>(flags | value));
+        return;
+    }
+
+    out.push_back(static_cast<char>(flags | limit));
+    value -= limit;
+    while (value >= 128)
+    {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+/// <summary>
+/// Reads an integer with an N-bit prefix, advancing <c>p</c> past it. Values that do not fit
+/// in 32 bits are rejected, and so are encodings padded with more continuation octets than a
+/// 32-bit value needs.
+/// </summary>
+inline bool decode_integer(const std::uint8_t*& p, const std::uint8_t* end, int prefix_bits, std::uint64_t& value)
+{
+    if (p == end)
+        return false;
+
+    const std::uint64_t limit = (1u << prefix_bits) - 1;
+    value = *p++ & limit;
+    if (value < limit)
+        return true;
+
+    for (int shift = 0; p != end; shift += 7)
+    {
+        if (shift > 28)
+            return false;
+        const std::uint8_t octet = *p++;
+        value += static_cast<std::uint64_t>(octet & 0x7F) << shift;
+        if (value > 0xFFFFFFFFu)
+            return false;
+        if ((octet & 0x80) == 0)
+            return true;
+    }
+    return false;
+}
+
+inline void encode_string(std::string& out, std::string_view text)
+{
+    const std::size_t huffman_size = huffman_encoded_size(text);
+    if (huffman_size < text.size())
+    {
+        encode_integer(out, 0x80, 7, huffman_size);
+        huffman_encode(text, out);
+    }
+    else
+    {
+        encode_integer(out, 0x00, 7, text.size());
+        out.append(text);
+    }
+}
+
+/// <summary>
+/// The dynamic table shared by an encoder and the decoder at the other end. The most recent
+/// entry comes first, right after the static table.
+/// </summary>
+class dynamic_table
+{
+public:
+    using entry = std::pair<std::string, std::string>;
+
+    /// <summary>
+    /// Size of an entry as defined by RFC 7541 section 4.1.
+    /// </summary>
+    static std::size_t entry_size(std::string_view name, std::string_view value) { return name.size() + value.size() + 32; }
+
+    explicit dynamic_table(std::size_t max_size) : _max_size(max_size) {}
+
+    void add(std::string name, std::string value)
+    {
+        const std::size_t size = entry_size(name, value);
+        if (size > _max_size)
+        {
+            // An entry larger than the table empties it and is not added
+            _entries.clear();
+            _size = 0;
+            return;
+        }
+
+        evict(_max_size - size);
+        _entries.emplace_front(std::move(name), std::move(value));
+        _size += size;
+    }
+
+    void resize(std::size_t max_size)
+    {
+        _max_size = max_size;
+        evict(max_size);
+    }
+
+    /// <summary>
+    /// Entry at the given index of the combined index space, or nullptr.
+    /// </summary>
+    const entry* at(std::size_t index) const
+    {
+        index -= static_table_size + 1;
+        return index < _entries.size() ? &_entries[index] : nullptr;
+    }
+
+    std::size_t count() const { return _entries.size(); }
+
+    std::size_t size() const { return _size; }
+
+    std::size_t max_size() const { return _max_size; }
+
+private:
+    void evict(std::size_t keep)
+    {
+        while (_size > keep && !_entries.empty())
+        {
+            _size -= entry_size(_entries.back().first, _entries.back().second);
+            _entries.pop_back();
+        }
+    }
+
+    std::deque<entry> _entries;
+    std::size_t _size = 0;
+    std::size_t _max_size;
+};
+
+/// <summary>
+/// Decodes the header blocks received on one HTTP/2 connection, in order.
+/// </summary>
+class decoder
+{
+public:
+    /// <summary>
+    /// <c>max_table_size</c> is the SETTINGS_HEADER_TABLE_SIZE we advertised.
+    /// </summary>
+    explicit decoder(std::size_t max_table_size = 4096) : _table(max_table_size), _max_table_size(max_table_size) {}
+
+    /// <summary>
+    /// Decodes a complete header block, calling <c>on_field(name, value)</c> for every field.
+    /// The views are only valid during the call.
+    /// </summary>
+    /// <returns>False on a compression error, which is fatal to the connection.</returns>
+    template<typename OnField>
+    bool decode(const std::uint8_t* p, std::size_t size, OnField&& on_field)
+    {
+        const std::uint8_t* const end = p + size;
+        bool field_seen = false;
+        while (p != end)
+        {
+            const std::uint8_t first = *p;
+            std::uint64_t index = 0;
+
+            if (first & 0x80)
+            {
+                // Indexed header field
+                if (!decode_integer(p, end, 7, index) || !lookup(index, _name, _value))
+                    return false;
+                field_seen = true;
+                on_field(std::string_view(_name), std::string_view(_value));
+                continue;
+            }
+
+            if ((first & 0xE0) == 0x20)
+            {
+                // Dynamic table size update, only allowed before the first field (RFC 7541, section 4.2)
+                if (field_seen || !decode_integer(p, end, 5, index) || index > _max_table_size)
+                    return false;
+                _table.resize(static_cast<std::size_t>(index));
+                continue;
+            }
+
+            // Literal header field, with incremental indexing (6-bit prefix) or without (4-bit)
+            const bool indexing = (first & 0xC0) == 0x40;
+            if (!decode_integer(p, end, indexing ? 6 : 4, index))
+                return false;
+
+            if (index == 0)
+            {
+                if (!decode_string(p, end, _name))
+                    return false;
+            }
+            else if (!lookup(index, _name, _value))
+            {
+                return false;
+            }
+            if (!decode_string(p, end, _value))
+                return false;
+
+            field_seen = true;
+            on_field(std::string_view(_name), std::string_view(_value));
+            if (indexing)
+                _table.add(_name, _value);
+        }
+        return true;
+    }
+
+    const dynamic_table& table() const { return _table; }
+
+private:
+    bool lookup(std::uint64_t index, std::string& name, std::string& value) const
+    {
+        if (index == 0)
+            return false;
+        if (index <= static_table_size)
+        {
+            name.assign(static_table[index - 1].name);
+            value.assign(static_table[index - 1].value);
+            return true;
+        }
+
+        const dynamic_table::entry* e = _table.at(static_cast<std::size_t>(index));
+        if (!e)
+            return false;
+        name = e->first;
+        value = e->second;
+        return true;
+    }
+
+    static bool decode_string(const std::uint8_t*& p, const std::uint8_t* end, std::string& out)
+    {
+        if (p == end)
+            return false;
+
+        const bool huffman = (*p & 0x80) != 0;
+        std::uint64_t length = 0;
+        if (!decode_integer(p, end, 7, length) || length > static_cast<std::uint64_t>(end - p))
+            return false;
+
+        out.clear();
+        const auto size = static_cast<std::size_t>(length);
+        if (huffman)
+        {
+            if (!huffman_decode(p, size, out))
+                return false;
+        }
+        else
+        {
+            out.assign(reinterpret_cast<const char*>(p), size);
+        }
+        p += size;
+        return true;
+    }
+
+    dynamic_table _table;
+    const std::size_t _max_table_size;
+    std::string _name;
+    std::string _value;
+};
+
+/// <summary>
+/// Encodes the header blocks sent on one HTTP/2 connection, in order.
+///
+/// Fields already in a table are sent as a single index. Other fields are added to the dynamic
+/// table, so headers repeated across requests (user agent, accept, authority...) shrink to one
+/// or two octets after the first request. Values that change with every request are sent
+/// without indexing so they do not push useful entries out, and credentials are never indexed.
+/// </summary>
+class encoder
+{
+public:
+    explicit encoder(std::size_t max_table_size = 4096) : _table(max_table_size), _limit(max_table_size) {}
+
+    /// <summary>
+    /// Applies the SETTINGS_HEADER_TABLE_SIZE of the peer. The change is signalled at the start
+    /// of the next header block.
+    /// </summary>
+    void set_peer_max_table_size(std::size_t size)
+    {
+        const std::size_t max_size = size < _limit ? size : _limit;
+        if (max_size != _table.max_size())
+        {
+            _table.resize(max_size);
+            _size_update = true;
+        }
+    }
+
+    /// <summary>
+    /// Must be called before the first field of every header block.
+    /// </summary>
+    void begin_block(std::string& out)
+    {
+        if (_size_update)
+        {
+            encode_integer(out, 0x20, 5, _table.max_size());
+            _size_update = false;
+        }
+    }
+
+    /// <summary>
+    /// Appends one field. The name must be in lower case.
+    /// </summary>
+    void encode(std::string& out, std::string_view name, std::string_view value)
+    {
+        std::size_t name_index = 0;
+        for (std::size_t i = 0; i < static_table_size; ++i)
+        {
+            if (static_table[i].name != name)
+                continue;
+            if (static_table[i].value == value)
+                return encode_integer(out, 0x80, 7, i + 1);
+            if (name_index == 0)
+                name_index = i + 1;
+        }
+        for (std::size_t i = 0; i < _table.count(); ++i)
+        {
+            const std::size_t index = static_table_size + 1 + i;
+            const dynamic_table::entry* e = _table.at(index);
+            if (e->first != name)
+                continue;
+            if (e->second == value)
+                return encode_integer(out, 0x80, 7, index);
+            if (name_index == 0)
+                name_index = index;
+        }
+
+        if (is_sensitive(name))
+        {
+            // Never indexed, here and by every intermediary
+            encode_integer(out, 0x10, 4, name_index);
+        }
+        else if (is_volatile(name) || dynamic_table::entry_size(name, value) > _table.max_size() / 2)
+        {
+            encode_integer(out, 0x00, 4, name_index);
+        }
+        else
+        {
+            encode_integer(out, 0x40, 6, name_index);
+            _table.add(std::string(name), std::string(value));
+        }
+
+        if (name_index == 0)
+            encode_string(out, name);
+        encode_string(out, value);
+    }
+
+    const dynamic_table& table() const { return _table; }
+
+private:
+    static bool is_sensitive(std::string_view name)
+    {
+        return name == "authorization" || name == "proxy-authorization" || name == "cookie";
+    }
+
+    static bool is_volatile(std::string_view name) { return name == ":path" || name == "content-length"; }
+
+    dynamic_table _table;
+    const std::size_t _limit;
+    bool _size_update = false;
+};
+
+} // namespace hpack
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_HPACK_HPP
@@ -0,0 +1,432 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Parsing and formatting of HTTP dates (RFC 9110, section 5.6.7) and ISO 8601 timestamps (RFC 3339).
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_HTTP_DATE_HPP
+#define RESTPP_HTTP_DATE_HPP
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ratio>
+#include <string>
+#include <string_view>
+
+namespace restpp
+{
+namespace details
+{
+/// <summary>
+/// Days from 1970-01-01 to the given date of the proleptic Gregorian calendar.
+/// </summary>
+constexpr std::int64_t days_from_civil(std::int64_t year, unsigned month, unsigned day)
+{
+    year -= month <= 2;
+    const std::int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const auto year_of_era = static_cast<unsigned>(year - era * 400);
+    const unsigned day_of_year = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + static_cast<std::int64_t>(day_of_era) - 719468;
+}
+
+/// <summary>
+/// Time since 1970-01-01 in the 100 ns ticks of <c>utility::datetime</c>, which span every
+/// four-digit year where the nanoseconds of <c>system_clock</c> span about 1678 to 2262 only.
+/// </summary>
+using date_ticks = std::chrono::duration<std::int64_t, std::ratio<1, 10000000>>;
+
+/// <summary>
+/// The time point of a date, clamped to what <c>system_clock</c> can hold.
+/// </summary>
+inline std::chrono::system_clock::time_point to_time_point(date_ticks since_epoch)
+{
+    using clock = std::chrono::system_clock;
+    constexpr auto lowest = std::chrono::ceil<date_ticks>(clock::duration::min());
+    constexpr auto highest = std::chrono::floor<date_ticks>(clock::duration::max());
+    return clock::time_point(std::chrono::duration_cast<clock::duration>(std::clamp(since_epoch, lowest, highest)));
+}
+
+/// <summary>
+/// Reads <c>count</c> digits at <c>at</c>, moving past them.
+/// </summary>
+inline bool read_date_digits(std::string_view text, std::size_t& at, std::size_t count, unsigned& value)
+{
+    if (at + count > text.size())
+        return false;
+    value = 0;
+    for (std::size_t i = at; i < at + count; ++i)
+    {
+        if (text[i] < '0' || text[i] > '9')
+            return false;
+        value = value * 10 + static_cast<unsigned>(text[i] - '0');
+    }
+    at += count;
+    return true;
+}
+
+inline bool read_date_literal(std::string_view text, std::size_t& at, std::string_view literal)
+{
+    if (at > text.size() || text.substr(at, literal.size()) != literal)
+        return false;
+    at += literal.size();
+    return true;
+}
+
+inline bool read_date_month(std::string_view text, std::size_t& at, unsigned& month)
+{
+    static constexpr std::string_view months[] = {
+        "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    if (at > text.size())
+        return false;
+    const std::string_view name = text.substr(at, 3);
+    for (unsigned i = 0; i < 12; ++i)
+    {
+        if (name == months[i])
+        {
+            month = i + 1;
+            at += 3;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool read_date_time(std::string_view text, std::size_t& at, unsigned& hour, unsigned& minute, unsigned& second)
+{
+    return read_date_digits(text, at, 2, hour) && read_date_literal(text, at, ":") &&
+           read_date_digits(text, at, 2, minute) && read_date_literal(text, at, ":") &&
+           read_date_digits(text, at, 2, second) && hour < 24 && minute < 60 && second <= 60;
+}
+
+/// <summary>
+/// Parses an HTTP date in any of the three formats recipients must accept: the IMF-fixdate of
+/// RFC 1123 ("Sun, 06 Nov 1994 08:49:37 GMT"), the obsolete RFC 850 format
+/// ("Sunday, 06-Nov-94 08:49:37 GMT") and that of asctime ("Sun Nov  6 08:49:37 1994").
+/// </summary>
+inline std::optional<date_ticks> parse_http_date_ticks(std::string_view text)
+{
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+        text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t'))
+        text.remove_suffix(1);
+
+    unsigned year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0, digits;
+    const std::size_t comma = text.find(',');
+    std::size_t at = 0;
+    if (comma == 3)
+    {
+        at = 4;
+        if (!(read_date_literal(text, at, " ") && read_date_digits(text, at, 2, day) &&
+              read_date_literal(text, at, " ") && read_date_month(text, at, month) && read_date_literal(text, at, " ") &&
+              read_date_digits(text, at, 4, year) && read_date_literal(text, at, " ") &&
+              read_date_time(text, at, hour, minute, second) && read_date_literal(text, at, " GMT")))
+            return std::nullopt;
+    }
+    else if (comma != std::string_view::npos)
+    {
+        // RFC 850 years have two digits; those below 70 are in this century
+        at = comma + 1;
+        if (!(read_date_literal(text, at, " ") && read_date_digits(text, at, 2, day) &&
+              read_date_literal(text, at, "-") && read_date_month(text, at, month) && read_date_literal(text, at, "-") &&
+              read_date_digits(text, at, 2, digits) && read_date_literal(text, at, " ") &&
+              read_date_time(text, at, hour, minute, second) && read_date_literal(text, at, " GMT")))
+            return std::nullopt;
+        year = digits + (digits < 70 ? 2000 : 1900);
+    }
+    else
+    {
+        at = 3;
+        if (!(read_date_literal(text, at, " ") && read_date_month(text, at, month) && read_date_literal(text, at, " ")))
+            return std::nullopt;
+        if (at < text.size() && text[at] == ' ')
+            ++at;
+        if (!(read_date_digits(text, at, text.size() > at + 1 && text[at + 1] != ' ' ? 2 : 1, day) &&
+              read_date_literal(text, at, " ") && read_date_time(text, at, hour, minute, second) &&
+              read_date_literal(text, at, " ") && read_date_digits(text, at, 4, year)))
+            return std::nullopt;
+    }
+    if (at != text.size() || day == 0 || day > 31)
+        return std::nullopt;
+
+    const std::int64_t seconds =
+        days_from_civil(year, month, day) * 86400 + static_cast<std::int64_t>(hour * 3600 + minute * 60 + second);
+    return std::chrono::duration_cast<date_ticks>(std::chrono::seconds(seconds));
+}
+
+/// <summary>
+/// Parses an HTTP date, such as that of an Expires header; dates past what <c>system_clock</c>
+/// can hold, such as year 9999, read as its end.
+/// </summary>
+inline std::optional<std::chrono::system_clock::time_point> parse_http_date(std::string_view text)
+{
+    if (const auto ticks = parse_http_date_ticks(text))
+        return to_time_point(*ticks);
+    return std::nullopt;
+}
+
+/// <summary>
+/// The date of the proleptic Gregorian calendar the given number of days from 1970-01-01 falls
+/// on; the inverse of <c>days_from_civil</c>.
+/// </summary>
+constexpr void civil_from_days(std::int64_t days, std::int64_t& year, unsigned& month, unsigned& day)
+{
+    const std::int64_t z = days + 719468;
+    const std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const auto day_of_era = static_cast<unsigned>(z - era * 146097);
+    const unsigned year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    const unsigned day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    const unsigned mp = (5 * day_of_year + 2) / 153;
+    day = day_of_year - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = static_cast<std::int64_t>(year_of_era) + era * 400 + (month <= 2);
+}
+
+/// <summary>
+/// Splits a time into whole days since 1970-01-01 and seconds into the day, rounding down.
+/// </summary>
+inline void split_date(date_ticks since_epoch, std::int64_t& days, std::int64_t& seconds)
+{
+    const auto whole = std::chrono::floor<std::chrono::seconds>(since_epoch).count();
+    days = whole / 86400;
+    seconds = whole % 86400;
+    if (seconds < 0)
+    {
+        seconds += 86400;
+        --days;
+    }
+}
+
+inline char* write_two_digits(char* out, unsigned value)
+{
+    *out++ = static_cast<char>('0' + value / 10 % 10);
+    *out++ = static_cast<char>('0' + value % 10);
+    return out;
+}
+
+/// <summary>
+/// Writes a year with at least four digits.
+/// </summary>
+inline char* write_year(char* out, std::int64_t year)
+{
+    if (year >= 0 && year < 1000)
+    {
+        out = write_two_digits(out, static_cast<unsigned>(year / 100));
+        return write_two_digits(out, static_cast<unsigned>(year % 100));
+    }
+    return std::to_chars(out, out + 20, year).ptr;
+}
+
+/// <summary>
+/// Room needed by <c>write_http_date</c> and <c>write_iso8601_date</c>, whatever the year.
+/// </summary>
+constexpr std::size_t max_date_size = 64;
+
+/// <summary>
+/// Writes a time as an IMF-fixdate, such as "Sun, 06 Nov 1994 08:49:37 GMT", into a buffer of
+/// at least <c>max_date_size</c> bytes, returning the end of what it wrote.
+/// </summary>
+inline char* write_http_date(char* out, date_ticks since_epoch)
+{
+    static constexpr std::string_view weekdays[] = {"Thu", "Fri", "Sat", "Sun", "Mon", "Tue", "Wed"};
+    static constexpr std::string_view months[] = {
+        "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+    std::int64_t days, rest, year;
+    unsigned month, day;
+    split_date(since_epoch, days, rest);
+    civil_from_days(days, year, month, day);
+
+    const auto copy = [](char* to, std::string_view text) { return std::copy(text.begin(), text.end(), to); };
+    out = copy(out, weekdays[((days % 7) + 7) % 7]);
+    out = copy(out, ", ");
+    out = write_two_digits(out, day);
+    *out++ = ' ';
+    out = copy(out, months[month - 1]);
+    *out++ = ' ';
+    out = write_year(out, year);
+    *out++ = ' ';
+    out = write_two_digits(out, static_cast<unsigned>(rest / 3600));
+    *out++ = ':';
+    out = write_two_digits(out, static_cast<unsigned>(rest / 60 % 60));
+    *out++ = ':';
+    out = write_two_digits(out, static_cast<unsigned>(rest % 60));
+    return copy(out, " GMT");
+}
+
+inline char* write_http_date(char* out, std::chrono::system_clock::time_point time)
+{
+    return write_http_date(out, std::chrono::floor<date_ticks>(time.time_since_epoch()));
+}
+
+/// <summary>
+/// Appends a time as an IMF-fixdate.
+/// </summary>
+template<typename String>
+void append_http_date(String& out, std::chrono::system_clock::time_point time)
+{
+    char text[max_date_size];
+    out.append(text, static_cast<std::size_t>(write_http_date(text, time) - text));
+}
+
+/// <summary>
+/// Formats a time as an IMF-fixdate, such as "Sun, 06 Nov 1994 08:49:37 GMT".
+/// </summary>
+inline std::string format_http_date(std::chrono::system_clock::time_point time)
+{
+    std::string out;
+    append_http_date(out, time);
+    return out;
+}
+
+/// <summary>
+/// The current time as an IMF-fixdate, for the Date header of responses. Each thread formats
+/// it once a second at most; the view stays valid until the thread calls this again.
+/// </summary>
+inline std::string_view current_http_date()
+{
+    thread_local std::int64_t formatted_second = INT64_MIN;
+    thread_local char text[max_date_size];
+    thread_local std::size_t size = 0;
+
+    const auto now = std::chrono::system_clock::now();
+    const auto second = std::chrono::floor<std::chrono::seconds>(now.time_since_epoch()).count();
+    if (second != formatted_second)
+    {
+        size = static_cast<std::size_t>(write_http_date(text, now) - text);
+        formatted_second = second;
+    }
+    return std::string_view(text, size);
+}
+
+/// <summary>
+/// Writes a time in the ISO 8601 format of RFC 3339 in UTC, such as "1994-11-06T08:49:37Z", with
+/// as many fractional digits as its sub-second part needs, up to 7.
+/// </summary>
+inline char* write_iso8601_date(char* out, date_ticks since_epoch)
+{
+    std::int64_t days, rest, year;
+    unsigned month, day;
+    split_date(since_epoch, days, rest);
+    civil_from_days(days, year, month, day);
+
+    out = write_year(out, year);
+    *out++ = '-';
+    out = write_two_digits(out, month);
+    *out++ = '-';
+    out = write_two_digits(out, day);
+    *out++ = 'T';
+    out = write_two_digits(out, static_cast<unsigned>(rest / 3600));
+    *out++ = ':';
+    out = write_two_digits(out, static_cast<unsigned>(rest / 60 % 60));
+    *out++ = ':';
+    out = write_two_digits(out, static_cast<unsigned>(rest % 60));
+
+    auto fraction = static_cast<unsigned>((since_epoch - std::chrono::floor<std::chrono::seconds>(since_epoch)).count());
+    if (fraction != 0)
+    {
+        char digits[7];
+        for (int i = 6; i >= 0; --i, fraction /= 10)
+            digits[i] = static_cast<char>('0' + fraction % 10);
+        int used = 7;
+        while (digits[used - 1] == '0')
+            --used;
+        *out++ = '.';
+        out = std::copy(digits, digits + used, out);
+    }
+    *out++ = 'Z';
+    return out;
+}
+
+inline char* write_iso8601_date(char* out, std::chrono::system_clock::time_point time)
+{
+    return write_iso8601_date(out, std::chrono::floor<date_ticks>(time.time_since_epoch()));
+}
+
+template<typename String>
+void append_iso8601_date(String& out, std::chrono::system_clock::time_point time)
+{
+    char text[max_date_size];
+    out.append(text, static_cast<std::size_t>(write_iso8601_date(text, time) - text));
+}
+
+/// <summary>
+/// Parses a date and time in the ISO 8601 format of RFC 3339, "1994-11-06T08:49:37Z", with an
+/// optional fraction of a second and "Z" or an offset such as "+02:00". A date alone is read
+/// as its midnight in UTC.
+/// </summary>
+inline std::optional<date_ticks> parse_iso8601_date_ticks(std::string_view text)
+{
+    unsigned year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+    std::size_t at = 0;
+    if (!(read_date_digits(text, at, 4, year) && read_date_literal(text, at, "-") && read_date_digits(text, at, 2, month) &&
+          read_date_literal(text, at, "-") && read_date_digits(text, at, 2, day)) ||
+        month == 0 || month > 12 || day == 0 || day > 31)
+        return std::nullopt;
+
+    date_ticks fraction{};
+    std::int64_t offset = 0;
+    if (at != text.size())
+    {
+        if ((text[at] != 'T' && text[at] != 't' && text[at] != ' ') || !read_date_time(text, ++at, hour, minute, second))
+            return std::nullopt;
+
+        // Digits past the seventh are below the precision kept
+        if (at < text.size() && (text[at] == '.' || text[at] == ','))
+        {
+            std::int64_t scale = 1000000;
+            const std::size_t first = ++at;
+            for (; at < text.size() && text[at] >= '0' && text[at] <= '9'; ++at, scale /= 10)
+                fraction += date_ticks((text[at] - '0') * scale);
+            if (at == first)
+                return std::nullopt;
+        }
+
+        if (at < text.size() && (text[at] == 'Z' || text[at] == 'z'))
+            ++at;
+        else if (at < text.size() && (text[at] == '+' || text[at] == '-'))
+        {
+            const int sign = text[at++] == '-' ? -1 : 1;
+            unsigned offset_hour = 0, offset_minute = 0;
+            if (!read_date_digits(text, at, 2, offset_hour))
+                return std::nullopt;
+            read_date_literal(text, at, ":");
+            if (!read_date_digits(text, at, 2, offset_minute) || offset_hour > 23 || offset_minute > 59)
+                return std::nullopt;
+            offset = sign * static_cast<std::int64_t>(offset_hour * 3600 + offset_minute * 60);
+        }
+        else
+            return std::nullopt;
+    }
+    if (at != text.size())
+        return std::nullopt;
+
+    const std::int64_t seconds = days_from_civil(year, month, day) * 86400 +
+                                 static_cast<std::int64_t>(hour * 3600 + minute * 60 + second) - offset;
+    return std::chrono::seconds(seconds) + fraction;
+}
+
+inline std::optional<std::chrono::system_clock::time_point> parse_iso8601_date(std::string_view text)
+{
+    if (const auto ticks = parse_iso8601_date_ticks(text))
+        return to_time_point(*ticks);
+    return std::nullopt;
+}
+
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_HTTP_DATE_HPP
@@ -0,0 +1,660 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Incremental HTTP/1.1 request and response parsers working directly on receive buffer spans.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_HTTP_PARSER_HPP
+#define RESTPP_HTTP_PARSER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <boost/system/error_code.hpp>
+
+#include <restpp/core/error.hpp>
+#include <restpp/core/headers.hpp>
+#include <restpp/core/details/restpp_compat.hpp>
+
+namespace restpp
+{
+namespace details
+{
+/// <summary>
+/// How the body of a message is delimited on the wire.
+/// </summary>
+enum class body_framing
+{
+    none,
+    content_length,
+    chunked,
+    until_eof
+};
+
+/// <summary>
+/// A header line of a parsed message. Both views point into the buffer that was parsed.
+/// </summary>
+struct header_field
+{
+    std::string_view name;
+    std::string_view value;
+};
+
+inline std::string_view trim_ows(std::string_view value)
+{
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t'))
+        value.remove_prefix(1);
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t'))
+        value.remove_suffix(1);
+    return value;
+}
+
+/// <summary>
+/// Whether the comma separated header value lists the given token.
+/// </summary>
+inline bool has_token(std::string_view value, std::string_view token)
+{
+    while (!value.empty())
+    {
+        const auto comma = value.find(',');
+        if (iequals(trim_ows(value.substr(0, comma)), token))
+            return true;
+        if (comma == std::string_view::npos)
+            break;
+        value.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+/// <summary>
+/// Resumable state machine parsing HTTP/1.x messages: responses when <c>IsRequest</c> is false,
+/// as the client reads them, and requests when it is true, as the server does.
+///
+/// The parser is fed the unconsumed bytes of a receive buffer and reports how many it consumed.
+/// Nothing is copied: the start line and headers are only parsed once the whole header block
+/// is in the buffer, and are exposed as views into it that stay valid until the buffer is
+/// modified. Body bytes are handed to a callback as views as soon as they are available. The
+/// parser stops exactly at the end of a message, so bytes of a pipelined message that follows
+/// are left untouched in the buffer.
+/// </summary>
+template<bool IsRequest>
+class message_parser
+{
+public:
+    explicit message_parser(std::size_t max_head_size = 64 * 1024,
+                            std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+        : _max_head_size(max_head_size), _fields(memory)
+    {
+        _fields.reserve(16);
+    }
+
+    /// <summary>
+    /// Prepares the parser for the next message on the connection.
+    /// </summary>
+    /// <param name="head_request">Whether the response answers a HEAD request, which makes it bodiless.</param>
+    void reset(bool head_request = false)
+    {
+        _state = state::head;
+        _head_request = head_request;
+        _scanned = 0;
+        _status_code = 0;
+        _version_minor = 1;
+        _reason = {};
+        _method = {};
+        _target = {};
+        _expect_continue = false;
+        _header_block = {};
+        _fields.clear();
+        _framing = body_framing::none;
+        _content_length = 0;
+        _remaining = 0;
+        _keep_alive = false;
+    }
+
+    /// <summary>
+    /// Parses as much of the given bytes as possible.
+    /// </summary>
+    /// <param name="on_body">Invoked with a <c>std::string_view</c> for every piece of body data. If it
+    /// returns false, parsing pauses right after that piece so the caller can process it before
+    /// the buffer is touched again.</param>
+    /// <returns>The number of bytes consumed. Unconsumed bytes must be passed again, followed by
+    /// newly received data, on the next call.</returns>
+    template<typename OnBody>
+    std::size_t parse(const char* data, std::size_t size, boost::system::error_code& ec, OnBody&& on_body)
+    {
+        ec = {};
+        std::size_t used = 0;
+        while (_state != state::done && !ec)
+        {
+            const char* p = data + used;
+            const std::size_t avail = size - used;
+            std::size_t n = 0;
+
+            switch (_state)
+            {
+                case state::head: n = parse_head(p, avail, ec); break;
+                case state::body_length:
+                case state::chunk_data:
+                {
+                    n = avail < _remaining ? avail : static_cast<std::size_t>(_remaining);
+                    _remaining -= n;
+                    if (_remaining == 0)
+                        _state = _state == state::body_length ? state::done : state::chunk_crlf;
+                    if (n != 0 && !deliver(on_body, std::string_view(p, n)))
+                        return used + n;
+                    break;
+                }
+                case state::body_eof:
+                    n = avail;
+                    if (n != 0 && !deliver(on_body, std::string_view(p, n)))
+                        return used + n;
+                    break;
+                case state::chunk_size: n = parse_chunk_size(p, avail, ec); break;
+                case state::chunk_crlf: n = parse_chunk_crlf(p, avail, ec); break;
+                case state::trailers: n = parse_trailers(p, avail, ec); break;
+                case state::done: break;
+            }
+
+            if (n == 0 && _state != state::done)
+                break;
+            used += n;
+        }
+        return used;
+    }
+
+    /// <summary>
+    /// Signals that the peer closed the connection. Completes a body delimited by the end of
+    /// the connection, and reports any other unfinished message as an error.
+    /// </summary>
+    void finish(boost::system::error_code& ec)
+    {
+        if (_state == state::body_eof)
+            _state = state::done;
+        else if (_state != state::done)
+            ec = error::partial_message;
+    }
+
+    /// <summary>
+    /// Accounts for <c>n</c> bytes of a Content-Length body that the caller read directly into
+    /// its own storage instead of passing them through the parser.
+    /// </summary>
+    void skip_body(std::size_t n)
+    {
+        _remaining -= n;
+        if (_remaining == 0)
+            _state = state::done;
+    }
+
+    bool is_done() const { return _state == state::done; }
+
+    bool is_head_done() const { return _state != state::head; }
+
+    int status_code() const { return _status_code; }
+
+    int version_minor() const { return _version_minor; }
+
+    std::string_view reason() const { return _reason; }
+
+    /// <summary>
+    /// The method of a parsed request, such as "GET".
+    /// </summary>
+    std::string_view method() const { return _method; }
+
+    /// <summary>
+    /// The request-target of a parsed request, usually an absolute path and query.
+    /// </summary>
+    std::string_view target() const { return _target; }
+
+    /// <summary>
+    /// Whether the client of a parsed request waits for "100 Continue" before sending its body.
+    /// </summary>
+    bool expect_continue() const { return _expect_continue; }
+
+    /// <summary>
+    /// The header lines of the message, excluding the status line and the final empty line.
+    /// Every line keeps its CRLF terminator.
+    /// </summary>
+    std::string_view header_block() const { return _header_block; }
+
+    const std::pmr::vector<header_field>& fields() const { return _fields; }
+
+    body_framing framing() const { return _framing; }
+
+    std::uint64_t content_length() const { return _content_length; }
+
+    /// <summary>
+    /// Body bytes still expected when the body is delimited by Content-Length.
+    /// </summary>
+    std::uint64_t body_remaining() const { return _state == state::body_length ? _remaining : 0; }
+
+    /// <summary>
+    /// Whether the connection may carry another message once this one is complete.
+    /// </summary>
+    bool keep_alive() const { return _keep_alive; }
+
+private:
+    enum class state
+    {
+        head,
+        body_length,
+        body_eof,
+        chunk_size,
+        chunk_data,
+        chunk_crlf,
+        trailers,
+        done
+    };
+
+    template<typename OnBody>
+    static bool deliver(OnBody& on_body, std::string_view data)
+    {
+        if constexpr (std::is_same<decltype(on_body(data)), bool>::value)
+        {
+            return on_body(data);
+        }
+        else
+        {
+            on_body(data);
+            return true;
+        }
+    }
+
+    static bool is_token_char(unsigned char c)
+    {
+        // clang-format off
+        static RESTPP_CONSTEXPR bool table[256] = {
+            /*        X0 X1 X2 X3 X4 X5 X6 X7 X8 X9 XA XB XC XD XE XF */
+            /* 0X */   0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            /* 1X */   0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+            /* 2X */   0, 1, 0, 1, 1, 1, 1, 1, 0, 0, 1, 1, 0, 1, 1, 0, /* !#$%&'*+-. */
+            /* 3X */   1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, /* 0-9 */
+            /* 4X */   0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, /* A-Z */
+            /* 5X */   1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 1, 1, /* ^_ */
+            /* 6X */   1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, /* `a-z */
+            /* 7X */   1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 0, 1, 0  /* |~ */
+            /* non-ASCII values initialized to 0 */
+        };
+        // clang-format on
+        return table[c];
+    }
+
+    /// <summary>
+    /// Finds the next line in [p, end). Returns the position past its LF and sets
+    /// <c>line_end</c> to the position of its terminator (CR of a CRLF, or a bare LF).
+    /// </summary>
+    static const char* next_line(const char* p, const char* end, const char*& line_end)
+    {
+        const char* lf = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(end - p)));
+        if (!lf)
+            return nullptr;
+        line_end = (lf != p && lf[-1] == '\r') ? lf - 1 : lf;
+        return lf + 1;
+    }
+
+    std::size_t parse_head(const char* data, std::size_t size, boost::system::error_code& ec)
+    {
+        if constexpr (IsRequest)
+        {
+            // Empty lines ahead of a request line are ignored (RFC 9112, section 2.2)
+            std::size_t empty = 0;
+            while (_scanned == 0 && empty < size && (data[empty] == '\r' || data[empty] == '\n'))
+                ++empty;
+            if (empty != 0)
+                return empty;
+        }
+
+        // Look for the empty line that terminates the header block, resuming where the previous
+        // call stopped so no byte is scanned twice.
+        std::size_t head_size = 0;
+        while (_scanned < size)
+        {
+            const char* lf = static_cast<const char*>(std::memchr(data + _scanned, '\n', size - _scanned));
+            if (!lf)
+            {
+                _scanned = size;
+                break;
+            }
+
+            const std::size_t i = static_cast<std::size_t>(lf - data);
+            if (i + 1 < size && data[i + 1] == '\n')
+            {
+                head_size = i + 2;
+                break;
+            }
+            if (i + 2 < size && data[i + 1] == '\r' && data[i + 2] == '\n')
+            {
+                head_size = i + 3;
+                break;
+            }
+            if (i + 2 >= size)
+            {
+                // Not enough bytes yet to tell whether the next line is empty
+                _scanned = i;
+                break;
+            }
+            _scanned = i + 1;
+        }
+
+        if (head_size == 0 || head_size > _max_head_size)
+        {
+            if (size > _max_head_size)
+                ec = error::header_too_large;
+            return 0;
+        }
+
+        const char* end = data + head_size;
+        const char* line_end = nullptr;
+        const char* p = next_line(data, end, line_end);
+        if (IsRequest ? !parse_request_line(data, line_end) : !parse_status_line(data, line_end))
+        {
+            ec = IsRequest ? error::invalid_request_line : error::invalid_status_line;
+            return 0;
+        }
+        const char* block_begin = p;
+
+        bool chunked = false;
+        bool has_transfer_encoding = false;
+        bool has_length = false;
+        bool connection_close = false;
+        bool connection_keep_alive = false;
+        for (;;)
+        {
+            const char* line = p;
+            p = next_line(line, end, line_end);
+            if (line_end == line)
+                break;
+
+            const char* colon = line;
+            while (colon != line_end && is_token_char(static_cast<unsigned char>(*colon)))
+                ++colon;
+            if (colon == line || colon == line_end || *colon != ':')
+            {
+                ec = error::invalid_header;
+                return 0;
+            }
+
+            header_field field;
+            field.name = std::string_view(line, static_cast<std::size_t>(colon - line));
+            field.value = trim_ows(std::string_view(colon + 1, static_cast<std::size_t>(line_end - colon - 1)));
+            _fields.push_back(field);
+
+            if (iequals(field.name, "Content-Length"))
+            {
+                std::uint64_t length = 0;
+                if (!parse_decimal(field.value, length) || (has_length && length != _content_length))
+                {
+                    ec = error::invalid_header;
+                    return 0;
+                }
+                _content_length = length;
+                has_length = true;
+            }
+            else if (iequals(field.name, "Transfer-Encoding"))
+            {
+                // Only the final transfer coding decides how the body is delimited
+                auto last = field.value.rfind(',');
+                chunked = iequals(trim_ows(last == std::string_view::npos ? field.value : field.value.substr(last + 1)),
+                                  "chunked");
+                has_transfer_encoding = true;
+            }
+            else if (iequals(field.name, "Connection"))
+            {
+                connection_close = connection_close || has_token(field.value, "close");
+                connection_keep_alive = connection_keep_alive || has_token(field.value, "keep-alive");
+            }
+            else if (IsRequest && iequals(field.name, "Expect"))
+            {
+                _expect_continue = iequals(field.value, "100-continue");
+            }
+        }
+        _header_block = std::string_view(block_begin, static_cast<std::size_t>(line_end - block_begin));
+
+        // Interim responses are followed by the final one on the same connection
+        if (!IsRequest && _status_code >= 100 && _status_code < 200 && _status_code != 101)
+        {
+            reset(_head_request);
+            return head_size;
+        }
+
+        _keep_alive = _version_minor >= 1 ? !connection_close : connection_keep_alive && !connection_close;
+
+        // The length of a request body with another final transfer coding cannot be determined,
+        // so the request can only be refused (RFC 9112, section 6.3)
+        if (IsRequest && has_transfer_encoding && !chunked)
+        {
+            ec = error::invalid_header;
+            return 0;
+        }
+
+        // A message framed both ways may be read differently by another hop: a request is refused
+        // and a response is read by its transfer coding, without reusing the connection for the
+        // next one (RFC 9112, section 6.1)
+        if (has_transfer_encoding && has_length)
+        {
+            if (IsRequest)
+            {
+                ec = error::invalid_header;
+                return 0;
+            }
+            _keep_alive = false;
+        }
+
+        if (!IsRequest && (_head_request || (_status_code >= 100 && _status_code < 200) || _status_code == 204 ||
+                           _status_code == 304))
+        {
+            _framing = body_framing::none;
+            _state = state::done;
+        }
+        else if (chunked)
+        {
+            _framing = body_framing::chunked;
+            _state = state::chunk_size;
+        }
+        else if (has_length && !has_transfer_encoding)
+        {
+            _framing = body_framing::content_length;
+            _remaining = _content_length;
+            _state = _remaining == 0 ? state::done : state::body_length;
+        }
+        else if (IsRequest)
+        {
+            // Requests without Content-Length or chunked coding have no body
+            _framing = body_framing::none;
+            _state = state::done;
+        }
+        else
+        {
+            _framing = body_framing::until_eof;
+            _keep_alive = false;
+            _state = state::body_eof;
+        }
+        return head_size;
+    }
+
+    bool parse_status_line(const char* p, const char* end)
+    {
+        // HTTP-version SP status-code SP reason-phrase
+        if (end - p < 12 || std::memcmp(p, "HTTP/1.", 7) != 0 || p[7] < '0' || p[7] > '9' || p[8] != ' ')
+            return false;
+        _version_minor = p[7] - '0';
+
+        p += 9;
+        if (p[0] < '0' || p[0] > '9' || p[1] < '0' || p[1] > '9' || p[2] < '0' || p[2] > '9')
+            return false;
+        _status_code = (p[0] - '0') * 100 + (p[1] - '0') * 10 + (p[2] - '0');
+        p += 3;
+
+        if (p != end && *p != ' ')
+            return false;
+        _reason = p == end ? std::string_view() : std::string_view(p + 1, static_cast<std::size_t>(end - p - 1));
+        return true;
+    }
+
+    bool parse_request_line(const char* p, const char* end)
+    {
+        // method SP request-target SP HTTP-version
+        const char* method_end = p;
+        while (method_end != end && is_token_char(static_cast<unsigned char>(*method_end)))
+            ++method_end;
+        if (method_end == p || method_end == end || *method_end != ' ')
+            return false;
+
+        const char* target = method_end + 1;
+        const char* target_end = target;
+        while (target_end != end && static_cast<unsigned char>(*target_end) > ' ' && *target_end != 0x7f)
+            ++target_end;
+        if (target_end == target || end - target_end != 9 || *target_end != ' ' ||
+            std::memcmp(target_end + 1, "HTTP/1.", 7) != 0 || target_end[8] < '0' || target_end[8] > '9')
+            return false;
+
+        _version_minor = target_end[8] - '0';
+        _method = std::string_view(p, static_cast<std::size_t>(method_end - p));
+        _target = std::string_view(target, static_cast<std::size_t>(target_end - target));
+        return true;
+    }
+
+    static bool parse_decimal(std::string_view value, std::uint64_t& out)
+    {
+        if (value.empty() || value.size() > 19)
+            return false;
+        out = 0;
+        for (char c : value)
+        {
+            if (c < '0' || c > '9')
+                return false;
+            out = out * 10 + static_cast<std::uint64_t>(c - '0');
+        }
+        return true;
+    }
+
+    std::size_t parse_chunk_size(const char* data, std::size_t size, boost::system::error_code& ec)
+    {
+        const char* line_end = nullptr;
+        const char* next = next_line(data, data + size, line_end);
+        if (!next)
+        {
+            if (size > 1024)
+                ec = error::invalid_chunk;
+            return 0;
+        }
+
+        std::uint64_t chunk_size = 0;
+        const char* p = data;
+        for (; p != line_end; ++p)
+        {
+            int digit;
+            if (*p >= '0' && *p <= '9')
+                digit = *p - '0';
+            else if (*p >= 'a' && *p <= 'f')
+                digit = *p - 'a' + 10;
+            else if (*p >= 'A' && *p <= 'F')
+                digit = *p - 'A' + 10;
+            else
+                break;
+
+            if (chunk_size >> 60)
+            {
+                ec = error::invalid_chunk;
+                return 0;
+            }
+            chunk_size = (chunk_size << 4) | static_cast<std::uint64_t>(digit);
+        }
+
+        // Chunk extensions are ignored
+        if (p == data || (p != line_end && *p != ';' && *p != ' ' && *p != '\t'))
+        {
+            ec = error::invalid_chunk;
+            return 0;
+        }
+
+        _remaining = chunk_size;
+        _state = chunk_size == 0 ? state::trailers : state::chunk_data;
+        return static_cast<std::size_t>(next - data);
+    }
+
+    std::size_t parse_chunk_crlf(const char* data, std::size_t size, boost::system::error_code& ec)
+    {
+        if (size == 0)
+            return 0;
+        if (data[0] == '\n')
+        {
+            _state = state::chunk_size;
+            return 1;
+        }
+        if (size < 2)
+            return 0;
+        if (data[0] != '\r' || data[1] != '\n')
+        {
+            ec = error::invalid_chunk;
+            return 0;
+        }
+        _state = state::chunk_size;
+        return 2;
+    }
+
+    std::size_t parse_trailers(const char* data, std::size_t size, boost::system::error_code& ec)
+    {
+        // Trailer fields are discarded up to the terminating empty line
+        std::size_t used = 0;
+        for (;;)
+        {
+            const char* line_end = nullptr;
+            const char* next = next_line(data + used, data + size, line_end);
+            if (!next)
+            {
+                if (size - used > _max_head_size)
+                    ec = error::header_too_large;
+                return used;
+            }
+
+            const bool empty = line_end == data + used;
+            used = static_cast<std::size_t>(next - data);
+            if (empty)
+            {
+                _state = state::done;
+                return used;
+            }
+        }
+    }
+
+    const std::size_t _max_head_size;
+
+    state _state = state::head;
+    bool _head_request = false;
+    std::size_t _scanned = 0;
+
+    int _status_code = 0;
+    int _version_minor = 1;
+    std::string_view _reason;
+    std::string_view _method;
+    std::string_view _target;
+    bool _expect_continue = false;
+    std::string_view _header_block;
+    std::pmr::vector<header_field> _fields;
+
+    body_framing _framing = body_framing::none;
+    std::uint64_t _content_length = 0;
+    std::uint64_t _remaining = 0;
+    bool _keep_alive = false;
+};
+
+using response_parser = message_parser<false>;
+using request_parser = message_parser<true>;
+
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_HTTP_PARSER_HPP
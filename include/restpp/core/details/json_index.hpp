@@ -0,0 +1,307 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Structural index of JSON text, found 64 bytes at a time with vector compares.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_JSON_INDEX_HPP
+#define RESTPP_JSON_INDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RESTPP_JSON_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace restpp
+{
+namespace details
+{
+namespace json_scan
+{
+/// <summary>
+/// One bit per byte of a 64 byte block, for each character class the index is built from.
+/// </summary>
+struct block_masks
+{
+    std::uint64_t backslash;
+    std::uint64_t quote;
+    std::uint64_t whitespace;
+    std::uint64_t op;
+};
+
+inline unsigned first_set_bit(std::uint64_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctzll(mask));
+#endif
+}
+
+inline unsigned count_bits(std::uint64_t mask)
+{
+#if defined(_MSC_VER)
+    return static_cast<unsigned>(__popcnt64(mask));
+#else
+    return static_cast<unsigned>(__builtin_popcountll(mask));
+#endif
+}
+
+// The operators are { } [ ] : and ,. Setting bit 5 folds [ and ] onto { and }, so four
+// compares find all six of them, and four more the whitespace.
+#if defined(__AVX2__)
+inline std::uint32_t half_masks(const char* p, std::uint32_t& backslash, std::uint32_t& quote, std::uint32_t& ws)
+{
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const __m256i folded = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    const auto eq = [](__m256i a, char c) { return _mm256_cmpeq_epi8(a, _mm256_set1_epi8(c)); };
+
+    backslash = static_cast<std::uint32_t>(_mm256_movemask_epi8(eq(v, '\\')));
+    quote = static_cast<std::uint32_t>(_mm256_movemask_epi8(eq(v, '"')));
+    ws = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_or_si256(eq(v, ' '), eq(v, '\t')), _mm256_or_si256(eq(v, '\n'), eq(v, '\r')))));
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(
+        _mm256_or_si256(_mm256_or_si256(eq(folded, '{'), eq(folded, '}')), _mm256_or_si256(eq(v, ':'), eq(v, ',')))));
+}
+
+inline block_masks classify(const char* p)
+{
+    block_masks m;
+    std::uint32_t b[2], q[2], w[2], o[2];
+    o[0] = half_masks(p, b[0], q[0], w[0]);
+    o[1] = half_masks(p + 32, b[1], q[1], w[1]);
+    m.backslash = b[0] | (std::uint64_t(b[1]) << 32);
+    m.quote = q[0] | (std::uint64_t(q[1]) << 32);
+    m.whitespace = w[0] | (std::uint64_t(w[1]) << 32);
+    m.op = o[0] | (std::uint64_t(o[1]) << 32);
+    return m;
+}
+#elif defined(RESTPP_JSON_SSE2)
+inline std::uint16_t quarter_masks(const char* p, std::uint16_t& backslash, std::uint16_t& quote, std::uint16_t& ws)
+{
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    const auto eq = [](__m128i a, char c) { return _mm_cmpeq_epi8(a, _mm_set1_epi8(c)); };
+
+    backslash = static_cast<std::uint16_t>(_mm_movemask_epi8(eq(v, '\\')));
+    quote = static_cast<std::uint16_t>(_mm_movemask_epi8(eq(v, '"')));
+    ws = static_cast<std::uint16_t>(
+        _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(eq(v, ' '), eq(v, '\t')), _mm_or_si128(eq(v, '\n'), eq(v, '\r')))));
+    return static_cast<std::uint16_t>(
+        _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(eq(folded, '{'), eq(folded, '}')), _mm_or_si128(eq(v, ':'), eq(v, ',')))));
+}
+
+inline block_masks classify(const char* p)
+{
+    block_masks m{0, 0, 0, 0};
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        std::uint16_t b, q, w;
+        const std::uint16_t o = quarter_masks(p + 16 * i, b, q, w);
+        m.backslash |= std::uint64_t(b) << (16 * i);
+        m.quote |= std::uint64_t(q) << (16 * i);
+        m.whitespace |= std::uint64_t(w) << (16 * i);
+        m.op |= std::uint64_t(o) << (16 * i);
+    }
+    return m;
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+/// <summary>
+/// NEON has no byte movemask: the compare results of the four quarters are weighted by bit
+/// and added pairwise down to one 64 bit mask.
+/// </summary>
+inline std::uint64_t to_bitmask(uint8x16_t m0, uint8x16_t m1, uint8x16_t m2, uint8x16_t m3)
+{
+    static const std::uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    const uint8x16_t w = vld1q_u8(weights);
+    uint8x16_t sum0 = vpaddq_u8(vandq_u8(m0, w), vandq_u8(m1, w));
+    const uint8x16_t sum1 = vpaddq_u8(vandq_u8(m2, w), vandq_u8(m3, w));
+    sum0 = vpaddq_u8(sum0, sum1);
+    sum0 = vpaddq_u8(sum0, sum0);
+    return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+}
+
+inline block_masks classify(const char* p)
+{
+    uint8x16_t v[4];
+    for (unsigned i = 0; i < 4; ++i)
+        v[i] = vld1q_u8(reinterpret_cast<const std::uint8_t*>(p) + 16 * i);
+
+    const auto eq = [](uint8x16_t a, char c) { return vceqq_u8(a, vdupq_n_u8(static_cast<std::uint8_t>(c))); };
+    const auto ws = [&](uint8x16_t a) { return vorrq_u8(vorrq_u8(eq(a, ' '), eq(a, '\t')), vorrq_u8(eq(a, '\n'), eq(a, '\r'))); };
+    const auto op = [&](uint8x16_t a) {
+        const uint8x16_t folded = vorrq_u8(a, vdupq_n_u8(0x20));
+        return vorrq_u8(vorrq_u8(eq(folded, '{'), eq(folded, '}')), vorrq_u8(eq(a, ':'), eq(a, ',')));
+    };
+
+    block_masks m;
+    m.backslash = to_bitmask(eq(v[0], '\\'), eq(v[1], '\\'), eq(v[2], '\\'), eq(v[3], '\\'));
+    m.quote = to_bitmask(eq(v[0], '"'), eq(v[1], '"'), eq(v[2], '"'), eq(v[3], '"'));
+    m.whitespace = to_bitmask(ws(v[0]), ws(v[1]), ws(v[2]), ws(v[3]));
+    m.op = to_bitmask(op(v[0]), op(v[1]), op(v[2]), op(v[3]));
+    return m;
+}
+#else
+inline block_masks classify(const char* p)
+{
+    block_masks m{0, 0, 0, 0};
+    for (unsigned i = 0; i < 64; ++i)
+    {
+        const std::uint64_t bit = std::uint64_t(1) << i;
+        switch (p[i])
+        {
+            case '\\': m.backslash |= bit; break;
+            case '"': m.quote |= bit; break;
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r': m.whitespace |= bit; break;
+            case '{':
+            case '}':
+            case '[':
+            case ']':
+            case ':':
+            case ',': m.op |= bit; break;
+            default: break;
+        }
+    }
+    return m;
+}
+#endif
+
+/// <summary>
+/// Bit i is set when an odd number of bits at or below i are set: the inside of every quoted
+/// string, opening quote included.
+/// </summary>
+inline std::uint64_t prefix_xor(std::uint64_t bits)
+{
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+/// <summary>
+/// State carried from one block to the next.
+/// </summary>
+struct carry
+{
+    std::uint64_t escaped_next = 0;
+    std::uint64_t in_string = 0;
+    std::uint64_t scalar = 0;
+};
+
+/// <summary>
+/// The characters escaped by a backslash: those that follow an odd-length run of backslashes.
+/// Subtracting the run starts from the odd bits carries through each run and leaves the parity
+/// of its length in the bit that follows it.
+/// </summary>
+inline std::uint64_t escaped_chars(std::uint64_t backslash, carry& state)
+{
+    constexpr std::uint64_t odd_bits = 0xAAAAAAAAAAAAAAAAull;
+    if (backslash == 0)
+    {
+        const std::uint64_t escaped = state.escaped_next;
+        state.escaped_next = 0;
+        return escaped;
+    }
+
+    const std::uint64_t potential_escape = backslash & ~state.escaped_next;
+    const std::uint64_t maybe_escaped = potential_escape << 1;
+    const std::uint64_t series = (maybe_escaped | odd_bits) - potential_escape;
+    const std::uint64_t escape_and_terminal = series ^ odd_bits;
+    const std::uint64_t escaped = escape_and_terminal ^ (backslash | state.escaped_next);
+    state.escaped_next = (escape_and_terminal & backslash) >> 63;
+    return escaped;
+}
+
+/// <summary>
+/// The structural characters of one block: operators and the opening quote of strings, along
+/// with the first character of every number and literal, all outside of strings.
+/// </summary>
+inline std::uint64_t structurals(const block_masks& m, carry& state)
+{
+    const std::uint64_t quotes = m.quote & ~escaped_chars(m.backslash, state);
+    const std::uint64_t in_string = prefix_xor(quotes) ^ state.in_string;
+    state.in_string = static_cast<std::uint64_t>(static_cast<std::int64_t>(in_string) >> 63);
+
+    const std::uint64_t scalar = ~(m.op | m.whitespace | quotes | in_string);
+    const std::uint64_t scalar_start = scalar & ~((scalar << 1) | state.scalar);
+    state.scalar = scalar >> 63;
+
+    return ((m.op | scalar_start) & ~in_string) | (quotes & in_string);
+}
+} // namespace json_scan
+
+/// <summary>
+/// Finds the offset of every structural character of a JSON text: each { } [ ] : and , the
+/// opening quote of each string, and the first character of each number, true, false and null,
+/// skipping over the contents of strings. Navigating the text afterwards only visits these
+/// offsets. The text is read in place; only its last partial block is copied so that no load
+/// reads past its end.
+/// </summary>
+/// <returns>False when a string is not terminated.</returns>
+inline bool index_json(std::string_view text, std::vector<std::uint32_t>& index)
+{
+    index.clear();
+    index.reserve(text.size() / 8 + 16);
+
+    json_scan::carry state;
+    const auto emit = [&index](std::uint64_t bits, std::size_t base) {
+        if (bits == 0)
+            return;
+        std::size_t at = index.size();
+        index.resize(at + json_scan::count_bits(bits));
+        std::uint32_t* out = index.data();
+        do
+        {
+            out[at++] = static_cast<std::uint32_t>(base + json_scan::first_set_bit(bits));
+            bits &= bits - 1;
+        } while (bits != 0);
+    };
+
+    std::size_t offset = 0;
+    for (; text.size() - offset >= 64; offset += 64)
+        emit(json_scan::structurals(json_scan::classify(text.data() + offset), state), offset);
+
+    if (offset < text.size())
+    {
+        char tail[64];
+        std::memset(tail, ' ', sizeof(tail));
+        std::memcpy(tail, text.data() + offset, text.size() - offset);
+        emit(json_scan::structurals(json_scan::classify(tail), state), offset);
+    }
+    return state.in_string == 0;
+}
+
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_JSON_INDEX_HPP
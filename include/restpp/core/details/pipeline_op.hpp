@@ -0,0 +1,307 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * HTTP/1.1 pipelining of several requests over one keep-alive connection.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_PIPELINE_OP_HPP
+#define RESTPP_PIPELINE_OP_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/asio/coroutine.hpp>
+
+#include <restpp/core/options.hpp>
+#include <restpp/core/response.hpp>
+#include <restpp/core/uri.hpp>
+#include <restpp/core/details/connection_pool.hpp>
+#include <restpp/core/details/content_decoder.hpp>
+#include <restpp/core/details/fetch_op.hpp>
+#include <restpp/core/details/fetch_watch.hpp>
+#include <restpp/core/details/http_parser.hpp>
+
+namespace restpp
+{
+namespace details
+{
+/// <summary>
+/// Whether requests made with these options may be pipelined: only bodiless GET and HEAD
+/// requests, which are safe to send again should the connection be lost before they were
+/// answered, and whose responses are collected into the response itself. Requests with
+/// timeouts, a deadline or an abort signal are sent on their own, as a pipeline cannot give up on
+/// one of its requests without losing the ones behind it.
+/// </summary>
+inline bool is_pipelinable(const options& _options)
+{
+    return (_options.method == "GET" || _options.method == "HEAD") && !_options.body && !_options.sink &&
+           _options.chunk_size != 0 && !fetch_watch::needed(_options);
+}
+
+/// <summary>
+/// Requests sent back to back over a pooled connection, and the responses read back in order.
+/// </summary>
+struct pipeline_state
+{
+    using response_handler = std::function<void(std::size_t index, response res)>;
+
+    pipeline_state(connection_pool& pool,
+                   decoder_pool* decoders,
+                   connection_key key,
+                   std::unique_ptr<connection> conn,
+                   const options& opts,
+                   std::vector<const uri*> targets,
+                   response_handler on_response)
+        : pool(pool)
+        , decoders(decoders)
+        , key(std::move(key))
+        , conn(std::move(conn))
+        , opts(opts)
+        , targets(std::move(targets))
+        , on_response(std::move(on_response))
+    {
+    }
+
+    connection_pool& pool;
+    decoder_pool* decoders;
+    connection_key key;
+    std::unique_ptr<connection> conn;
+    const options& opts;
+    std::vector<const uri*> targets;
+    response_handler on_response;
+
+    std::string requests;
+    std::string head;
+    std::vector<std::size_t> request_sizes;
+
+    /// <summary>
+    /// When the pipeline started, how long writing it took, and when the response being read
+    /// started to be waited for.
+    /// </summary>
+    std::chrono::steady_clock::time_point started;
+    std::chrono::steady_clock::duration written{};
+    std::chrono::steady_clock::time_point waiting;
+    std::size_t completed = 0;
+    response_parser parser;
+    response res;
+    content_decoder decoder;
+    std::string decoded;
+};
+
+/// <summary>
+/// Composed operation writing every request of a pipeline in a single write, then reading the
+/// responses as they come and handing each one over as soon as it is complete. Completes with
+/// <c>void(boost::system::error_code, std::size_t completed)</c>; the requests past
+/// <c>completed</c> were not answered, either because of the error or because the server
+/// closed the connection after the last answered one.
+/// </summary>
+class pipeline_op : boost::asio::coroutine
+{
+public:
+    explicit pipeline_op(std::unique_ptr<pipeline_state> state) : _state(std::move(state)) {}
+
+    template<typename Self>
+    void operator()(Self& self, boost::system::error_code ec = {}, std::size_t bytes_transferred = 0)
+    {
+        pipeline_state& s = *_state;
+
+        BOOST_ASIO_CORO_REENTER(*this)
+        {
+            s.started = std::chrono::steady_clock::now();
+            for (const uri* target : s.targets)
+            {
+                build_request(s.head, *target, s.opts, true);
+                s.requests.append(s.head);
+                s.request_sizes.push_back(s.head.size());
+            }
+
+            BOOST_ASIO_CORO_YIELD boost::asio::async_write(*s.conn, boost::asio::buffer(s.requests), std::move(self));
+            if (ec)
+                return complete(self, ec);
+            s.waiting = std::chrono::steady_clock::now();
+            s.written = s.waiting - s.started;
+
+            while (s.completed < s.targets.size())
+            {
+                s.res = {};
+                s.parser.reset(s.opts.method == "HEAD");
+                for (;;)
+                {
+                    parse_buffered(ec);
+                    if (ec || s.parser.is_done())
+                        break;
+
+                    if (s.parser.body_remaining() != 0)
+                    {
+                        bytes_transferred = s.res.body.size();
+                        grow_body(s.res.body, s.parser.body_remaining(), s.opts.max_body_size, ec);
+                        if (ec)
+                            break;
+                        BOOST_ASIO_CORO_YIELD boost::asio::async_read(
+                            *s.conn,
+                            boost::asio::buffer(&s.res.body[bytes_transferred], s.res.body.size() - bytes_transferred),
+                            std::move(self));
+                        if (ec)
+                            break;
+                        s.res.timings.bytes_received += bytes_transferred;
+                        s.parser.skip_body(bytes_transferred);
+                        continue;
+                    }
+
+                    BOOST_ASIO_CORO_YIELD s.conn->async_read_some(
+                        s.conn->buffer().prepare(s.opts.chunk_size), std::move(self));
+                    if (ec)
+                        break;
+                    s.conn->buffer().commit(bytes_transferred);
+                }
+
+                if (is_end_of_stream(ec))
+                {
+                    ec = {};
+                    s.parser.finish(ec);
+                }
+                if (!ec)
+                    decode_body(ec);
+                if (ec)
+                    return complete(self, ec);
+
+                s.res.alpn = s.conn->alpn();
+                s.res.tls_resumed = s.conn->tls_resumed();
+                finish_timings();
+
+                // Done with the connection before the last response is handed over, after which
+                // the pool may go away with its client. The server may also have answered its
+                // last request on this connection.
+                bytes_transferred = s.completed++;
+                if (s.completed == s.targets.size() && s.parser.keep_alive())
+                {
+                    s.conn->set_pipelinable(s.parser.version_minor() >= 1);
+                    s.pool.release(s.key, std::move(s.conn));
+                }
+                else if (s.completed == s.targets.size() || !s.parser.keep_alive())
+                {
+                    s.conn->close();
+                    s.conn.reset();
+                }
+
+                s.on_response(bytes_transferred, std::move(s.res));
+                if (!s.conn)
+                    break;
+            }
+            complete(self, {});
+        }
+    }
+
+private:
+    void parse_buffered(boost::system::error_code& ec)
+    {
+        pipeline_state& s = *_state;
+        auto& buffer = s.conn->buffer();
+        const bool had_head = s.parser.is_head_done();
+
+        boost::system::error_code body_ec;
+        const std::size_t used = s.parser.parse(buffer.data(), buffer.size(), ec, [&](std::string_view data) {
+            return append_body(s.res.body, data, s.opts.max_body_size, body_ec);
+        });
+        if (body_ec)
+            ec = body_ec;
+        s.res.timings.bytes_received += used;
+        if (!ec && !had_head && s.parser.is_head_done())
+        {
+            take_head(s.parser, s.res, true);
+            const auto now = std::chrono::steady_clock::now();
+            s.res.timings.first_byte = now - s.waiting;
+            s.waiting = now;
+        }
+
+        // Whatever follows the end of this response belongs to the next one
+        buffer.consume(used);
+    }
+
+    /// <summary>
+    /// Fills in the timings of a response read whole. The requests of a pipeline share its
+    /// write, and each waits for its head from the end of the response before it.
+    /// </summary>
+    void finish_timings()
+    {
+        pipeline_state& s = *_state;
+        const auto now = std::chrono::steady_clock::now();
+        auto& timings = s.res.timings;
+        timings.write = s.written;
+        timings.transfer = now - s.waiting;
+        timings.total = now - s.started;
+        timings.bytes_sent = s.request_sizes[s.completed];
+        timings.reused_connection = true;
+        s.waiting = now;
+    }
+
+    /// <summary>
+    /// Decodes a compressed body once it was read whole; pipelined bodies are collected into the
+    /// response anyway. The decoded body is held to <c>max_body_size</c> as it grows, as the
+    /// compressed one was.
+    /// </summary>
+    void decode_body(boost::system::error_code& ec)
+    {
+        pipeline_state& s = *_state;
+        if (!s.opts.decode_content || s.opts.method == "HEAD")
+            return;
+        const auto coding = s.res.headers.get(field::content_encoding);
+        if (!coding)
+            return;
+        s.decoder.start(parse_content_coding(*coding), s.decoders, s.opts.chunk_size);
+        if (!s.decoder)
+            return;
+
+        s.decoded.clear();
+        s.decoder.feed(s.res.body);
+        std::string_view piece;
+        while (s.decoder.next(piece, ec))
+        {
+            if (!append_body(s.decoded, piece, s.opts.max_body_size, ec))
+                break;
+        }
+        if (!ec)
+            s.decoder.finish(ec);
+        s.decoder.reset();
+        if (!ec)
+            s.res.body.swap(s.decoded);
+    }
+
+    template<typename Self>
+    void complete(Self& self, const boost::system::error_code& ec)
+    {
+        if (_state->conn)
+            _state->conn->close();
+        const std::size_t completed = _state->completed;
+        _state.reset();
+        self.complete(ec, completed);
+    }
+
+    std::unique_ptr<pipeline_state> _state;
+};
+
+template<typename CompletionToken>
+auto async_pipeline(boost::asio::io_context& io_context, std::unique_ptr<pipeline_state> state, CompletionToken&& token)
+{
+    return boost::asio::async_compose<CompletionToken, void(boost::system::error_code, std::size_t)>(
+        pipeline_op(std::move(state)), token, io_context.get_executor());
+}
+
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_PIPELINE_OP_HPP
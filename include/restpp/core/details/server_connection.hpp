@@ -0,0 +1,600 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * A connection accepted by the embedded server, serving its requests one after the other.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_SERVER_CONNECTION_HPP
+#define RESTPP_SERVER_CONNECTION_HPP
+
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include <restpp/core/error.hpp>
+#include <restpp/core/server_config.hpp>
+#include <restpp/core/server_request.hpp>
+#include <restpp/core/server_response.hpp>
+#include <restpp/core/details/flat_buffer.hpp>
+#include <restpp/core/details/http_date.hpp>
+#include <restpp/core/details/http_parser.hpp>
+
+namespace restpp
+{
+namespace details
+{
+/// <summary>
+/// The reason phrase sent along with a status code.
+/// </summary>
+inline std::string_view reason_phrase(int status_code)
+{
+    switch (status_code)
+    {
+        case 100: return "Continue";
+        case 101: return "Switching Protocols";
+        case 200: return "OK";
+        case 201: return "Created";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 206: return "Partial Content";
+        case 301: return "Moved Permanently";
+        case 302: return "Found";
+        case 303: return "See Other";
+        case 304: return "Not Modified";
+        case 307: return "Temporary Redirect";
+        case 308: return "Permanent Redirect";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 406: return "Not Acceptable";
+        case 408: return "Request Timeout";
+        case 409: return "Conflict";
+        case 410: return "Gone";
+        case 411: return "Length Required";
+        case 412: return "Precondition Failed";
+        case 413: return "Content Too Large";
+        case 414: return "URI Too Long";
+        case 415: return "Unsupported Media Type";
+        case 416: return "Range Not Satisfiable";
+        case 417: return "Expectation Failed";
+        case 422: return "Unprocessable Content";
+        case 429: return "Too Many Requests";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        default: return "";
+    }
+}
+
+class server_connection;
+
+/// <summary>
+/// The settings and handler of a server, shared with its connections so that those still
+/// winding down after the server went away can use them.
+/// </summary>
+struct server_state
+{
+    server_config config;
+    request_handler handler;
+};
+
+/// <summary>
+/// The connections a server serves on one I/O context. Only used on that context.
+/// </summary>
+struct server_shard
+{
+    server_shard(boost::asio::io_context& io_context, std::shared_ptr<const server_state> state)
+        : io_context(io_context), state(std::move(state))
+    {
+    }
+
+    boost::asio::io_context& io_context;
+    std::shared_ptr<const server_state> state;
+    std::unordered_set<server_connection*> connections;
+    bool stopping = false;
+};
+
+/// <summary>
+/// Reads the requests of a connection, hands them to the handler and writes back the responses,
+/// in order, until either side closes the connection. Pipelined requests are served from the
+/// bytes already received without waiting for the socket.
+///
+/// The connection lives on the I/O context of its shard. Deferred and streamed responses may be
+/// completed from other threads, which hand their work over to that context.
+/// </summary>
+class server_connection : public response_channel, public std::enable_shared_from_this<server_connection>
+{
+public:
+    server_connection(std::shared_ptr<server_shard> shard, boost::asio::ip::tcp::socket socket)
+        : _shard(std::move(shard))
+        , _state(_shard->state)
+        , _socket(std::move(socket))
+        , _timer(_socket.get_executor())
+        , _parser(_state->config.max_head_size)
+    {
+        _response._channel = this;
+    }
+
+    /// <summary>
+    /// Starts serving the requests of the connection, on the I/O context of its shard.
+    /// </summary>
+    void start()
+    {
+        _shard->connections.insert(this);
+        boost::system::error_code ignored;
+        _socket.set_option(boost::asio::ip::tcp::no_delay(true), ignored);
+        _request.remote_endpoint = _socket.remote_endpoint(ignored);
+        read_request();
+    }
+
+    /// <summary>
+    /// Closes the connection, failing any piece of body waiting to be sent.
+    /// </summary>
+    void close()
+    {
+        if (_closed)
+            return;
+        const auto self = shared_from_this();
+        _closed = true;
+        _shard->connections.erase(this);
+
+        boost::system::error_code ignored;
+        _timer.cancel();
+        _socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignored);
+        _socket.close(ignored);
+
+        if (_piece_done)
+        {
+            auto done = std::move(_piece_done);
+            _piece_done = nullptr;
+            if (!_writing)
+                done(boost::asio::error::operation_aborted);
+        }
+    }
+
+    std::shared_ptr<response_channel> hold() override { return shared_from_this(); }
+
+    void resume() override
+    {
+        // Posted, so that a handler completing its own deferred response sees it sent after it returned
+        boost::asio::post(_socket.get_executor(), [self = shared_from_this()] {
+            if (!self->_closed && self->_deferred)
+                self->send();
+        });
+    }
+
+    void write(std::string_view data, std::function<void(boost::system::error_code)> done) override
+    {
+        boost::asio::dispatch(_socket.get_executor(), [self = shared_from_this(), data, done = std::move(done)]() mutable {
+            if (self->_closed)
+                return done(boost::asio::error::operation_aborted);
+            self->_piece = data;
+            self->_piece_done = std::move(done);
+            self->flush();
+        });
+    }
+
+    void end() override
+    {
+        boost::asio::dispatch(_socket.get_executor(), [self = shared_from_this()] {
+            if (self->_closed)
+                return;
+            self->_ending = true;
+            self->flush();
+        });
+    }
+
+private:
+    /// <summary>
+    /// Serves the next request, from the bytes already received if it is complete, or once
+    /// enough have been read.
+    /// </summary>
+    void read_request()
+    {
+        if (_buffer.size() != 0 && parse())
+            return;
+        wait_for_data();
+    }
+
+    void wait_for_data()
+    {
+        const auto& config = _state->config;
+        if (_buffer.size() == 0 && !_parser.is_head_done())
+        {
+            if (!_timing_request)
+                arm(config.idle_timeout);
+        }
+        else if (!_timing_request)
+        {
+            // From the first bytes of a request, the whole request must arrive in time
+            _timing_request = true;
+            arm(config.request_timeout);
+        }
+
+        _socket.async_read_some(_buffer.prepare(read_size),
+                                [self = shared_from_this()](const boost::system::error_code& ec, std::size_t n) {
+                                    self->on_read(ec, n);
+                                });
+    }
+
+    void on_read(const boost::system::error_code& ec, std::size_t n)
+    {
+        if (_closed)
+            return;
+        if (ec)
+            return close();
+
+        _buffer.commit(n);
+        if (!parse())
+            wait_for_data();
+    }
+
+    /// <summary>
+    /// Parses the bytes received so far.
+    /// </summary>
+    /// <returns>Whether the connection moved on, to serving the request or refusing it; false
+    /// when more bytes are needed.</returns>
+    bool parse()
+    {
+        const auto& config = _state->config;
+        const bool had_head = _parser.is_head_done();
+        bool too_large = false;
+        boost::system::error_code ec;
+        const std::size_t used = _parser.parse(_buffer.data(), _buffer.size(), ec, [&](std::string_view data) {
+            if (_request.body.size() + data.size() > config.max_body_size)
+            {
+                too_large = true;
+                return false;
+            }
+            _request.body.append(data);
+            return true;
+        });
+
+        // The views of the head point into the buffer, which is about to change
+        if (!ec && !had_head && _parser.is_head_done())
+            take_head();
+        _buffer.consume(used);
+
+        if (ec)
+            return refuse(ec == error::header_too_large ? 431 : 400);
+        if (too_large ||
+            (_parser.framing() == body_framing::content_length && _parser.content_length() > config.max_body_size))
+            return refuse(413);
+        if (_parser.is_done())
+        {
+            dispatch();
+            return true;
+        }
+
+        if (_parser.is_head_done() && _parser.expect_continue() && !_continue_sent && _buffer.size() == 0)
+        {
+            _continue_sent = true;
+            arm(config.request_timeout);
+            boost::asio::async_write(_socket, boost::asio::buffer(continue_line),
+                                     [self = shared_from_this()](const boost::system::error_code& ec, std::size_t) {
+                                         if (self->_closed)
+                                             return;
+                                         if (ec)
+                                             return self->close();
+                                         self->wait_for_data();
+                                     });
+            return true;
+        }
+        return false;
+    }
+
+    void take_head()
+    {
+        _request.method.assign(_parser.method());
+        _request.target.assign(_parser.target());
+        _request.version_minor = _parser.version_minor();
+
+        const auto& fields = _parser.fields();
+        _request.headers.reserve(fields.size(), _parser.header_block().size());
+        for (const auto& f : fields)
+            _request.headers.add(f.name, f.value);
+
+        if (_parser.framing() == body_framing::content_length &&
+            _parser.content_length() <= _state->config.max_body_size)
+            _request.body.reserve(static_cast<std::size_t>(_parser.content_length()));
+    }
+
+    /// <summary>
+    /// Answers a request that cannot be served with an error status, then closes the connection.
+    /// </summary>
+    bool refuse(int status_code)
+    {
+        _timing_request = false;
+        _keep_alive = false;
+        _response.clear();
+        _response.status_code = status_code;
+        send();
+        return true;
+    }
+
+    void dispatch()
+    {
+        const auto& config = _state->config;
+        ++_served;
+        _timing_request = false;
+        _keep_alive = _parser.keep_alive() && !_shard->stopping &&
+                      (config.max_requests_per_connection == 0 || _served < config.max_requests_per_connection);
+
+        try
+        {
+            _state->handler(_request, _response);
+        }
+        catch (...)
+        {
+            if (_response.is_deferred() || _response.is_streamed())
+                return close();
+            _response.clear();
+            _response.status_code = 500;
+        }
+
+        if (_response.is_deferred())
+        {
+            _deferred = true;
+            _timer.cancel();
+            return;
+        }
+        send();
+    }
+
+    /// <summary>
+    /// Writes the response, or the head of a streamed one.
+    /// </summary>
+    void send()
+    {
+        _deferred = false;
+        const bool head_only = _request.method == "HEAD";
+        const bool streamed = _response.is_streamed();
+        if (streamed && _request.version_minor == 0)
+            _keep_alive = false;
+        if (has_token(_response.headers.get(field::connection).value_or(std::string_view()), "close"))
+            _keep_alive = false;
+        write_head(head_only);
+
+        arm(_state->config.request_timeout);
+        if (streamed)
+        {
+            _writing = true;
+            boost::asio::async_write(_socket, boost::asio::buffer(_head),
+                                     [self = shared_from_this()](const boost::system::error_code& ec, std::size_t) {
+                                         self->_writing = false;
+                                         if (self->_closed)
+                                             return;
+                                         if (ec)
+                                             return self->close();
+                                         self->_head_sent = true;
+                                         self->flush();
+                                     });
+            return;
+        }
+
+        const std::array<boost::asio::const_buffer, 2> buffers = {
+            boost::asio::buffer(_head),
+            head_only || !has_body() ? boost::asio::const_buffer() : boost::asio::buffer(_response.body)};
+        boost::asio::async_write(_socket, buffers,
+                                 [self = shared_from_this()](const boost::system::error_code& ec, std::size_t) {
+                                     self->on_sent(ec);
+                                 });
+    }
+
+    /// <summary>
+    /// Writes the piece of a streamed body waiting to be sent, or ends the body once asked to and
+    /// the last piece went out.
+    /// </summary>
+    void flush()
+    {
+        if (_writing || !_head_sent)
+            return;
+
+        const bool raw = _request.version_minor == 0;
+        const bool discard = _request.method == "HEAD" || !has_body();
+        if (_piece_done)
+        {
+            if (_piece.empty() || discard)
+            {
+                auto done = std::move(_piece_done);
+                _piece_done = nullptr;
+                return done({});
+            }
+
+            const auto end = std::to_chars(_chunk_head, _chunk_head + sizeof(_chunk_head) - 2, _piece.size(), 16).ptr;
+            end[0] = '\r';
+            end[1] = '\n';
+            std::array<boost::asio::const_buffer, 3> buffers = {
+                boost::asio::buffer(_chunk_head, static_cast<std::size_t>(end + 2 - _chunk_head)),
+                boost::asio::buffer(_piece.data(), _piece.size()), boost::asio::buffer("\r\n", 2)};
+            if (raw)
+                buffers[0] = buffers[2] = boost::asio::const_buffer();
+
+            _writing = true;
+            arm(_state->config.request_timeout);
+            boost::asio::async_write(_socket, buffers,
+                                     [self = shared_from_this()](const boost::system::error_code& ec, std::size_t) {
+                                         self->_writing = false;
+                                         auto done = std::move(self->_piece_done);
+                                         self->_piece_done = nullptr;
+                                         if (ec)
+                                             self->close();
+                                         done(ec);
+                                         if (!ec)
+                                             self->flush();
+                                     });
+            return;
+        }
+
+        if (!_ending)
+            return;
+        _ending = false;
+        _head_sent = false;
+        if (raw || discard)
+            return on_sent({});
+
+        _writing = true;
+        boost::asio::async_write(_socket, boost::asio::buffer(last_chunk),
+                                 [self = shared_from_this()](const boost::system::error_code& ec, std::size_t) {
+                                     self->_writing = false;
+                                     self->on_sent(ec);
+                                 });
+    }
+
+    /// <summary>
+    /// Moves on to the next request once a response was written.
+    /// </summary>
+    void on_sent(const boost::system::error_code& ec)
+    {
+        if (_closed)
+            return;
+        if (ec || !_keep_alive)
+            return close();
+
+        _timer.cancel();
+        _request.method.clear();
+        _request.target.clear();
+        _request.headers.clear();
+        _request.body.clear();
+        _request.params.clear();
+        _response.clear();
+        _parser.reset();
+        _continue_sent = false;
+
+        // Storage that grew for a large message is given back rather than kept for the connection
+        if (_request.body.capacity() > retained_body_size)
+            std::string().swap(_request.body);
+        if (_response.body.capacity() > retained_body_size)
+            std::string().swap(_response.body);
+
+        read_request();
+    }
+
+    /// <summary>
+    /// Whether a response with the current status carries a body.
+    /// </summary>
+    bool has_body() const
+    {
+        const int status = _response.status_code;
+        return status >= 200 && status != 204 && status != 304;
+    }
+
+    void write_head(bool head_only)
+    {
+        const auto& config = _state->config;
+        const auto& fields = _response.headers;
+
+        char digits[24];
+        const int status = _response.status_code;
+        _head.assign("HTTP/1.1 ");
+        _head.append(digits, std::to_chars(digits, digits + sizeof(digits), status).ptr);
+        _head.append(" ").append(reason_phrase(status)).append("\r\n");
+
+        if (!config.server_name.empty() && !fields.contains(field::server))
+            _head.append("Server: ").append(config.server_name).append("\r\n");
+        if (!fields.contains(field::date))
+            _head.append("Date: ").append(current_http_date()).append("\r\n");
+
+        for (std::size_t i = 0; i < fields.size(); ++i)
+        {
+            const field id = fields.id_at(i);
+            if (id == field::transfer_encoding || id == field::connection ||
+                (id == field::content_length && !head_only))
+                continue;
+            const auto line = fields.at(i);
+            _head.append(line.first).append(": ").append(line.second).append("\r\n");
+        }
+
+        if (has_body())
+        {
+            if (_response.is_streamed())
+            {
+                if (_request.version_minor >= 1)
+                    _head.append("Transfer-Encoding: chunked\r\n");
+            }
+            else if (!head_only || !fields.contains(field::content_length))
+            {
+                _head.append("Content-Length: ");
+                _head.append(digits, std::to_chars(digits, digits + sizeof(digits), _response.body.size()).ptr);
+                _head.append("\r\n");
+            }
+        }
+
+        if (!_keep_alive)
+            _head.append("Connection: close\r\n");
+        else if (_request.version_minor == 0)
+            _head.append("Connection: keep-alive\r\n");
+        _head.append("\r\n");
+    }
+
+    /// <summary>
+    /// Closes the connection if it is still waiting on the client after the given time.
+    /// </summary>
+    void arm(std::chrono::steady_clock::duration timeout)
+    {
+        _timer.expires_after(timeout);
+        _timer.async_wait([self = shared_from_this()](const boost::system::error_code& ec) {
+            // A wait that completed just as the timer was rearmed is not a timeout
+            if (!ec && self->_timer.expiry() <= std::chrono::steady_clock::now())
+                self->close();
+        });
+    }
+
+    static constexpr std::size_t read_size = 16 * 1024;
+    static constexpr std::size_t retained_body_size = 64 * 1024;
+    static constexpr std::string_view continue_line = "HTTP/1.1 100 Continue\r\n\r\n";
+    static constexpr std::string_view last_chunk = "0\r\n\r\n";
+
+    std::shared_ptr<server_shard> _shard;
+    std::shared_ptr<const server_state> _state;
+    boost::asio::ip::tcp::socket _socket;
+    boost::asio::steady_timer _timer;
+    flat_buffer _buffer;
+    request_parser _parser;
+    server_request _request;
+    server_response _response;
+    std::string _head;
+    std::size_t _served = 0;
+    bool _closed = false;
+    bool _keep_alive = false;
+    bool _timing_request = false;
+    bool _continue_sent = false;
+    bool _deferred = false;
+
+    // The piece of a streamed body being sent, and its completion
+    bool _head_sent = false;
+    bool _writing = false;
+    bool _ending = false;
+    std::string_view _piece;
+    std::function<void(boost::system::error_code)> _piece_done;
+    char _chunk_head[20];
+};
+
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_SERVER_CONNECTION_HPP
@@ -0,0 +1,142 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Coalescing of identical requests in flight at the same time into a single one.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_SINGLE_FLIGHT_HPP
+#define RESTPP_SINGLE_FLIGHT_HPP
+
+#include <cctype>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/system/error_code.hpp>
+
+#include <restpp/core/options.hpp>
+#include <restpp/core/response.hpp>
+#include <restpp/core/uri.hpp>
+
+namespace restpp
+{
+namespace details
+{
+/// <summary>
+/// The requests of a client in flight, by what makes them identical, along with everyone waiting
+/// for their response. The first fetch of a key leads: it makes the request, and hands its
+/// response to every fetch that joined meanwhile, the same one to all of them.
+/// </summary>
+class single_flight
+{
+public:
+    using waiter = std::function<void(boost::system::error_code, std::shared_ptr<const response>)>;
+
+    /// <summary>
+    /// Whether a request may share the response of another. Only GET and HEAD requests without a
+    /// body nor a sink do, and not those with a deadline or an abort signal, which belong to the
+    /// caller alone and would otherwise cut short the request of everyone sharing it.
+    /// </summary>
+    static bool eligible(const options& opts)
+    {
+        return (opts.method == "GET" || opts.method == "HEAD") && opts.body.type() == request_body::kind::none &&
+               !opts.sink && !opts.deadline && !opts.signal;
+    }
+
+    /// <summary>
+    /// What identifies a request: its method, URI, headers, whether its body is decoded and
+    /// its timeouts, the latter deciding when the shared request fails. Header names are folded
+    /// to lower case; their order still matters.
+    /// </summary>
+    static std::string make_key(const uri& target, const options& opts)
+    {
+        std::string key;
+        key.reserve(opts.method.size() + target.to_string().size() + 64);
+        key.append(opts.method).append(opts.decode_content ? " +decoded " : " ").append(target.to_string());
+        for (const auto& [name, value] : opts.headers)
+        {
+            key.push_back('\n');
+            for (char c : name)
+                key.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+            key.append(": ").append(value);
+        }
+
+        const auto& t = opts.timeouts;
+        for (auto limit : {t.resolve, t.connect, t.tls_handshake, t.first_byte, t.total})
+            key.append("\n").append(std::to_string(limit.count()));
+        return key;
+    }
+
+    /// <summary>
+    /// Adds a fetch waiting for the response to the request with the given key. Returns true
+    /// when the request is not in flight yet, in which case the caller must make it and
+    /// <c>finish</c> it.
+    /// </summary>
+    bool join(const std::string& key, waiter w)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto [it, leads] = _flights.try_emplace(key);
+        it->second.push_back(std::move(w));
+        return leads;
+    }
+
+    /// <summary>
+    /// Hands the response to the request with the given key to everyone waiting for it. Fetches
+    /// of the key joining from then on make a request of their own.
+    /// </summary>
+    void finish(const std::string& key, boost::system::error_code ec, std::shared_ptr<const response> res)
+    {
+        std::vector<waiter> waiters;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _flights.find(key);
+            if (it == _flights.end())
+                return;
+            waiters = std::move(it->second);
+            _flights.erase(it);
+        }
+        for (auto& w : waiters)
+            w(ec, res);
+    }
+
+    /// <summary>
+    /// Number of requests in flight.
+    /// </summary>
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _flights.size();
+    }
+
+private:
+    mutable std::mutex _mutex;
+    std::unordered_map<std::string, std::vector<waiter>> _flights;
+};
+
+/// <summary>
+/// The response behind a shared one, moved out of it when nobody else holds it, and copied
+/// otherwise.
+/// </summary>
+inline response unshare(std::shared_ptr<const response> res)
+{
+    // Shared responses are created mutable and only handed out as const
+    if (res.use_count() == 1)
+        return std::move(const_cast<response&>(*res));
+    return *res;
+}
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_SINGLE_FLIGHT_HPP
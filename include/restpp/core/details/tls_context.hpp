@@ -0,0 +1,218 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * OpenSSL context shared by the TLS connections of a client, with its session cache.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_TLS_CONTEXT_HPP
+#define RESTPP_TLS_CONTEXT_HPP
+
+#ifndef RESTPP_EXCLUDE_SSL
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <boost/asio/ip/address.hpp>
+#include <boost/asio/ssl.hpp>
+
+#include <restpp/core/tls_config.hpp>
+
+namespace restpp
+{
+namespace details
+{
+/// <summary>
+/// Wraps the <c>boost::asio::ssl::context</c> every TLS connection of a client is created from,
+/// so the certificate store is loaded once, and caches the last session each server handed out.
+///
+/// Sessions are captured through OpenSSL's new-session callback rather than right after the
+/// handshake: TLS 1.3 servers send their tickets after the handshake completed, and they are
+/// only seen once the connection reads application data.
+/// </summary>
+class tls_context
+{
+public:
+    explicit tls_context(const tls_config& config)
+        : _context(boost::asio::ssl::context::tls_client)
+        , _session_resumption(config.session_resumption)
+        , _max_cached_sessions(config.max_cached_sessions)
+    {
+        _context.set_options(boost::asio::ssl::context::default_workarounds | boost::asio::ssl::context::no_sslv2 |
+                             boost::asio::ssl::context::no_sslv3);
+
+        if (config.ca_file.empty())
+            _context.set_default_verify_paths();
+        else
+            _context.load_verify_file(config.ca_file);
+        _context.set_verify_mode(config.verify_peer ? boost::asio::ssl::verify_peer : boost::asio::ssl::verify_none);
+        _verify_peer = config.verify_peer;
+
+        SSL_CTX* native = _context.native_handle();
+        if (!config.alpn.empty())
+        {
+            std::string protocols;
+            for (const auto& protocol : config.alpn)
+                protocols.append(1, static_cast<char>(protocol.size())).append(protocol);
+
+            // Unlike most of OpenSSL, 0 means success here
+            if (SSL_CTX_set_alpn_protos(
+                    native, reinterpret_cast<const unsigned char*>(protocols.data()), static_cast<unsigned>(protocols.size())) != 0)
+            {
+                throw boost::system::system_error(
+                    boost::system::error_code(static_cast<int>(::ERR_get_error()), boost::asio::error::get_ssl_category()),
+                    "SSL_CTX_set_alpn_protos");
+            }
+        }
+
+        if (_session_resumption)
+        {
+            SSL_CTX_set_session_cache_mode(native, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+            SSL_CTX_set_ex_data(native, context_index(), this);
+            SSL_CTX_sess_set_new_cb(native, &tls_context::on_new_session);
+        }
+    }
+
+    tls_context(const tls_context&) = delete;
+    tls_context& operator=(const tls_context&) = delete;
+
+    ~tls_context()
+    {
+        for (auto& entry : _sessions)
+            SSL_SESSION_free(entry.second);
+    }
+
+    boost::asio::ssl::context& context() { return _context; }
+
+    /// <summary>
+    /// Sets up a TLS stream that is about to handshake with the given host: SNI, the host name
+    /// the certificate is verified against and, if there is one, the cached session to resume.
+    /// <c>session_key</c> identifies the server in the cache and must outlive the stream.
+    /// </summary>
+    void prepare(SSL* ssl, const std::string& host, const std::string& session_key, boost::system::error_code& ec)
+    {
+        boost::system::error_code address_ec;
+        boost::asio::ip::make_address(host, address_ec);
+        const bool is_address = !address_ec;
+
+        // Server names are only sent for DNS names, never for IP literals
+        int ok = 1;
+        if (!is_address)
+            ok = static_cast<int>(SSL_set_tlsext_host_name(ssl, host.c_str()));
+        if (ok == 1 && _verify_peer)
+        {
+            ok = is_address ? X509_VERIFY_PARAM_set1_ip_asc(SSL_get0_param(ssl), host.c_str())
+                            : SSL_set1_host(ssl, host.c_str());
+        }
+        if (ok != 1)
+        {
+            ec = boost::system::error_code(static_cast<int>(::ERR_get_error()), boost::asio::error::get_ssl_category());
+            return;
+        }
+
+        if (!_session_resumption)
+            return;
+
+        SSL_set_ex_data(ssl, session_key_index(), const_cast<std::string*>(&session_key));
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _sessions.find(session_key);
+        if (it != _sessions.end())
+            SSL_set_session(ssl, it->second);
+    }
+
+    /// <summary>
+    /// Narrows the ALPN offer of a stream to HTTP/1.1, for requests that cannot be sent over an
+    /// HTTP/2 connection, such as those upgrading it to another protocol.
+    /// </summary>
+    static void offer_http1_only(SSL* ssl)
+    {
+        static constexpr unsigned char protocols[] = {8, 'h', 't', 't', 'p', '/', '1', '.', '1'};
+        SSL_set_alpn_protos(ssl, protocols, sizeof(protocols));
+    }
+
+    /// <summary>
+    /// Number of servers a session is currently cached for.
+    /// </summary>
+    std::size_t cached_sessions() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _sessions.size();
+    }
+
+private:
+    static int context_index()
+    {
+        static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+        return index;
+    }
+
+    static int session_key_index()
+    {
+        static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+        return index;
+    }
+
+    /// <summary>
+    /// Called by OpenSSL for every new session or ticket. Returning 1 keeps the reference.
+    /// </summary>
+    static int on_new_session(SSL* ssl, SSL_SESSION* session)
+    {
+        auto* self = static_cast<tls_context*>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), context_index()));
+        auto* key = static_cast<const std::string*>(SSL_get_ex_data(ssl, session_key_index()));
+        if (!self || !key)
+            return 0;
+
+        std::lock_guard<std::mutex> lock(self->_mutex);
+        auto it = self->_sessions.find(*key);
+        if (it != self->_sessions.end())
+        {
+            SSL_SESSION_free(it->second);
+            it->second = session;
+            return 1;
+        }
+
+        if (self->_max_cached_sessions == 0)
+            return 0;
+        if (self->_sessions.size() >= self->_max_cached_sessions)
+        {
+            SSL_SESSION_free(self->_sessions.begin()->second);
+            self->_sessions.erase(self->_sessions.begin());
+        }
+        self->_sessions.emplace(*key, session);
+        return 1;
+    }
+
+    boost::asio::ssl::context _context;
+    const bool _session_resumption;
+    const std::size_t _max_cached_sessions;
+    bool _verify_peer = true;
+
+    mutable std::mutex _mutex;
+    std::map<std::string, SSL_SESSION*> _sessions;
+};
+
+/// <summary>
+/// The context used by fetches that are not made through a client, created on first use.
+/// </summary>
+inline tls_context& default_tls_context()
+{
+    static tls_context instance{tls_config{}};
+    return instance;
+}
+
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_EXCLUDE_SSL
+
+#endif // RESTPP_TLS_CONTEXT_HPP
@@ -0,0 +1,255 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Character classes of RFC 3986 and fast scanning over them.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_URI_CHARS_HPP
+#define RESTPP_URI_CHARS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RESTPP_URI_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace restpp
+{
+namespace details
+{
+/// <summary>
+/// Bit flags of the character classes every URI component is made of. An octet belongs to
+/// a class when <c>uri_char_table[octet]</c> has the corresponding bit set.
+///
+/// The component classes do not contain '%': it is legal in an encoded component, as the
+/// start of an escape, but must itself be escaped when encoding. Parsers test for
+/// <c>uri_percent</c> along with the component class.
+/// </summary>
+enum uri_char_class : std::uint16_t
+{
+    uri_unreserved = 1 << 0,
+    uri_gen_delim = 1 << 1,
+    uri_sub_delim = 1 << 2,
+    uri_scheme = 1 << 3,
+    uri_user_info = 1 << 4,
+    uri_authority = 1 << 5,
+    uri_path = 1 << 6,
+    uri_query = 1 << 7,
+    uri_percent = 1 << 8,
+
+    // The fragment has the same set of legal characters as the query
+    uri_fragment = uri_query
+};
+
+struct uri_char_table_t
+{
+    std::uint16_t classes[256] = {};
+
+    constexpr std::uint16_t operator[](unsigned char c) const { return classes[c]; }
+};
+
+constexpr bool is_one_of(const char* set, int c)
+{
+    for (; *set != '\0'; ++set)
+    {
+        if (*set == c)
+            return true;
+    }
+    return false;
+}
+
+constexpr uri_char_table_t make_uri_char_table()
+{
+    uri_char_table_t table;
+    for (int c = 0; c < 256; ++c)
+    {
+        const bool alnum = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+        const bool unreserved = alnum || is_one_of("-._~", c);
+        const bool sub_delim = is_one_of("!$&'()*+,;=", c);
+        const bool path = unreserved || sub_delim || is_one_of("/:@", c);
+
+        std::uint16_t classes = 0;
+        if (unreserved)
+            classes |= uri_unreserved;
+        if (is_one_of(":/?#[]@", c))
+            classes |= uri_gen_delim;
+        if (sub_delim)
+            classes |= uri_sub_delim;
+        if (alnum || is_one_of("+-.", c))
+            classes |= uri_scheme;
+        if (unreserved || sub_delim || c == ':')
+            classes |= uri_user_info;
+        if (unreserved || sub_delim || is_one_of("@:[]", c))
+            classes |= uri_authority;
+        if (path)
+            classes |= uri_path;
+        if (path || c == '?')
+            classes |= uri_query;
+        if (c == '%')
+            classes |= uri_percent;
+        table.classes[c] = classes;
+    }
+    return table;
+}
+
+inline constexpr uri_char_table_t uri_char_table = make_uri_char_table();
+
+/// <summary>
+/// Tells whether the code unit belongs to any of the given classes. Code units outside of
+/// the octet range never do.
+/// </summary>
+template<typename CharT>
+constexpr bool is_uri_char(CharT c, std::uint16_t classes)
+{
+    using unsigned_t = std::make_unsigned_t<CharT>;
+    const auto u = static_cast<unsigned_t>(c);
+    return u <= 0xFF && (uri_char_table[static_cast<unsigned char>(u)] & classes) != 0;
+}
+
+namespace uri_scan
+{
+inline unsigned first_set_bit(std::uint32_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+#if defined(__AVX2__)
+constexpr std::size_t width = 32;
+
+/// <summary>
+/// Bit i is set when byte i of the block is an ASCII letter or digit.
+/// </summary>
+inline std::uint32_t alnum_mask(const char* p)
+{
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    // Folding upper case onto lower case leaves digits untouched, and bytes over 0x7F are
+    // negative so they fail every signed comparison below
+    const __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    const __m256i digit =
+        _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+    const __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                                           _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower));
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(digit, alpha)));
+}
+
+constexpr std::uint32_t all_alnum = 0xFFFFFFFFu;
+#elif defined(RESTPP_URI_SSE2)
+constexpr std::size_t width = 16;
+
+inline std::uint32_t alnum_mask(const char* p)
+{
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    const __m128i alpha =
+        _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_or_si128(digit, alpha)));
+}
+
+constexpr std::uint32_t all_alnum = 0xFFFFu;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+constexpr std::size_t width = 16;
+
+inline std::uint32_t alnum_mask(const char* p)
+{
+    const uint8x16_t v = vld1q_u8(reinterpret_cast<const std::uint8_t*>(p));
+    const uint8x16_t lower = vorrq_u8(v, vdupq_n_u8(0x20));
+    const uint8x16_t digit = vandq_u8(vcgeq_u8(v, vdupq_n_u8('0')), vcleq_u8(v, vdupq_n_u8('9')));
+    const uint8x16_t alpha = vandq_u8(vcgeq_u8(lower, vdupq_n_u8('a')), vcleq_u8(lower, vdupq_n_u8('z')));
+    const uint8x16_t alnum = vorrq_u8(digit, alpha);
+
+    // NEON has no byte movemask; the common case of a block made only of letters and digits
+    // is answered with one reduction, the rest is spelled out bit by bit
+    if (vminvq_u8(alnum) == 0xFF)
+        return 0xFFFFu;
+
+    std::uint8_t bytes[16];
+    vst1q_u8(bytes, alnum);
+    std::uint32_t mask = 0;
+    for (unsigned i = 0; i < 16; ++i)
+        mask |= static_cast<std::uint32_t>(bytes[i] & 1) << i;
+    return mask;
+}
+
+constexpr std::uint32_t all_alnum = 0xFFFFu;
+#else
+constexpr std::size_t width = 0;
+#endif
+} // namespace uri_scan
+
+/// <summary>
+/// Returns the first code unit of [begin, end) that belongs to none of the given classes,
+/// or <c>end</c>.
+/// </summary>
+template<typename CharT>
+const CharT* scan_uri_chars(const CharT* begin, const CharT* end, std::uint16_t classes)
+{
+    for (; begin != end && is_uri_char(*begin, classes); ++begin)
+    {
+    }
+    return begin;
+}
+
+/// <summary>
+/// Narrow string specialization. Every class but the delimiters contains all letters and
+/// digits, which make up most of any URI; whole blocks of them are skipped with vector
+/// compares and only the remaining octets go through the table.
+/// </summary>
+inline const char* scan_uri_chars(const char* begin, const char* end, std::uint16_t classes)
+{
+#if defined(__AVX2__) || defined(RESTPP_URI_SSE2) || (defined(__ARM_NEON) && defined(__aarch64__))
+    if ((uri_char_table['a'] & uri_char_table['A'] & uri_char_table['0'] & classes) != 0)
+    {
+        while (static_cast<std::size_t>(end - begin) >= uri_scan::width)
+        {
+            const std::uint32_t mask = uri_scan::alnum_mask(begin);
+            if (mask == uri_scan::all_alnum)
+            {
+                begin += uri_scan::width;
+                continue;
+            }
+
+            // Check the first octet that is not a letter or digit against the table; if it
+            // belongs to the classes, keep scanning right after it
+            begin += uri_scan::first_set_bit(~mask);
+            if (!is_uri_char(*begin, classes))
+                return begin;
+            ++begin;
+        }
+    }
+#endif
+    for (; begin != end && is_uri_char(*begin, classes); ++begin)
+    {
+    }
+    return begin;
+}
+
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_URI_CHARS_HPP
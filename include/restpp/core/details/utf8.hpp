@@ -0,0 +1,115 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * UTF-8 encoding of code points, shared by the JSON and XML readers.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_UTF8_HPP
+#define RESTPP_UTF8_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace restpp
+{
+namespace details
+{
+inline void append_utf8(std::string& out, std::uint32_t code_point)
+{
+    if (code_point < 0x80)
+        out.push_back(static_cast<char>(code_point));
+    else if (code_point < 0x800)
+    {
+        out.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else if (code_point < 0x10000)
+    {
+        out.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else
+    {
+        out.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+
+/// <summary>
+/// Whether the text is well-formed UTF-8: no overlong forms, surrogates nor code points past
+/// U+10FFFF (RFC 3629). Runs of ASCII are skipped eight bytes at a time.
+/// </summary>
+inline bool is_valid_utf8(std::string_view text)
+{
+    const auto* p = reinterpret_cast<const unsigned char*>(text.data());
+    const auto* end = p + text.size();
+    while (p != end)
+    {
+        if (end - p >= 8)
+        {
+            std::uint64_t word;
+            std::memcpy(&word, p, 8);
+            if ((word & 0x8080808080808080ULL) == 0)
+            {
+                p += 8;
+                continue;
+            }
+        }
+        if (*p < 0x80)
+        {
+            ++p;
+            continue;
+        }
+
+        std::size_t length;
+        unsigned char low = 0x80, high = 0xBF;
+        if (*p >= 0xC2 && *p <= 0xDF)
+            length = 2;
+        else if (*p >= 0xE0 && *p <= 0xEF)
+        {
+            length = 3;
+            if (*p == 0xE0)
+                low = 0xA0;
+            else if (*p == 0xED)
+                high = 0x9F;
+        }
+        else if (*p >= 0xF0 && *p <= 0xF4)
+        {
+            length = 4;
+            if (*p == 0xF0)
+                low = 0x90;
+            else if (*p == 0xF4)
+                high = 0x8F;
+        }
+        else
+            return false;
+
+        if (static_cast<std::size_t>(end - p) < length || p[1] < low || p[1] > high)
+            return false;
+        for (std::size_t i = 2; i < length; ++i)
+        {
+            if ((p[i] & 0xC0) != 0x80)
+                return false;
+        }
+        p += length;
+    }
+    return true;
+}
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_UTF8_HPP
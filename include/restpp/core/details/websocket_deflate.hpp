@@ -0,0 +1,282 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * The permessage-deflate extension of WebSocket (RFC 7692).
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_WEBSOCKET_DEFLATE_HPP
+#define RESTPP_WEBSOCKET_DEFLATE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <boost/system/error_code.hpp>
+
+#include <restpp/core/error.hpp>
+#include <restpp/core/details/content_decoder.hpp>
+
+namespace restpp
+{
+namespace details
+{
+namespace ws
+{
+/// <summary>
+/// What the server agreed to in its answer to our permessage-deflate offer.
+/// </summary>
+struct deflate_params
+{
+    bool enabled = false;
+    bool server_no_context_takeover = false;
+    bool client_no_context_takeover = false;
+    int server_max_window_bits = 15;
+    int client_max_window_bits = 15;
+};
+
+/// <summary>
+/// The Sec-WebSocket-Extensions offer of a client. Without context takeover each message is
+/// compressed on its own, so neither end keeps a window between messages.
+/// </summary>
+inline std::string deflate_offer(bool context_takeover)
+{
+    std::string offer = "permessage-deflate; client_max_window_bits";
+    if (!context_takeover)
+        offer.append("; client_no_context_takeover; server_no_context_takeover");
+    return offer;
+}
+
+inline std::string_view trim_token(std::string_view text)
+{
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+        text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t'))
+        text.remove_suffix(1);
+    if (text.size() >= 2 && text.front() == '"' && text.back() == '"')
+        text = text.substr(1, text.size() - 2);
+    return text;
+}
+
+/// <summary>
+/// Reads the Sec-WebSocket-Extensions of the handshake response into <c>params</c>. Returns
+/// false when the server answered with an extension or a parameter that was not offered, or
+/// with a value out of range, which fails the connection.
+/// </summary>
+inline bool read_deflate_response(std::string_view value, deflate_params& params)
+{
+    while (!value.empty())
+    {
+        const std::size_t comma = value.find(',');
+        std::string_view extension = value.substr(0, comma);
+        value = comma == std::string_view::npos ? std::string_view() : value.substr(comma + 1);
+
+        std::size_t semicolon = extension.find(';');
+        const std::string_view name = trim_token(extension.substr(0, semicolon));
+        if (name.empty())
+            continue;
+        if (name != "permessage-deflate" || params.enabled)
+            return false;
+        params.enabled = true;
+
+        while (semicolon != std::string_view::npos)
+        {
+            extension = extension.substr(semicolon + 1);
+            semicolon = extension.find(';');
+            const std::string_view param = extension.substr(0, semicolon);
+            const std::size_t equals = param.find('=');
+            const std::string_view key = trim_token(param.substr(0, equals));
+            const std::string_view argument =
+                equals == std::string_view::npos ? std::string_view() : trim_token(param.substr(equals + 1));
+
+            if (key == "server_no_context_takeover" && argument.empty())
+                params.server_no_context_takeover = true;
+            else if (key == "client_no_context_takeover" && argument.empty())
+                params.client_no_context_takeover = true;
+            else if (key == "server_max_window_bits" || key == "client_max_window_bits")
+            {
+                if (argument.size() != 1 && argument.size() != 2)
+                    return false;
+                int bits = 0;
+                for (char c : argument)
+                {
+                    if (c < '0' || c > '9')
+                        return false;
+                    bits = bits * 10 + (c - '0');
+                }
+                if (bits < 8 || bits > 15)
+                    return false;
+                (key.front() == 's' ? params.server_max_window_bits : params.client_max_window_bits) = bits;
+            }
+            else
+                return false;
+        }
+    }
+    return true;
+}
+
+#ifdef RESTPP_HAS_ZLIB
+/// <summary>
+/// Trailer of a sync flush, which a sender strips from every compressed message and the
+/// receiver appends again before inflating its end.
+/// </summary>
+constexpr std::string_view flush_trailer{"\x00\x00\xff\xff", 4};
+
+/// <summary>
+/// Compresses the messages a client sends. With context takeover the window carries over from
+/// one message to the next, which is what makes small, similar messages compress well;
+/// without, the same stream is reset rather than set up again for every message.
+/// </summary>
+class message_deflater
+{
+public:
+    message_deflater() = default;
+    message_deflater(const message_deflater&) = delete;
+    message_deflater& operator=(const message_deflater&) = delete;
+
+    ~message_deflater()
+    {
+        if (_ready)
+            deflateEnd(&_stream);
+    }
+
+    /// <summary>
+    /// Sets the stream up for a window of the given size. zlib cannot produce raw deflate
+    /// for a 256-byte window, so a server asking for 8 bits gets uncompressed messages.
+    /// </summary>
+    bool start(int window_bits, int level, bool reset_each_message)
+    {
+        if (window_bits < 9)
+            return false;
+        _reset = reset_each_message;
+        _ready = deflateInit2(&_stream, level, Z_DEFLATED, -window_bits, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+        return _ready;
+    }
+
+    explicit operator bool() const { return _ready; }
+
+    /// <summary>
+    /// Compresses a whole message into <c>out</c>, without the trailer of the sync flush.
+    /// </summary>
+    bool compress(std::string_view message, std::string& out)
+    {
+        out.clear();
+        _stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(message.data()));
+        _stream.avail_in = static_cast<uInt>(message.size());
+        do
+        {
+            const std::size_t used = out.size();
+            out.resize(used + message.size() / 2 + 64);
+            _stream.next_out = reinterpret_cast<Bytef*>(&out[used]);
+            _stream.avail_out = static_cast<uInt>(out.size() - used);
+            if (deflate(&_stream, Z_SYNC_FLUSH) == Z_STREAM_ERROR)
+                return false;
+            out.resize(out.size() - _stream.avail_out);
+        } while (_stream.avail_in != 0 || _stream.avail_out == 0);
+
+        if (out.size() >= flush_trailer.size() &&
+            std::string_view(out).substr(out.size() - flush_trailer.size()) == flush_trailer)
+            out.resize(out.size() - flush_trailer.size());
+        if (_reset)
+            deflateReset(&_stream);
+        return true;
+    }
+
+private:
+    z_stream _stream{};
+    bool _ready = false;
+    bool _reset = false;
+};
+
+/// <summary>
+/// Inflates the messages the server sends, with an inflate stream taken from the decoder pool
+/// of the client and handed back when the connection goes away. Messages are inflated with the
+/// largest window, which covers whatever the server compressed with.
+/// </summary>
+class message_inflater
+{
+public:
+    message_inflater() = default;
+    message_inflater(const message_inflater&) = delete;
+    message_inflater& operator=(const message_inflater&) = delete;
+
+    ~message_inflater()
+    {
+        if (_inflater && _pool)
+            _pool->give_back(std::move(_inflater));
+    }
+
+    bool start(decoder_pool* pool, bool reset_each_message)
+    {
+        _pool = pool;
+        _reset = reset_each_message;
+        _inflater = pool ? pool->take_inflater() : std::make_unique<zlib_inflater>();
+        return _inflater->ready && inflateReset2(&_inflater->stream, -15) == Z_OK;
+    }
+
+    explicit operator bool() const { return _inflater != nullptr; }
+
+    /// <summary>
+    /// Inflates a piece of a compressed message onto the end of <c>out</c>; the last piece is
+    /// followed by <c>finish</c>. Fails with <c>message_too_large</c> once <c>out</c> outgrows
+    /// <c>limit</c>, having inflated at most a step past it.
+    /// </summary>
+    void feed(std::string_view piece, std::string& out, std::size_t limit, boost::system::error_code& ec)
+    {
+        z_stream& z = _inflater->stream;
+        z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(piece.data()));
+        z.avail_in = static_cast<uInt>(piece.size());
+        while (z.avail_in != 0)
+        {
+            const std::size_t used = out.size();
+            out.resize(used + std::max<std::size_t>(piece.size() * 2, 4096));
+            z.next_out = reinterpret_cast<Bytef*>(&out[used]);
+            z.avail_out = static_cast<uInt>(out.size() - used);
+            const int rc = inflate(&z, Z_SYNC_FLUSH);
+            out.resize(out.size() - z.avail_out);
+            if (out.size() > limit)
+            {
+                ec = error::message_too_large;
+                return;
+            }
+
+            // A sender may end a message with a final block, and start the next one afresh
+            if (rc == Z_STREAM_END)
+                inflateReset2(&z, -15);
+            else if (rc != Z_OK && rc != Z_BUF_ERROR)
+            {
+                ec = error::decoding_failed;
+                return;
+            }
+            else if (rc == Z_BUF_ERROR && z.avail_out != 0)
+                break;
+        }
+    }
+
+    void finish(std::string& out, std::size_t limit, boost::system::error_code& ec)
+    {
+        feed(flush_trailer, out, limit, ec);
+        if (!ec && _reset)
+            inflateReset2(&_inflater->stream, -15);
+    }
+
+private:
+    decoder_pool* _pool = nullptr;
+    std::unique_ptr<zlib_inflater> _inflater;
+    bool _reset = false;
+};
+#endif
+} // namespace ws
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_WEBSOCKET_DEFLATE_HPP
@@ -0,0 +1,318 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * WebSocket frames (RFC 6455, section 5) and the keys of the opening handshake.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_WEBSOCKET_FRAME_HPP
+#define RESTPP_WEBSOCKET_FRAME_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+
+#ifndef RESTPP_EXCLUDE_SSL
+#include <openssl/rand.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RESTPP_WEBSOCKET_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace restpp
+{
+namespace details
+{
+namespace ws
+{
+enum opcode : std::uint8_t
+{
+    continuation = 0x0,
+    text = 0x1,
+    binary = 0x2,
+    close = 0x8,
+    ping = 0x9,
+    pong = 0xA
+};
+
+enum close_code : std::uint16_t
+{
+    normal_closure = 1000,
+    going_away = 1001,
+    protocol_error = 1002,
+    no_status = 1005,
+    invalid_payload = 1007,
+    message_too_big = 1009
+};
+
+/// <summary>
+/// Largest frame header: two bytes, a 64-bit length and the masking key.
+/// </summary>
+constexpr std::size_t max_header_size = 14;
+
+/// <summary>
+/// Control frames carry at most this much payload, and are never fragmented.
+/// </summary>
+constexpr std::size_t max_control_payload = 125;
+
+constexpr bool is_control(std::uint8_t op) { return (op & 0x8) != 0; }
+
+struct frame_header
+{
+    bool fin = false;
+    bool rsv1 = false;
+    std::uint8_t opcode = 0;
+    bool masked = false;
+    std::uint64_t length = 0;
+    std::uint8_t key[4] = {};
+
+    /// <summary>
+    /// Bytes the header itself took.
+    /// </summary>
+    std::size_t size = 0;
+};
+
+/// <summary>
+/// Reads a frame header from the front of <c>data</c>. Returns false while the header is not
+/// all there yet; <c>valid</c> is cleared when the reserved bits RSV2 and RSV3, which no
+/// extension negotiated here uses, are set or the length is not in its shortest form.
+/// </summary>
+inline bool read_frame_header(const char* data, std::size_t size, frame_header& h, bool& valid)
+{
+    valid = true;
+    if (size < 2)
+        return false;
+    const auto* p = reinterpret_cast<const std::uint8_t*>(data);
+    h.fin = (p[0] & 0x80) != 0;
+    h.rsv1 = (p[0] & 0x40) != 0;
+    h.opcode = p[0] & 0x0F;
+    h.masked = (p[1] & 0x80) != 0;
+
+    const std::uint8_t short_length = p[1] & 0x7F;
+    const std::size_t length_size = short_length == 126 ? 2 : short_length == 127 ? 8 : 0;
+    h.size = 2 + length_size + (h.masked ? 4 : 0);
+    if (size < h.size)
+        return false;
+
+    h.length = short_length;
+    if (length_size != 0)
+    {
+        h.length = 0;
+        for (std::size_t i = 0; i < length_size; ++i)
+            h.length = (h.length << 8) | p[2 + i];
+        valid = length_size == 2 ? h.length >= 126 : h.length > 0xFFFF && (h.length >> 63) == 0;
+    }
+    if ((p[0] & 0x30) != 0)
+        valid = false;
+    if (h.masked)
+        std::memcpy(h.key, p + 2 + length_size, 4);
+    return true;
+}
+
+/// <summary>
+/// Writes the header of a masked frame, as every frame a client sends is, into a buffer of
+/// <c>max_header_size</c> bytes. Returns the size of the header.
+/// </summary>
+inline std::size_t write_frame_header(char* out, bool fin, bool rsv1, std::uint8_t op, std::uint64_t length, const std::uint8_t key[4])
+{
+    auto* p = reinterpret_cast<std::uint8_t*>(out);
+    p[0] = static_cast<std::uint8_t>((fin ? 0x80 : 0) | (rsv1 ? 0x40 : 0) | op);
+    std::size_t at = 2;
+    if (length < 126)
+        p[1] = static_cast<std::uint8_t>(0x80 | length);
+    else if (length <= 0xFFFF)
+    {
+        p[1] = 0x80 | 126;
+        p[2] = static_cast<std::uint8_t>(length >> 8);
+        p[3] = static_cast<std::uint8_t>(length);
+        at = 4;
+    }
+    else
+    {
+        p[1] = 0x80 | 127;
+        for (int i = 0; i < 8; ++i)
+            p[2 + i] = static_cast<std::uint8_t>(length >> (56 - 8 * i));
+        at = 10;
+    }
+    std::memcpy(p + at, key, 4);
+    return at + 4;
+}
+
+/// <summary>
+/// XORs <c>size</c> bytes of <c>in</c> with the masking key into <c>out</c>, which may be
+/// <c>in</c> itself; <c>offset</c> is where in the payload the bytes start. The key repeats every
+/// four bytes, so it is rotated to the offset once and then applied a vector at a time: 32 bytes
+/// with AVX2, 16 with SSE2 or NEON, and 8 with a plain 64-bit word elsewhere.
+/// </summary>
+inline void mask_copy(char* out, const char* in, std::size_t size, const std::uint8_t key[4], std::uint64_t offset)
+{
+    std::uint8_t rotated[8];
+    for (std::size_t i = 0; i < 8; ++i)
+        rotated[i] = key[(offset + i) & 3];
+
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    std::uint32_t word;
+    std::memcpy(&word, rotated, 4);
+    const __m256i wide = _mm256_set1_epi32(static_cast<int>(word));
+    for (; i + 32 <= size; i += 32)
+    {
+        const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_xor_si256(chunk, wide));
+    }
+#elif defined(RESTPP_WEBSOCKET_SSE2)
+    std::uint32_t word;
+    std::memcpy(&word, rotated, 4);
+    const __m128i wide = _mm_set1_epi32(static_cast<int>(word));
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_xor_si128(chunk, wide));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    std::uint32_t word;
+    std::memcpy(&word, rotated, 4);
+    const uint8x16_t wide = vreinterpretq_u8_u32(vdupq_n_u32(word));
+    for (; i + 16 <= size; i += 16)
+        vst1q_u8(reinterpret_cast<std::uint8_t*>(out + i),
+                 veorq_u8(vld1q_u8(reinterpret_cast<const std::uint8_t*>(in + i)), wide));
+#endif
+
+    std::uint64_t word64;
+    std::memcpy(&word64, rotated, 8);
+    for (; i + 8 <= size; i += 8)
+    {
+        std::uint64_t chunk;
+        std::memcpy(&chunk, in + i, 8);
+        chunk ^= word64;
+        std::memcpy(out + i, &chunk, 8);
+    }
+    for (; i < size; ++i)
+        out[i] = static_cast<char>(in[i] ^ rotated[i & 7]);
+}
+
+/// <summary>
+/// SHA-1 of a short message, only used for the accept key of the handshake, where it is not a
+/// matter of security.
+/// </summary>
+inline void sha1(std::string_view message, std::uint8_t digest[20])
+{
+    std::uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    const auto rotl = [](std::uint32_t x, int n) { return (x << n) | (x >> (32 - n)); };
+
+    std::string padded(message);
+    padded.push_back(static_cast<char>(0x80));
+    while (padded.size() % 64 != 56)
+        padded.push_back('\0');
+    const std::uint64_t bits = static_cast<std::uint64_t>(message.size()) * 8;
+    for (int i = 7; i >= 0; --i)
+        padded.push_back(static_cast<char>(bits >> (8 * i)));
+
+    for (std::size_t block = 0; block < padded.size(); block += 64)
+    {
+        std::uint32_t w[80];
+        const auto* p = reinterpret_cast<const std::uint8_t*>(padded.data() + block);
+        for (int i = 0; i < 16; ++i)
+            w[i] = (std::uint32_t(p[4 * i]) << 24) | (std::uint32_t(p[4 * i + 1]) << 16) |
+                   (std::uint32_t(p[4 * i + 2]) << 8) | std::uint32_t(p[4 * i + 3]);
+        for (int i = 16; i < 80; ++i)
+            w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        std::uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i)
+        {
+            std::uint32_t f, k;
+            if (i < 20)
+                f = (b & c) | (~b & d), k = 0x5A827999;
+            else if (i < 40)
+                f = b ^ c ^ d, k = 0x6ED9EBA1;
+            else if (i < 60)
+                f = (b & c) | (b & d) | (c & d), k = 0x8F1BBCDC;
+            else
+                f = b ^ c ^ d, k = 0xCA62C1D6;
+            const std::uint32_t t = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = t;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+    for (int i = 0; i < 20; ++i)
+        digest[i] = static_cast<std::uint8_t>(h[i / 4] >> (24 - 8 * (i % 4)));
+}
+
+inline std::string base64_encode(const std::uint8_t* data, std::size_t size)
+{
+    static constexpr char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((size + 2) / 3 * 4);
+    for (std::size_t i = 0; i < size; i += 3)
+    {
+        const std::uint32_t n = (std::uint32_t(data[i]) << 16) | (i + 1 < size ? std::uint32_t(data[i + 1]) << 8 : 0) |
+                                (i + 2 < size ? std::uint32_t(data[i + 2]) : 0);
+        out.push_back(alphabet[(n >> 18) & 63]);
+        out.push_back(alphabet[(n >> 12) & 63]);
+        out.push_back(i + 1 < size ? alphabet[(n >> 6) & 63] : '=');
+        out.push_back(i + 2 < size ? alphabet[n & 63] : '=');
+    }
+    return out;
+}
+
+/// <summary>
+/// The Sec-WebSocket-Accept a server must answer the given Sec-WebSocket-Key with.
+/// </summary>
+inline std::string accept_key(std::string_view key)
+{
+    std::string message(key);
+    message.append("258EAFA5-E914-47DA-95CA-C5AB0DC85B11");
+    std::uint8_t digest[20];
+    sha1(message, digest);
+    return base64_encode(digest, sizeof(digest));
+}
+
+/// <summary>
+/// Fills <c>out</c> with bytes an intermediary cannot predict, as handshake nonces and masking
+/// keys must be (RFC 6455, section 10.3): from OpenSSL, or from the random device of the
+/// platform without it.
+/// </summary>
+inline void random_bytes(std::uint8_t* out, std::size_t size)
+{
+#ifndef RESTPP_EXCLUDE_SSL
+    if (RAND_bytes(out, static_cast<int>(size)) == 1)
+        return;
+#endif
+    std::random_device device;
+    for (std::size_t i = 0; i < size; i += sizeof(unsigned int))
+    {
+        const unsigned int word = device();
+        std::memcpy(out + i, &word, std::min(sizeof(word), size - i));
+    }
+}
+} // namespace ws
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_WEBSOCKET_FRAME_HPP
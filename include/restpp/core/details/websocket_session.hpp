@@ -0,0 +1,791 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * The client end of a WebSocket connection (RFC 6455), over an upgraded HTTP/1.1 connection.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_WEBSOCKET_SESSION_HPP
+#define RESTPP_WEBSOCKET_SESSION_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include <restpp/core/error.hpp>
+#include <restpp/core/headers.hpp>
+#include <restpp/core/response.hpp>
+#include <restpp/core/websocket_options.hpp>
+#include <restpp/core/details/connection_pool.hpp>
+#include <restpp/core/details/content_decoder.hpp>
+#include <restpp/core/details/http_parser.hpp>
+#include <restpp/core/details/utf8.hpp>
+#include <restpp/core/details/websocket_deflate.hpp>
+#include <restpp/core/details/websocket_frame.hpp>
+
+namespace restpp
+{
+namespace details
+{
+/// <summary>
+/// A WebSocket over the connection its opening handshake upgraded. Everything runs on a strand
+/// of the I/O context of the connection; reads, writes and closes are handed to it from any
+/// thread, and their handlers are called on the strand.
+///
+/// A session only reads from the socket while a message is asked for, or while a close waits
+/// for the answer of the server, so messages are read at the pace of the application and an
+/// idle session does not keep <c>io_context::run()</c> from returning. Pings the server sent
+/// meanwhile are answered on the next read.
+///
+/// Every message goes out as a single frame, masked a chunk at a time into a buffer the session
+/// keeps, so sending allocates nothing once that buffer exists. Control frames the session
+/// sends itself, pongs and the answer to a close, go out between messages.
+/// </summary>
+class websocket_session : public std::enable_shared_from_this<websocket_session>
+{
+public:
+    using handler = std::function<void(const boost::system::error_code&)>;
+
+    /// <summary>
+    /// Bytes read from the socket at a time, and masked per write.
+    /// </summary>
+    static constexpr std::size_t read_size = 16 * 1024;
+    static constexpr std::size_t mask_chunk_size = 64 * 1024;
+
+    websocket_session(boost::asio::io_context& io_context, decoder_pool* decoders, const websocket_options& opts)
+        : _io_context(io_context)
+        , _strand(boost::asio::make_strand(io_context))
+        , _timer(_strand)
+        , _decoders(decoders)
+        , _protocols(opts.protocols)
+        , _max_message_size(opts.max_message_size)
+        , _compress_threshold(opts.compress_threshold)
+        , _compression_level(std::clamp(opts.compression_level, 1, 9))
+        , _close_timeout(opts.close_timeout)
+    {
+#ifdef RESTPP_HAS_ZLIB
+        _offers_deflate = opts.compression;
+#endif
+    }
+
+    websocket_session(const websocket_session&) = delete;
+    websocket_session& operator=(const websocket_session&) = delete;
+
+    ~websocket_session()
+    {
+        if (_conn && !_closed)
+            _conn->close();
+    }
+
+    boost::asio::io_context& io_context() { return _io_context; }
+
+    /// <summary>
+    /// Where the opening handshake hands the upgraded connection over.
+    /// </summary>
+    std::unique_ptr<connection>& upgraded() { return _conn; }
+
+    /// <summary>
+    /// Whether the handshake offers permessage-deflate.
+    /// </summary>
+    bool offers_deflate() const { return _offers_deflate; }
+
+    /// <summary>
+    /// A fresh Sec-WebSocket-Key: 16 random bytes, base64 encoded.
+    /// </summary>
+    std::string make_key()
+    {
+        std::uint8_t nonce[16];
+        ws::random_bytes(nonce, sizeof(nonce));
+        return ws::base64_encode(nonce, sizeof(nonce));
+    }
+
+    /// <summary>
+    /// Checks the answer of the server to a handshake sent with <c>key</c>, and sets up what it
+    /// agreed to. The session is open once this succeeded; it must be called before any other
+    /// operation.
+    /// </summary>
+    boost::system::error_code accept(const response& res, std::string_view key)
+    {
+        if (res.status_code != 101 || !_conn)
+            return error::websocket_handshake_failed;
+
+        const auto upgrade = res.headers.get(field::upgrade);
+        const auto connection = res.headers.get(field::connection);
+        const auto accept = res.headers.get("Sec-WebSocket-Accept");
+        if (!upgrade || !iequals(trim_ows(*upgrade), "websocket") || !connection || !has_token(*connection, "upgrade") ||
+            !accept || trim_ows(*accept) != ws::accept_key(key))
+            return error::websocket_handshake_failed;
+
+        // The server may only pick a subprotocol and extensions that were offered
+        ws::deflate_params params;
+        for (const auto& [name, value] : res.headers)
+        {
+            if (iequals(name, "Sec-WebSocket-Protocol"))
+            {
+                const auto picked = trim_ows(value);
+                if (!_protocol.empty() || std::find(_protocols.begin(), _protocols.end(), picked) == _protocols.end())
+                    return error::websocket_handshake_failed;
+                _protocol = std::string(picked);
+            }
+            else if (iequals(name, "Sec-WebSocket-Extensions") && !ws::read_deflate_response(value, params))
+                return error::websocket_handshake_failed;
+        }
+        if (params.enabled && !_offers_deflate)
+            return error::websocket_handshake_failed;
+
+#ifdef RESTPP_HAS_ZLIB
+        if (params.enabled)
+        {
+            if (!_inflater.start(_decoders, params.server_no_context_takeover))
+                return error::websocket_handshake_failed;
+            _deflater.start(params.client_max_window_bits, _compression_level, params.client_no_context_takeover);
+            _compressed = true;
+        }
+#endif
+        _open = true;
+        return {};
+    }
+
+    bool is_open() const { return _open.load(); }
+
+    const std::string& protocol() const { return _protocol; }
+
+    bool compressed() const { return _compressed; }
+
+    /// <summary>
+    /// The status code and reason of the close frame the server sent, once the connection was
+    /// closed.
+    /// </summary>
+    std::uint16_t close_code() const { return _close_code; }
+
+    const std::string& close_reason() const { return _close_reason; }
+
+    /// <summary>
+    /// Reads the next message into <c>message</c>. Only one read may be pending at a time.
+    /// </summary>
+    void async_read(websocket_message& message, handler done)
+    {
+        boost::asio::dispatch(_strand, [self = shared_from_this(), &message, done = std::move(done)]() mutable {
+            self->start_read(message, std::move(done));
+        });
+    }
+
+    /// <summary>
+    /// Sends a text or binary message. <c>data</c> is borrowed, and must stay valid until the
+    /// write completed.
+    /// </summary>
+    void async_write(std::string_view data, std::uint8_t op, handler done)
+    {
+        boost::asio::dispatch(_strand, [self = shared_from_this(), data, op, done = std::move(done)]() mutable {
+            self->queue(self->_messages, outgoing{op, data, std::string(), std::move(done)});
+        });
+    }
+
+    void async_ping(std::string payload, handler done)
+    {
+        payload.resize(std::min(payload.size(), ws::max_control_payload));
+        boost::asio::dispatch(
+            _strand, [self = shared_from_this(), payload = std::move(payload), done = std::move(done)]() mutable {
+                self->queue(self->_controls, outgoing{ws::ping, {}, std::move(payload), std::move(done)});
+            });
+    }
+
+    /// <summary>
+    /// Sends a close frame after the messages already queued, then waits for the server to
+    /// close its end, for at most the close timeout.
+    /// </summary>
+    void async_close(std::uint16_t code, std::string reason, handler done)
+    {
+        boost::asio::dispatch(
+            _strand, [self = shared_from_this(), code, reason = std::move(reason), done = std::move(done)]() mutable {
+                self->start_close(code, reason, std::move(done));
+            });
+    }
+
+    /// <summary>
+    /// Drops the connection, failing whatever is pending with <c>operation_aborted</c>.
+    /// </summary>
+    void cancel()
+    {
+        boost::asio::dispatch(_strand, [self = shared_from_this()] { self->fail(boost::asio::error::operation_aborted); });
+    }
+
+private:
+    struct outgoing
+    {
+        std::uint8_t opcode = 0;
+        std::string_view data;
+        std::string owned;
+        handler done;
+
+        std::string_view payload() const { return ws::is_control(opcode) ? std::string_view(owned) : data; }
+    };
+
+    void start_read(websocket_message& message, handler done)
+    {
+        if (_read_done)
+            return done(boost::asio::error::already_started);
+        if (_closed || _close_received || _draining)
+            return done(_error ? _error : make_error_code(error::websocket_closed));
+        _out = &message;
+        _read_done = std::move(done);
+        read_frames();
+    }
+
+    /// <summary>
+    /// Goes through the frames in the receive buffer until a message is complete, reading more
+    /// of them when the buffer runs dry.
+    /// </summary>
+    void read_frames()
+    {
+        auto& buffer = _conn->buffer();
+        for (;;)
+        {
+            if (!_in_frame)
+            {
+                bool valid = true;
+                if (!ws::read_frame_header(buffer.data(), buffer.size(), _frame, valid))
+                    return read_more(ws::max_header_size - buffer.size());
+                if (!valid || _frame.masked)
+                    return (void)protocol_violation();
+
+                if (ws::is_control(_frame.opcode))
+                {
+                    if (!_frame.fin || _frame.rsv1 || _frame.length > ws::max_control_payload)
+                        return (void)protocol_violation();
+                    const std::size_t size = _frame.size + static_cast<std::size_t>(_frame.length);
+                    if (buffer.size() < size)
+                        return read_more(size - buffer.size());
+                    const bool more = on_control(std::string_view(buffer.data() + _frame.size, size - _frame.size));
+                    buffer.consume(size);
+                    if (!more)
+                        return;
+                    continue;
+                }
+
+                if (!start_frame())
+                    return;
+
+                // A message in a single frame that was read whole is handed out where it is
+                const std::size_t length = static_cast<std::size_t>(_frame.length);
+                if (_frame.opcode != ws::continuation && _frame.fin && !_frame.rsv1 && buffer.size() - _frame.size >= length)
+                {
+                    _out->data = std::string_view(buffer.data() + _frame.size, length);
+                    buffer.consume(_frame.size + length);
+                    if (!deliver())
+                        return;
+                    continue;
+                }
+                buffer.consume(_frame.size);
+                _in_frame = true;
+                _frame_remaining = _frame.length;
+            }
+
+            const std::size_t take = static_cast<std::size_t>(std::min<std::uint64_t>(_frame_remaining, buffer.size()));
+            if (take != 0)
+            {
+                if (!append(std::string_view(buffer.data(), take)))
+                    return;
+                buffer.consume(take);
+                _frame_remaining -= take;
+            }
+            if (_frame_remaining != 0)
+            {
+                // Large payloads go from the socket straight into the message
+                if (!_message_compressed && _frame_remaining >= read_size)
+                    return read_payload();
+                return read_more(static_cast<std::size_t>(std::min<std::uint64_t>(_frame_remaining, read_size)));
+            }
+
+            _in_frame = false;
+            if (!_frame.fin)
+                continue;
+
+#ifdef RESTPP_HAS_ZLIB
+            if (_message_compressed)
+            {
+                boost::system::error_code ec;
+                _inflater.finish(_out->storage, _max_message_size, ec);
+                if (ec)
+                    return inflate_failure(ec);
+            }
+#endif
+            _out->data = _out->storage;
+            if (!deliver())
+                return;
+        }
+    }
+
+    /// <summary>
+    /// Checks a data frame against the message it starts or continues. Returns false when it
+    /// failed the connection.
+    /// </summary>
+    bool start_frame()
+    {
+        if (_frame.opcode == ws::continuation)
+        {
+            if (_message_op == 0 || _frame.rsv1)
+                return protocol_violation();
+        }
+        else
+        {
+            if ((_frame.opcode != ws::text && _frame.opcode != ws::binary) || _message_op != 0)
+                return protocol_violation();
+#ifdef RESTPP_HAS_ZLIB
+            if (_frame.rsv1 && !_inflater)
+#else
+            if (_frame.rsv1)
+#endif
+                return protocol_violation();
+            _message_op = _frame.opcode;
+            _message_compressed = _frame.rsv1;
+            _out->storage.clear();
+        }
+
+        // Compressed messages are measured as they are inflated
+        if (!_message_compressed && _frame.length > _max_message_size - _out->storage.size())
+        {
+            protocol_failure(ws::message_too_big, error::message_too_large);
+            return false;
+        }
+        return true;
+    }
+
+    bool append(std::string_view piece)
+    {
+#ifdef RESTPP_HAS_ZLIB
+        if (_message_compressed)
+        {
+            boost::system::error_code ec;
+            _inflater.feed(piece, _out->storage, _max_message_size, ec);
+            if (ec)
+                inflate_failure(ec);
+            return !ec;
+        }
+#endif
+        _out->storage.append(piece);
+        return true;
+    }
+
+    bool protocol_violation()
+    {
+        protocol_failure(ws::protocol_error, error::websocket_protocol_error);
+        return false;
+    }
+
+    void inflate_failure(const boost::system::error_code& ec)
+    {
+        protocol_failure(ec == error::message_too_large ? ws::message_too_big : ws::invalid_payload, ec);
+    }
+
+    /// <summary>
+    /// Completes the read with the message in <c>_out</c>. Returns true when reading goes on,
+    /// which it only does for messages discarded while a close waits for the server.
+    /// </summary>
+    bool deliver()
+    {
+        const std::uint8_t op = _message_op;
+        _message_op = 0;
+        if (_draining)
+            return true;
+        if (op == ws::text && !is_valid_utf8(_out->data))
+        {
+            protocol_failure(ws::invalid_payload, error::websocket_protocol_error);
+            return false;
+        }
+        _out->type = op == ws::text ? websocket_message_type::text : websocket_message_type::binary;
+        complete_read({});
+        return false;
+    }
+
+    /// <summary>
+    /// Handles a control frame. Returns false when it ended the read.
+    /// </summary>
+    bool on_control(std::string_view payload)
+    {
+        if (_frame.opcode == ws::ping)
+        {
+            if (!_close_queued)
+            {
+                _controls.push_back(outgoing{ws::pong, {}, std::string(payload), nullptr});
+                flush();
+            }
+            return true;
+        }
+        if (_frame.opcode == ws::pong)
+            return true;
+        if (_frame.opcode != ws::close || payload.size() == 1)
+            return protocol_violation();
+
+        std::uint16_t code = ws::no_status;
+        if (payload.size() >= 2)
+        {
+            code = static_cast<std::uint16_t>((static_cast<std::uint8_t>(payload[0]) << 8) | static_cast<std::uint8_t>(payload[1]));
+            payload.remove_prefix(2);
+            if (!is_valid_close_code(code) || !is_valid_utf8(payload))
+                return protocol_violation();
+        }
+        _close_received = true;
+        _close_code = code;
+        _close_reason = std::string(payload);
+        _open = false;
+
+        // Answer with the same code, ahead of any message still queued
+        if (!_close_queued)
+        {
+            _close_queued = true;
+            _controls.push_back(outgoing{ws::close, {}, close_payload(code, {}), nullptr});
+        }
+        complete_read(error::websocket_closed);
+        if (_close_sent)
+            shutdown({});
+        else
+            flush();
+        return false;
+    }
+
+    static bool is_valid_close_code(std::uint16_t code)
+    {
+        return (code >= 1000 && code <= 1014 && code != 1004 && code != 1005 && code != 1006) ||
+               (code >= 3000 && code <= 4999);
+    }
+
+    static std::string close_payload(std::uint16_t code, std::string_view reason)
+    {
+        std::string payload;
+        if (code == ws::no_status)
+            return payload;
+        payload.push_back(static_cast<char>(code >> 8));
+        payload.push_back(static_cast<char>(code & 0xFF));
+        payload.append(reason.substr(0, ws::max_control_payload - 2));
+        return payload;
+    }
+
+    void read_more(std::size_t at_least)
+    {
+        _conn->async_read_some(
+            _conn->buffer().prepare(std::max(at_least, read_size)),
+            boost::asio::bind_executor(
+                _strand, [self = shared_from_this()](const boost::system::error_code& ec, std::size_t bytes_transferred) {
+                    if (self->_closed)
+                        return;
+                    if (ec)
+                        return self->fail(ec);
+                    self->_conn->buffer().commit(bytes_transferred);
+                    self->read_frames();
+                }));
+    }
+
+    void read_payload()
+    {
+        auto& storage = _out->storage;
+        const std::size_t used = storage.size();
+        storage.resize(used + static_cast<std::size_t>(_frame_remaining));
+        boost::asio::async_read(
+            *_conn,
+            boost::asio::buffer(&storage[used], storage.size() - used),
+            boost::asio::bind_executor(_strand, [self = shared_from_this()](const boost::system::error_code& ec, std::size_t) {
+                if (self->_closed)
+                    return;
+                if (ec)
+                    return self->fail(ec);
+                self->_frame_remaining = 0;
+                self->read_frames();
+            }));
+    }
+
+    void complete_read(const boost::system::error_code& ec)
+    {
+        auto done = std::move(_read_done);
+        _read_done = nullptr;
+        _out = nullptr;
+        if (done)
+            done(ec);
+
+        // A close sent while this read was pending waits for the answer of the server
+        if (!ec && _close_sent && !_close_received && !_closed)
+            start_drain();
+    }
+
+    void start_drain()
+    {
+        _draining = true;
+        _out = &_discard;
+        read_frames();
+    }
+
+    void queue(std::deque<outgoing>& jobs, outgoing job)
+    {
+        if (_closed || _close_queued)
+            return job.done(_error ? _error : make_error_code(error::websocket_closed));
+        jobs.push_back(std::move(job));
+        flush();
+    }
+
+    void start_close(std::uint16_t code, const std::string& reason, handler done)
+    {
+        if (_closed)
+            return done(_error);
+        if (_close_done)
+            return done(boost::asio::error::already_started);
+        _close_done = std::move(done);
+        if (_close_queued)
+            return;
+        _close_queued = true;
+        _messages.push_back(outgoing{ws::close, {}, close_payload(code, reason), nullptr});
+        flush();
+    }
+
+    void flush()
+    {
+        if (_writing || _closed)
+            return;
+        if (!_sending)
+        {
+            auto& jobs = !_controls.empty() ? _controls : _messages;
+            if (jobs.empty())
+                return;
+            _current = std::move(jobs.front());
+            jobs.pop_front();
+            start_frame_out();
+        }
+        write_chunk();
+    }
+
+    void start_frame_out()
+    {
+        std::string_view payload = _current.payload();
+        bool rsv1 = false;
+#ifdef RESTPP_HAS_ZLIB
+        if (_deflater && !ws::is_control(_current.opcode) && payload.size() >= _compress_threshold &&
+            _deflater.compress(payload, _deflated))
+        {
+            payload = _deflated;
+            rsv1 = true;
+        }
+#endif
+        ws::random_bytes(_key, sizeof(_key));
+        _head_size = ws::write_frame_header(_head, true, rsv1, _current.opcode, payload.size(), _key);
+        _payload = payload;
+        _sent = 0;
+        _sending = true;
+        if (!_masked)
+            _masked.reset(new char[mask_chunk_size]);
+    }
+
+    /// <summary>
+    /// Masks the next chunk of the frame being sent and writes it out, after the header on the
+    /// first one.
+    /// </summary>
+    void write_chunk()
+    {
+        const std::size_t size = std::min(_payload.size() - _sent, mask_chunk_size);
+        ws::mask_copy(_masked.get(), _payload.data() + _sent, size, _key, _sent);
+        const std::array<boost::asio::const_buffer, 2> buffers{
+            boost::asio::buffer(_head, _head_size), boost::asio::buffer(_masked.get(), size)};
+
+        _writing = true;
+        boost::asio::async_write(
+            *_conn,
+            buffers,
+            boost::asio::bind_executor(_strand, [self = shared_from_this(), size](const boost::system::error_code& ec, std::size_t) {
+                self->_writing = false;
+                if (self->_closed)
+                    return;
+                if (ec)
+                    return self->fail(ec);
+                self->_head_size = 0;
+                self->_sent += size;
+                if (self->_sent == self->_payload.size())
+                    self->frame_written();
+                self->flush();
+            }));
+    }
+
+    void frame_written()
+    {
+        _sending = false;
+        const std::uint8_t op = _current.opcode;
+        auto done = std::move(_current.done);
+        _current = outgoing();
+        if (done)
+            done({});
+        if (op == ws::close)
+            on_close_sent();
+    }
+
+    void on_close_sent()
+    {
+        _close_sent = true;
+        _open = false;
+
+        // Nothing goes out after a close
+        std::deque<outgoing> messages;
+        messages.swap(_messages);
+        for (auto& job : messages)
+        {
+            if (job.done)
+                job.done(error::websocket_closed);
+        }
+
+        if (_failing || _close_received)
+            return shutdown(_error);
+
+        _timer.expires_after(_close_timeout);
+        _timer.async_wait(boost::asio::bind_executor(_strand, [self = shared_from_this()](const boost::system::error_code& ec) {
+            if (!ec)
+                self->shutdown({});
+        }));
+        if (!_read_done)
+            start_drain();
+    }
+
+    /// <summary>
+    /// Fails the connection for something the server sent: the close frame with the given code
+    /// goes out, and the connection is dropped once it did.
+    /// </summary>
+    void protocol_failure(std::uint16_t code, const boost::system::error_code& ec)
+    {
+        if (_failing || _closed)
+            return;
+        _failing = true;
+        _error = ec;
+        _open = false;
+        complete_read(ec);
+        if (_close_queued)
+            return shutdown(ec);
+        _close_queued = true;
+        _controls.push_back(outgoing{ws::close, {}, close_payload(code, {}), nullptr});
+        flush();
+    }
+
+    void fail(const boost::system::error_code& ec)
+    {
+        if (_closed)
+            return;
+        _error = ec;
+        shutdown(ec);
+    }
+
+    /// <summary>
+    /// Drops the connection and completes everything pending: with <c>ec</c>, or once the close
+    /// handshake is over with <c>websocket_closed</c> for reads and writes and success for the
+    /// close.
+    /// </summary>
+    void shutdown(const boost::system::error_code& ec)
+    {
+        if (_closed)
+            return;
+        _closed = true;
+        _open = false;
+        _timer.cancel();
+        _conn->close();
+
+        const boost::system::error_code reason = ec ? ec : make_error_code(error::websocket_closed);
+        _draining = false;
+        complete_read(reason);
+
+        std::vector<handler> pending;
+        if (_sending && _current.done)
+            pending.push_back(std::move(_current.done));
+        for (auto* jobs : {&_controls, &_messages})
+        {
+            for (auto& job : *jobs)
+            {
+                if (job.done)
+                    pending.push_back(std::move(job.done));
+            }
+            jobs->clear();
+        }
+        for (auto& done : pending)
+            done(reason);
+
+        if (_close_done)
+        {
+            auto done = std::move(_close_done);
+            _close_done = nullptr;
+            done(_close_sent && !ec ? boost::system::error_code() : reason);
+        }
+    }
+
+    boost::asio::io_context& _io_context;
+    boost::asio::strand<boost::asio::io_context::executor_type> _strand;
+    boost::asio::steady_timer _timer;
+    std::unique_ptr<connection> _conn;
+    decoder_pool* _decoders;
+    const std::vector<std::string> _protocols;
+    const std::size_t _max_message_size;
+    const std::size_t _compress_threshold;
+    const int _compression_level;
+    const std::chrono::steady_clock::duration _close_timeout;
+
+    std::atomic<bool> _open{false};
+    std::string _protocol;
+    bool _offers_deflate = false;
+    bool _compressed = false;
+#ifdef RESTPP_HAS_ZLIB
+    ws::message_deflater _deflater;
+    ws::message_inflater _inflater;
+    std::string _deflated;
+#endif
+
+    // Reading
+    websocket_message* _out = nullptr;
+    handler _read_done;
+    websocket_message _discard;
+    bool _draining = false;
+    ws::frame_header _frame;
+    bool _in_frame = false;
+    std::uint64_t _frame_remaining = 0;
+    std::uint8_t _message_op = 0;
+    bool _message_compressed = false;
+
+    // Writing
+    std::deque<outgoing> _controls;
+    std::deque<outgoing> _messages;
+    outgoing _current;
+    bool _sending = false;
+    bool _writing = false;
+    std::string_view _payload;
+    std::size_t _sent = 0;
+    char _head[ws::max_header_size];
+    std::size_t _head_size = 0;
+    std::uint8_t _key[4] = {};
+    std::unique_ptr<char[]> _masked;
+
+    // Closing
+    handler _close_done;
+    bool _close_queued = false;
+    bool _close_sent = false;
+    bool _close_received = false;
+    bool _failing = false;
+    bool _closed = false;
+    boost::system::error_code _error;
+    std::uint16_t _close_code = ws::no_status;
+    std::string _close_reason;
+};
+
+} // namespace details
+} // namespace restpp
+
+#endif // RESTPP_WEBSOCKET_SESSION_HPP
@@ -0,0 +1,177 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Error codes reported by restpp operations.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_ERROR_HPP
+#define RESTPP_ERROR_HPP
+
+#include <string>
+#include <type_traits>
+
+#include <boost/system/error_code.hpp>
+
+namespace restpp
+{
+namespace error
+{
+/// <summary>
+/// Errors raised when the remote peer does not speak valid HTTP, or when restpp itself gives up
+/// on a request.
+/// </summary>
+enum protocol_errors
+{
+    /// The status line of the response is malformed.
+    invalid_status_line = 1,
+
+    /// A header line of the response is malformed.
+    invalid_header,
+
+    /// A chunk of a chunked response body is malformed.
+    invalid_chunk,
+
+    /// The connection was closed before the response was complete.
+    partial_message,
+
+    /// The status line and headers exceed the configured limit.
+    header_too_large,
+
+    /// The body sink refused a piece of the response body.
+    body_aborted,
+
+    /// The generator of the request body aborted the transfer.
+    request_aborted,
+
+    /// The scheme of the URI is not one restpp can fetch, such as https in a build without TLS.
+    unsupported_scheme,
+
+    /// The HTTP/2 server refused the stream before processing it, so it may safely be retried.
+    stream_refused,
+
+    /// The HTTP/2 server reset the stream while the response was in flight.
+    stream_reset,
+
+    /// The HTTP/2 server violated the protocol.
+    http2_protocol_error,
+
+    /// The host name was not resolved within the resolve timeout.
+    resolve_timed_out,
+
+    /// No connection was established within the connect timeout.
+    connect_timed_out,
+
+    /// The TLS handshake did not complete within its timeout.
+    handshake_timed_out,
+
+    /// The server did not start answering within the first byte timeout.
+    first_byte_timed_out,
+
+    /// The request did not complete within its total timeout or before its deadline.
+    deadline_exceeded,
+
+    /// The request was aborted through its abort signal.
+    aborted,
+
+    /// The response body is not valid in the content coding it was sent with.
+    decoding_failed,
+
+    /// The response status is not a success where one is required, as when decoding the body
+    /// into a type.
+    unexpected_status,
+
+    /// The request line of a request received by the server is malformed.
+    invalid_request_line,
+
+    /// The server did not accept the WebSocket handshake.
+    websocket_handshake_failed,
+
+    /// The WebSocket peer violated the protocol.
+    websocket_protocol_error,
+
+    /// The WebSocket was closed, by either end.
+    websocket_closed,
+
+    /// A WebSocket message is larger than the configured limit.
+    message_too_large,
+
+    /// The response body is larger than the configured limit, or than what could be allocated.
+    body_too_large
+};
+
+namespace details
+{
+class protocol_category : public boost::system::error_category
+{
+public:
+    const char* name() const noexcept override { return "restpp.protocol"; }
+
+    std::string message(int value) const override
+    {
+        switch (value)
+        {
+            case invalid_status_line: return "Invalid response status line";
+            case invalid_header: return "Invalid response header";
+            case invalid_chunk: return "Invalid chunk in chunked response body";
+            case partial_message: return "Connection closed before the response was complete";
+            case header_too_large: return "Response header block is too large";
+            case body_aborted: return "Response body sink aborted the transfer";
+            case request_aborted: return "Request body generator aborted the transfer";
+            case unsupported_scheme: return "Unsupported URI scheme";
+            case stream_refused: return "HTTP/2 stream refused by the server";
+            case stream_reset: return "HTTP/2 stream reset by the server";
+            case http2_protocol_error: return "HTTP/2 protocol error";
+            case resolve_timed_out: return "Timed out resolving the host";
+            case connect_timed_out: return "Timed out connecting to the host";
+            case handshake_timed_out: return "Timed out in the TLS handshake";
+            case first_byte_timed_out: return "Timed out waiting for the response";
+            case deadline_exceeded: return "Request deadline exceeded";
+            case aborted: return "Request aborted";
+            case decoding_failed: return "Response body could not be decoded";
+            case unexpected_status: return "Response status is not a success";
+            case invalid_request_line: return "Invalid request line";
+            case websocket_handshake_failed: return "WebSocket handshake rejected by the server";
+            case websocket_protocol_error: return "WebSocket protocol error";
+            case websocket_closed: return "WebSocket closed";
+            case message_too_large: return "WebSocket message is too large";
+            case body_too_large: return "Response body is too large";
+            default: return "restpp.protocol error";
+        }
+    }
+};
+} // namespace details
+
+inline const boost::system::error_category& get_protocol_category()
+{
+    static details::protocol_category instance;
+    return instance;
+}
+
+inline boost::system::error_code make_error_code(protocol_errors e)
+{
+    return boost::system::error_code(static_cast<int>(e), get_protocol_category());
+}
+
+} // namespace error
+} // namespace restpp
+
+namespace boost
+{
+namespace system
+{
+template<>
+struct is_error_code_enum<restpp::error::protocol_errors> : std::true_type
+{
+};
+} // namespace system
+} // namespace boost
+
+#endif // RESTPP_ERROR_HPP
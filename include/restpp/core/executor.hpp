@@ -0,0 +1,181 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Threads running the I/O of clients, one I/O context per thread.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_EXECUTOR_HPP
+#define RESTPP_EXECUTOR_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/asio/thread_pool.hpp>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace restpp
+{
+
+/// <summary>
+/// Threads of an <c>executor</c>.
+/// </summary>
+struct executor_config
+{
+    /// <summary>
+    /// Number of I/O threads, each running an I/O context of its own. Defaults to one per core.
+    /// </summary>
+    std::size_t io_threads = std::thread::hardware_concurrency();
+
+    /// <summary>
+    /// Pin I/O thread <c>i</c> to core <c>i</c>, so the sockets of a shard are always served
+    /// from the same cache. Only supported on Linux; elsewhere threads are left unpinned.
+    /// </summary>
+    bool pin_threads = false;
+
+    /// <summary>
+    /// Number of threads running CPU-heavy work handed over with <c>compute()</c>. Zero means one
+    /// per core. They are only started the first time such work is handed over.
+    /// </summary>
+    std::size_t compute_threads = 0;
+};
+
+/// <summary>
+/// Runs a fixed set of I/O contexts, each on a thread of its own. Clients built on an executor
+/// shard their connections over its contexts: a connection is only ever used on the context it
+/// was opened on, so its state stays on one core and the pool it returns to is never contended.
+///
+/// Completion handlers run on the I/O thread of their request and should return quickly. CPU-heavy
+/// work, such as parsing large bodies, belongs on <c>compute()</c>, whose threads share one queue:
+/// whichever of them is idle takes the next piece of work, so a long job never holds back the
+/// ones queued behind it.
+/// </summary>
+class executor
+{
+public:
+    explicit executor(executor_config config = {}) : _config(config)
+    {
+        const std::size_t count = config.io_threads != 0 ? config.io_threads : 1;
+        _shards.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+            _shards.push_back(std::make_unique<shard>());
+
+        _threads.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            _threads.emplace_back([this, i] {
+                if (_config.pin_threads)
+                    pin_to_core(i);
+                _shards[i]->io_context.run();
+            });
+        }
+    }
+
+    executor(const executor&) = delete;
+    executor& operator=(const executor&) = delete;
+
+    ~executor() { stop(); }
+
+    /// <summary>
+    /// Number of I/O contexts.
+    /// </summary>
+    std::size_t size() const { return _shards.size(); }
+
+    boost::asio::io_context& io_context(std::size_t index) { return _shards[index % _shards.size()]->io_context; }
+
+    /// <summary>
+    /// Takes the I/O contexts in turns, spreading new work evenly over the threads.
+    /// </summary>
+    boost::asio::io_context& next_io_context()
+    {
+        return io_context(_next.fetch_add(1, std::memory_order_relaxed));
+    }
+
+    /// <summary>
+    /// The executor of the thread pool meant for CPU-heavy work, started on first use. Post to it
+    /// from a completion handler to move the work off the I/O thread.
+    /// </summary>
+    boost::asio::thread_pool::executor_type compute()
+    {
+        std::call_once(_compute_once, [this] {
+            _compute = std::make_unique<boost::asio::thread_pool>(
+                _config.compute_threads != 0 ? _config.compute_threads : hardware_threads());
+        });
+        return _compute->get_executor();
+    }
+
+    /// <summary>
+    /// Stops the I/O contexts and waits for their threads and for the work handed to
+    /// <c>compute()</c>. Operations still pending are abandoned, as when an I/O context is stopped.
+    /// </summary>
+    void stop()
+    {
+        for (auto& s : _shards)
+        {
+            s->work.reset();
+            s->io_context.stop();
+        }
+        for (auto& thread : _threads)
+        {
+            if (thread.joinable())
+                thread.join();
+        }
+        if (_compute)
+            _compute->join();
+    }
+
+private:
+    struct shard
+    {
+        boost::asio::io_context io_context{1};
+        std::unique_ptr<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> work =
+            std::make_unique<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>>(
+                io_context.get_executor());
+    };
+
+    static std::size_t hardware_threads()
+    {
+        const unsigned n = std::thread::hardware_concurrency();
+        return n != 0 ? n : 1;
+    }
+
+    static void pin_to_core(std::size_t index)
+    {
+#ifdef __linux__
+        cpu_set_t cores;
+        CPU_ZERO(&cores);
+        CPU_SET(static_cast<int>(index % hardware_threads()), &cores);
+        pthread_setaffinity_np(pthread_self(), sizeof(cores), &cores);
+#else
+        (void)index;
+#endif
+    }
+
+    const executor_config _config;
+    std::vector<std::unique_ptr<shard>> _shards;
+    std::vector<std::thread> _threads;
+    std::atomic<std::size_t> _next{0};
+    std::once_flag _compute_once;
+    std::unique_ptr<boost::asio::thread_pool> _compute;
+};
+
+} // namespace restpp
+
+#endif // RESTPP_EXECUTOR_HPP
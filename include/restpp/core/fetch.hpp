@@ -15,88 +15,619 @@
 #ifndef RESTPP_FETCH_HPP
 #define RESTPP_FETCH_HPP
 
-#include <iostream>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
 #include <boost/asio.hpp>
+#include <boost/system/system_error.hpp>
 
 #include <restpp/core/uri.hpp>
+#include <restpp/core/client.hpp>
 #include <restpp/core/options.hpp>
 #include <restpp/core/response.hpp>
+#include <restpp/core/details/fetch_op.hpp>
 
 namespace restpp
 {
-response fetch(uri _path, options _options = {}) {
-    try {
-        boost::asio::io_context io_context;
-
-        // Resolve the host and port
-        boost::asio::ip::tcp::resolver resolver(io_context);
-        auto endpoints = resolver.resolve(_path.host(), std::to_string(_path.port()));
-
-        // Create the socket
-        boost::asio::ip::tcp::socket socket(io_context);
-        boost::asio::connect(socket, endpoints);
-
-        // Form the HTTP request
-        std::ostringstream request_stream;
-        request_stream << _options.method << " " << _path.path() << " HTTP/1.1\r\n";
-        request_stream << "Host: " << _path.host() << "\r\n";
-        request_stream << "Connection: close\r\n";
-
-        // Add custom headers
-        for (const auto& [key, value] : _options.headers) {
-            request_stream << key << ": " << value << "\r\n";
+namespace details
+{
+/// <summary>
+/// The options of requests made without any, shared so that they are not built on every call.
+/// </summary>
+inline const options& default_options()
+{
+    static const options instance;
+    return instance;
+}
+
+/// <summary>
+/// What a fetch through the client uses, with the connections of the given shard.
+/// </summary>
+inline fetch_services client_services(client& _client, client_shard& shard, const uri& _path)
+{
+    fetch_services services;
+    services.pool = &shard.pool;
+    services.h2_pool = _client.config().http2 ? &shard.h2_pool : nullptr;
+    services.decoders = &shard.decoders;
+    services.dns = _client.dns();
+#ifndef RESTPP_EXCLUDE_SSL
+    services.tls = fetch_state::is_secure(_path) ? &_client.tls_context() : nullptr;
+#endif
+    services.cache = _client.config().cache.get();
+    services.observer = _client.config().observer.get();
+    services.keep_alive = _client.config().keep_alive;
+    services.memory = _client.memory();
+    return services;
+}
+
+template<typename CompletionToken>
+auto async_fetch(boost::asio::io_context& io_context, fetch_state_ptr state, CompletionToken&& token)
+{
+    // Watched requests run their steps on the strand they share with their timer
+    if (state->watch) {
+        auto executor = state->executor;
+        return boost::asio::async_compose<CompletionToken, void(boost::system::error_code, response)>(
+            fetch_op(std::move(state)), token, executor);
+    }
+    return boost::asio::async_compose<CompletionToken, void(boost::system::error_code, response)>(
+        fetch_op(std::move(state)), token, io_context.get_executor());
+}
+
+/// <summary>
+/// A request through the retry, hedging and concurrency policies of a client. Each attempt is a
+/// fetch of its own, waiting for a slot under the concurrency limit of the host first; a hedged
+/// attempt only goes out when a slot is free right away. The steps run on a strand of the I/O
+/// context of the request, and a new round of attempts only starts once every attempt of the
+/// previous one completed, so the options they borrow never change under them.
+/// </summary>
+class policy_fetch : public std::enable_shared_from_this<policy_fetch>
+{
+public:
+    using completion = std::function<void(boost::system::error_code, response)>;
+    using clock = std::chrono::steady_clock;
+
+    policy_fetch(client& _client, client_shard& shard, uri target, options opts, completion done)
+        : _client(_client)
+        , _shard(shard)
+        , _strand(boost::asio::make_strand(shard.io_context))
+        , _timer(_strand)
+        , _target(std::move(target))
+        , _opts(std::move(opts))
+        , _done(std::move(done))
+        , _host(_client.hosts().at(_target))
+    {
+        const auto& config = _client.config();
+
+        // The total timeout covers every attempt, and the waits between them
+        if (_opts.timeouts.total != clock::duration::zero())
+        {
+            const auto deadline = clock::now() + _opts.timeouts.total;
+            _opts.deadline = _opts.deadline ? std::min(*_opts.deadline, deadline) : deadline;
         }
-        request_stream << "\r\n";
-
-        // Send the request
-        std::string request = request_stream.str();
-        boost::asio::write(socket, boost::asio::buffer(request));
-
-        // Read the response
-        boost::asio::streambuf response_buffer;
-        boost::asio::read_until(socket, response_buffer, "\r\n");
-
-        // Parse the response status line
-        std::istream response_stream(&response_buffer);
-        std::string http_version;
-        unsigned int status_code;
-        std::string status_message;
-        response_stream >> http_version >> status_code;
-        std::getline(response_stream, status_message);
-
-        if (!response_stream || http_version.substr(0, 5) != "HTTP/") {
-            throw std::runtime_error("Invalid response");
+        _max_attempts = may_retry(_opts) ? std::max(config.retry.max_attempts, 1) : 1;
+        _hedged = config.hedge.enabled && may_hedge(_opts);
+        if (_hedged)
+        {
+            for (auto& a : _attempts)
+                a.opts = _opts;
         }
+    }
+
+    void start()
+    {
+        boost::asio::dispatch(_strand, [self = shared_from_this()] {
+            // Aborting the request aborts every attempt of it
+            if (self->_hedged && self->_opts.signal)
+            {
+                std::weak_ptr<policy_fetch> weak = self;
+                self->_subscription = self->_opts.signal.subscribe([weak] {
+                    if (auto fetch = weak.lock())
+                        boost::asio::post(fetch->_strand, [fetch] { fetch->abort_attempts(); });
+                });
+            }
+            self->next_round();
+        });
+    }
+
+private:
+    struct attempt
+    {
+        options opts;
+        abort_controller controller;
+        clock::time_point started;
+        bool in_flight = false;
+        bool slot = false;
+    };
 
-        // Read headers
-        std::ostringstream headers;
-        std::string header_line;
-        while (std::getline(response_stream, header_line) && header_line != "\r") {
-            headers << header_line << "\n";
+    void next_round()
+    {
+        ++_round;
+        ++_attempts_made;
+        launch(0, true);
+    }
+
+    /// <summary>
+    /// Sends an attempt once it holds a slot, when the client limits concurrency. A backup does
+    /// not wait for one.
+    /// </summary>
+    void launch(std::size_t i, bool wait_for_slot)
+    {
+        if (_client.config().limits_concurrency())
+        {
+            if (!wait_for_slot)
+            {
+                if (!_host->try_acquire())
+                    return;
+            }
+            else if ((_queued = _host->acquire([self = shared_from_this(), i] {
+                          boost::asio::post(self->_strand, [self, i] { self->on_slot(i); });
+                      })) != 0)
+                return watch_queue();
+            return send(i, true);
         }
+        send(i, false);
+    }
 
-        // Read the body
-        std::ostringstream body;
-        if (response_buffer.size() > 0) {
-            body << &response_buffer;
+    /// <summary>
+    /// Gives up the wait for a slot when the request is aborted or reaches its deadline, which
+    /// would otherwise only be noticed once it was sent.
+    /// </summary>
+    void watch_queue()
+    {
+        if (_opts.signal)
+        {
+            std::weak_ptr<policy_fetch> weak = shared_from_this();
+            _queue_subscription = _opts.signal.subscribe([weak] {
+                if (auto fetch = weak.lock())
+                    boost::asio::post(fetch->_strand, [fetch] { fetch->leave_queue(error::aborted); });
+            });
         }
+        if (_opts.deadline)
+        {
+            _timer.expires_at(*_opts.deadline);
+            _timer.async_wait([self = shared_from_this(), round = _round](const boost::system::error_code& ec) {
+                if (!ec && round == self->_round)
+                    self->leave_queue(error::deadline_exceeded);
+            });
+        }
+    }
 
-        // Continue reading the body until EOF
-        boost::system::error_code error;
-        while (boost::asio::read(socket, response_buffer,
-                                 boost::asio::transfer_at_least(1), error)) {
-            body << &response_buffer;
+    void leave_queue(boost::system::error_code ec)
+    {
+        if (_queued == 0 || _finished)
+            return;
+
+        // When a slot was taken for the request meanwhile, on_slot gives it back
+        if (_host->cancel(_queued))
+            _queued = 0;
+        finish(ec, response());
+    }
+
+    void on_slot(std::size_t i)
+    {
+        _queued = 0;
+        if (_finished)
+            return _host->release(_client.config().concurrency, false, false, {});
+
+        _timer.cancel();
+        _opts.signal.unsubscribe(_queue_subscription);
+        _queue_subscription = 0;
+        send(i, true);
+    }
+
+    void send(std::size_t i, bool slot)
+    {
+        attempt& a = _attempts[i];
+        a.in_flight = true;
+        a.slot = slot;
+        a.started = clock::now();
+        ++_running;
+
+        const options* opts = &_opts;
+        if (_hedged)
+        {
+            a.controller = abort_controller();
+            a.opts.signal = a.controller.signal();
+            opts = &a.opts;
+        }
+
+        auto state = make_fetch_state(_shard.io_context, client_services(_client, _shard, _target), _target, *opts);
+        async_fetch(_shard.io_context,
+                    std::move(state),
+                    boost::asio::bind_executor(_strand,
+                                               [self = shared_from_this(), i](boost::system::error_code ec, response res) {
+                                                   self->on_attempt(i, ec, std::move(res));
+                                               }));
+
+        if (_hedged && i == 0)
+        {
+            _timer.expires_after(_host->hedge_delay(_client.config().hedge));
+            _timer.async_wait([self = shared_from_this(), round = _round](const boost::system::error_code& ec) {
+                if (!ec && round == self->_round && !self->_finished && self->_attempts[0].in_flight)
+                    self->launch(1, false);
+            });
+        }
+    }
+
+    void on_attempt(std::size_t i, boost::system::error_code ec, response res)
+    {
+        attempt& a = _attempts[i];
+        const auto latency = clock::now() - a.started;
+        a.in_flight = false;
+        --_running;
+
+        // Attempts the client aborted itself say nothing of the host
+        if (a.slot)
+        {
+            const bool dropped = ec || is_transient_status(res.status_code);
+            _host->release(_client.config().concurrency, ec != error::aborted, dropped, latency);
         }
-        if (error != boost::asio::error::eof) {
-            throw boost::system::system_error(error);
+        if (!ec && _hedged)
+            _host->record_latency(latency);
+        if (_finished)
+            return;
+
+        const bool transient =
+            ec ? is_transient_error(ec) : _client.config().retry.retry_status && is_transient_status(res.status_code);
+        if (!transient)
+            return finish(ec, std::move(res));
+
+        // A failed attempt leaves the request to the other, if it is still in flight
+        _last_error = ec;
+        _last = std::move(res);
+        if (_running != 0)
+            return;
+        _timer.cancel();
+        if (_attempts_made >= _max_attempts || !retry_later())
+            finish(_last_error, std::move(_last));
+    }
+
+    /// <summary>
+    /// Starts the next round after the backoff, unless it would end past the deadline.
+    /// </summary>
+    bool retry_later()
+    {
+        auto delay = std::max(backoff_delay(_client.config().retry, _attempts_made), retry_after(_last));
+        if (_opts.signal.aborted() || (_opts.deadline && clock::now() + delay >= *_opts.deadline))
+            return false;
+
+        _timer.expires_after(delay);
+        _timer.async_wait([self = shared_from_this()](const boost::system::error_code& ec) {
+            if (!ec)
+                self->next_round();
+        });
+        return true;
+    }
+
+    void abort_attempts()
+    {
+        for (auto& a : _attempts)
+        {
+            if (a.in_flight)
+                a.controller.abort();
         }
+    }
 
-        // Construct the response object
-        return {static_cast<int>(status_code), headers.str(), body.str()};
-    } catch (const std::exception& e) {
-        std::cerr << "Error: " << e.what() << std::endl;
-        return {500, "", e.what()};
+    void finish(boost::system::error_code ec, response res)
+    {
+        _finished = true;
+        _timer.cancel();
+        abort_attempts();
+        _opts.signal.unsubscribe(_subscription);
+        _opts.signal.unsubscribe(_queue_subscription);
+        _done(ec, std::move(res));
     }
+
+    client& _client;
+    client_shard& _shard;
+    boost::asio::strand<boost::asio::io_context::executor_type> _strand;
+    boost::asio::steady_timer _timer;
+    const uri _target;
+    options _opts;
+    completion _done;
+    std::shared_ptr<host_policy> _host;
+
+    int _max_attempts = 1;
+    bool _hedged = false;
+    std::array<attempt, 2> _attempts;
+    std::uint64_t _round = 0;
+    int _attempts_made = 0;
+    int _running = 0;
+    bool _finished = false;
+    std::uint64_t _subscription = 0;
+    std::uint64_t _queued = 0;
+    std::uint64_t _queue_subscription = 0;
+    boost::system::error_code _last_error;
+    response _last;
+};
+
+/// <summary>
+/// Starts a fetch through the policies of the client, completing on the associated executor of
+/// the handler.
+/// </summary>
+template<typename Handler>
+void start_policy_fetch(client& _client, client_shard& shard, uri _path, options _options, Handler handler)
+{
+    auto executor = boost::asio::get_associated_executor(handler, shard.io_context.get_executor());
+    auto work = boost::asio::make_work_guard(executor);
+    auto holder = std::make_shared<Handler>(std::move(handler));
+    auto done = [holder, work](boost::system::error_code ec, response res) {
+        boost::asio::post(work.get_executor(), [holder, work, ec, res = std::move(res)]() mutable {
+            (*holder)(ec, std::move(res));
+        });
+    };
+    std::make_shared<policy_fetch>(_client, shard, std::move(_path), std::move(_options), std::move(done))->start();
+}
+
+/// <summary>
+/// Starts a fetch through the client completing with a shared response, on the associated
+/// executor of the handler. When the client coalesces, and the request may be, it joins the
+/// identical request in flight or leads a new one.
+/// </summary>
+template<bool Shared, typename Target, typename Options, typename Handler>
+void start_shared_fetch(client& _client, Target&& _path, Options&& _options, Handler handler)
+{
+    auto& shard = _client.next_shard();
+    auto executor = boost::asio::get_associated_executor(handler, shard.io_context.get_executor());
+    auto work = boost::asio::make_work_guard(executor);
+    auto holder = std::make_shared<Handler>(std::move(handler));
+    single_flight::waiter deliver = [holder, work](boost::system::error_code ec, std::shared_ptr<const response> res) {
+        boost::asio::post(work.get_executor(), [holder, work, ec, res = std::move(res)]() mutable {
+            if constexpr (Shared)
+                (*holder)(ec, std::move(res));
+            else
+                (*holder)(ec, unshare(std::move(res)));
+        });
+    };
+
+    // A request others may join hands its response to the flight instead
+    std::string key;
+    if (_client.config().coalesce && single_flight::eligible(_options))
+    {
+        key = single_flight::make_key(_path, _options);
+        if (!_client.flights().join(key, deliver))
+            return;
+        deliver = nullptr;
+    }
+
+    auto on_done = [&flights = _client.flights(), key = std::move(key), deliver = std::move(deliver)](
+                       boost::system::error_code ec, response res) {
+        auto shared = std::make_shared<response>(std::move(res));
+        if (deliver)
+            deliver(ec, std::move(shared));
+        else
+            flights.finish(key, ec, std::move(shared));
+    };
+    if (_client.config().uses_policies())
+        return start_policy_fetch(_client, shard, std::forward<Target>(_path), std::forward<Options>(_options), std::move(on_done));
+
+    const auto services = client_services(_client, shard, _path);
+    auto state = make_fetch_state(shard.io_context, services, std::forward<Target>(_path), std::forward<Options>(_options));
+    async_fetch(shard.io_context, std::move(state), std::move(on_done));
+}
+
+/// <summary>
+/// Runs an operation started by <c>start</c>, which calls its argument once it completed, and
+/// blocks until then.
+/// </summary>
+template<typename Start>
+void run_blocking(client& _client, Start start)
+{
+    if (_client.owns_io_context()) {
+        bool done = false;
+        start([&] { done = true; });
+        _client.run_until([&] { return done; });
+    } else {
+        std::promise<void> promise;
+        auto completed = promise.get_future();
+        start([&] { promise.set_value(); });
+        completed.wait();
+    }
+}
+} // namespace details
+
+/// <summary>
+/// Asynchronously fetches a remote resource over a dedicated connection that is closed
+/// afterwards. The operation runs on the given I/O context and completes with the signature
+/// <c>void(boost::system::error_code, restpp::response)</c>, so any Asio completion token may be
+/// used: a callback, <c>boost::asio::use_future</c> or <c>boost::asio::use_awaitable</c>.
+/// </summary>
+template<typename CompletionToken>
+auto async_fetch(boost::asio::io_context& io_context, uri _path, options _options, CompletionToken&& token)
+{
+    details::fetch_services services;
+#ifndef RESTPP_EXCLUDE_SSL
+    services.tls = details::fetch_state::is_secure(_path) ? &details::default_tls_context() : nullptr;
+#endif
+    auto state = details::make_fetch_state(io_context, services, std::move(_path), std::move(_options));
+    return details::async_fetch(io_context, std::move(state), std::forward<CompletionToken>(token));
+}
+
+/// <summary>
+/// Asynchronously fetches a remote resource reusing the keep-alive connections pooled by the
+/// given client; requests to HTTP/2 servers share a connection as concurrent streams. The operation
+/// runs on the client's I/O context, or the next one of its executor, and completes with the
+/// signature <c>void(boost::system::error_code, restpp::response)</c>.
+/// </summary>
+template<typename CompletionToken>
+auto async_fetch(client& _client, uri _path, options _options, CompletionToken&& token)
+{
+    if (_client.config().coalesce && details::single_flight::eligible(_options))
+    {
+        return boost::asio::async_initiate<CompletionToken, void(boost::system::error_code, response)>(
+            [&_client](auto handler, uri _path, options _options) {
+                details::start_shared_fetch<false>(_client, std::move(_path), std::move(_options), std::move(handler));
+            },
+            token,
+            std::move(_path),
+            std::move(_options));
+    }
+
+    if (_client.config().uses_policies())
+    {
+        return boost::asio::async_initiate<CompletionToken, void(boost::system::error_code, response)>(
+            [&_client](auto handler, uri _path, options _options) {
+                details::start_policy_fetch(_client, _client.next_shard(), std::move(_path), std::move(_options), std::move(handler));
+            },
+            token,
+            std::move(_path),
+            std::move(_options));
+    }
+
+    auto& shard = _client.next_shard();
+    const auto services = details::client_services(_client, shard, _path);
+    auto state = details::make_fetch_state(shard.io_context, services, std::move(_path), std::move(_options));
+    return details::async_fetch(shard.io_context, std::move(state), std::forward<CompletionToken>(token));
+}
+
+/// <summary>
+/// Asynchronously fetches a remote resource through the given client, completing with the
+/// signature <c>void(boost::system::error_code, std::shared_ptr&lt;const restpp::response&gt;)</c>.
+/// When the client coalesces requests, every fetch that shared a request gets the same response,
+/// reference counted instead of copied.
+/// </summary>
+template<typename CompletionToken>
+auto async_fetch_shared(client& _client, uri _path, options _options, CompletionToken&& token)
+{
+    return boost::asio::async_initiate<CompletionToken,
+                                       void(boost::system::error_code, std::shared_ptr<const response>)>(
+        [&_client](auto handler, uri _path, options _options) {
+            details::start_shared_fetch<true>(_client, std::move(_path), std::move(_options), std::move(handler));
+        },
+        token,
+        std::move(_path),
+        std::move(_options));
+}
+
+/// <summary>
+/// Fetches a remote resource reusing the keep-alive connections pooled by the given client,
+/// into a response whose header and body storage is reused. Fetching into the same response
+/// over and over allocates nothing once its buffers have grown to fit. The URI and options are
+/// used in place, without being copied.
+///
+/// A client running on a caller supplied I/O context requires that context to be run by
+/// another thread while this call blocks.
+/// </summary>
+inline boost::system::error_code fetch(client& _client, const uri& _path, const options& _options, response& result) {
+    result.status_code = 0;
+    result.headers.clear();
+    result.body.clear();
+    result.alpn.clear();
+    result.tls_resumed = false;
+    result.timings = {};
+    result.error = {};
+    result.mapped.reset();
+
+    boost::system::error_code error;
+    if (_client.config().coalesce && details::single_flight::eligible(_options)) {
+        details::run_blocking(_client, [&](auto done) {
+            details::start_shared_fetch<false>(_client, _path, _options, [&, done](boost::system::error_code ec, response res) {
+                error = ec;
+                result = std::move(res);
+                done();
+            });
+        });
+        return error;
+    }
+
+    auto& shard = _client.next_shard();
+    if (_client.config().uses_policies()) {
+        details::run_blocking(_client, [&](auto done) {
+            details::start_policy_fetch(_client, shard, _path, _options, [&, done](boost::system::error_code ec, response res) {
+                error = ec;
+                result = std::move(res);
+                done();
+            });
+        });
+        return error;
+    }
+
+    auto state = details::make_fetch_state(shard.io_context, details::client_services(_client, shard, _path), _path, _options);
+    state->res = std::move(result);
+    details::run_blocking(_client, [&](auto done) {
+        details::async_fetch(shard.io_context, std::move(state), [&, done](boost::system::error_code ec, response res) {
+            error = ec;
+            result = std::move(res);
+            done();
+        });
+    });
+    return error;
+}
+
+/// <summary>
+/// Fetches a remote resource through the given client into a shared response, which is the
+/// same for every fetch that shared a request when the client coalesces them.
+/// </summary>
+inline boost::system::error_code fetch(client& _client,
+                                       const uri& _path,
+                                       const options& _options,
+                                       std::shared_ptr<const response>& result) {
+    boost::system::error_code error;
+    details::run_blocking(_client, [&](auto done) {
+        details::start_shared_fetch<true>(
+            _client, _path, _options, [&, done](boost::system::error_code ec, std::shared_ptr<const response> res) {
+                error = ec;
+                result = std::move(res);
+                done();
+            });
+    });
+    return error;
+}
+
+/// <summary>
+/// Fetches a remote resource reusing the keep-alive connections pooled by the given client.
+/// When the request fails, the response has <c>error</c> set and a status code of 0.
+/// A client running on a caller supplied I/O context requires that context to be run by
+/// another thread while this call blocks.
+/// </summary>
+inline response fetch(client& _client, const uri& _path, const options& _options = details::default_options()) {
+    response result;
+    result.error = fetch(_client, _path, _options, result);
+    return result;
+}
+
+/// <summary>
+/// Fetches a remote resource over a dedicated connection that is closed afterwards.
+/// </summary>
+inline response fetch(const uri& _path, const options& _options = details::default_options()) {
+    client_config config;
+    config.keep_alive = false;
+    client _client(config);
+    return fetch(_client, _path, _options);
+}
+
+/// <summary>
+/// Fetches a remote resource and decodes its JSON body into a value of the given type, whose
+/// fields are listed with <c>RESTPP_JSON_FIELDS</c>. Throws <c>boost::system::system_error</c>
+/// when the request fails or its status is not a success, and <c>json_exception</c> when the
+/// body does not fit the type.
+/// </summary>
+template<typename T>
+T fetch(client& _client, const uri& _path, const options& _options = details::default_options()) {
+    response result;
+    const auto ec = fetch(_client, _path, _options, result);
+    if (ec)
+        throw boost::system::system_error(ec);
+    if (result.status_code < 200 || result.status_code >= 300)
+        throw boost::system::system_error(error::unexpected_status, "HTTP status " + std::to_string(result.status_code));
+    return result.as<T>();
+}
+
+/// <summary>
+/// Fetches a remote resource over a dedicated connection and decodes its JSON body into a
+/// value of the given type.
+/// </summary>
+template<typename T>
+T fetch(const uri& _path, const options& _options = details::default_options()) {
+    client_config config;
+    config.keep_alive = false;
+    client _client(config);
+    return fetch<T>(_client, _path, _options);
 }
 
 } // namespace restpp
@@ -0,0 +1,414 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Fetching many resources concurrently, with results handed over as they complete.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_FETCH_ALL_HPP
+#define RESTPP_FETCH_ALL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include <restpp/core/client.hpp>
+#include <restpp/core/fetch.hpp>
+#include <restpp/core/options.hpp>
+#include <restpp/core/response.hpp>
+#include <restpp/core/uri.hpp>
+#include <restpp/core/details/pipeline_op.hpp>
+
+namespace restpp
+{
+
+/// <summary>
+/// Limits a batch of fetches runs under.
+/// </summary>
+struct fetch_all_config
+{
+    /// <summary>
+    /// Maximum number of requests in flight at once, over all hosts.
+    /// </summary>
+    std::size_t concurrency = 64;
+
+    /// <summary>
+    /// Maximum number of connections used at once to the same (scheme, host, port), each
+    /// carrying one request at a time or a pipeline of them. Requests to an HTTP/2 server share
+    /// its connection, and this caps their number instead.
+    /// </summary>
+    std::size_t max_per_host = 8;
+
+    /// <summary>
+    /// How many requests may be pipelined on one HTTP/1.1 connection; 1 disables pipelining.
+    /// Only bodiless GET and HEAD requests are pipelined, only over pooled connections whose
+    /// last response was HTTP/1.1 keep-alive, and a host that fails a pipelined exchange is
+    /// sent one request per connection from then on. Requests to HTTP/2 servers are multiplexed
+    /// as streams instead, and requests through a client with a cache are never pipelined.
+    /// </summary>
+    std::size_t pipeline_depth = 1;
+};
+
+/// <summary>
+/// Receives the outcome of each fetch of a batch, along with the position of its URI in the
+/// range given. When the I/O context runs on several threads, it may be called concurrently.
+/// </summary>
+using fetch_all_handler = std::function<void(std::size_t index, boost::system::error_code ec, response res)>;
+
+namespace details
+{
+/// <summary>
+/// Schedules the fetches of a batch over the connections of a client. Hosts with pending work
+/// take turns, so a slow or large host does not hold back the others, and as soon as a fetch
+/// completes the room it leaves is taken by the next pending one.
+/// </summary>
+class fetch_batch : public std::enable_shared_from_this<fetch_batch>
+{
+public:
+    template<typename Range>
+    fetch_batch(client& _client, const Range& targets, options _options, fetch_all_config config, fetch_all_handler on_result)
+        : _client(_client), _options(std::move(_options)), _config(config), _on_result(std::move(on_result))
+    {
+        _config.concurrency = std::max<std::size_t>(_config.concurrency, 1);
+        _config.max_per_host = std::max<std::size_t>(_config.max_per_host, 1);
+
+        // Requests through a cache go one by one, so that it can answer or revalidate each
+        const bool pipelinable = is_pipelinable(this->_options) && !_client.config().cache;
+        _config.pipeline_depth = pipelinable ? std::max<std::size_t>(_config.pipeline_depth, 1) : 1;
+
+        for (const auto& target : targets)
+            _targets.emplace_back(target);
+
+        for (std::size_t i = 0; i < _targets.size(); ++i)
+        {
+            const uri& target = _targets[i];
+            connection_key key{std::string(target.scheme()), std::string(target.host()), target.port()};
+            auto it = _hosts.find(key);
+            if (it == _hosts.end())
+            {
+                it = _hosts.emplace(key, host{}).first;
+                it->second.key = std::move(key);
+                _runnable.push_back(&it->second);
+                it->second.runnable = true;
+            }
+            it->second.pending.push_back(i);
+        }
+        _remaining = _targets.size();
+    }
+
+    fetch_batch(const fetch_batch&) = delete;
+    fetch_batch& operator=(const fetch_batch&) = delete;
+
+    /// <summary>
+    /// Starts fetching; <c>on_done</c> is called on the I/O context of the client once the
+    /// outcome of every fetch was handed over.
+    /// </summary>
+    void start(std::function<void()> on_done)
+    {
+        _on_done = std::move(on_done);
+        if (_remaining == 0)
+        {
+            boost::asio::post(_client.io_context(), std::move(_on_done));
+            return;
+        }
+        pump();
+    }
+
+private:
+    struct host
+    {
+        connection_key key;
+        std::deque<std::size_t> pending;
+        std::size_t lanes = 0;
+        bool runnable = false;
+        bool warmed = false;
+        bool pipelining = true;
+        bool forgave_stale = false;
+    };
+
+    struct launch
+    {
+        host* origin;
+        client_shard* shard;
+        std::vector<std::size_t> items;
+    };
+
+    /// <summary>
+    /// Lanes, that is single requests or pipelines, a host may have in flight. Until its first
+    /// response came back just one, so that it is known whether later requests can share an
+    /// HTTP/2 connection or reuse, and pipeline over, the keep-alive connection it came over,
+    /// rather than each setting up a connection of its own.
+    /// </summary>
+    std::size_t host_limit(const host& h) const { return h.warmed ? _config.max_per_host : 1; }
+
+    /// <summary>
+    /// Queues a host for its next turn if it has pending work and room for more. Called with
+    /// the lock held.
+    /// </summary>
+    void schedule(host& h)
+    {
+        if (!h.runnable && !h.pending.empty() && h.lanes < host_limit(h))
+        {
+            h.runnable = true;
+            _runnable.push_back(&h);
+        }
+    }
+
+    /// <summary>
+    /// Fills the room left under the limits. A host gets a pipeline when it has an idle
+    /// connection to carry it, and single fetches otherwise.
+    /// </summary>
+    void pump()
+    {
+        std::vector<launch> launches;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            while (_in_flight < _config.concurrency && !_runnable.empty())
+            {
+                host& h = *_runnable.front();
+                _runnable.pop_front();
+                h.runnable = false;
+                if (h.pending.empty() || h.lanes >= host_limit(h))
+                    continue;
+
+                // Lanes go to the shards of the client in turns, each with the connections there
+                client_shard& shard = _client.next_shard();
+                std::size_t count = 1;
+                if (_config.pipeline_depth > 1 && h.pipelining && shard.pool.idle_count(h.key) != 0)
+                    count = std::min({_config.pipeline_depth, _config.concurrency - _in_flight, h.pending.size()});
+
+                launch l{&h, &shard, {}};
+                l.items.assign(h.pending.begin(), h.pending.begin() + static_cast<std::ptrdiff_t>(count));
+                h.pending.erase(h.pending.begin(), h.pending.begin() + static_cast<std::ptrdiff_t>(count));
+                ++h.lanes;
+                _in_flight += count;
+                schedule(h);
+                launches.push_back(std::move(l));
+            }
+        }
+
+        for (auto& l : launches)
+            run(l);
+    }
+
+    /// <summary>
+    /// Starts a lane. Should the idle connection a pipeline was meant for be gone, or turn out
+    /// not to be pipelinable, all but the first request go back to the queue.
+    /// </summary>
+    void run(launch& l)
+    {
+        host& h = *l.origin;
+        if (l.items.size() > 1)
+        {
+            auto conn = l.shard->pool.acquire(h.key);
+            if (conn && conn->pipelinable())
+                return pipeline(l, std::move(conn));
+            if (conn)
+                l.shard->pool.release(h.key, std::move(conn));
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            h.pending.insert(h.pending.begin(), l.items.begin() + 1, l.items.end());
+            _in_flight -= l.items.size() - 1;
+            schedule(h);
+        }
+        fetch_one(h, *l.shard, l.items.front());
+    }
+
+    void fetch_one(host& h, client_shard& shard, std::size_t index)
+    {
+        const uri& target = _targets[index];
+        auto state = make_fetch_state(shard.io_context, client_services(_client, shard, target), target, _options);
+        details::async_fetch(shard.io_context,
+                             std::move(state),
+                             [self = shared_from_this(), &h, index](boost::system::error_code ec, response res) {
+                                 self->finish(h, index, ec, std::move(res), true);
+                             });
+    }
+
+    void pipeline(launch& l, std::unique_ptr<connection> conn)
+    {
+        host& h = *l.origin;
+        std::vector<const uri*> targets;
+        targets.reserve(l.items.size());
+        for (const std::size_t index : l.items)
+            targets.push_back(&_targets[index]);
+
+        // Requests a pipeline leaves unanswered are sent again, and so start again
+        if (auto* observer = _client.config().observer.get())
+        {
+            for (const uri* target : targets)
+                observer->on_start(*target, _options);
+        }
+
+        auto self = shared_from_this();
+        auto state = std::make_unique<pipeline_state>(
+            l.shard->pool, &l.shard->decoders, h.key, std::move(conn), _options, std::move(targets), [self, &h, items = l.items](std::size_t i, response res) {
+                if (auto* observer = self->_client.config().observer.get())
+                    observer->on_complete(self->_targets[items[i]], self->_options, {}, res);
+                self->finish(h, items[i], {}, std::move(res), false);
+            });
+        async_pipeline(l.shard->io_context,
+                       std::move(state),
+                       [self, &h, items = std::move(l.items)](boost::system::error_code ec, std::size_t completed) {
+                           self->requeue(h, items, completed, ec);
+                       });
+    }
+
+    /// <summary>
+    /// Hands over the outcome of a fetch. The lane of a pipeline stays taken until the whole
+    /// pipeline completed.
+    /// </summary>
+    void finish(host& h, std::size_t index, boost::system::error_code ec, response res, bool lane_done)
+    {
+        _on_result(index, ec, std::move(res));
+
+        bool done = false;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            --_in_flight;
+            done = --_remaining == 0;
+            h.warmed = true;
+            if (lane_done)
+                --h.lanes;
+            schedule(h);
+        }
+        if (done)
+            _on_done();
+        else
+            pump();
+    }
+
+    /// <summary>
+    /// Puts the requests a pipeline left unanswered back at the front of their host's queue.
+    /// Being idempotent, they are simply sent again. A failed exchange stops pipelining to the
+    /// host, except once for a pooled connection the server had already closed.
+    /// </summary>
+    void requeue(host& h, const std::vector<std::size_t>& items, std::size_t completed, boost::system::error_code ec)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            --h.lanes;
+            if (ec)
+            {
+                if (completed == 0 && is_stale_connection_error(ec) && !h.forgave_stale)
+                    h.forgave_stale = true;
+                else
+                    h.pipelining = false;
+            }
+            h.pending.insert(h.pending.begin(), items.begin() + static_cast<std::ptrdiff_t>(completed), items.end());
+            _in_flight -= items.size() - completed;
+            schedule(h);
+        }
+        pump();
+    }
+
+    client& _client;
+    const options _options;
+    fetch_all_config _config;
+    fetch_all_handler _on_result;
+    std::function<void()> _on_done;
+    std::vector<uri> _targets;
+
+    std::mutex _mutex;
+    std::map<connection_key, host> _hosts;
+    std::deque<host*> _runnable;
+    std::size_t _in_flight = 0;
+    std::size_t _remaining = 0;
+};
+
+class fetch_all_op
+{
+public:
+    explicit fetch_all_op(std::shared_ptr<fetch_batch> batch) : _batch(std::move(batch)) {}
+
+    template<typename Self>
+    void operator()(Self& self)
+    {
+        auto batch = std::move(_batch);
+        auto resume = std::make_shared<Self>(std::move(self));
+        batch->start([resume]() { resume->complete(boost::system::error_code()); });
+    }
+
+private:
+    std::shared_ptr<fetch_batch> _batch;
+};
+} // namespace details
+
+/// <summary>
+/// Asynchronously fetches every URI of a range through the given client, keeping up to
+/// <c>config.concurrency</c> requests in flight. The outcome of each fetch is handed to
+/// <c>on_result</c> as soon as it is known; the operation completes with
+/// <c>void(boost::system::error_code)</c> once all of them were.
+/// </summary>
+template<typename Range, typename CompletionToken>
+auto async_fetch_all(client& _client,
+                     const Range& targets,
+                     options _options,
+                     fetch_all_config config,
+                     fetch_all_handler on_result,
+                     CompletionToken&& token)
+{
+    auto batch = std::make_shared<details::fetch_batch>(_client, targets, std::move(_options), config, std::move(on_result));
+    return boost::asio::async_compose<CompletionToken, void(boost::system::error_code)>(
+        details::fetch_all_op(std::move(batch)), token, _client.io_context().get_executor());
+}
+
+/// <summary>
+/// Fetches every URI of a range through the given client, and returns once the outcome of each
+/// fetch was handed to <c>on_result</c>. A client running on a caller supplied I/O context
+/// requires that context to be run by another thread while this call blocks.
+/// </summary>
+template<typename Range>
+void fetch_all(client& _client, const Range& targets, const options& _options, fetch_all_config config, fetch_all_handler on_result)
+{
+    if (_client.owns_io_context())
+    {
+        bool done = false;
+        async_fetch_all(_client, targets, _options, config, std::move(on_result), [&](boost::system::error_code) {
+            done = true;
+        });
+        _client.run_until([&] { return done; });
+    }
+    else
+    {
+        std::promise<void> promise;
+        auto completed = promise.get_future();
+        async_fetch_all(_client, targets, _options, config, std::move(on_result), [&](boost::system::error_code) {
+            promise.set_value();
+        });
+        completed.wait();
+    }
+}
+
+/// <summary>
+/// Fetches every URI of a range with up to <c>concurrency</c> requests in flight, over
+/// connections that are kept for the batch and closed afterwards.
+/// </summary>
+template<typename Range>
+void fetch_all(const Range& targets, const options& _options, std::size_t concurrency, fetch_all_handler on_result)
+{
+    client _client;
+    fetch_all_config config;
+    config.concurrency = concurrency;
+    fetch_all(_client, targets, _options, config, std::move(on_result));
+}
+
+} // namespace restpp
+
+#endif // RESTPP_FETCH_ALL_HPP
@@ -0,0 +1,505 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * HTTP header fields of requests and responses.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_HEADERS_HPP
+#define RESTPP_HEADERS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <boost/container/small_vector.hpp>
+
+namespace restpp
+{
+
+/// <summary>
+/// Header names known to the library. Looking these up is O(1) on a <c>headers</c> instance.
+/// </summary>
+enum class field : std::uint8_t
+{
+    unknown = 0,
+    accept,
+    accept_encoding,
+    accept_language,
+    age,
+    authorization,
+    cache_control,
+    connection,
+    content_encoding,
+    content_length,
+    content_range,
+    content_type,
+    cookie,
+    date,
+    etag,
+    expect,
+    expires,
+    host,
+    if_modified_since,
+    if_none_match,
+    keep_alive,
+    last_modified,
+    location,
+    pragma,
+    range,
+    retry_after,
+    server,
+    set_cookie,
+    transfer_encoding,
+    upgrade,
+    user_agent,
+    vary,
+    www_authenticate
+};
+
+namespace details
+{
+constexpr std::size_t field_count = static_cast<std::size_t>(field::www_authenticate) + 1;
+
+// clang-format off
+constexpr std::string_view field_names[field_count] = {
+    "",
+    "Accept", "Accept-Encoding", "Accept-Language", "Age", "Authorization", "Cache-Control", "Connection",
+    "Content-Encoding", "Content-Length", "Content-Range", "Content-Type", "Cookie", "Date", "ETag", "Expect",
+    "Expires", "Host", "If-Modified-Since", "If-None-Match", "Keep-Alive", "Last-Modified", "Location", "Pragma",
+    "Range", "Retry-After", "Server", "Set-Cookie", "Transfer-Encoding", "Upgrade", "User-Agent", "Vary",
+    "WWW-Authenticate"
+};
+// clang-format on
+
+constexpr char ascii_tolower(char c) { return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c; }
+
+/// <summary>
+/// Case insensitive comparison of two ASCII strings.
+/// </summary>
+constexpr bool iequals(std::string_view left, std::string_view right)
+{
+    if (left.size() != right.size())
+        return false;
+    for (std::size_t i = 0; i < left.size(); ++i)
+    {
+        if (ascii_tolower(left[i]) != ascii_tolower(right[i]))
+            return false;
+    }
+    return true;
+}
+
+/// <summary>
+/// Case insensitive FNV-1a hash of a header name.
+/// </summary>
+constexpr std::uint32_t hash_field_name(std::string_view name)
+{
+    std::uint32_t hash = 2166136261u;
+    for (char c : name)
+    {
+        hash ^= static_cast<unsigned char>(ascii_tolower(c));
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/// <summary>
+/// Open addressing table from name hashes to known fields, built at compile time.
+/// </summary>
+struct field_table
+{
+    static constexpr std::size_t size = 128;
+    std::uint8_t slots[size] = {};
+};
+
+constexpr field_table make_field_table()
+{
+    field_table table;
+    for (std::size_t i = 1; i < field_count; ++i)
+    {
+        std::size_t slot = hash_field_name(field_names[i]) & (field_table::size - 1);
+        while (table.slots[slot] != 0)
+            slot = (slot + 1) & (field_table::size - 1);
+        table.slots[slot] = static_cast<std::uint8_t>(i);
+    }
+    return table;
+}
+
+inline constexpr field_table known_fields = make_field_table();
+
+} // namespace details
+
+/// <summary>
+/// Maps a header name, in any letter case, to the corresponding known field.
+/// </summary>
+constexpr field to_field(std::string_view name)
+{
+    std::size_t slot = details::hash_field_name(name) & (details::field_table::size - 1);
+    while (details::known_fields.slots[slot] != 0)
+    {
+        const auto id = details::known_fields.slots[slot];
+        if (details::iequals(details::field_names[id], name))
+            return static_cast<field>(id);
+        slot = (slot + 1) & (details::field_table::size - 1);
+    }
+    return field::unknown;
+}
+
+/// <summary>
+/// The canonical spelling of a known field.
+/// </summary>
+constexpr std::string_view to_string(field id) { return details::field_names[static_cast<std::size_t>(id)]; }
+
+/// <summary>
+/// An ordered collection of header fields with case insensitive lookup.
+///
+/// All names and values are stored back to back in a single string, and the entries indexing
+/// them live inline for up to 16 fields, so a typical header set costs at most one allocation.
+/// The first occurrence of every known <c>field</c> is indexed, making lookups of headers such as
+/// Content-Length or Content-Type constant time. Both the text and the entries past the inline
+/// ones come from a <c>std::pmr::memory_resource</c>, the default one unless another is given.
+/// </summary>
+class headers
+{
+public:
+    /// <summary>
+    /// A header name and value. Views are invalidated by any modification of the collection.
+    /// </summary>
+    using value_type = std::pair<std::string_view, std::string_view>;
+
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = headers::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = value_type;
+
+        const_iterator() = default;
+
+        value_type operator*() const { return _owner->at(_index); }
+
+        const_iterator& operator++()
+        {
+            ++_index;
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            auto copy = *this;
+            ++_index;
+            return copy;
+        }
+
+        bool operator==(const const_iterator& other) const { return _index == other._index; }
+
+        bool operator!=(const const_iterator& other) const { return _index != other._index; }
+
+    private:
+        friend class headers;
+
+        const_iterator(const headers* owner, std::size_t index) : _owner(owner), _index(index) {}
+
+        const headers* _owner = nullptr;
+        std::size_t _index = 0;
+    };
+
+    headers() { _index.fill(npos); }
+
+    /// <summary>
+    /// Fields stored in the given memory resource, such as an arena released along with a
+    /// request. As with pmr containers, the resource stays with the collection through
+    /// assignments, and copies of it use the default resource.
+    /// </summary>
+    explicit headers(std::pmr::memory_resource* resource)
+        : _text(resource), _entries(entry_list::allocator_type(std::pmr::polymorphic_allocator<entry>(resource)))
+    {
+        _index.fill(npos);
+    }
+
+    headers(std::initializer_list<value_type> fields) : headers()
+    {
+        for (const auto& f : fields)
+            add(f.first, f.second);
+    }
+
+    /// <summary>
+    /// Pre-allocates room for the given number of fields and bytes of names and values.
+    /// </summary>
+    void reserve(std::size_t count, std::size_t bytes)
+    {
+        _entries.reserve(count);
+        _text.reserve(bytes);
+    }
+
+    /// <summary>
+    /// Appends a field, keeping any existing field with the same name.
+    /// </summary>
+    void add(std::string_view name, std::string_view value) { add(to_field(name), name, value); }
+
+    void add(field id, std::string_view value) { add(id, restpp::to_string(id), value); }
+
+    /// <summary>
+    /// Sets a field, replacing every existing field with the same name.
+    /// </summary>
+    void set(std::string_view name, std::string_view value)
+    {
+        erase(name);
+        add(name, value);
+    }
+
+    void set(field id, std::string_view value)
+    {
+        erase(id);
+        add(id, value);
+    }
+
+    /// <summary>
+    /// Removes every field with the given name.
+    /// </summary>
+    /// <returns>The number of fields removed.</returns>
+    std::size_t erase(std::string_view name)
+    {
+        const field id = to_field(name);
+        if (id != field::unknown)
+            return erase(id);
+        return erase_if([&](const entry& e) { return e.id == field::unknown && details::iequals(name_of(e), name); });
+    }
+
+    std::size_t erase(field id)
+    {
+        if (_index[static_cast<std::size_t>(id)] == npos)
+            return 0;
+        return erase_if([&](const entry& e) { return e.id == id; });
+    }
+
+    bool contains(std::string_view name) const { return find(name) != nullptr; }
+
+    bool contains(field id) const { return _index[static_cast<std::size_t>(id)] != npos; }
+
+    /// <summary>
+    /// Returns the value of the first field with the given name.
+    /// </summary>
+    std::optional<std::string_view> get(std::string_view name) const
+    {
+        const entry* e = find(name);
+        if (!e)
+            return std::nullopt;
+        return value_of(*e);
+    }
+
+    std::optional<std::string_view> get(field id) const
+    {
+        const auto i = _index[static_cast<std::size_t>(id)];
+        if (i == npos)
+            return std::nullopt;
+        return value_of(_entries[i]);
+    }
+
+    /// <summary>
+    /// The value of Content-Length, if present and well formed.
+    /// </summary>
+    std::optional<std::uint64_t> content_length() const
+    {
+        const auto value = get(field::content_length);
+        if (!value || value->empty() || value->size() > 19)
+            return std::nullopt;
+
+        std::uint64_t length = 0;
+        for (char c : *value)
+        {
+            if (c < '0' || c > '9')
+                return std::nullopt;
+            length = length * 10 + static_cast<std::uint64_t>(c - '0');
+        }
+        return length;
+    }
+
+    /// <summary>
+    /// The value of Content-Type, or an empty view if absent.
+    /// </summary>
+    std::string_view content_type() const { return get(field::content_type).value_or(std::string_view()); }
+
+    std::size_t size() const { return _entries.size(); }
+
+    bool empty() const { return _entries.empty(); }
+
+    void clear()
+    {
+        _entries.clear();
+        _text.clear();
+        _index.fill(npos);
+    }
+
+    /// <summary>
+    /// The field at the given position, in insertion order.
+    /// </summary>
+    value_type at(std::size_t i) const { return {name_of(_entries[i]), value_of(_entries[i])}; }
+
+    /// <summary>
+    /// The known field identifier of the field at the given position.
+    /// </summary>
+    field id_at(std::size_t i) const { return _entries[i].id; }
+
+    /// <summary>
+    /// The memory resource the fields are stored in.
+    /// </summary>
+    std::pmr::memory_resource* resource() const { return _text.get_allocator().resource(); }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+
+    const_iterator end() const { return const_iterator(this, _entries.size()); }
+
+    /// <summary>
+    /// Serializes the fields as CRLF terminated "Name: value" lines.
+    /// </summary>
+    std::string to_string() const
+    {
+        std::string out;
+        out.reserve(_text.size() + 4 * _entries.size());
+        for (const auto& e : _entries)
+        {
+            out.append(name_of(e)).append(": ").append(value_of(e)).append("\r\n");
+        }
+        return out;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const headers& h)
+    {
+        for (const auto& e : h._entries)
+            os << h.name_of(e) << ": " << h.value_of(e) << "\r\n";
+        return os;
+    }
+
+private:
+    static constexpr std::uint16_t npos = 0xFFFF;
+
+    struct entry
+    {
+        std::uint32_t offset;
+        std::uint32_t name_size;
+        std::uint32_t value_size;
+        field id;
+    };
+
+    using entry_list = boost::container::small_vector<entry, 16, std::pmr::polymorphic_allocator<entry>>;
+
+    void add(field id, std::string_view name, std::string_view value)
+    {
+        if (name.size() + value.size() > std::numeric_limits<std::uint32_t>::max() - _text.size())
+            throw std::length_error("header fields exceed 4 GiB");
+
+        entry e;
+        e.offset = static_cast<std::uint32_t>(_text.size());
+        e.name_size = static_cast<std::uint32_t>(name.size());
+        e.value_size = static_cast<std::uint32_t>(value.size());
+        e.id = id;
+        _text.append(name).append(value);
+
+        auto& first = _index[static_cast<std::size_t>(id)];
+        if (id != field::unknown && first == npos)
+            first = static_cast<std::uint16_t>(_entries.size());
+        _entries.push_back(e);
+    }
+
+    const entry* find(std::string_view name) const
+    {
+        const field id = to_field(name);
+        if (id != field::unknown)
+        {
+            const auto i = _index[static_cast<std::size_t>(id)];
+            return i == npos ? nullptr : &_entries[i];
+        }
+        for (const auto& e : _entries)
+        {
+            if (e.id == field::unknown && e.name_size == name.size() && details::iequals(name_of(e), name))
+                return &e;
+        }
+        return nullptr;
+    }
+
+    template<typename Predicate>
+    std::size_t erase_if(Predicate matches)
+    {
+        std::size_t kept = 0;
+        std::size_t live = 0;
+        for (std::size_t i = 0; i < _entries.size(); ++i)
+        {
+            if (!matches(_entries[i]))
+            {
+                live += _entries[i].name_size + _entries[i].value_size;
+                _entries[kept++] = _entries[i];
+            }
+        }
+        const std::size_t removed = _entries.size() - kept;
+        if (removed == 0)
+            return 0;
+
+        // The text of removed fields stays in place until it outweighs that of the fields left,
+        // so a collection whose fields are set over and over stays within twice its size
+        _entries.resize(kept);
+        if (_text.size() - live > live)
+            compact();
+        _index.fill(npos);
+        for (std::size_t i = 0; i < _entries.size(); ++i)
+        {
+            auto& first = _index[static_cast<std::size_t>(_entries[i].id)];
+            if (_entries[i].id != field::unknown && first == npos)
+                first = static_cast<std::uint16_t>(i);
+        }
+        return removed;
+    }
+
+    /// <summary>
+    /// Moves the text of the remaining fields to the front of the buffer. Fields are appended in
+    /// order, so their text already is, and each only moves towards the front.
+    /// </summary>
+    void compact()
+    {
+        std::uint32_t offset = 0;
+        for (auto& e : _entries)
+        {
+            const std::uint32_t size = e.name_size + e.value_size;
+            if (e.offset != offset)
+                std::memmove(&_text[offset], _text.data() + e.offset, size);
+            e.offset = offset;
+            offset += size;
+        }
+        _text.resize(offset);
+    }
+
+    std::string_view name_of(const entry& e) const { return std::string_view(_text.data() + e.offset, e.name_size); }
+
+    std::string_view value_of(const entry& e) const
+    {
+        return std::string_view(_text.data() + e.offset + e.name_size, e.value_size);
+    }
+
+    std::pmr::string _text;
+    entry_list _entries;
+    std::array<std::uint16_t, details::field_count> _index;
+};
+
+} // namespace restpp
+
+#endif // RESTPP_HEADERS_HPP
@@ -0,0 +1,374 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * An HTTP cache (RFC 9111) clients consult before going to the network.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_HTTP_CACHE_HPP
+#define RESTPP_HTTP_CACHE_HPP
+
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <restpp/core/headers.hpp>
+#include <restpp/core/options.hpp>
+#include <restpp/core/response.hpp>
+#include <restpp/core/uri.hpp>
+#include <restpp/core/details/cache_policy.hpp>
+#include <restpp/core/details/cache_store.hpp>
+
+namespace restpp
+{
+
+/// <summary>
+/// Settings of an <c>http_cache</c>.
+/// </summary>
+struct cache_config
+{
+    /// <summary>
+    /// Bytes of responses kept in memory, headers and bodies alike.
+    /// </summary>
+    std::size_t memory_budget = 64 * 1024 * 1024;
+
+    /// <summary>
+    /// Number of independently locked parts the memory is split into, each holding its share of
+    /// the budget. More shards let more threads use the cache at once.
+    /// </summary>
+    std::size_t shards = 16;
+
+    /// <summary>
+    /// Directory of the disk tier, which keeps responses evicted from memory and those of earlier
+    /// runs. Empty, the default, keeps responses in memory only.
+    /// </summary>
+    std::string directory;
+
+    /// <summary>
+    /// Bytes of files kept in the directory.
+    /// </summary>
+    std::uint64_t disk_budget = 1024 * 1024 * 1024;
+
+    /// <summary>
+    /// Behave as a shared cache, which serves several users: responses marked private, and those
+    /// to requests with credentials not explicitly allowed, are not stored, and s-maxage applies.
+    /// A cache used by a single application is private, the default.
+    /// </summary>
+    bool shared = false;
+};
+
+/// <summary>
+/// What a cache lookup found for a request.
+/// </summary>
+enum class cache_lookup
+{
+    /// <summary>
+    /// The request goes to the network and is not cached.
+    /// </summary>
+    bypass,
+
+    /// <summary>
+    /// Nothing usable is stored; the request goes to the network and its response may be stored.
+    /// </summary>
+    miss,
+
+    /// <summary>
+    /// A stored response answers the request.
+    /// </summary>
+    hit,
+
+    /// <summary>
+    /// A stored response needs validating: the request goes out conditionally, and a 304 answer
+    /// is served from the stored one.
+    /// </summary>
+    revalidate,
+
+    /// <summary>
+    /// The request asked for only-if-cached and nothing usable is stored; it is answered with a
+    /// 504 Gateway Timeout without going to the network.
+    /// </summary>
+    unsatisfiable
+};
+
+namespace details
+{
+/// <summary>
+/// What a fetch carries from its cache lookup to the arrival of its response.
+/// </summary>
+struct cache_exchange
+{
+    cache_lookup lookup = cache_lookup::bypass;
+    std::string key;
+    std::shared_ptr<const cached_response> stored;
+
+    /// <summary>
+    /// The validators sent with a revalidating request.
+    /// </summary>
+    restpp::headers conditional;
+
+    std::chrono::system_clock::time_point request_time;
+};
+} // namespace details
+
+/// <summary>
+/// A cache of HTTP responses, following RFC 9111, that answers repeated requests without going
+/// to the network for as long as the responses stay fresh. Stale responses with an ETag or a
+/// Last-Modified date are revalidated with a conditional request, and served again when the
+/// server answers 304 Not Modified. Responses are matched on the request fields named by their
+/// Vary header.
+///
+/// Only GET requests without a body sink, a range or conditional headers of their own use the
+/// cache; successful requests of other methods, such as POST or DELETE, invalidate what is stored
+/// of their target. Responses whose body was decoded are stored apart from those that were not.
+///
+/// Responses are kept in a memory LRU split into independently locked shards, and, when given a
+/// directory, written through to files there, read back through memory mappings. A cache may be
+/// shared between threads and between clients, through <c>client_config::cache</c>.
+/// </summary>
+class http_cache
+{
+public:
+    explicit http_cache(cache_config config = {})
+        : _config(std::move(config))
+        , _memory(_config.memory_budget, _config.shards)
+        , _disk(_config.directory.empty() ? nullptr
+                                          : std::make_unique<details::disk_cache>(_config.directory, _config.disk_budget))
+    {
+    }
+
+    http_cache(const http_cache&) = delete;
+    http_cache& operator=(const http_cache&) = delete;
+
+    const cache_config& config() const { return _config; }
+
+    /// <summary>
+    /// Drops every stored response, from memory and disk.
+    /// </summary>
+    void clear()
+    {
+        _memory.clear();
+        if (_disk)
+            _disk->clear();
+    }
+
+    /// <summary>
+    /// Drops what is stored of the given URI.
+    /// </summary>
+    void erase(const uri& target)
+    {
+        erase(make_key(target, false));
+        erase(make_key(target, true));
+    }
+
+    /// <summary>
+    /// Bytes of responses held in memory.
+    /// </summary>
+    std::size_t memory_size() const { return _memory.size(); }
+
+    /// <summary>
+    /// Bytes of files held in the disk tier.
+    /// </summary>
+    std::uint64_t disk_size() const { return _disk ? _disk->size() : 0; }
+
+    /// <summary>
+    /// Looks for a response to the request, before it is sent. On a hit the response is written
+    /// to <c>res</c>, with its Age, as it is for an unsatisfiable only-if-cached request.
+    /// </summary>
+    cache_lookup lookup(const uri& target, const options& request, details::cache_exchange& exchange, response& res)
+    {
+        exchange.lookup = cache_lookup::bypass;
+        if (!details::is_cacheable_request(request))
+            return exchange.lookup;
+        const auto cc = details::parse_cache_control(request.headers);
+        if (cc.no_store)
+            return exchange.lookup;
+
+        const auto now = std::chrono::system_clock::now();
+        exchange.key = make_key(target, request.decode_content);
+        exchange.request_time = now;
+        exchange.lookup = cache_lookup::miss;
+
+        details::cached_variants variants;
+        if (!find(exchange.key, variants))
+            return finish_lookup(exchange, cc, res);
+
+        for (const auto& variant : variants)
+        {
+            if (!variant->matches(request))
+                continue;
+
+            const auto age = variant->current_age(now);
+            if (!variant->no_cache && !cc.no_cache && (!cc.max_age || age <= *cc.max_age) &&
+                (!cc.min_fresh || variant->lifetime - age >= *cc.min_fresh))
+            {
+                // Stale responses are served only to requests that said they would take them
+                const auto staleness = age - variant->lifetime;
+                if (age < variant->lifetime ||
+                    (!variant->must_revalidate && cc.max_stale && staleness <= *cc.max_stale))
+                {
+                    serve(*variant, age, res);
+                    return exchange.lookup = cache_lookup::hit;
+                }
+            }
+
+            if (variant->has_validators() && !cc.only_if_cached)
+            {
+                exchange.conditional.clear();
+                if (const auto etag = variant->headers.get(field::etag))
+                    exchange.conditional.add(field::if_none_match, *etag);
+                if (const auto modified = variant->headers.get(field::last_modified))
+                    exchange.conditional.add(field::if_modified_since, *modified);
+                exchange.stored = variant;
+                return exchange.lookup = cache_lookup::revalidate;
+            }
+            break;
+        }
+        return finish_lookup(exchange, cc, res);
+    }
+
+    /// <summary>
+    /// Takes the response to a request that was looked up, storing it when allowed. A 304 to a
+    /// revalidating request is replaced with the stored response it refreshed.
+    /// </summary>
+    void update(const uri& target, const options& request, details::cache_exchange& exchange, response& res)
+    {
+        if (exchange.lookup == cache_lookup::bypass)
+        {
+            if (details::is_unsafe_method(request.method) && res.status_code >= 200 && res.status_code < 400)
+                erase(target);
+            return;
+        }
+        if (exchange.lookup != cache_lookup::miss && exchange.lookup != cache_lookup::revalidate)
+            return;
+
+        const auto now = std::chrono::system_clock::now();
+        if (res.status_code == 304 && exchange.stored)
+        {
+            auto refreshed = std::make_shared<details::cached_response>(*exchange.stored);
+            refreshed->headers = details::merge_not_modified(exchange.stored->headers, res.headers);
+            refreshed->request_time = exchange.request_time;
+            refreshed->response_time = now;
+            refreshed->derive(_config.shared);
+
+            serve(*refreshed, refreshed->current_age(now), res);
+            if (details::is_storable(request, refreshed->status_code, refreshed->headers, _config.shared))
+                store(exchange.key, std::move(refreshed));
+            else
+                erase(exchange.key);
+            return;
+        }
+
+        if (!details::is_storable(request, res.status_code, res.headers, _config.shared))
+            return;
+
+        auto entry = std::make_shared<details::cached_response>();
+        entry->status_code = res.status_code;
+        entry->headers = res.headers;
+        entry->body = res.body;
+        for (auto& name : details::vary_names(res.headers))
+        {
+            auto value = details::request_field_value(request, name);
+            entry->vary.emplace_back(std::move(name), std::move(value));
+        }
+        entry->request_time = exchange.request_time;
+        entry->response_time = now;
+        entry->derive(_config.shared);
+
+        // Nothing is gained from a response that is stale at once and cannot be validated
+        if (entry->current_age(now) >= entry->lifetime && !entry->has_validators())
+            return;
+        store(exchange.key, std::move(entry));
+    }
+
+private:
+    static std::string make_key(const uri& target, bool decoded)
+    {
+        std::string key(decoded ? "GET+decoded " : "GET ");
+        key.append(target.to_string());
+        return key;
+    }
+
+    void erase(const std::string& key)
+    {
+        _memory.shard(key).erase(key);
+        if (_disk)
+            _disk->erase(key);
+    }
+
+    bool find(const std::string& key, details::cached_variants& variants)
+    {
+        auto& shard = _memory.shard(key);
+        if (shard.find(key, variants))
+            return true;
+        if (!_disk || !_disk->load(key, _config.shared, variants))
+            return false;
+        shard.put(key, variants);
+        return true;
+    }
+
+    static cache_lookup finish_lookup(details::cache_exchange& exchange, const details::cache_control& cc, response& res)
+    {
+        if (!cc.only_if_cached)
+            return exchange.lookup;
+        res.status_code = 504;
+        res.headers.clear();
+        res.body.clear();
+        return exchange.lookup = cache_lookup::unsatisfiable;
+    }
+
+    static void serve(const details::cached_response& stored, std::chrono::seconds age, response& res)
+    {
+        res.status_code = stored.status_code;
+        res.headers = stored.headers;
+        char digits[24];
+        const char* end = std::to_chars(digits, digits + sizeof(digits), age.count()).ptr;
+        res.headers.set(field::age, std::string_view(digits, static_cast<std::size_t>(end - digits)));
+        res.body.assign(stored.body);
+    }
+
+    /// <summary>
+    /// Stores a response alongside those of the same target that vary on other request values,
+    /// replacing the one it matches.
+    /// </summary>
+    void store(const std::string& key, std::shared_ptr<const details::cached_response> entry)
+    {
+        details::cached_variants variants;
+        find(key, variants);
+        variants.erase(std::remove_if(variants.begin(),
+                                      variants.end(),
+                                      [&](const std::shared_ptr<const details::cached_response>& variant) {
+                                          return variant->vary == entry->vary;
+                                      }),
+                       variants.end());
+
+        // Keep the number of variants of a target bounded, dropping the oldest first
+        constexpr std::size_t max_variants = 8;
+        if (variants.size() >= max_variants)
+            variants.erase(variants.begin(), variants.begin() + (variants.size() - max_variants + 1));
+        variants.push_back(std::move(entry));
+
+        _memory.shard(key).put(key, variants);
+        if (_disk)
+            _disk->store(key, variants);
+    }
+
+    cache_config _config;
+    details::memory_cache _memory;
+    std::unique_ptr<details::disk_cache> _disk;
+};
+
+} // namespace restpp
+
+#endif // RESTPP_HTTP_CACHE_HPP
@@ -0,0 +1,829 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * On-demand access to JSON documents, such as response bodies, without building a tree.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_JSON_HPP
+#define RESTPP_JSON_HPP
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <restpp/core/details/json_index.hpp>
+#include <restpp/core/details/utf8.hpp>
+
+namespace restpp
+{
+
+/// <summary>
+/// Errors in JSON text, and accesses to a JSON value as something it is not.
+/// </summary>
+class json_exception : public std::exception
+{
+public:
+    json_exception(std::string msg) : _msg{std::move(msg)} {}
+
+    ~json_exception() noexcept {}
+
+    const char* what() const noexcept override { return _msg.c_str(); }
+
+private:
+    std::string _msg;
+};
+
+enum class json_type
+{
+    null,
+    boolean,
+    number,
+    string,
+    array,
+    object
+};
+
+class json_document;
+class json_array_iterator;
+class json_object_iterator;
+
+namespace details
+{
+inline bool is_json_delimiter(char c)
+{
+    switch (c)
+    {
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+        case ',':
+        case ':':
+        case '[':
+        case ']':
+        case '{':
+        case '}':
+        case '"': return true;
+        default: return false;
+    }
+}
+
+inline int json_hex_value(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+inline bool read_json_hex4(std::string_view raw, std::size_t at, std::uint32_t& value)
+{
+    if (at + 4 > raw.size())
+        return false;
+    value = 0;
+    for (std::size_t i = at; i < at + 4; ++i)
+    {
+        const int digit = json_hex_value(raw[i]);
+        if (digit < 0)
+            return false;
+        value = (value << 4) | static_cast<std::uint32_t>(digit);
+    }
+    return true;
+}
+
+/// <summary>
+/// Appends the unescaped form of the contents of a JSON string to <c>out</c>.
+/// </summary>
+/// <returns>False when an escape is malformed.</returns>
+inline bool unescape_json(std::string_view raw, std::string& out)
+{
+    std::size_t done = 0;
+    std::size_t slash = raw.find('\\');
+    while (slash != std::string_view::npos)
+    {
+        out.append(raw.data() + done, slash - done);
+        if (slash + 1 >= raw.size())
+            return false;
+
+        std::size_t next = slash + 2;
+        switch (raw[slash + 1])
+        {
+            case '"': out.push_back('"'); break;
+            case '\\': out.push_back('\\'); break;
+            case '/': out.push_back('/'); break;
+            case 'b': out.push_back('\b'); break;
+            case 'f': out.push_back('\f'); break;
+            case 'n': out.push_back('\n'); break;
+            case 'r': out.push_back('\r'); break;
+            case 't': out.push_back('\t'); break;
+            case 'u':
+            {
+                std::uint32_t code_point;
+                if (!read_json_hex4(raw, slash + 2, code_point))
+                    return false;
+                next = slash + 6;
+
+                // Characters outside the basic plane come as a surrogate pair
+                if (code_point >= 0xD800 && code_point < 0xDC00)
+                {
+                    std::uint32_t low;
+                    if (next + 1 >= raw.size() || raw[next] != '\\' || raw[next + 1] != 'u' ||
+                        !read_json_hex4(raw, next + 2, low) || low < 0xDC00 || low >= 0xE000)
+                        return false;
+                    code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                    next += 6;
+                }
+                else if (code_point >= 0xDC00 && code_point < 0xE000)
+                    return false;
+                append_utf8(out, code_point);
+                break;
+            }
+            default: return false;
+        }
+        done = next;
+        slash = raw.find('\\', done);
+    }
+    out.append(raw.data() + done, raw.size() - done);
+    return true;
+}
+} // namespace details
+
+/// <summary>
+/// A value in a <c>json_document</c>. Values are small handles, cheap to copy, that stay valid
+/// as long as the document and the text it views. Nothing is parsed until it is asked for:
+/// looking up a member skips over the values before it, and a number is only converted when
+/// it is read, so a few fields can be taken out of a large document without building a tree.
+///
+/// Lookups with <c>operator[]</c> and the <c>get_*</c> accessors throw <c>json_exception</c>
+/// when the value is not what is asked for; <c>find</c> returns an empty value instead.
+/// </summary>
+class json_value
+{
+public:
+    /// <summary>
+    /// An empty value, as returned by <c>find</c> for members that do not exist.
+    /// </summary>
+    json_value() = default;
+
+    explicit operator bool() const { return _document != nullptr; }
+
+    json_type type() const;
+
+    bool is_null() const { return *this && type() == json_type::null; }
+    bool is_bool() const { return *this && type() == json_type::boolean; }
+    bool is_number() const { return *this && type() == json_type::number; }
+    bool is_string() const { return *this && type() == json_type::string; }
+    bool is_array() const { return *this && type() == json_type::array; }
+    bool is_object() const { return *this && type() == json_type::object; }
+
+    /// <summary>
+    /// The member of an object with the given name, or an empty value.
+    /// </summary>
+    json_value find(std::string_view name) const;
+
+    /// <summary>
+    /// The member of an object with the given name.
+    /// </summary>
+    json_value operator[](std::string_view name) const;
+
+    json_value operator[](const char* name) const { return (*this)[std::string_view(name)]; }
+
+    /// <summary>
+    /// The element of an array at the given position.
+    /// </summary>
+    json_value operator[](std::size_t position) const;
+
+    /// <summary>
+    /// The value a JSON pointer (RFC 6901) such as <c>"/items/0/id"</c> designates, or an empty
+    /// value.
+    /// </summary>
+    json_value at_pointer(std::string_view pointer) const;
+
+    /// <summary>
+    /// The number of elements of an array or members of an object, counted by walking them.
+    /// </summary>
+    std::size_t size() const;
+
+    bool get_bool() const;
+    std::int64_t get_int64() const;
+    std::uint64_t get_uint64() const;
+    double get_double() const;
+
+    /// <summary>
+    /// The contents of a string, with its escapes decoded.
+    /// </summary>
+    std::string get_string() const;
+
+    /// <summary>
+    /// The contents of a string as they appear in the text, escapes included, without copying.
+    /// </summary>
+    std::string_view get_raw_string() const;
+
+    /// <summary>
+    /// The JSON text of the value, whatever its type, as a view into the document.
+    /// </summary>
+    std::string_view raw_json() const;
+
+    /// <summary>
+    /// The elements of an array, for range-based for loops.
+    /// </summary>
+    std::pair<json_array_iterator, json_array_iterator> elements() const;
+
+    /// <summary>
+    /// The members of an object, for range-based for loops.
+    /// </summary>
+    std::pair<json_object_iterator, json_object_iterator> members() const;
+
+private:
+    friend class json_document;
+    friend class json_array_iterator;
+    friend class json_object_iterator;
+
+    json_value(const json_document* document, std::uint32_t position) : _document(document), _position(position) {}
+
+    char first() const;
+    std::uint32_t offset() const;
+    std::string_view text() const;
+    json_value at(std::uint32_t position) const { return json_value(_document, position); }
+    std::uint32_t skip() const;
+
+    /// <summary>
+    /// The text of a number or literal: everything up to the next delimiter.
+    /// </summary>
+    std::string_view scalar_text() const;
+
+    const json_document* _document = nullptr;
+    std::uint32_t _position = 0;
+};
+
+/// <summary>
+/// A member of an object: its name, escapes included, and its value.
+/// </summary>
+struct json_member
+{
+    std::string_view name;
+    json_value value;
+};
+
+/// <summary>
+/// JSON text, indexed in one pass over its bytes. The index lists the offset of every
+/// structural character, found 64 bytes at a time by vector compares in the manner of
+/// simdjson, and every later access only walks the part of the index it needs.
+///
+/// The document views the text without copying it; the text, such as the body of a
+/// <c>response</c>, must outlive the document and the values taken from it, and stay
+/// unchanged. The document can be moved but not copied.
+/// </summary>
+class json_document
+{
+public:
+    json_document() = default;
+
+    /// <summary>
+    /// Indexes the given text. Throws <c>json_exception</c> when the text is not a single JSON
+    /// value with balanced brackets and terminated strings; the rest of the grammar is checked
+    /// as the values are accessed.
+    /// </summary>
+    explicit json_document(std::string_view text) : _text(text)
+    {
+        if (text.size() >= std::numeric_limits<std::uint32_t>::max())
+            throw json_exception("JSON text is too large");
+        if (!details::index_json(text, _index))
+            throw json_exception("invalid JSON: unterminated string");
+        check_structure();
+        _index.push_back(static_cast<std::uint32_t>(text.size()));
+    }
+
+    json_document(json_document&&) = default;
+    json_document& operator=(json_document&&) = default;
+    json_document(const json_document&) = delete;
+    json_document& operator=(const json_document&) = delete;
+
+    json_value root() const
+    {
+        if (_index.size() < 2)
+            throw json_exception("invalid JSON: no value");
+        return json_value(this, 0);
+    }
+
+    json_value find(std::string_view name) const { return root().find(name); }
+    json_value operator[](std::string_view name) const { return root()[name]; }
+    json_value operator[](const char* name) const { return root()[std::string_view(name)]; }
+    json_value operator[](std::size_t position) const { return root()[position]; }
+    json_value at_pointer(std::string_view pointer) const { return root().at_pointer(pointer); }
+
+    std::string_view text() const { return _text; }
+
+private:
+    friend class json_value;
+    friend class json_array_iterator;
+    friend class json_object_iterator;
+
+    /// <summary>
+    /// Checks that brackets come in matching pairs and that the text holds a single value,
+    /// walking the index once.
+    /// </summary>
+    void check_structure() const
+    {
+        std::vector<char> open;
+        std::size_t roots = 0;
+        for (const std::uint32_t offset : _index)
+        {
+            const char c = _text[offset];
+            if (open.empty() && c != '}' && c != ']' && ++roots > 1)
+                throw json_exception("invalid JSON: more than one value");
+
+            switch (c)
+            {
+                case '{':
+                case '[': open.push_back(c); break;
+                case '}':
+                case ']':
+                    if (open.empty() || open.back() != (c == '}' ? '{' : '['))
+                        throw json_exception(std::string("invalid JSON: unexpected '") + c + "'");
+                    open.pop_back();
+                    break;
+                case ':':
+                case ',':
+                    if (open.empty())
+                        throw json_exception(std::string("invalid JSON: unexpected '") + c + "'");
+                    break;
+                default: break;
+            }
+        }
+        if (!open.empty())
+            throw json_exception("invalid JSON: unterminated array or object");
+    }
+
+    char at(std::uint32_t position) const { return _text[_index[position]]; }
+
+    /// <summary>
+    /// Whether the structural at the given position is the given character. The last position
+    /// only marks the end of the text, and is never one.
+    /// </summary>
+    bool is_at(std::uint32_t position, char c) const { return position + 1 < _index.size() && at(position) == c; }
+
+    /// <summary>
+    /// Throws unless the structural at the given position is the expected character.
+    /// </summary>
+    void expect(std::uint32_t position, char c) const
+    {
+        if (position + 1 >= _index.size() || at(position) != c)
+            throw json_exception(std::string("invalid JSON: expected '") + c + "'");
+    }
+
+    std::string_view _text;
+
+    // The offset of every structural character, followed by the length of the text
+    std::vector<std::uint32_t> _index;
+};
+
+/// <summary>
+/// Walks the elements of an array.
+/// </summary>
+class json_array_iterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = json_value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const json_value*;
+    using reference = json_value;
+
+    json_array_iterator() = default;
+
+    json_value operator*() const { return json_value(_document, _position); }
+
+    json_array_iterator& operator++()
+    {
+        const std::uint32_t next = json_value(_document, _position).skip();
+        if (_document->is_at(next, ','))
+        {
+            _position = next + 1;
+            if (_document->is_at(_position, ']'))
+                throw json_exception("invalid JSON: unexpected ']'");
+        }
+        else
+        {
+            _document->expect(next, ']');
+            _position = next;
+        }
+        return *this;
+    }
+
+    json_array_iterator operator++(int)
+    {
+        auto previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    bool operator==(const json_array_iterator& other) const { return _position == other._position; }
+    bool operator!=(const json_array_iterator& other) const { return _position != other._position; }
+
+private:
+    friend class json_value;
+
+    json_array_iterator(const json_document* document, std::uint32_t position) : _document(document), _position(position)
+    {
+    }
+
+    const json_document* _document = nullptr;
+    std::uint32_t _position = 0;
+};
+
+/// <summary>
+/// Walks the members of an object.
+/// </summary>
+class json_object_iterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = json_member;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const json_member*;
+    using reference = json_member;
+
+    json_object_iterator() = default;
+
+    json_member operator*() const
+    {
+        return json_member{json_value(_document, _position).get_raw_string(), json_value(_document, _position + 2)};
+    }
+
+    json_object_iterator& operator++()
+    {
+        const std::uint32_t next = json_value(_document, _position + 2).skip();
+        if (_document->is_at(next, ','))
+        {
+            _position = next + 1;
+            check_member();
+        }
+        else
+        {
+            _document->expect(next, '}');
+            _position = next;
+        }
+        return *this;
+    }
+
+    json_object_iterator operator++(int)
+    {
+        auto previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    bool operator==(const json_object_iterator& other) const { return _position == other._position; }
+    bool operator!=(const json_object_iterator& other) const { return _position != other._position; }
+
+private:
+    friend class json_value;
+
+    json_object_iterator(const json_document* document, std::uint32_t position) : _document(document), _position(position)
+    {
+    }
+
+    /// <summary>
+    /// Checks that a member starts at the current position: a name, a colon and a value.
+    /// </summary>
+    void check_member() const
+    {
+        _document->expect(_position, '"');
+        _document->expect(_position + 1, ':');
+        if (_position + 2 + 1 >= _document->_index.size())
+            throw json_exception("invalid JSON: missing value");
+    }
+
+    const json_document* _document = nullptr;
+    std::uint32_t _position = 0;
+};
+
+inline json_array_iterator begin(const std::pair<json_array_iterator, json_array_iterator>& range) { return range.first; }
+inline json_array_iterator end(const std::pair<json_array_iterator, json_array_iterator>& range) { return range.second; }
+inline json_object_iterator begin(const std::pair<json_object_iterator, json_object_iterator>& range) { return range.first; }
+inline json_object_iterator end(const std::pair<json_object_iterator, json_object_iterator>& range) { return range.second; }
+
+inline char json_value::first() const
+{
+    if (!_document)
+        throw json_exception("JSON value does not exist");
+    return _document->at(_position);
+}
+
+inline std::uint32_t json_value::offset() const { return _document->_index[_position]; }
+
+inline std::string_view json_value::text() const { return _document->_text; }
+
+inline json_type json_value::type() const
+{
+    switch (first())
+    {
+        case '{': return json_type::object;
+        case '[': return json_type::array;
+        case '"': return json_type::string;
+        case 't':
+        case 'f':
+        case 'n':
+        {
+            const std::string_view literal = scalar_text();
+            if (literal == "null")
+                return json_type::null;
+            if (literal == "true" || literal == "false")
+                return json_type::boolean;
+            throw json_exception("invalid JSON: unexpected '" + std::string(literal) + "'");
+        }
+        case '-':
+        case '0':
+        case '1':
+        case '2':
+        case '3':
+        case '4':
+        case '5':
+        case '6':
+        case '7':
+        case '8':
+        case '9': return json_type::number;
+        default: throw json_exception(std::string("invalid JSON: unexpected '") + first() + "'");
+    }
+}
+
+inline std::uint32_t json_value::skip() const
+{
+    const char c = first();
+    if (c == '}' || c == ']' || c == ',' || c == ':')
+        throw json_exception(std::string("invalid JSON: unexpected '") + c + "'");
+    if (c != '{' && c != '[')
+        return _position + 1;
+
+    // Brackets were checked to be balanced when indexing, so counting them finds the end
+    std::uint32_t position = _position + 1;
+    for (std::size_t depth = 1; depth != 0; ++position)
+    {
+        switch (_document->at(position))
+        {
+            case '{':
+            case '[': ++depth; break;
+            case '}':
+            case ']': --depth; break;
+            default: break;
+        }
+    }
+    return position;
+}
+
+inline std::string_view json_value::scalar_text() const
+{
+    const std::string_view all = text();
+    std::size_t end = offset();
+    while (end < all.size() && !details::is_json_delimiter(all[end]))
+        ++end;
+    return all.substr(offset(), end - offset());
+}
+
+inline std::pair<json_array_iterator, json_array_iterator> json_value::elements() const
+{
+    if (first() != '[')
+        throw json_exception("JSON value is not an array");
+    const std::uint32_t close = skip() - 1;
+    const std::uint32_t start = _document->at(_position + 1) == ']' ? close : _position + 1;
+    return {json_array_iterator(_document, start), json_array_iterator(_document, close)};
+}
+
+inline std::pair<json_object_iterator, json_object_iterator> json_value::members() const
+{
+    if (first() != '{')
+        throw json_exception("JSON value is not an object");
+    const std::uint32_t close = skip() - 1;
+    json_object_iterator start(_document, _position + 1);
+    if (_document->at(_position + 1) == '}')
+        start = json_object_iterator(_document, close);
+    else
+        start.check_member();
+    return {start, json_object_iterator(_document, close)};
+}
+
+inline json_value json_value::find(std::string_view name) const
+{
+    if (!_document || first() != '{')
+        return {};
+
+    const bool plain = name.find('\\') == std::string_view::npos;
+    std::string unescaped;
+    for (const json_member member : members())
+    {
+        if (member.name == name && plain)
+            return member.value;
+        if (member.name.find('\\') != std::string_view::npos)
+        {
+            unescaped.clear();
+            if (details::unescape_json(member.name, unescaped) && unescaped == name)
+                return member.value;
+        }
+    }
+    return {};
+}
+
+inline json_value json_value::operator[](std::string_view name) const
+{
+    if (first() != '{')
+        throw json_exception("JSON value is not an object");
+    const json_value member = find(name);
+    if (!member)
+        throw json_exception("JSON object has no member \"" + std::string(name) + "\"");
+    return member;
+}
+
+inline json_value json_value::operator[](std::size_t position) const
+{
+    std::size_t i = 0;
+    for (const json_value element : elements())
+    {
+        if (i++ == position)
+            return element;
+    }
+    throw json_exception("JSON array index out of range");
+}
+
+inline json_value json_value::at_pointer(std::string_view pointer) const
+{
+    json_value current = *this;
+    std::string token;
+    while (current && !pointer.empty())
+    {
+        if (pointer.front() != '/')
+            throw json_exception("invalid JSON pointer");
+        pointer.remove_prefix(1);
+        const std::size_t end = pointer.find('/');
+        const std::string_view raw = pointer.substr(0, end);
+        pointer = end == std::string_view::npos ? std::string_view() : pointer.substr(end);
+
+        // ~1 stands for '/' and ~0 for '~'
+        token.clear();
+        for (std::size_t i = 0; i < raw.size(); ++i)
+        {
+            if (raw[i] == '~' && i + 1 < raw.size() && (raw[i + 1] == '0' || raw[i + 1] == '1'))
+                token.push_back(raw[++i] == '0' ? '~' : '/');
+            else
+                token.push_back(raw[i]);
+        }
+
+        if (current.is_object())
+            current = current.find(token);
+        else if (current.is_array())
+        {
+            std::size_t position = 0;
+            const auto result = std::from_chars(token.data(), token.data() + token.size(), position);
+            if (token.empty() || result.ec != std::errc() || result.ptr != token.data() + token.size())
+                return {};
+            json_value element;
+            std::size_t i = 0;
+            for (const json_value candidate : current.elements())
+            {
+                if (i++ == position)
+                {
+                    element = candidate;
+                    break;
+                }
+            }
+            current = element;
+        }
+        else
+            return {};
+    }
+    return current;
+}
+
+inline std::size_t json_value::size() const
+{
+    std::size_t count = 0;
+    if (first() == '{')
+    {
+        for (const json_member member : members())
+            (void)member, ++count;
+        return count;
+    }
+    for (const json_value element : elements())
+        (void)element, ++count;
+    return count;
+}
+
+inline bool json_value::get_bool() const
+{
+    const std::string_view literal = scalar_text();
+    if (literal == "true")
+        return true;
+    if (literal == "false")
+        return false;
+    throw json_exception("JSON value is not a boolean");
+}
+
+namespace details
+{
+template<typename T>
+T json_number(std::string_view literal, const char* what)
+{
+    // JSON numbers start with a digit, after an optional minus, and have no leading zeros
+    T value{};
+    const std::size_t digit = !literal.empty() && literal[0] == '-' ? 1 : 0;
+    if (digit >= literal.size() || literal[digit] < '0' || literal[digit] > '9' ||
+        (literal[digit] == '0' && digit + 1 < literal.size() && literal[digit + 1] >= '0' && literal[digit + 1] <= '9'))
+        throw json_exception(std::string("JSON value is not ") + what);
+    const auto result = std::from_chars(literal.data(), literal.data() + literal.size(), value);
+    if (result.ec == std::errc::result_out_of_range)
+        throw json_exception(std::string("JSON number does not fit ") + what);
+    if (result.ec != std::errc() || result.ptr != literal.data() + literal.size())
+        throw json_exception(std::string("JSON value is not ") + what);
+    return value;
+}
+} // namespace details
+
+inline std::int64_t json_value::get_int64() const
+{
+    return details::json_number<std::int64_t>(scalar_text(), "a 64 bit integer");
+}
+
+inline std::uint64_t json_value::get_uint64() const
+{
+    return details::json_number<std::uint64_t>(scalar_text(), "an unsigned 64 bit integer");
+}
+
+inline double json_value::get_double() const
+{
+    return details::json_number<double>(scalar_text(), "a number");
+}
+
+inline std::string_view json_value::get_raw_string() const
+{
+    if (first() != '"')
+        throw json_exception("JSON value is not a string");
+
+    // The closing quote is the first one not escaped by an odd run of backslashes
+    const std::string_view all = text();
+    const std::size_t start = offset() + 1;
+    std::size_t quote = all.find('"', start);
+    for (;;)
+    {
+        std::size_t backslashes = 0;
+        while (quote - backslashes > start && all[quote - backslashes - 1] == '\\')
+            ++backslashes;
+        if (backslashes % 2 == 0)
+            break;
+        quote = all.find('"', quote + 1);
+    }
+    return all.substr(start, quote - start);
+}
+
+inline std::string json_value::get_string() const
+{
+    const std::string_view raw = get_raw_string();
+    std::string out;
+    out.reserve(raw.size());
+    if (!details::unescape_json(raw, out))
+        throw json_exception("invalid JSON: malformed escape in string");
+    return out;
+}
+
+inline std::string_view json_value::raw_json() const
+{
+    const std::string_view all = text();
+    switch (first())
+    {
+        case '{':
+        case '[':
+        {
+            const std::uint32_t close = skip() - 1;
+            return all.substr(offset(), _document->_index[close] + 1 - offset());
+        }
+        case '"':
+        {
+            const std::string_view contents = get_raw_string();
+            return all.substr(offset(), contents.size() + 2);
+        }
+        default: return scalar_text();
+    }
+}
+
+} // namespace restpp
+
+#endif // RESTPP_JSON_HPP
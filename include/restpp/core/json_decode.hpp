@@ -0,0 +1,637 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Decoding of JSON text straight into user types, described by their fields at compile time.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_JSON_DECODE_HPP
+#define RESTPP_JSON_DECODE_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <restpp/core/json.hpp>
+
+namespace restpp
+{
+
+/// <summary>
+/// Reads JSON text front to back for the decoders of <c>from_json</c>. Errors throw
+/// <c>json_exception</c> with the offset they were found at.
+/// </summary>
+class json_cursor
+{
+public:
+    explicit json_cursor(std::string_view text) : _begin(text.data()), _at(text.data()), _end(text.data() + text.size()) {}
+
+    [[noreturn]] void fail(const char* what) const
+    {
+        throw json_exception("invalid JSON at byte " + std::to_string(_at - _begin) + ": " + what);
+    }
+
+    void skip_space()
+    {
+        while (_at != _end && (*_at == ' ' || *_at == '\n' || *_at == '\r' || *_at == '\t'))
+            ++_at;
+    }
+
+    /// <summary>
+    /// The next character after whitespace, or 0 at the end of the text.
+    /// </summary>
+    char peek()
+    {
+        skip_space();
+        return _at != _end ? *_at : '\0';
+    }
+
+    /// <summary>
+    /// Consumes the next character when it is <c>c</c>.
+    /// </summary>
+    bool consume(char c)
+    {
+        if (peek() != c)
+            return false;
+        ++_at;
+        return true;
+    }
+
+    void expect(char c, const char* what)
+    {
+        if (!consume(c))
+            fail(what);
+    }
+
+    bool at_end()
+    {
+        skip_space();
+        return _at == _end;
+    }
+
+    /// <summary>
+    /// Reads a string, returning its contents as they appear in the text.
+    /// </summary>
+    /// <param name="escaped">Set to whether the contents hold escapes.</param>
+    std::string_view read_raw_string(bool& escaped)
+    {
+        expect('"', "expected a string");
+        const char* start = _at;
+        for (;;)
+        {
+            const auto* quote = static_cast<const char*>(std::memchr(_at, '"', static_cast<std::size_t>(_end - _at)));
+            if (!quote)
+                fail("unterminated string");
+
+            // A quote after an odd run of backslashes is part of the string
+            std::size_t backslashes = 0;
+            while (quote - backslashes > start && quote[-1 - static_cast<std::ptrdiff_t>(backslashes)] == '\\')
+                ++backslashes;
+            _at = quote + 1;
+            if (backslashes % 2 == 0)
+            {
+                const auto size = static_cast<std::size_t>(quote - start);
+                escaped = std::memchr(start, '\\', size) != nullptr;
+                return std::string_view(start, size);
+            }
+        }
+    }
+
+    /// <summary>
+    /// Reads a string with its escapes decoded into <c>out</c>, which is replaced.
+    /// </summary>
+    void read_string(std::string& out)
+    {
+        bool escaped;
+        const std::string_view raw = read_raw_string(escaped);
+        if (!escaped)
+        {
+            out.assign(raw.data(), raw.size());
+            return;
+        }
+        out.clear();
+        if (!details::unescape_json(raw, out))
+            fail("malformed escape in string");
+    }
+
+    /// <summary>
+    /// Reads a number or literal: everything up to the next delimiter.
+    /// </summary>
+    std::string_view read_scalar()
+    {
+        skip_space();
+        const char* start = _at;
+        while (_at != _end && !details::is_json_delimiter(*_at))
+            ++_at;
+        if (_at == start)
+            fail("expected a value");
+        return std::string_view(start, static_cast<std::size_t>(_at - start));
+    }
+
+    /// <summary>
+    /// Consumes a <c>null</c> literal when one comes next.
+    /// </summary>
+    bool consume_null()
+    {
+        if (peek() != 'n')
+            return false;
+        if (read_scalar() != "null")
+            fail("expected null");
+        return true;
+    }
+
+    /// <summary>
+    /// Skips a value of any kind, such as that of a member the type being decoded does not have.
+    /// Only brackets are matched; the skipped value is not otherwise checked.
+    /// </summary>
+    void skip_value()
+    {
+        std::size_t depth = 0;
+        bool escaped;
+        do
+        {
+            switch (peek())
+            {
+                case '{':
+                case '[':
+                    ++depth;
+                    ++_at;
+                    break;
+                case '}':
+                case ']':
+                    if (depth == 0)
+                        fail("expected a value");
+                    --depth;
+                    ++_at;
+                    break;
+                case ',':
+                case ':':
+                    if (depth == 0)
+                        fail("expected a value");
+                    ++_at;
+                    break;
+                case '"': read_raw_string(escaped); break;
+                default: read_scalar(); break;
+            }
+        } while (depth != 0);
+    }
+
+private:
+    const char* _begin;
+    const char* _at;
+    const char* _end;
+};
+
+/// <summary>
+/// A member of a type as it appears in JSON: its name and the pointer to the member.
+/// </summary>
+template<typename Class, typename Member>
+struct json_field
+{
+    std::string_view name;
+    Member Class::*member;
+};
+
+template<typename Class, typename Member>
+constexpr json_field<Class, Member> make_json_field(std::string_view name, Member Class::*member)
+{
+    return json_field<Class, Member>{name, member};
+}
+
+/// <summary>
+/// Describes the fields of a type for <c>from_json</c>. It defaults to the fields a type lists
+/// with <c>RESTPP_JSON_FIELDS</c>; specialize it for types that cannot be changed or whose
+/// members are named differently in JSON, with a <c>static constexpr auto get()</c> returning a
+/// tuple of <c>json_field</c>:
+///
+/// <code>
+/// template&lt;&gt;
+/// struct restpp::json_fields&lt;order&gt;
+/// {
+///     static constexpr auto get()
+///     {
+///         return std::make_tuple(restpp::make_json_field("orderId", &amp;order::id),
+///                                restpp::make_json_field("total", &amp;order::total));
+///     }
+/// };
+/// </code>
+/// </summary>
+template<typename T, typename = void>
+struct json_fields
+{
+};
+
+template<typename T>
+struct json_fields<T, std::void_t<decltype(T::restpp_json_fields())>>
+{
+    static constexpr auto get() { return T::restpp_json_fields(); }
+};
+
+/// <summary>
+/// Decodes a value of type <c>T</c> from a <c>json_cursor</c>. Specialize it, with a
+/// <c>static void decode(json_cursor&amp;, T&amp;)</c>, to decode types of your own by hand.
+/// </summary>
+template<typename T, typename = void>
+struct json_decoder;
+
+namespace details
+{
+template<typename T, typename = void>
+struct has_json_fields : std::false_type
+{
+};
+
+template<typename T>
+struct has_json_fields<T, std::void_t<decltype(json_fields<T>::get())>> : std::true_type
+{
+};
+
+template<typename T, typename = void>
+struct has_json_decoder : std::false_type
+{
+};
+
+template<typename T>
+struct has_json_decoder<T, std::void_t<decltype(sizeof(json_decoder<T>))>> : std::true_type
+{
+};
+
+/// <summary>
+/// FNV-1a, mixed with a seed chosen so that the names of the fields of a type never collide.
+/// </summary>
+constexpr std::uint32_t json_field_hash(std::string_view name, std::uint32_t seed)
+{
+    std::uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+    for (const char c : name)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash ^ (hash >> 15);
+}
+
+constexpr std::size_t json_ceil_pow2(std::size_t n)
+{
+    std::size_t size = 1;
+    while (size < n)
+        size *= 2;
+    return size;
+}
+
+/// <summary>
+/// A perfect hash table from field names to their position, built at compile time.
+/// </summary>
+template<std::size_t N>
+struct json_field_table
+{
+    static constexpr std::size_t capacity = json_ceil_pow2(N) * 8;
+
+    std::uint32_t seed = 0;
+    std::uint32_t mask = 0;
+    std::array<std::int16_t, capacity> slots{};
+
+    constexpr int find(std::string_view name) const { return slots[json_field_hash(name, seed) & mask]; }
+};
+
+/// <summary>
+/// Finds the smallest table and a seed under which the names do not collide. Evaluated at
+/// compile time, failing to find one, as for duplicate names, is a compile error.
+/// </summary>
+template<std::size_t N>
+constexpr json_field_table<N> make_json_field_table(const std::array<std::string_view, N>& names)
+{
+    json_field_table<N> table{};
+    for (std::size_t size = json_ceil_pow2(N); size <= table.capacity; size *= 2)
+    {
+        for (std::uint32_t seed = 0; seed < 1024; ++seed)
+        {
+            for (auto& slot : table.slots)
+                slot = -1;
+
+            bool perfect = true;
+            for (std::size_t i = 0; i < N && perfect; ++i)
+            {
+                auto& slot = table.slots[json_field_hash(names[i], seed) & (size - 1)];
+                perfect = slot == -1;
+                slot = static_cast<std::int16_t>(i);
+            }
+            if (perfect)
+            {
+                table.seed = seed;
+                table.mask = static_cast<std::uint32_t>(size - 1);
+                return table;
+            }
+        }
+    }
+    throw json_exception("field names have no perfect hash; are some of them duplicated?");
+}
+
+template<typename T>
+struct json_object_decoder
+{
+    static constexpr auto fields = json_fields<T>::get();
+    static constexpr std::size_t count = std::tuple_size<decltype(fields)>::value;
+
+    template<std::size_t... I>
+    static constexpr std::array<std::string_view, count> names(std::index_sequence<I...>)
+    {
+        return {{std::get<I>(fields).name...}};
+    }
+
+    static constexpr std::array<std::string_view, count> field_names = names(std::make_index_sequence<count>());
+    static constexpr json_field_table<count> table = make_json_field_table(field_names);
+
+    using member_decoder = void (*)(json_cursor&, T&);
+
+    template<std::size_t I>
+    static void decode_member(json_cursor& cursor, T& out)
+    {
+        constexpr auto field = std::get<I>(fields);
+        using member_type = std::remove_reference_t<decltype(out.*(field.member))>;
+        json_decoder<member_type>::decode(cursor, out.*(field.member));
+    }
+
+    template<std::size_t... I>
+    static constexpr std::array<member_decoder, count> decoders(std::index_sequence<I...>)
+    {
+        return {{&decode_member<I>...}};
+    }
+
+    static void decode(json_cursor& cursor, T& out)
+    {
+        static constexpr std::array<member_decoder, count> members = decoders(std::make_index_sequence<count>());
+
+        cursor.expect('{', "expected an object");
+        if (cursor.consume('}'))
+            return;
+
+        std::string unescaped;
+        do
+        {
+            bool escaped;
+            std::string_view name = cursor.read_raw_string(escaped);
+            if (escaped)
+            {
+                unescaped.clear();
+                if (!unescape_json(name, unescaped))
+                    cursor.fail("malformed escape in string");
+                name = unescaped;
+            }
+            cursor.expect(':', "expected ':'");
+
+            // Members the type does not have are skipped
+            const int position = count != 0 ? table.find(name) : -1;
+            if (position >= 0 && field_names[static_cast<std::size_t>(position)] == name)
+                members[static_cast<std::size_t>(position)](cursor, out);
+            else
+                cursor.skip_value();
+        } while (cursor.consume(','));
+        cursor.expect('}', "expected ',' or '}'");
+    }
+};
+
+template<typename T>
+T json_integer(json_cursor& cursor)
+{
+    const std::string_view literal = cursor.read_scalar();
+    try
+    {
+        return json_number<T>(literal, "an integer of this size");
+    }
+    catch (const json_exception& e)
+    {
+        cursor.fail(e.what());
+    }
+}
+} // namespace details
+
+template<>
+struct json_decoder<bool>
+{
+    static void decode(json_cursor& cursor, bool& out)
+    {
+        const std::string_view literal = cursor.read_scalar();
+        if (literal == "true")
+            out = true;
+        else if (literal == "false")
+            out = false;
+        else
+            cursor.fail("expected a boolean");
+    }
+};
+
+template<typename T>
+struct json_decoder<T, std::enable_if_t<std::is_integral<T>::value && !std::is_same<T, bool>::value>>
+{
+    static void decode(json_cursor& cursor, T& out) { out = details::json_integer<T>(cursor); }
+};
+
+template<typename T>
+struct json_decoder<T, std::enable_if_t<std::is_floating_point<T>::value>>
+{
+    static void decode(json_cursor& cursor, T& out)
+    {
+        const std::string_view literal = cursor.read_scalar();
+        try
+        {
+            out = static_cast<T>(details::json_number<double>(literal, "a number"));
+        }
+        catch (const json_exception& e)
+        {
+            cursor.fail(e.what());
+        }
+    }
+};
+
+template<>
+struct json_decoder<std::string>
+{
+    static void decode(json_cursor& cursor, std::string& out) { cursor.read_string(out); }
+};
+
+template<typename T>
+struct json_decoder<std::optional<T>>
+{
+    static void decode(json_cursor& cursor, std::optional<T>& out)
+    {
+        if (cursor.consume_null())
+        {
+            out.reset();
+            return;
+        }
+        if (!out)
+            out.emplace();
+        json_decoder<T>::decode(cursor, *out);
+    }
+};
+
+template<typename T, typename Allocator>
+struct json_decoder<std::vector<T, Allocator>>
+{
+    static void decode(json_cursor& cursor, std::vector<T, Allocator>& out)
+    {
+        out.clear();
+        cursor.expect('[', "expected an array");
+        if (cursor.consume(']'))
+            return;
+        do
+        {
+            out.emplace_back();
+            json_decoder<T>::decode(cursor, out.back());
+        } while (cursor.consume(','));
+        cursor.expect(']', "expected ',' or ']'");
+    }
+};
+
+namespace details
+{
+template<typename Map>
+struct json_map_decoder
+{
+    static void decode(json_cursor& cursor, Map& out)
+    {
+        out.clear();
+        cursor.expect('{', "expected an object");
+        if (cursor.consume('}'))
+            return;
+        std::string name;
+        do
+        {
+            cursor.read_string(name);
+            cursor.expect(':', "expected ':'");
+            json_decoder<typename Map::mapped_type>::decode(cursor, out[name]);
+        } while (cursor.consume(','));
+        cursor.expect('}', "expected ',' or '}'");
+    }
+};
+} // namespace details
+
+template<typename T, typename Compare, typename Allocator>
+struct json_decoder<std::map<std::string, T, Compare, Allocator>>
+    : details::json_map_decoder<std::map<std::string, T, Compare, Allocator>>
+{
+};
+
+template<typename T, typename Hash, typename Equal, typename Allocator>
+struct json_decoder<std::unordered_map<std::string, T, Hash, Equal, Allocator>>
+    : details::json_map_decoder<std::unordered_map<std::string, T, Hash, Equal, Allocator>>
+{
+};
+
+template<typename T>
+struct json_decoder<T, std::enable_if_t<details::has_json_fields<T>::value>> : details::json_object_decoder<T>
+{
+};
+
+/// <summary>
+/// Decodes JSON text into an existing value, whose storage, such as that of its strings and
+/// vectors, is reused. Members of the text the type does not have are skipped, and members of
+/// the type the text does not have keep their value.
+/// </summary>
+template<typename T>
+void from_json(std::string_view text, T& out)
+{
+    static_assert(details::has_json_decoder<T>::value,
+                  "restpp::from_json needs the fields of the type, listed with RESTPP_JSON_FIELDS or "
+                  "a specialization of restpp::json_fields, or a specialization of restpp::json_decoder");
+    json_cursor cursor(text);
+    json_decoder<T>::decode(cursor, out);
+    if (!cursor.at_end())
+        cursor.fail("unexpected text after the value");
+}
+
+/// <summary>
+/// Decodes JSON text into a value of the given type, in a single pass without building a
+/// document: each member name is matched to a field through a perfect hash computed at compile
+/// time, and its value parsed straight into the field.
+/// </summary>
+template<typename T>
+T from_json(std::string_view text)
+{
+    T out{};
+    from_json(text, out);
+    return out;
+}
+
+} // namespace restpp
+
+#define RESTPP_JSON_EXPAND(x) x
+#define RESTPP_JSON_CONCAT_(a, b) a##b
+#define RESTPP_JSON_CONCAT(a, b) RESTPP_JSON_CONCAT_(a, b)
+#define RESTPP_JSON_COUNT_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, N, ...) N
+#define RESTPP_JSON_COUNT(...) RESTPP_JSON_EXPAND(RESTPP_JSON_COUNT_(__VA_ARGS__, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1))
+#define RESTPP_JSON_EACH_1(m, t, x) m(t, x)
+#define RESTPP_JSON_EACH_2(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_1(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_3(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_2(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_4(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_3(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_5(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_4(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_6(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_5(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_7(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_6(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_8(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_7(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_9(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_8(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_10(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_9(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_11(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_10(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_12(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_11(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_13(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_12(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_14(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_13(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_15(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_14(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_16(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_15(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_17(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_16(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_18(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_17(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_19(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_18(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_20(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_19(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_21(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_20(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_22(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_21(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_23(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_22(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_24(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_23(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_25(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_24(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_26(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_25(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_27(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_26(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_28(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_27(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_29(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_28(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_30(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_29(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_31(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_30(m, t, __VA_ARGS__))
+#define RESTPP_JSON_EACH_32(m, t, x, ...) m(t, x), RESTPP_JSON_EXPAND(RESTPP_JSON_EACH_31(m, t, __VA_ARGS__))
+#define RESTPP_JSON_FOR_EACH(m, t, ...) \
+    RESTPP_JSON_EXPAND(RESTPP_JSON_CONCAT(RESTPP_JSON_EACH_, RESTPP_JSON_COUNT(__VA_ARGS__))(m, t, __VA_ARGS__))
+#define RESTPP_JSON_FIELD(type, member) ::restpp::make_json_field(#member, &type::member)
+
+/// <summary>
+/// Lists, inside the definition of a type, the members <c>from_json</c> decodes, each under its
+/// own name, up to 32 of them:
+///
+/// <code>
+/// struct order
+/// {
+///     std::uint64_t id;
+///     std::string customer;
+///     std::vector&lt;line&gt; lines;
+///
+///     RESTPP_JSON_FIELDS(order, id, customer, lines)
+/// };
+/// </code>
+/// </summary>
+#define RESTPP_JSON_FIELDS(type, ...) \
+    static constexpr auto restpp_json_fields() \
+    { \
+        return std::make_tuple(RESTPP_JSON_FOR_EACH(RESTPP_JSON_FIELD, type, __VA_ARGS__)); \
+    }
+
+#endif // RESTPP_JSON_DECODE_HPP
@@ -0,0 +1,66 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Hooks through which applications see every request a client makes, to feed their metrics.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_OBSERVER_HPP
+#define RESTPP_OBSERVER_HPP
+
+#include <boost/system/error_code.hpp>
+
+#include <restpp/core/options.hpp>
+#include <restpp/core/response.hpp>
+#include <restpp/core/uri.hpp>
+
+namespace restpp
+{
+
+/// <summary>
+/// Told about every request made through a client it is installed on with
+/// <c>client_config::observer</c>, such as to count requests and errors or record latency
+/// histograms for Prometheus or OpenTelemetry. A client without an observer pays nothing more
+/// than a null check per request.
+///
+/// The calls come from the threads running the I/O contexts of the client, or blocked in a
+/// synchronous fetch, possibly several at once: implementations must be thread-safe, and should
+/// return quickly, as the request waits on them.
+/// </summary>
+class fetch_observer
+{
+public:
+    virtual ~fetch_observer() = default;
+
+    /// <summary>
+    /// A request is starting.
+    /// </summary>
+    virtual void on_start(const uri& target, const options& opts)
+    {
+        (void)target;
+        (void)opts;
+    }
+
+    /// <summary>
+    /// A request completed, successfully or with the given error, right before its completion
+    /// handler runs. <c>res.timings</c> holds the duration of its phases even when it failed.
+    /// </summary>
+    virtual void on_complete(const uri& target, const options& opts, const boost::system::error_code& ec, const response& res)
+    {
+        (void)target;
+        (void)opts;
+        (void)ec;
+        (void)res;
+    }
+};
+
+} // namespace restpp
+
+#endif // RESTPP_OBSERVER_HPP
@@ -15,22 +15,129 @@
 #ifndef RESTPP_OPTIONS_HPP
 #define RESTPP_OPTIONS_HPP
 
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <optional>
 #include <string>
-#include <map>
+
+#include <restpp/core/abort_signal.hpp>
+#include <restpp/core/body_sink.hpp>
+#include <restpp/core/headers.hpp>
+#include <restpp/core/request_body.hpp>
 
 namespace restpp
 {
 
+/// <summary>
+/// Limits on how long each phase of a request may take. Zero, the default, leaves a phase
+/// unlimited. A request going over a limit fails with the matching timeout error, and its
+/// connection is closed.
+/// </summary>
+struct timeouts
+{
+    using duration = std::chrono::steady_clock::duration;
+
+    /// <summary>
+    /// Resolving the host name. Hosts found in the DNS cache of the client take no time.
+    /// </summary>
+    duration resolve{};
+
+    /// <summary>
+    /// Establishing the TCP connection, over every address of the host.
+    /// </summary>
+    duration connect{};
+
+    /// <summary>
+    /// The TLS handshake of https connections.
+    /// </summary>
+    duration tls_handshake{};
+
+    /// <summary>
+    /// From the request being sent until the first bytes of the response arrive.
+    /// </summary>
+    duration first_byte{};
+
+    /// <summary>
+    /// The whole request, from the call until the last byte of the response.
+    /// </summary>
+    duration total{};
+
+    bool any() const
+    {
+        return resolve != duration::zero() || connect != duration::zero() || tls_handshake != duration::zero() ||
+               first_byte != duration::zero() || total != duration::zero();
+    }
+};
+
 struct options
 {
-    options()
+    options() : options(std::pmr::get_default_resource()) {}
+
+    /// <summary>
+    /// Options whose headers are stored in the given memory resource.
+    /// </summary>
+    explicit options(std::pmr::memory_resource* resource) : headers(resource)
     {
         method = "GET";
-        headers.insert({"User-Agent", "restpp.io client"});
+        headers.set(field::user_agent, "restpp.io client");
     }
 
     std::string method;
-    std::map<std::string, std::string> headers;
+    restpp::headers headers;
+
+    /// <summary>
+    /// The body sent with the request, if any.
+    /// </summary>
+    request_body body;
+
+    /// <summary>
+    /// When set, the response body is streamed to this sink as it arrives and
+    /// <c>response::body</c> is left empty.
+    /// </summary>
+    body_sink sink;
+
+    /// <summary>
+    /// Size of the reads issued on the connection. When streaming, this bounds the memory held
+    /// for the body: every piece handed to the sink is at most this large. File bodies are read
+    /// in pieces of this size when they cannot be sent with <c>sendfile</c>. A fetch with a
+    /// chunk size of 0 fails with <c>boost::asio::error::invalid_argument</c>.
+    /// </summary>
+    std::size_t chunk_size = 16 * 1024;
+
+    /// <summary>
+    /// Largest body read into <c>response::body</c>. A longer one, whether announced by
+    /// Content-Length or only found out as it arrives, fails the request with
+    /// <c>body_too_large</c>, as does running out of memory for it. Bodies going to a sink are
+    /// not limited.
+    /// </summary>
+    std::uint64_t max_body_size = std::numeric_limits<std::uint64_t>::max();
+
+    /// <summary>
+    /// Asks for a compressed response, sending Accept-Encoding with every coding this build
+    /// decodes unless the header was set, and decodes the body as it arrives. The response body,
+    /// or what the sink receives, is the decoded one; the Content-Encoding and Content-Length
+    /// headers still describe what came over the wire.
+    /// </summary>
+    bool decode_content = false;
+
+    /// <summary>
+    /// Per-phase limits on the duration of the request.
+    /// </summary>
+    restpp::timeouts timeouts;
+
+    /// <summary>
+    /// A point in time by which the request must have completed, whatever its phase; useful to
+    /// hand the remaining time of an outer operation down to the requests it makes.
+    /// </summary>
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+
+    /// <summary>
+    /// Aborts the request, and any I/O it has in flight, once its controller is aborted.
+    /// </summary>
+    abort_signal signal;
 };
 
 } // namespace restpp
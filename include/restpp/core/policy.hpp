@@ -0,0 +1,104 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Retry, hedging and adaptive concurrency policies of a client.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_POLICY_HPP
+#define RESTPP_POLICY_HPP
+
+#include <chrono>
+#include <cstddef>
+
+namespace restpp
+{
+
+/// <summary>
+/// Sends idempotent requests again when they fail in a way another attempt may not, such as a
+/// refused connection, a timeout or a 503, after an exponential backoff with full jitter: the
+/// n-th retry waits a random time up to <c>initial_backoff * multiplier^(n-1)</c>, at most
+/// <c>max_backoff</c>, and at least what the server asked for with Retry-After.
+///
+/// Only GET, HEAD, OPTIONS, TRACE, PUT and DELETE requests are retried, and only those whose body
+/// can be sent again and that stream to no sink. A request that was aborted or ran out of time
+/// is not; its deadline, or total timeout, covers every attempt and the waits between them.
+/// </summary>
+struct retry_policy
+{
+    using duration = std::chrono::steady_clock::duration;
+
+    /// <summary>
+    /// Attempts a request gets in all, the first one included. One, the default, never retries.
+    /// </summary>
+    int max_attempts = 1;
+
+    duration initial_backoff = std::chrono::milliseconds(50);
+    duration max_backoff = std::chrono::seconds(2);
+    double multiplier = 2.0;
+
+    /// <summary>
+    /// Also retry responses with status 429, 502, 503 or 504. When every attempt got one, the
+    /// last response is the result.
+    /// </summary>
+    bool retry_status = true;
+};
+
+/// <summary>
+/// Cuts the tail latency of GET, HEAD and OPTIONS requests without a body nor a sink: a request
+/// still unanswered after the given percentile of the latency recently seen from its host is
+/// sent a second time, and whichever answers first wins, the other being aborted.
+/// </summary>
+struct hedge_policy
+{
+    using duration = std::chrono::steady_clock::duration;
+
+    bool enabled = false;
+
+    /// <summary>
+    /// The percentile of the latency of the host after which the backup request goes out.
+    /// </summary>
+    double percentile = 0.95;
+
+    /// <summary>
+    /// How long to wait before the backup request while a host has answered fewer than
+    /// <c>min_samples</c> requests, which are too few to tell its latency.
+    /// </summary>
+    duration initial_delay = std::chrono::milliseconds(100);
+    std::size_t min_samples = 20;
+
+    /// <summary>
+    /// The shortest wait before a backup request, however fast the host usually is.
+    /// </summary>
+    duration min_delay = std::chrono::milliseconds(1);
+};
+
+/// <summary>
+/// Limits the requests in flight to each host to what it can take, learnt from the latency and
+/// failures of its responses: the limit grows by one per window of requests answered about as
+/// fast as the fastest recently seen, and shrinks by <c>backoff_ratio</c> on every response
+/// slower than <c>tolerance</c> times that, failed, or answered 429 or 503. Requests over the
+/// limit wait for a slot, in order, and stop waiting once aborted or past their deadline.
+/// </summary>
+struct concurrency_policy
+{
+    bool adaptive = false;
+
+    std::size_t initial_limit = 16;
+    std::size_t min_limit = 1;
+    std::size_t max_limit = 1000;
+
+    double backoff_ratio = 0.9;
+    double tolerance = 2.0;
+};
+
+} // namespace restpp
+
+#endif // RESTPP_POLICY_HPP
@@ -0,0 +1,138 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Sources of request bodies.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_REQUEST_BODY_HPP
+#define RESTPP_REQUEST_BODY_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/asio/buffer.hpp>
+
+namespace restpp
+{
+
+/// <summary>
+/// The body sent with a request. The payload is never copied into the request buffer: buffers
+/// are written along with the request head in a single gathered write, files are sent from the
+/// page cache with <c>sendfile</c> where the platform and connection allow it, and generated
+/// bodies are sent chunk by chunk with chunked transfer-encoding.
+/// </summary>
+class request_body
+{
+public:
+    /// <summary>
+    /// Produces the next chunk of a generated body into <c>chunk</c>, which must stay valid
+    /// until the next call. An empty chunk ends the body; returning false aborts the transfer.
+    /// </summary>
+    using chunk_generator = std::function<bool(std::string_view& chunk)>;
+
+    enum class kind
+    {
+        none,
+        buffers,
+        file,
+        chunked
+    };
+
+    /// <summary>
+    /// No body.
+    /// </summary>
+    request_body() = default;
+
+    /// <summary>
+    /// A body held by the request itself. The string is moved in, not copied.
+    /// </summary>
+    request_body(std::string data) : _kind(kind::buffers), _owned(std::make_shared<const std::string>(std::move(data)))
+    {
+        _buffers.emplace_back(_owned->data(), _owned->size());
+    }
+
+    request_body(const char* data) : request_body(std::string(data)) {}
+
+    /// <summary>
+    /// A body made of buffers owned by the caller, which must outlive the request.
+    /// </summary>
+    static request_body from_buffers(std::vector<boost::asio::const_buffer> buffers)
+    {
+        request_body body;
+        body._kind = kind::buffers;
+        body._buffers = std::move(buffers);
+        return body;
+    }
+
+    /// <summary>
+    /// A body read from the file at the given path when the request is sent.
+    /// </summary>
+    static request_body from_file(std::string path)
+    {
+        request_body body;
+        body._kind = kind::file;
+        body._path = std::move(path);
+        return body;
+    }
+
+    /// <summary>
+    /// A body of unknown length, produced chunk by chunk while it is sent.
+    /// </summary>
+    static request_body from_generator(chunk_generator generator)
+    {
+        request_body body;
+        body._kind = kind::chunked;
+        body._generator = std::move(generator);
+        return body;
+    }
+
+    explicit operator bool() const { return _kind != kind::none; }
+
+    kind type() const { return _kind; }
+
+    /// <summary>
+    /// Whether the body can be sent again, as needed to retry a request over a new connection.
+    /// Generated bodies can only be sent once.
+    /// </summary>
+    bool replayable() const { return _kind != kind::chunked; }
+
+    const std::vector<boost::asio::const_buffer>& buffers() const { return _buffers; }
+
+    /// <summary>
+    /// Total size of the buffers of the body.
+    /// </summary>
+    std::uint64_t buffers_size() const
+    {
+        std::uint64_t size = 0;
+        for (const auto& buffer : _buffers)
+            size += buffer.size();
+        return size;
+    }
+
+    const std::string& path() const { return _path; }
+
+    bool next_chunk(std::string_view& chunk) const { return _generator(chunk); }
+
+private:
+    kind _kind = kind::none;
+    std::shared_ptr<const std::string> _owned;
+    std::vector<boost::asio::const_buffer> _buffers;
+    std::string _path;
+    chunk_generator _generator;
+};
+
+} // namespace restpp
+
+#endif // RESTPP_REQUEST_BODY_HPP
@@ -15,16 +15,148 @@
 #ifndef RESTPP_RESPONSE_H
 #define RESTPP_RESPONSE_H
 
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+
+#include <boost/system/error_code.hpp>
+
+#include <restpp/core/headers.hpp>
+#include <restpp/core/json.hpp>
+#include <restpp/core/json_decode.hpp>
+#include <restpp/core/xml.hpp>
 
 namespace restpp
 {
 
+/// <summary>
+/// Where the time of a request went, measured with the monotonic clock. Phases a request did
+/// not go through, such as resolving a host whose addresses were cached or connecting when a
+/// pooled connection was reused, take no time; those repeated by a retry add up.
+/// </summary>
+struct timings
+{
+    using duration = std::chrono::steady_clock::duration;
+
+    duration resolve{};
+    duration connect{};
+    duration tls_handshake{};
+
+    /// <summary>
+    /// Sending the request head and body.
+    /// </summary>
+    duration write{};
+
+    /// <summary>
+    /// From the request being sent until the first bytes of the response arrived.
+    /// </summary>
+    duration first_byte{};
+
+    /// <summary>
+    /// From the first bytes of the response until the last.
+    /// </summary>
+    duration transfer{};
+
+    /// <summary>
+    /// The whole request, from the call until it completed.
+    /// </summary>
+    duration total{};
+
+    /// <summary>
+    /// Bytes of the request and response as written to and read from the connection, before
+    /// encryption. Over HTTP/2 only the bodies count, the headers being compressed into frames
+    /// shared with other streams.
+    /// </summary>
+    std::uint64_t bytes_sent = 0;
+    std::uint64_t bytes_received = 0;
+
+    /// <summary>
+    /// Whether the request went over a pooled connection or an existing HTTP/2 connection.
+    /// </summary>
+    bool reused_connection = false;
+
+    /// <summary>
+    /// Whether the response came from the cache of the client, without going to the network.
+    /// </summary>
+    bool cached = false;
+};
+
 struct response
 {
-    int status_code;
-    std::string headers;
+    response() = default;
+
+    /// <summary>
+    /// A response whose headers are stored in the given memory resource, such as an arena the
+    /// caller releases in one go; fetching into it reuses that storage. The body stays a
+    /// <c>std::string</c>, which callers move out of and pass on as one; a body meant to land
+    /// in caller-owned memory goes through the <c>sink</c> of the options instead.
+    /// </summary>
+    explicit response(std::pmr::memory_resource* resource) : headers(resource) {}
+
+    int status_code = 0;
+    restpp::headers headers;
     std::string body;
+
+    /// <summary>
+    /// Application protocol negotiated through ALPN for https requests, such as "http/1.1".
+    /// </summary>
+    std::string alpn;
+
+    /// <summary>
+    /// Whether the TLS connection the response came over was set up by resuming a cached session.
+    /// </summary>
+    bool tls_resumed = false;
+
+    /// <summary>
+    /// How long each phase of the request took.
+    /// </summary>
+    restpp::timings timings;
+
+    /// <summary>
+    /// Why the request failed, for the fetch overloads that return a response rather than an
+    /// error code. A failed request got no response: its status code is 0, unlike that of a
+    /// server answering with an error of its own.
+    /// </summary>
+    boost::system::error_code error;
+
+    /// <summary>
+    /// For file URIs, the file mapped read-only into memory, which the body is read from in
+    /// place of <c>body</c>, left empty. Copies of the response share the mapping, which goes
+    /// away with the last of them.
+    /// </summary>
+    std::shared_ptr<const std::string_view> mapped;
+
+    /// <summary>
+    /// The body, wherever it is held: the mapped file, or <c>body</c>.
+    /// </summary>
+    std::string_view content() const { return mapped ? *mapped : std::string_view(body); }
+
+    /// <summary>
+    /// Indexes the body as JSON, for fields to be read on demand. The document views the body
+    /// without copying it, so the response must outlive it and its body must not change.
+    /// Throws <c>json_exception</c> when the body is not JSON.
+    /// </summary>
+    restpp::json_document json() const { return restpp::json_document(content()); }
+
+    /// <summary>
+    /// Decodes the body as JSON into a value of the given type, whose fields are listed with
+    /// <c>RESTPP_JSON_FIELDS</c>. Throws <c>json_exception</c> when the body does not fit.
+    /// </summary>
+    template<typename T>
+    T as() const
+    {
+        return restpp::from_json<T>(content());
+    }
+
+    /// <summary>
+    /// Reads the body as XML, one event at a time. The reader views the body, which must outlive
+    /// it. To read large documents as they arrive instead, set <c>xml_reader::sink()</c> as the
+    /// sink of the request.
+    /// </summary>
+    restpp::xml_reader xml() const { return restpp::xml_reader(content()); }
 };
 
 } // namespace restpp
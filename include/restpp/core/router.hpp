@@ -0,0 +1,300 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Routing of the requests of the embedded server to handlers, by method and path.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_ROUTER_HPP
+#define RESTPP_ROUTER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <restpp/core/server_request.hpp>
+#include <restpp/core/server_response.hpp>
+#include <restpp/core/uri.hpp>
+
+namespace restpp
+{
+
+/// <summary>
+/// Dispatches requests to handlers by method and path, as the handler of a <c>server</c>.
+///
+/// Routes are patterns of path segments, each either literal or a parameter: "/users/{id}/orders"
+/// matches "/users/42/orders" with "id" set to "42" in <c>server_request::params</c>. A last
+/// segment "{name...}" matches the rest of the path, slashes included. Literal segments win over
+/// parameters, which win over the rest of the path, whatever the order the routes were added in.
+///
+/// The routes form a tree with a node per segment, whose literal children are looked up by hash,
+/// so finding the route of a request takes time proportional to the length of its path however
+/// many routes there are, and allocates nothing. Requests whose path matches no route get a 404,
+/// and those whose method matches none of the routes of their path a 405 with an Allow header.
+/// HEAD requests are served by the GET route of their path when they have no route of their own.
+///
+/// Routes are added before the router is handed to the server, which keeps a copy of it.
+/// </summary>
+class router
+{
+public:
+    router() : _nodes(1) {}
+
+    /// <summary>
+    /// Adds a route. Throws <c>std::invalid_argument</c> when the pattern is malformed, when a
+    /// parameter of the same position in another route has a different name, or when the method
+    /// already has a route with the same pattern.
+    /// </summary>
+    router& add(std::string_view method, std::string_view pattern, request_handler handler)
+    {
+        if (pattern.empty() || pattern.front() != '/')
+            throw std::invalid_argument("route pattern must start with '/': " + std::string(pattern));
+
+        std::uint32_t at = 0;
+        const path_segments segments(pattern);
+        for (auto it = segments.begin(); it != segments.end(); ++it)
+        {
+            const std::string_view segment = *it;
+            if (segment.empty() || segment.front() != '{')
+            {
+                if (segment.find_first_of("{}") != std::string_view::npos)
+                    throw std::invalid_argument("route parameters must span a whole segment: " + std::string(pattern));
+                at = literal_child(at, segment);
+                continue;
+            }
+
+            if (segment.size() < 3 || segment.back() != '}')
+                throw std::invalid_argument("malformed route parameter: " + std::string(pattern));
+            std::string_view name = segment.substr(1, segment.size() - 2);
+            const bool rest = name.size() > 3 && name.substr(name.size() - 3) == "...";
+            if (rest)
+            {
+                auto next = it;
+                if (++next != segments.end())
+                    throw std::invalid_argument("'{" + std::string(name) + "}' must be the last segment: " +
+                                                std::string(pattern));
+                name.remove_suffix(3);
+            }
+            at = parameter_child(at, name, rest, pattern);
+        }
+
+        auto& routes = _nodes[at].routes;
+        for (const auto& r : routes)
+        {
+            if (r.method == method)
+                throw std::invalid_argument("duplicate route: " + std::string(method) + " " + std::string(pattern));
+        }
+        routes.push_back({std::string(method), std::move(handler)});
+        return *this;
+    }
+
+    router& get(std::string_view pattern, request_handler handler) { return add("GET", pattern, std::move(handler)); }
+
+    router& post(std::string_view pattern, request_handler handler) { return add("POST", pattern, std::move(handler)); }
+
+    router& put(std::string_view pattern, request_handler handler) { return add("PUT", pattern, std::move(handler)); }
+
+    router& patch(std::string_view pattern, request_handler handler)
+    {
+        return add("PATCH", pattern, std::move(handler));
+    }
+
+    router& del(std::string_view pattern, request_handler handler)
+    {
+        return add("DELETE", pattern, std::move(handler));
+    }
+
+    /// <summary>
+    /// Serves the requests whose path matches no route, instead of answering them with 404.
+    /// </summary>
+    router& fallback(request_handler handler)
+    {
+        _fallback = std::move(handler);
+        return *this;
+    }
+
+    /// <summary>
+    /// Serves a request with the handler of its route.
+    /// </summary>
+    void operator()(server_request& req, server_response& res) const
+    {
+        req.params.clear();
+        const std::string_view path = req.path();
+        const path_segments segments(path);
+        const node* found = match(0, segments.begin(), req.params);
+        if (!found)
+        {
+            req.params.clear();
+            if (_fallback)
+                return _fallback(req, res);
+            res.status_code = 404;
+            return;
+        }
+
+        const route* chosen = nullptr;
+        for (const auto& r : found->routes)
+        {
+            if (r.method == req.method)
+            {
+                chosen = &r;
+                break;
+            }
+            if (req.method == "HEAD" && r.method == "GET")
+                chosen = &r;
+        }
+        if (chosen)
+            return chosen->handler(req, res);
+
+        std::string allow;
+        for (const auto& r : found->routes)
+            allow.append(allow.empty() ? "" : ", ").append(r.method);
+        res.status_code = 405;
+        res.headers.set("Allow", allow);
+    }
+
+private:
+    static constexpr std::uint32_t none = 0xFFFFFFFF;
+
+    struct route
+    {
+        std::string method;
+        request_handler handler;
+    };
+
+    struct literal
+    {
+        std::uint32_t hash;
+        std::string segment;
+        std::uint32_t node;
+    };
+
+    struct node
+    {
+        // Sorted by hash, then by segment
+        std::vector<literal> literals;
+        std::uint32_t parameter = none;
+        std::uint32_t rest = none;
+
+        // Name of the parameter this node stands for
+        std::string name;
+        std::vector<route> routes;
+    };
+
+    static std::uint32_t hash_segment(std::string_view segment)
+    {
+        std::uint32_t hash = 2166136261u;
+        for (char c : segment)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    static bool literal_less(const literal& l, std::uint32_t hash, std::string_view segment)
+    {
+        return l.hash != hash ? l.hash < hash : std::string_view(l.segment) < segment;
+    }
+
+    std::uint32_t find_literal(const node& n, std::string_view segment) const
+    {
+        const std::uint32_t hash = hash_segment(segment);
+        auto it = std::lower_bound(n.literals.begin(), n.literals.end(), hash,
+                                   [](const literal& l, std::uint32_t h) { return l.hash < h; });
+        for (; it != n.literals.end() && it->hash == hash; ++it)
+        {
+            if (it->segment == segment)
+                return it->node;
+        }
+        return none;
+    }
+
+    std::uint32_t literal_child(std::uint32_t parent, std::string_view segment)
+    {
+        const std::uint32_t found = find_literal(_nodes[parent], segment);
+        if (found != none)
+            return found;
+
+        const auto child = static_cast<std::uint32_t>(_nodes.size());
+        _nodes.emplace_back();
+        auto& literals = _nodes[parent].literals;
+        const std::uint32_t hash = hash_segment(segment);
+        auto it = std::lower_bound(literals.begin(), literals.end(), hash,
+                                   [&](const literal& l, std::uint32_t h) { return literal_less(l, h, segment); });
+        literals.insert(it, literal{hash, std::string(segment), child});
+        return child;
+    }
+
+    std::uint32_t parameter_child(std::uint32_t parent, std::string_view name, bool rest, std::string_view pattern)
+    {
+        std::uint32_t child = rest ? _nodes[parent].rest : _nodes[parent].parameter;
+        if (child != none)
+        {
+            if (_nodes[child].name != name)
+                throw std::invalid_argument("route parameter '" + std::string(name) + "' conflicts with '" +
+                                            _nodes[child].name + "': " + std::string(pattern));
+            return child;
+        }
+
+        child = static_cast<std::uint32_t>(_nodes.size());
+        _nodes.emplace_back();
+        _nodes[child].name = std::string(name);
+        (rest ? _nodes[parent].rest : _nodes[parent].parameter) = child;
+        return child;
+    }
+
+    /// <summary>
+    /// Finds the node of the route matching the segments from <c>at</c> on, below the given node,
+    /// adding the parameters on the way. Tries literals first, and only falls back on parameters
+    /// when the literal leads nowhere.
+    /// </summary>
+    const node* match(std::uint32_t index, path_segments::const_iterator at, route_params& params) const
+    {
+        const node& n = _nodes[index];
+        if (at == path_segments::const_iterator())
+            return n.routes.empty() ? nullptr : &n;
+
+        const std::string_view segment = *at;
+        auto next = at;
+        ++next;
+
+        const std::uint32_t literal = find_literal(n, segment);
+        if (literal != none)
+        {
+            if (const node* found = match(literal, next, params))
+                return found;
+        }
+        if (n.parameter != none && !segment.empty())
+        {
+            params.add(_nodes[n.parameter].name, segment);
+            if (const node* found = match(n.parameter, next, params))
+                return found;
+            params.pop();
+        }
+        if (n.rest != none && !_nodes[n.rest].routes.empty())
+        {
+            params.add(_nodes[n.rest].name, at.rest());
+            return &_nodes[n.rest];
+        }
+        return nullptr;
+    }
+
+    std::vector<node> _nodes;
+    request_handler _fallback;
+};
+
+} // namespace restpp
+
+#endif // RESTPP_ROUTER_HPP
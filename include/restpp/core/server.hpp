@@ -0,0 +1,237 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Embedded HTTP/1.1 server for the RESTful side of the library.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_SERVER_HPP
+#define RESTPP_SERVER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <future>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include <restpp/core/executor.hpp>
+#include <restpp/core/server_config.hpp>
+#include <restpp/core/server_request.hpp>
+#include <restpp/core/server_response.hpp>
+#include <restpp/core/details/server_connection.hpp>
+
+namespace restpp
+{
+namespace details
+{
+/// <summary>
+/// A listening socket and the shards it hands the connections it accepts to, in turns.
+/// </summary>
+struct server_listener
+{
+    server_listener(boost::asio::io_context& io_context, std::vector<std::shared_ptr<server_shard>> shards)
+        : io_context(io_context), acceptor(io_context), retry_timer(io_context), shards(std::move(shards))
+    {
+    }
+
+    boost::asio::io_context& io_context;
+    boost::asio::ip::tcp::acceptor acceptor;
+    boost::asio::steady_timer retry_timer;
+    std::vector<std::shared_ptr<server_shard>> shards;
+    std::size_t next = 0;
+};
+
+#ifdef SO_REUSEPORT
+using reuse_port = boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
+} // namespace details
+
+/// <summary>
+/// An HTTP/1.1 server calling a handler for every request it receives, with keep-alive and
+/// pipelining. Requests are read with the same parser as the client reads responses, and their
+/// headers land in the same <c>headers</c> collection.
+///
+/// The server runs on the I/O contexts of an executor, its own or a shared one, with one
+/// listening socket per context where the platform supports <c>SO_REUSEPORT</c>: the kernel
+/// spreads new connections over them, and each connection is served from start to end on the
+/// thread that accepted it, with no lock on the way. Elsewhere a single socket accepts, and hands
+/// the connections to the contexts in turns.
+///
+/// The server listens from construction until <c>stop()</c> or its destruction.
+/// Throws <c>boost::system::system_error</c> when it cannot listen on the configured address.
+/// </summary>
+class server
+{
+public:
+    server(server_config config, request_handler handler)
+        : _owned_executor(std::make_unique<restpp::executor>(config.executor))
+        , _executor(_owned_executor.get())
+        , _state(std::make_shared<details::server_state>(details::server_state{std::move(config), std::move(handler)}))
+    {
+        listen();
+    }
+
+    /// <summary>
+    /// Creates a server running on the I/O contexts of an executor, which must outlive it, and
+    /// whose every context must run on a single thread. <c>config.executor</c> is ignored.
+    /// </summary>
+    server(restpp::executor& executor, server_config config, request_handler handler)
+        : _executor(&executor)
+        , _state(std::make_shared<details::server_state>(details::server_state{std::move(config), std::move(handler)}))
+    {
+        listen();
+    }
+
+    server(const server&) = delete;
+    server& operator=(const server&) = delete;
+
+    ~server() { stop(); }
+
+    const server_config& config() const { return _state->config; }
+
+    /// <summary>
+    /// The port the server listens on, which is the one picked by the system when the configured
+    /// port is zero.
+    /// </summary>
+    unsigned short port() const { return _port; }
+
+    /// <summary>
+    /// The executor the server runs on, whose <c>compute()</c> pool suits work too slow for a
+    /// handler to do on its I/O thread.
+    /// </summary>
+    restpp::executor& executor() { return *_executor; }
+
+    /// <summary>
+    /// Stops accepting connections and closes those open, abandoning the responses in flight.
+    /// Waits for the I/O threads to have done so, so must not be called from a handler.
+    /// </summary>
+    void stop()
+    {
+        if (_stopped.exchange(true))
+            return;
+
+        for (auto& listener : _listeners)
+        {
+            run_on(listener->io_context.get_executor(), [listener] {
+                boost::system::error_code ignored;
+                listener->acceptor.close(ignored);
+                listener->retry_timer.cancel();
+            });
+        }
+        for (auto& shard : _shards)
+        {
+            run_on(shard->io_context.get_executor(), [shard] {
+                shard->stopping = true;
+                std::vector<std::shared_ptr<details::server_connection>> open;
+                open.reserve(shard->connections.size());
+                for (auto* connection : shard->connections)
+                    open.push_back(connection->shared_from_this());
+                for (auto& connection : open)
+                    connection->close();
+            });
+        }
+        if (_owned_executor)
+            _owned_executor->stop();
+    }
+
+private:
+    void listen()
+    {
+        const auto& config = _state->config;
+        for (std::size_t i = 0; i < _executor->size(); ++i)
+            _shards.push_back(std::make_shared<details::server_shard>(_executor->io_context(i), _state));
+
+        boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::make_address(config.address), config.port);
+#ifdef SO_REUSEPORT
+        for (auto& shard : _shards)
+            _listeners.push_back(std::make_shared<details::server_listener>(shard->io_context, std::vector{shard}));
+#else
+        _listeners.push_back(std::make_shared<details::server_listener>(_shards.front()->io_context, _shards));
+#endif
+
+        for (auto& listener : _listeners)
+        {
+            auto& acceptor = listener->acceptor;
+            acceptor.open(endpoint.protocol());
+            acceptor.set_option(boost::asio::socket_base::reuse_address(true));
+#ifdef SO_REUSEPORT
+            acceptor.set_option(details::reuse_port(true));
+#endif
+            acceptor.bind(endpoint);
+            acceptor.listen(config.backlog);
+
+            // The other sockets join the port the system picked for the first
+            endpoint.port(acceptor.local_endpoint().port());
+        }
+        _port = endpoint.port();
+
+        for (auto& listener : _listeners)
+            boost::asio::post(listener->io_context, [listener] { accept(listener); });
+    }
+
+    static void accept(const std::shared_ptr<details::server_listener>& listener)
+    {
+        auto shard = listener->shards[listener->next++ % listener->shards.size()];
+        listener->acceptor.async_accept(
+            shard->io_context, [listener, shard](const boost::system::error_code& ec, boost::asio::ip::tcp::socket socket) {
+                if (ec == boost::asio::error::operation_aborted || !listener->acceptor.is_open())
+                    return;
+                if (ec)
+                {
+                    // Out of file descriptors, most likely: give connections time to close
+                    listener->retry_timer.expires_after(std::chrono::milliseconds(50));
+                    listener->retry_timer.async_wait([listener](const boost::system::error_code& ec) {
+                        if (!ec)
+                            accept(listener);
+                    });
+                    return;
+                }
+
+                boost::asio::dispatch(shard->io_context, [shard, socket = std::move(socket)]() mutable {
+                    if (shard->stopping)
+                        return;
+                    std::make_shared<details::server_connection>(shard, std::move(socket))->start();
+                });
+                accept(listener);
+            });
+    }
+
+    /// <summary>
+    /// Runs the function on the I/O thread of the given executor, and waits for it.
+    /// </summary>
+    template<typename Executor, typename Function>
+    static void run_on(const Executor& executor, Function function)
+    {
+        if (executor.running_in_this_thread())
+            return function();
+        std::promise<void> done;
+        boost::asio::post(executor, [&] {
+            function();
+            done.set_value();
+        });
+        done.get_future().wait();
+    }
+
+    std::unique_ptr<restpp::executor> _owned_executor;
+    restpp::executor* _executor = nullptr;
+    std::shared_ptr<details::server_state> _state;
+    std::vector<std::shared_ptr<details::server_shard>> _shards;
+    std::vector<std::shared_ptr<details::server_listener>> _listeners;
+    unsigned short _port = 0;
+    std::atomic<bool> _stopped{false};
+};
+
+} // namespace restpp
+
+#endif // RESTPP_SERVER_HPP
@@ -0,0 +1,88 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Settings of the embedded HTTP server.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_SERVER_CONFIG_HPP
+#define RESTPP_SERVER_CONFIG_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <restpp/core/executor.hpp>
+
+namespace restpp
+{
+
+/// <summary>
+/// Where a <c>server</c> listens, and how much it accepts from its clients.
+/// </summary>
+struct server_config
+{
+    /// <summary>
+    /// Address to listen on. Defaults to every IPv4 interface.
+    /// </summary>
+    std::string address = "0.0.0.0";
+
+    /// <summary>
+    /// Port to listen on. Zero picks a free port, which <c>server::port()</c> then reports.
+    /// </summary>
+    unsigned short port = 8080;
+
+    /// <summary>
+    /// Threads of the executor the server creates for itself, each accepting and serving
+    /// connections on an I/O context of its own. Defaults to one per core.
+    /// </summary>
+    executor_config executor;
+
+    /// <summary>
+    /// Maximum number of connections waiting to be accepted, per listening socket.
+    /// </summary>
+    int backlog = 1024;
+
+    /// <summary>
+    /// Largest request line and header block accepted. Bigger ones are answered with 431.
+    /// </summary>
+    std::size_t max_head_size = 64 * 1024;
+
+    /// <summary>
+    /// Largest request body accepted. Bigger ones are answered with 413.
+    /// </summary>
+    std::uint64_t max_body_size = 8 * 1024 * 1024;
+
+    /// <summary>
+    /// How long a keep-alive connection may wait for its next request before it is closed.
+    /// </summary>
+    std::chrono::steady_clock::duration idle_timeout = std::chrono::seconds(60);
+
+    /// <summary>
+    /// How long a client has to send a whole request once it started, and to take the bytes
+    /// of a response off the socket. Protects against clients that trickle data in or out.
+    /// </summary>
+    std::chrono::steady_clock::duration request_timeout = std::chrono::seconds(30);
+
+    /// <summary>
+    /// Requests served over one connection before it is closed. Zero leaves it unlimited.
+    /// </summary>
+    std::size_t max_requests_per_connection = 0;
+
+    /// <summary>
+    /// Sent as the Server header of every response. Empty leaves the header out.
+    /// </summary>
+    std::string server_name = "restpp";
+};
+
+} // namespace restpp
+
+#endif // RESTPP_SERVER_CONFIG_HPP
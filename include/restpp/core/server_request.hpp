@@ -0,0 +1,153 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * HTTP request received by the embedded server.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_SERVER_REQUEST_HPP
+#define RESTPP_SERVER_REQUEST_HPP
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/container/small_vector.hpp>
+
+#include <restpp/core/headers.hpp>
+#include <restpp/core/json.hpp>
+#include <restpp/core/json_decode.hpp>
+
+namespace restpp
+{
+
+/// <summary>
+/// The parameters a route extracted from the path of a request, such as "id" for a request to
+/// "/users/42" matching "/users/{id}". Values are views into the target of the request, still
+/// percent-encoded. Up to eight parameters are held without allocating.
+/// </summary>
+class route_params
+{
+public:
+    using value_type = std::pair<std::string_view, std::string_view>;
+    using const_iterator = boost::container::small_vector<value_type, 8>::const_iterator;
+
+    /// <summary>
+    /// The value of the parameter with the given name.
+    /// </summary>
+    std::optional<std::string_view> get(std::string_view name) const
+    {
+        for (const auto& param : _params)
+        {
+            if (param.first == name)
+                return param.second;
+        }
+        return std::nullopt;
+    }
+
+    /// <summary>
+    /// The value of the parameter with the given name, or an empty view if there is none.
+    /// </summary>
+    std::string_view operator[](std::string_view name) const { return get(name).value_or(std::string_view()); }
+
+    void add(std::string_view name, std::string_view value) { _params.emplace_back(name, value); }
+
+    /// <summary>
+    /// Removes the parameter added last.
+    /// </summary>
+    void pop() { _params.pop_back(); }
+
+    std::size_t size() const { return _params.size(); }
+
+    bool empty() const { return _params.empty(); }
+
+    void clear() { _params.clear(); }
+
+    const_iterator begin() const { return _params.begin(); }
+
+    const_iterator end() const { return _params.end(); }
+
+private:
+    boost::container::small_vector<value_type, 8> _params;
+};
+
+/// <summary>
+/// A request being served. A connection reuses the same request for every request it carries,
+/// so once its strings have grown to fit the traffic, reading a request allocates nothing. The
+/// request is only valid until its response has been sent.
+/// </summary>
+struct server_request
+{
+    std::string method;
+
+    /// <summary>
+    /// The request-target as sent, usually an absolute path followed by a query.
+    /// </summary>
+    std::string target;
+
+    /// <summary>
+    /// Minor version of HTTP/1 the client spoke.
+    /// </summary>
+    int version_minor = 1;
+
+    restpp::headers headers;
+    std::string body;
+
+    /// <summary>
+    /// The parameters of the route of a <c>router</c> that matched the request.
+    /// </summary>
+    route_params params;
+
+    /// <summary>
+    /// Address and port of the client.
+    /// </summary>
+    boost::asio::ip::tcp::endpoint remote_endpoint;
+
+    /// <summary>
+    /// The target up to its query.
+    /// </summary>
+    std::string_view path() const
+    {
+        const std::string_view view(target);
+        return view.substr(0, view.find('?'));
+    }
+
+    /// <summary>
+    /// The query of the target, without its '?', or an empty view when there is none.
+    /// </summary>
+    std::string_view query() const
+    {
+        const auto question = target.find('?');
+        return question == std::string::npos ? std::string_view() : std::string_view(target).substr(question + 1);
+    }
+
+    /// <summary>
+    /// Indexes the body as JSON. The document views the body, which must outlive it.
+    /// Throws <c>json_exception</c> when the body is not JSON.
+    /// </summary>
+    restpp::json_document json() const { return restpp::json_document(body); }
+
+    /// <summary>
+    /// Decodes the body as JSON into a value of the given type, whose fields are listed with
+    /// <c>RESTPP_JSON_FIELDS</c>. Throws <c>json_exception</c> when the body does not fit.
+    /// </summary>
+    template<typename T>
+    T as() const
+    {
+        return restpp::from_json<T>(body);
+    }
+};
+
+} // namespace restpp
+
+#endif // RESTPP_SERVER_REQUEST_HPP
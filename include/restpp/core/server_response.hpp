@@ -0,0 +1,199 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * HTTP response sent by the embedded server, and the handlers that produce them.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_SERVER_RESPONSE_HPP
+#define RESTPP_SERVER_RESPONSE_HPP
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <boost/system/error_code.hpp>
+
+#include <restpp/core/headers.hpp>
+#include <restpp/core/server_request.hpp>
+
+namespace restpp
+{
+namespace details
+{
+class server_connection;
+
+/// <summary>
+/// What a response sent after its handler returned needs from the connection it goes out on.
+/// Every call may come from any thread.
+/// </summary>
+class response_channel
+{
+public:
+    virtual ~response_channel() = default;
+
+    /// <summary>
+    /// Keeps the connection alive for as long as a response sent after its handler returned
+    /// needs it.
+    /// </summary>
+    virtual std::shared_ptr<response_channel> hold() = 0;
+
+    /// <summary>
+    /// Sends the response of a deferred request, as it stands now.
+    /// </summary>
+    virtual void resume() = 0;
+
+    /// <summary>
+    /// Sends a piece of a streamed body, then invokes <c>done</c>.
+    /// </summary>
+    virtual void write(std::string_view data, std::function<void(boost::system::error_code)> done) = 0;
+
+    /// <summary>
+    /// Ends a streamed body.
+    /// </summary>
+    virtual void end() = 0;
+};
+} // namespace details
+
+/// <summary>
+/// Sends the body of a streamed response while it is produced. Pieces go out as chunks with
+/// chunked transfer-encoding, or as they are to an HTTP/1.0 client, which sees the end of the
+/// body when the connection closes.
+///
+/// Only one piece is in flight at a time: <c>done</c> is invoked once the piece was written to
+/// the socket, and the next piece should wait for it. A client that reads slowly thus slows the
+/// producer down, and no more than one piece is ever buffered. The stream may be used from any
+/// thread and kept past the return of the handler.
+/// </summary>
+class response_stream
+{
+public:
+    response_stream() = default;
+
+    /// <summary>
+    /// Sends a piece of the body, which must stay valid until <c>done</c> is invoked. An error
+    /// passed to <c>done</c> means the client went away, and the body should be given up.
+    /// </summary>
+    void write(std::string_view data, std::function<void(boost::system::error_code)> done) const
+    {
+        _channel->write(data, std::move(done));
+    }
+
+    /// <summary>
+    /// Ends the body once the pieces in flight were written, completing the response.
+    /// </summary>
+    void end() const { _channel->end(); }
+
+    explicit operator bool() const { return static_cast<bool>(_channel); }
+
+private:
+    friend struct server_response;
+
+    explicit response_stream(std::shared_ptr<details::response_channel> channel) : _channel(std::move(channel)) {}
+
+    std::shared_ptr<details::response_channel> _channel;
+};
+
+/// <summary>
+/// Completes a deferred response. Invoking it, from any thread, sends the response as it then
+/// stands; it may only be invoked once.
+/// </summary>
+class deferred_response
+{
+public:
+    deferred_response() = default;
+
+    void operator()() const { _channel->resume(); }
+
+    explicit operator bool() const { return static_cast<bool>(_channel); }
+
+private:
+    friend struct server_response;
+
+    explicit deferred_response(std::shared_ptr<details::response_channel> channel) : _channel(std::move(channel)) {}
+
+    std::shared_ptr<details::response_channel> _channel;
+};
+
+/// <summary>
+/// The response to a request being served. Unless the handler defers it or streams its body,
+/// the response is sent as soon as the handler returns, with a Content-Length matching the body.
+/// Like the request, a connection reuses the same response for every request it carries.
+/// </summary>
+struct server_response
+{
+    int status_code = 200;
+    restpp::headers headers;
+    std::string body;
+
+    /// <summary>
+    /// Leaves the response unsent when the handler returns, for it to be completed later, such as
+    /// once a request to another service came back. The request and the response stay valid, and
+    /// must not be touched once the returned completion was invoked.
+    /// </summary>
+    deferred_response defer()
+    {
+        _mode = mode::deferred;
+        return deferred_response(_channel->hold());
+    }
+
+    /// <summary>
+    /// Sends the body through the returned stream instead of from <c>body</c>. The status and
+    /// headers go out when the handler returns; the response is complete once the stream is ended.
+    /// </summary>
+    response_stream stream()
+    {
+        _mode = mode::streamed;
+        return response_stream(_channel->hold());
+    }
+
+    bool is_deferred() const { return _mode == mode::deferred; }
+
+    bool is_streamed() const { return _mode == mode::streamed; }
+
+    /// <summary>
+    /// Prepares the response for the next request on the connection, keeping its storage.
+    /// </summary>
+    void clear()
+    {
+        status_code = 200;
+        headers.clear();
+        body.clear();
+        _mode = mode::immediate;
+    }
+
+private:
+    friend class details::server_connection;
+
+    enum class mode
+    {
+        immediate,
+        deferred,
+        streamed
+    };
+
+    mode _mode = mode::immediate;
+
+    // The connection the response goes out on
+    details::response_channel* _channel = nullptr;
+};
+
+/// <summary>
+/// Serves a request by filling in its response. Handlers run on the I/O thread of the connection
+/// and should return quickly: slow work is better done elsewhere, with the response deferred.
+/// Exceptions thrown by a handler are answered with 500.
+/// </summary>
+using request_handler = std::function<void(server_request& req, server_response& res)>;
+
+} // namespace restpp
+
+#endif // RESTPP_SERVER_RESPONSE_HPP
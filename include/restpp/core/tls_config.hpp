@@ -0,0 +1,59 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Settings of the TLS connections opened for https URIs.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_TLS_CONFIG_HPP
+#define RESTPP_TLS_CONFIG_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace restpp
+{
+
+/// <summary>
+/// Settings of the TLS context a client shares between all of its https connections.
+/// </summary>
+struct tls_config
+{
+    /// <summary>
+    /// Verify the certificate chain of the server and that it was issued for the host of the URI.
+    /// </summary>
+    bool verify_peer = true;
+
+    /// <summary>
+    /// PEM file of certificate authorities to trust. When empty the system store is used.
+    /// </summary>
+    std::string ca_file;
+
+    /// <summary>
+    /// Application protocols offered through ALPN, in order of preference.
+    /// </summary>
+    std::vector<std::string> alpn = {"http/1.1"};
+
+    /// <summary>
+    /// Keep the TLS sessions and tickets handed out by servers, so that new connections to the
+    /// same host and port resume them with an abbreviated handshake.
+    /// </summary>
+    bool session_resumption = true;
+
+    /// <summary>
+    /// Maximum number of hosts a session is kept for.
+    /// </summary>
+    std::size_t max_cached_sessions = 256;
+};
+
+} // namespace restpp
+
+#endif // RESTPP_TLS_CONFIG_HPP
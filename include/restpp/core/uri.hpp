@@ -19,62 +19,49 @@
 #pragma once
 #endif // defined(_MSC_VER) && (_MSC_VER >= 1200)
 
-#include <string>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
-#include <cstring>
+#include <iterator>
+#include <string>
+#include <string_view>
 
 #include <restpp/core/asyncrt_utils.hpp>
 #include <restpp/core/details/basic_types.hpp>
+#include <restpp/core/details/uri_chars.hpp>
 
 namespace restpp
 {
 namespace details
 {
+/// <summary>
+/// Location of every component of a URI inside the string that holds it. A component that
+/// is absent has a size of zero.
+/// </summary>
 struct uri_components
 {
-    uri_components() : _path(_RESTPPSTR("/")), _port(-1) {}
-
-    uri_components(const uri_components&) = default;
-    uri_components& operator=(const uri_components&) = default;
-
-    uri_components(uri_components&& other) noexcept : _scheme(std::move(other._scheme)),
-                                                      _host(std::move(other._host)),
-                                                      _userInfo(std::move(other._userInfo)),
-                                                      _path(std::move(other._path)),
-                                                      _query(std::move(other._query)),
-                                                      _fragment(std::move(other._fragment)),
-                                                      _port(std::move(other._port))
-    {
-    }
-
-    uri_components& operator=(uri_components&& other) noexcept
+    struct span
     {
-        if (this != &other)
-        {
-            _scheme = std::move(other._scheme);
-            _host = std::move(other._host);
-            _userInfo = std::move(other._userInfo);
-            _path = std::move(other._path);
-            _query = std::move(other._query);
-            _fragment = std::move(other._fragment);
-            _port = other._port;
-        }
-        return *this;
-    }
-
-    utility::string_t join();
-
-    utility::string_t _scheme;
-    utility::string_t _host;
-    utility::string_t _userInfo;
-    utility::string_t _path;
-    utility::string_t _query;
-    utility::string_t _fragment;
-    int _port;
+        std::uint32_t offset = 0;
+        std::uint32_t size = 0;
+    };
+
+    span _scheme;
+    span _userInfo;
+    span _host;
+    span _path;
+    span _query;
+    span _fragment;
+    int _port = -1;
 };
 
 namespace 
 {
+inline bool is_alpha(int c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+
+inline bool is_digit(int c) { return c >= '0' && c <= '9'; }
+
 /// <summary>
 /// Unreserved characters are those that are allowed in a URI but do not have a reserved purpose. They include:
 /// - A-Z
@@ -85,20 +72,14 @@ namespace
 /// - '_' (underscore)
 /// - '~' (tilde)
 /// </summary>
-inline bool is_unreserved(int c)
-{
-    return ::utility::details::is_alnum((char)c) || c == '-' || c == '.' || c == '_' || c == '~';
-}
+inline bool is_unreserved(int c) { return is_uri_char(c, uri_unreserved); }
 
 /// <summary>
 /// General delimiters serve as the delimiters between different uri components.
 /// General delimiters include:
 /// - All of these :/?#[]@
 /// </summary>
-inline bool is_gen_delim(int c)
-{
-    return c == ':' || c == '/' || c == '?' || c == '#' || c == '[' || c == ']' || c == '@';
-}
+inline bool is_gen_delim(int c) { return is_uri_char(c, uri_gen_delim); }
 
 /// <summary>
 /// Subdelimiters are those characters that may have a defined meaning within component
@@ -106,30 +87,13 @@ inline bool is_gen_delim(int c)
 /// uri segments. sub_delimiters include:
 /// - All of these !$&'()*+,;=
 /// </summary>
-inline bool is_sub_delim(int c)
-{
-    switch (c)
-    {
-        case '!':
-        case '$':
-        case '&':
-        case '\'':
-        case '(':
-        case ')':
-        case '*':
-        case '+':
-        case ',':
-        case ';':
-        case '=': return true;
-        default: return false;
-    }
-}
+inline bool is_sub_delim(int c) { return is_uri_char(c, uri_sub_delim); }
 
 /// <summary>
 /// Reserved characters includes the general delimiters and sub delimiters. Some characters
 /// are neither reserved nor unreserved, and must be percent-encoded.
 /// </summary>
-inline bool is_reserved(int c) { return is_gen_delim(c) || is_sub_delim(c); }
+inline bool is_reserved(int c) { return is_uri_char(c, uri_gen_delim | uri_sub_delim); }
 
 /// <summary>
 /// Legal characters in the scheme portion include:
@@ -140,10 +104,7 @@ inline bool is_reserved(int c) { return is_gen_delim(c) || is_sub_delim(c); }
 ///
 /// Note that the scheme must BEGIN with an alpha character.
 /// </summary>
-inline bool is_scheme_character(int c)
-{
-    return ::utility::details::is_alnum((char)c) || c == '+' || c == '-' || c == '.';
-}
+inline bool is_scheme_character(int c) { return is_uri_char(c, uri_scheme); }
 
 /// <summary>
 /// Legal characters in the user information portion include:
@@ -152,7 +113,7 @@ inline bool is_scheme_character(int c)
 /// - The sub-delimiters
 /// - ':' (colon)
 /// </summary>
-inline bool is_user_info_character(int c) { return is_unreserved(c) || is_sub_delim(c) || c == '%' || c == ':'; }
+inline bool is_user_info_character(int c) { return is_uri_char(c, uri_user_info | uri_percent); }
 
 /// <summary>
 /// Legal characters in the authority portion include:
@@ -162,10 +123,7 @@ inline bool is_user_info_character(int c) { return is_unreserved(c) || is_sub_de
 /// - ':' (colon)
 /// - IPv6 requires '[]' allowed for it to be valid URI and passed to underlying platform for IPv6 support
 /// </summary>
-inline bool is_authority_character(int c)
-{
-    return is_unreserved(c) || is_sub_delim(c) || c == '%' || c == '@' || c == ':' || c == '[' || c == ']';
-}
+inline bool is_authority_character(int c) { return is_uri_char(c, uri_authority | uri_percent); }
 
 /// <summary>
 /// Legal characters in the path portion include:
@@ -175,17 +133,14 @@ inline bool is_authority_character(int c)
 /// - ':' (colon)
 /// - '@' (at sign)
 /// </summary>
-inline bool is_path_character(int c)
-{
-    return is_unreserved(c) || is_sub_delim(c) || c == '%' || c == '/' || c == ':' || c == '@';
-}
+inline bool is_path_character(int c) { return is_uri_char(c, uri_path | uri_percent); }
 
 /// <summary>
 /// Legal characters in the query portion include:
 /// - Any path character
 /// - '?' (question mark)
 /// </summary>
-inline bool is_query_character(int c) { return is_path_character(c) || c == '?'; }
+inline bool is_query_character(int c) { return is_uri_char(c, uri_query | uri_percent); }
 
 /// <summary>
 /// Legal characters in the fragment portion include:
@@ -195,7 +150,7 @@ inline bool is_query_character(int c) { return is_path_character(c) || c == '?';
 inline bool is_fragment_character(int c)
 {
     // this is intentional, they have the same set of legal characters
-    return is_query_character(c);
+    return is_uri_char(c, uri_fragment | uri_percent);
 }
 
 struct inner_parse_out
@@ -219,6 +174,15 @@ struct inner_parse_out
     /// 'encoded' is expected to point to an encoded zero-terminated string containing a uri
     /// </summary>
     bool parse_from(const utility::char_t* encoded)
+    {
+        return parse_from(encoded, encoded + std::char_traits<utility::char_t>::length(encoded));
+    }
+
+    /// <summary>
+    /// Parses the uri held in [encoded, end), where <c>*end</c> must be a terminating zero.
+    /// An embedded zero makes the uri invalid.
+    /// </summary>
+    bool parse_from(const utility::char_t* encoded, const utility::char_t* end)
     {
         const utility::char_t* p = encoded;
 
@@ -242,7 +206,7 @@ struct inner_parse_out
         if (!is_relative_reference)
         {
             // the first character of a scheme must be a letter
-            if (!isalpha(*p))
+            if (!is_alpha(*p))
             {
                 return false;
             }
@@ -274,14 +238,12 @@ struct inner_parse_out
 
             // the authority is delimited by a slash (resource), question-mark (query) or octothorpe (fragment)
             // or by EOS. The authority could be empty ('file:///C:\file_name.txt')
-            for (; *p != _RESTPPSTR('/') && *p != _RESTPPSTR('?') && *p != _RESTPPSTR('#') && *p != _RESTPPSTR('\0'); p++)
+            // We're NOT currently supporting IPvFuture or username/password in authority
+            // IPv6 as the host (i.e. http://[:::::::]) is allowed as valid URI and passed to subsystem for support.
+            p = scan_uri_chars(p, end, uri_authority | uri_percent);
+            if (*p != _RESTPPSTR('/') && *p != _RESTPPSTR('?') && *p != _RESTPPSTR('#') && *p != _RESTPPSTR('\0'))
             {
-                // We're NOT currently supporting IPvFuture or username/password in authority
-                // IPv6 as the host (i.e. http://[:::::::]) is allowed as valid URI and passed to subsystem for support.
-                if (!is_authority_character(*p))
-                {
-                    return false;
-                }
+                return false;
             }
             authority_end = p;
 
@@ -290,7 +252,7 @@ struct inner_parse_out
             {
                 // the port is made up of all digits
                 const utility::char_t* port_begin = authority_end - 1;
-                for (; isdigit(*port_begin) && port_begin != authority_begin; port_begin--)
+                for (; is_digit(*port_begin) && port_begin != authority_begin; port_begin--)
                 {
                 }
 
@@ -303,8 +265,15 @@ struct inner_parse_out
                     // skip the colon
                     port_begin++;
 
-                    port =
-                        utility::conversions::details::scan_string<int>(utility::string_t(port_begin, authority_end));
+                    port = 0;
+                    for (const utility::char_t* d = port_begin; d != authority_end; ++d)
+                    {
+                        port = port * 10 + static_cast<int>(*d - _RESTPPSTR('0'));
+                        if (port > 65535)
+                        {
+                            return false;
+                        }
+                    }
                 }
                 else
                 {
@@ -335,12 +304,10 @@ struct inner_parse_out
             path_begin = p;
 
             // the path is delimited by a question-mark (query) or octothorpe (fragment) or by EOS
-            for (; *p != _RESTPPSTR('?') && *p != _RESTPPSTR('#') && *p != _RESTPPSTR('\0'); p++)
+            p = scan_uri_chars(p, end, uri_path | uri_percent);
+            if (*p != _RESTPPSTR('?') && *p != _RESTPPSTR('#') && *p != _RESTPPSTR('\0'))
             {
-                if (!is_path_character(*p))
-                {
-                    return false;
-                }
+                return false;
             }
             path_end = p;
         }
@@ -353,12 +320,10 @@ struct inner_parse_out
             query_begin = p;
 
             // the query is delimited by a '#' (fragment) or EOS
-            for (; *p != _RESTPPSTR('#') && *p != _RESTPPSTR('\0'); p++)
+            p = scan_uri_chars(p, end, uri_query | uri_percent);
+            if (*p != _RESTPPSTR('#') && *p != _RESTPPSTR('\0'))
             {
-                if (!is_query_character(*p))
-                {
-                    return false;
-                }
+                return false;
             }
             query_end = p;
         }
@@ -371,75 +336,36 @@ struct inner_parse_out
             fragment_begin = p;
 
             // the fragment is delimited by EOS
-            for (; *p != _RESTPPSTR('\0'); p++)
-            {
-                if (!is_fragment_character(*p))
-                {
-                    return false;
-                }
-            }
+            p = scan_uri_chars(p, end, uri_fragment | uri_percent);
             fragment_end = p;
         }
 
-        return true;
+        return p == end;
     }
 
-    void write_to(uri_components& components)
+    /// <summary>
+    /// Records the parsed components as offsets relative to <c>base</c>, the start of the
+    /// buffer given to parse_from.
+    /// </summary>
+    void write_to(const utility::char_t* base, uri_components& components) const
     {
-        if (scheme_begin)
-        {
-            components._scheme.assign(scheme_begin, scheme_end);
-            utility::details::inplace_tolower(components._scheme);
-        }
-        else
-        {
-            components._scheme.clear();
-        }
-
-        if (uinfo_begin)
-        {
-            components._userInfo.assign(uinfo_begin, uinfo_end);
-        }
-
-        if (host_begin)
-        {
-            components._host.assign(host_begin, host_end);
-            utility::details::inplace_tolower(components._host);
-        }
-        else
-        {
-            components._host.clear();
-        }
-
-        components._port = port;
-
-        if (path_begin)
-        {
-            components._path.assign(path_begin, path_end);
-        }
-        else
-        {
-            // default path to begin with a slash for easy comparison
-            components._path = _RESTPPSTR("/");
-        }
-
-        if (query_begin)
-        {
-            components._query.assign(query_begin, query_end);
-        }
-        else
-        {
-            components._query.clear();
-        }
-
-        if (fragment_begin)
-        {
-            components._fragment.assign(fragment_begin, fragment_end);
-        }
-        else
-        {
-            components._fragment.clear();
-        }
+        auto to_span = [base](const utility::char_t* begin, const utility::char_t* end) {
+            uri_components::span result;
+            if (begin)
+            {
+                result.offset = static_cast<std::uint32_t>(begin - base);
+                result.size = static_cast<std::uint32_t>(end - begin);
+            }
+            return result;
+        };
+
+        components._scheme = to_span(scheme_begin, scheme_end);
+        components._userInfo = to_span(uinfo_begin, uinfo_end);
+        components._host = to_span(host_begin, host_end);
+        components._port = host_begin && port != 0 ? port : -1;
+        components._path = to_span(path_begin, path_end);
+        components._query = to_span(query_begin, query_end);
+        components._fragment = to_span(fragment_begin, fragment_end);
     }
 };
 } // namespace
@@ -452,41 +378,46 @@ struct inner_parse_out
 class uri_exception : public std::exception
 {
 public:
-    uri_exception(utility::string_t msg) : _msg{std::move(msg)} {}
+    uri_exception(std::string msg) : _msg{std::move(msg)} {}
 
     ~uri_exception() noexcept {}
 
-    const utility::char_t* what() noexcept { return _msg.c_str(); }
+    const char* what() const noexcept override { return _msg.c_str(); }
 
 private:
-    utility::string_t _msg;
+    std::string _msg;
 };
 
+/// <summary>
+/// A parsed URI. The encoded string is held in a single buffer and every component is a view
+/// into it, so parsing takes one pass and allocates nothing beyond that buffer. The scheme and
+/// host are normalized to lower case in place, but for the socket path of an http+unix URI.
+/// </summary>
 class uri
 {
 public:
+    using string_view_t = utility::string_view_t;
+
     /// <summary>
     /// Creates a URI from the given encoded string. This will throw an exception if the string
     /// does not contain a valid URI. Use uri::validate if processing user-input.
     /// </summary>
     /// <param name="uri_string">A pointer to an encoded string to create the URI instance.</param>
-    uri(const utility::char_t* uri_string)
-    {
-        if (std::strlen(uri_string) == 0)
-            throw uri_exception{"provided uri is invalid: " + std::string{uri_string}};
-        _url = uri_string;
-        parse();
-    }
+    uri(const utility::char_t* uri_string) : _uri(uri_string) { parse(); }
 
-    // <summary>
+    /// <summary>
     /// Creates a URI from the given encoded string. This will throw an exception if the string
     /// does not contain a valid URI. Use uri::validate if processing user-input.
     /// </summary>
     /// <param name="uri_string">An encoded URI string to create the URI instance.</param>
-    uri(const utility::string_t& uri_string)
-        : uri(uri_string.c_str())
-    {
-    }
+    uri(utility::string_t uri_string) : _uri(std::move(uri_string)) { parse(); }
+
+    /// <summary>
+    /// Creates a URI from a view of an encoded string, which is copied into the single buffer
+    /// of the URI. This will throw an exception if the string does not contain a valid URI.
+    /// </summary>
+    /// <param name="uri_string">A view of an encoded URI string.</param>
+    uri(string_view_t uri_string) : _uri(uri_string) { parse(); }
 
     /// <summary>
     /// Copy constructor.
@@ -499,26 +430,21 @@ public:
     uri& operator=(const uri&) = default;
 
     /// <summary>
-    /// Move constructor.
+    /// Move constructor. Components are stored as offsets, so they stay valid in the new buffer.
     /// </summary>
-    uri(uri&& other) noexcept : _uri{std::move(other._uri)} {}
+    uri(uri&& other) noexcept = default;
 
     /// <summary>
     /// Move assignment operator
     /// </summary>
-    uri& operator=(uri&& other) noexcept
-    {
-        if (this != &other)
-            _uri = std::move(other._uri);
-        return *this;
-    }
+    uri& operator=(uri&& other) noexcept = default;
 
     /// <summary>
     /// Conversion operator from std::string to uri.
     /// </summary>
-    uri& operator=(const utility::string_t& url)
+    uri& operator=(utility::string_t url)
     {
-        _url = url;
+        _uri = std::move(url);
         parse();
         return *this;
     }
@@ -528,94 +454,341 @@ public:
     /// </summary>
     uri& operator=(const utility::char_t* url)
     {
-        _url = url;
+        _uri = url;
+        parse();
+        return *this;
+    }
+
+    /// <summary>
+    /// Conversion operator from a string view to uri, reusing the buffer of the URI.
+    /// </summary>
+    uri& operator=(string_view_t url)
+    {
+        _uri.assign(url.data(), url.size());
         parse();
         return *this;
     }
 
+    /// <summary>
+    /// Validates a string as a URI. Unlike the constructors, this never throws, which makes
+    /// it suitable for untrusted input.
+    /// </summary>
+    /// <param name="uri_string">The URI string to be validated.</param>
+    /// <returns><c>true</c> if the given string represents a valid URI, <c>false</c> otherwise.</returns>
+    static bool validate(const utility::string_t& uri_string)
+    {
+        details::inner_parse_out out;
+        return !uri_string.empty() && out.parse_from(uri_string.c_str(), uri_string.c_str() + uri_string.size());
+    }
+
+    static bool validate(const utility::char_t* uri_string)
+    {
+        details::inner_parse_out out;
+        return *uri_string != _RESTPPSTR('\0') && out.parse_from(uri_string);
+    }
+
+    /// <summary>
+    /// Validates a view of a string as a URI. The parser needs the terminating zero a view may
+    /// lack, so the view is copied first.
+    /// </summary>
+    static bool validate(string_view_t uri_string) { return validate(utility::string_t(uri_string)); }
+
+    /// <summary>
+    /// The components a string can be encoded for. Each leaves the characters that are legal
+    /// in that component as they are and percent-encodes everything else; <c>data</c> keeps
+    /// only unreserved characters, which suits a single query parameter name or value.
+    /// </summary>
+    enum class component
+    {
+        data,
+        user_info,
+        path,
+        query,
+        fragment
+    };
+
+    /// <summary>
+    /// Percent-encodes a UTF-8 string for use in the given URI component.
+    /// </summary>
+    /// <param name="raw">The string to encode.</param>
+    /// <param name="kind">The component the result is meant for.</param>
+    /// <returns>The encoded string.</returns>
+    static std::string encode_component(std::string_view raw, component kind = component::data)
+    {
+        std::uint16_t classes = details::uri_unreserved;
+        switch (kind)
+        {
+            case component::data: break;
+            case component::user_info: classes = details::uri_user_info; break;
+            case component::path: classes = details::uri_path; break;
+            case component::query: classes = details::uri_query; break;
+            case component::fragment: classes = details::uri_fragment; break;
+        }
+
+        const char* const end = raw.data() + raw.size();
+        const char* p = details::scan_uri_chars(raw.data(), end, classes);
+        if (p == end)
+            return std::string(raw);
+
+        // Count the escapes first so the result is allocated once
+        std::size_t escapes = 0;
+        for (const char* q = p; q != end; q = details::scan_uri_chars(q + 1, end, classes))
+            ++escapes;
+
+        static constexpr char hex[] = "0123456789ABCDEF";
+        std::string encoded;
+        encoded.reserve(raw.size() + 2 * escapes);
+        encoded.append(raw.data(), p);
+        while (p != end)
+        {
+            const auto octet = static_cast<unsigned char>(*p);
+            const char escape[3] = {'%', hex[octet >> 4], hex[octet & 0x0F]};
+            encoded.append(escape, 3);
+
+            const char* next = details::scan_uri_chars(p + 1, end, classes);
+            encoded.append(p + 1, next);
+            p = next;
+        }
+        return encoded;
+    }
+
+    /// <summary>
+    /// Decodes every percent-encoded octet of a string. '+' is left as is.
+    /// This will throw an exception if an escape is malformed.
+    /// </summary>
+    /// <param name="encoded">The encoded string.</param>
+    /// <returns>The decoded string.</returns>
+    static std::string decode(std::string_view encoded)
+    {
+        std::size_t percent = encoded.find('%');
+        if (percent == std::string_view::npos)
+            return std::string(encoded);
+
+        std::string decoded;
+        decoded.reserve(encoded.size());
+        std::size_t done = 0;
+        while (percent != std::string_view::npos)
+        {
+            const int high = percent + 2 < encoded.size() ? hex_value(encoded[percent + 1]) : -1;
+            const int low = high >= 0 ? hex_value(encoded[percent + 2]) : -1;
+            if (low < 0)
+                throw uri_exception("invalid percent-encoding in uri component");
+
+            decoded.append(encoded.data() + done, percent - done);
+            decoded.push_back(static_cast<char>((high << 4) | low));
+            done = percent + 3;
+            percent = encoded.find('%', done);
+        }
+        decoded.append(encoded.data() + done, encoded.size() - done);
+        return decoded;
+    }
+
     /// <summary>
     /// Get the scheme component of the URI as an encoded string.
     /// </summary>
     /// <returns>The URI scheme as a string.</returns>
-    const utility::string_t& scheme() const {
-        return _components._scheme;
-    }
+    string_view_t scheme() const { return view(_components._scheme); }
 
     /// <summary>
     /// Get the user information component of the URI as an encoded string.
     /// </summary>
     /// <returns>The URI user information as a string.</returns>
-    const utility::string_t& user_info() const {
-        return _components._userInfo;
-    }
+    string_view_t user_info() const { return view(_components._userInfo); }
 
     /// <summary>
     /// Get the host component of the URI as an encoded string.
     /// </summary>
     /// <returns>The URI host as a string.</returns>
-    const utility::string_t& host() {
-        return _components._host;
-    }
+    string_view_t host() const { return view(_components._host); }
 
     /// <summary>
-    /// Get the port component of the URI. Returns -1 if no port is specified.
+    /// Get the port component of the URI. When no port is given, the default port of the
+    /// http, https, ws and wss schemes is returned; otherwise -1.
     /// </summary>
     /// <returns>The URI port as an integer.</returns>
-    int port() const {
-        return _components._port;
+    int port() const
+    {
+        if (_components._port != -1)
+            return _components._port;
+
+        const string_view_t s = scheme();
+        if (s == _RESTPPSTR("http") || s == _RESTPPSTR("ws"))
+            return 80;
+        if (s == _RESTPPSTR("https") || s == _RESTPPSTR("wss"))
+            return 443;
+        return -1;
     }
 
     /// <summary>
-    /// Get the path component of the URI as an encoded string.
+    /// Get the path component of the URI as an encoded string. An empty path is reported as "/".
     /// </summary>
     /// <returns>The URI path as a string.</returns>
-    const utility::string_t& path() {
-        return _components._path;
+    string_view_t path() const
+    {
+        if (_components._path.size == 0)
+            return string_view_t(_RESTPPSTR("/"), 1);
+        return view(_components._path);
     }
 
     /// <summary>
     /// Get the query component of the URI as an encoded string.
     /// </summary>
     /// <returns>The URI query as a string.</returns>
-    const utility::string_t& query() const {
-        return _components._query;
-    }
+    string_view_t query() const { return view(_components._query); }
 
     /// <summary>
     /// Get the fragment component of the URI as an encoded string.
     /// </summary>
     /// <returns>The URI fragment as a string.</returns>
-    const utility::string_t& fragment() const {
-        return _components._fragment;
+    string_view_t fragment() const { return view(_components._fragment); }
+
+    /// <summary>
+    /// Get the path and query of the URI, the part sent as the target of an HTTP request.
+    /// When the URI has an empty path the result does not start with a slash.
+    /// </summary>
+    /// <returns>The path and query as a string.</returns>
+    string_view_t resource() const
+    {
+        const auto& p = _components._path;
+        const auto& q = _components._query;
+        if (q.size == 0)
+            return path();
+
+        // The query is preceded by its '?' in the buffer
+        const std::uint32_t begin = p.size != 0 ? p.offset : q.offset - 1;
+        return string_view_t(_uri.data() + begin, q.offset + q.size - begin);
     }
 
+    /// <summary>
+    /// The full encoded URI, with its scheme and host in lower case, except for the socket path of
+    /// an http+unix URI.
+    /// </summary>
+    const utility::string_t& to_string() const { return _uri; }
+
+    bool operator==(const uri& other) const { return _uri == other._uri; }
+
+    bool operator!=(const uri& other) const { return !(*this == other); }
+
 private:
-    void parse() {
-        // very basic URI parsing
-        auto scheme_end = _url.find("://");
-        _components._scheme = _url.substr(0, scheme_end);
-
-        auto host_start = scheme_end + 3;
-        auto path_start = _url.find("/", host_start);
-        _components._host = _url.substr(host_start, path_start - host_start);
-
-        auto port_pos = _components._host.find(":");
-        if (port_pos != utility::string_t::npos) {
-            _components._port = std::atoi(_components._host.substr(port_pos + 1).c_str());
-            _components._host = _components._host.substr(0, port_pos);
-        } else {
-            _components._port = (_components._scheme == "https") ? 443 : 80;
-        }
+    void parse()
+    {
+        details::inner_parse_out out;
+        if (_uri.empty() || !out.parse_from(_uri.c_str(), _uri.c_str() + _uri.size()))
+            throw uri_exception("provided uri is invalid: " + utility::conversions::to_utf8string(_uri));
+
+        out.write_to(_uri.c_str(), _components);
+        to_lower(_components._scheme);
 
-        _components._path = (path_start == utility::string_t::npos) ? "/" : _url.substr(path_start);
+        // The host of an http+unix URI is the encoded path of a socket, which is case sensitive
+        if (view(_components._scheme) != _RESTPPSTR("http+unix"))
+            to_lower(_components._host);
     }
 
-private:
-    utility::string_t _url;
+    static int hex_value(char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        return -1;
+    }
+
+    void to_lower(details::uri_components::span s)
+    {
+        for (std::uint32_t i = s.offset; i != s.offset + s.size; ++i)
+        {
+            if (_uri[i] >= _RESTPPSTR('A') && _uri[i] <= _RESTPPSTR('Z'))
+                _uri[i] = static_cast<utility::char_t>(_uri[i] + (_RESTPPSTR('a') - _RESTPPSTR('A')));
+        }
+    }
+
+    string_view_t view(details::uri_components::span s) const { return string_view_t(_uri.data() + s.offset, s.size); }
+
     utility::string_t _uri;
     details::uri_components _components;
 };
 
+/// <summary>
+/// The segments of an encoded path, as views into it: "/users/42/orders" is made of "users", "42"
+/// and "orders". Empty segments are kept, so "/" has a single empty segment and "/a/" has two.
+/// Nothing is decoded or copied.
+/// </summary>
+class path_segments
+{
+public:
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::string_view;
+
+        const_iterator() = default;
+
+        std::string_view operator*() const { return _path.substr(_begin, _end - _begin); }
+
+        const_iterator& operator++()
+        {
+            if (_end == _path.size())
+            {
+                _begin = _end = std::string_view::npos;
+            }
+            else
+            {
+                _begin = _end + 1;
+                _end = std::min(_path.find('/', _begin), _path.size());
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int)
+        {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+
+        /// <summary>
+        /// The rest of the path, from the start of the current segment.
+        /// </summary>
+        std::string_view rest() const { return _path.substr(_begin); }
+
+        bool operator==(const const_iterator& other) const { return _begin == other._begin; }
+
+        bool operator!=(const const_iterator& other) const { return _begin != other._begin; }
+
+    private:
+        friend class path_segments;
+
+        const_iterator(std::string_view path, std::size_t begin)
+            : _path(path), _begin(begin), _end(std::min(path.find('/', begin), path.size()))
+        {
+        }
+
+        std::string_view _path;
+        std::size_t _begin = std::string_view::npos;
+        std::size_t _end = std::string_view::npos;
+    };
+
+    explicit path_segments(std::string_view path) : _path(path) {}
+
+    const_iterator begin() const
+    {
+        if (_path.empty())
+            return end();
+        return const_iterator(_path, _path.front() == '/' ? 1 : 0);
+    }
+
+    const_iterator end() const { return const_iterator(); }
+
+private:
+    std::string_view _path;
+};
+
 } // namespace restpp
 
 #endif // RESTPP_URI_H
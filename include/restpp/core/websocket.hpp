@@ -0,0 +1,333 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * WebSocket client, opened through the connections and TLS context of a client.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_WEBSOCKET_HPP
+#define RESTPP_WEBSOCKET_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <boost/asio.hpp>
+
+#include <restpp/core/client.hpp>
+#include <restpp/core/error.hpp>
+#include <restpp/core/fetch.hpp>
+#include <restpp/core/uri.hpp>
+#include <restpp/core/websocket_options.hpp>
+#include <restpp/core/details/websocket_session.hpp>
+
+namespace restpp
+{
+namespace details
+{
+/// <summary>
+/// Wraps a handler into one the session calls on its strand, which posts the completion to the
+/// associated executor of the handler.
+/// </summary>
+template<typename Handler>
+websocket_session::handler post_completion(Handler handler, boost::asio::io_context& io_context)
+{
+    auto executor = boost::asio::get_associated_executor(handler, io_context.get_executor());
+    auto work = boost::asio::make_work_guard(executor);
+    auto holder = std::make_shared<Handler>(std::move(handler));
+    return [holder, work](const boost::system::error_code& ec) {
+        boost::asio::post(work.get_executor(), [holder, work, ec]() mutable { (*holder)(ec); });
+    };
+}
+
+/// <summary>
+/// The http or https URI the opening handshake of a ws or wss one is sent to; empty for any
+/// other scheme.
+/// </summary>
+inline std::optional<uri> handshake_target(const uri& _path)
+{
+    const auto scheme = _path.scheme();
+    const auto& text = _path.to_string();
+    if (scheme == "ws")
+        return uri("http" + text.substr(2));
+    if (scheme == "wss")
+        return uri("https" + text.substr(3));
+    return std::nullopt;
+}
+
+using websocket_completion = std::function<void(boost::system::error_code, std::shared_ptr<websocket_session>)>;
+
+/// <summary>
+/// Sends the opening handshake as a fetch through the client, so that it resolves, connects and
+/// negotiates TLS as any other request does, from a pooled connection when there is one. A 101
+/// answer hands the connection over to the session instead of the pool; anything else fails
+/// with <c>websocket_handshake_failed</c>, the connection going back to the pool as usual.
+/// </summary>
+inline void start_websocket(client& _client, const uri& _path, const websocket_options& _options, websocket_completion done)
+{
+    auto& shard = _client.next_shard();
+    auto target = handshake_target(_path);
+    if (!target)
+    {
+        boost::asio::post(shard.io_context, [done = std::move(done)] { done(error::unsupported_scheme, nullptr); });
+        return;
+    }
+
+    auto session = std::make_shared<websocket_session>(shard.io_context, &shard.decoders, _options);
+    std::string key = session->make_key();
+
+    options request;
+    for (const auto& [name, value] : _options.headers)
+        request.headers.set(name, value);
+    request.headers.set(field::upgrade, "websocket");
+    request.headers.set(field::connection, "Upgrade");
+    request.headers.set("Sec-WebSocket-Key", key);
+    request.headers.set("Sec-WebSocket-Version", "13");
+    if (!_options.protocols.empty())
+    {
+        std::string protocols;
+        for (const auto& protocol : _options.protocols)
+            protocols.append(protocols.empty() ? "" : ", ").append(protocol);
+        request.headers.set("Sec-WebSocket-Protocol", protocols);
+    }
+    if (session->offers_deflate())
+        request.headers.set("Sec-WebSocket-Extensions", ws::deflate_offer(_options.context_takeover));
+    request.timeouts = _options.timeouts;
+    request.deadline = _options.deadline;
+    request.signal = _options.signal;
+
+    // A handshake is never answered from the cache
+    auto services = client_services(_client, shard, *target);
+    services.cache = nullptr;
+
+    auto state = make_fetch_state(shard.io_context, services, std::move(*target), std::move(request));
+    state->upgrade = &session->upgraded();
+    async_fetch(shard.io_context,
+                std::move(state),
+                [session, key = std::move(key), done = std::move(done)](boost::system::error_code ec, response res) {
+                    if (!ec)
+                        ec = session->accept(res, key);
+                    done(ec, ec ? nullptr : session);
+                });
+}
+} // namespace details
+
+/// <summary>
+/// A WebSocket opened through a client. Messages are read one at a time, at the pace of the
+/// application, and may be written from any thread while a read is pending; writes go out in
+/// the order they were made. Copies of a websocket share the same connection, which is closed
+/// once the last of them goes away.
+///
+/// The blocking members, like <c>fetch</c>, require the I/O context of a client running on a
+/// caller supplied one to be run by another thread meanwhile.
+/// </summary>
+class websocket
+{
+public:
+    websocket() = default;
+
+    websocket(client& _client, std::shared_ptr<details::websocket_session> session)
+        : _client(&_client), _session(std::move(session))
+    {
+    }
+
+    explicit operator bool() const { return _session != nullptr; }
+
+    /// <summary>
+    /// Whether messages may still be sent: the handshake succeeded and no close frame went
+    /// either way since.
+    /// </summary>
+    bool is_open() const { return _session && _session->is_open(); }
+
+    /// <summary>
+    /// The subprotocol the server picked among those offered, or an empty string.
+    /// </summary>
+    const std::string& protocol() const { return _session->protocol(); }
+
+    /// <summary>
+    /// Whether the server accepted permessage-deflate.
+    /// </summary>
+    bool compressed() const { return _session->compressed(); }
+
+    /// <summary>
+    /// The status code and reason of the close frame the server sent, once it sent one.
+    /// </summary>
+    std::uint16_t close_code() const { return _session->close_code(); }
+
+    const std::string& close_reason() const { return _session->close_reason(); }
+
+    /// <summary>
+    /// Reads the next message, answering the pings that come before it. Completes with the
+    /// signature <c>void(boost::system::error_code)</c>, and with <c>websocket_closed</c> once
+    /// the server closed the connection. Only one read may be pending at a time.
+    /// </summary>
+    template<typename CompletionToken>
+    auto async_read(websocket_message& message, CompletionToken&& token)
+    {
+        return boost::asio::async_initiate<CompletionToken, void(boost::system::error_code)>(
+            [session = _session, &message](auto handler) {
+                session->async_read(message, details::post_completion(std::move(handler), session->io_context()));
+            },
+            token);
+    }
+
+    /// <summary>
+    /// Sends a message, as text unless told otherwise. The data is borrowed, not copied, and
+    /// must stay valid until the write completed.
+    /// </summary>
+    template<typename CompletionToken>
+    auto async_write(std::string_view data, websocket_message_type type, CompletionToken&& token)
+    {
+        return boost::asio::async_initiate<CompletionToken, void(boost::system::error_code)>(
+            [session = _session, data, type](auto handler) {
+                session->async_write(data,
+                                     type == websocket_message_type::text ? details::ws::text : details::ws::binary,
+                                     details::post_completion(std::move(handler), session->io_context()));
+            },
+            token);
+    }
+
+    template<typename CompletionToken>
+    auto async_write(std::string_view data, CompletionToken&& token)
+    {
+        return async_write(data, websocket_message_type::text, std::forward<CompletionToken>(token));
+    }
+
+    /// <summary>
+    /// Sends a ping, ahead of the messages waiting to be sent. Its payload is cut to 125 bytes.
+    /// </summary>
+    template<typename CompletionToken>
+    auto async_ping(std::string payload, CompletionToken&& token)
+    {
+        return boost::asio::async_initiate<CompletionToken, void(boost::system::error_code)>(
+            [session = _session](auto handler, std::string payload) {
+                session->async_ping(std::move(payload), details::post_completion(std::move(handler), session->io_context()));
+            },
+            token,
+            std::move(payload));
+    }
+
+    /// <summary>
+    /// Closes the connection once the messages already written went out, completing when the
+    /// server answered the close frame or the close timeout passed.
+    /// </summary>
+    template<typename CompletionToken>
+    auto async_close(std::uint16_t code, std::string reason, CompletionToken&& token)
+    {
+        return boost::asio::async_initiate<CompletionToken, void(boost::system::error_code)>(
+            [session = _session, code](auto handler, std::string reason) {
+                session->async_close(
+                    code, std::move(reason), details::post_completion(std::move(handler), session->io_context()));
+            },
+            token,
+            std::move(reason));
+    }
+
+    /// <summary>
+    /// Drops the connection without a close frame; pending operations fail with
+    /// <c>operation_aborted</c>.
+    /// </summary>
+    void cancel()
+    {
+        if (_session)
+            _session->cancel();
+    }
+
+    boost::system::error_code read(websocket_message& message)
+    {
+        return blocking([&](auto done) { async_read(message, std::move(done)); });
+    }
+
+    boost::system::error_code write(std::string_view data, websocket_message_type type = websocket_message_type::text)
+    {
+        return blocking([&](auto done) { async_write(data, type, std::move(done)); });
+    }
+
+    boost::system::error_code close(std::uint16_t code = details::ws::normal_closure, std::string reason = {})
+    {
+        return blocking([&](auto done) { async_close(code, std::move(reason), std::move(done)); });
+    }
+
+private:
+    template<typename Start>
+    boost::system::error_code blocking(Start start)
+    {
+        boost::system::error_code error;
+        details::run_blocking(*_client, [&](auto done) {
+            start([&error, done](const boost::system::error_code& ec) {
+                error = ec;
+                done();
+            });
+        });
+        return error;
+    }
+
+    client* _client = nullptr;
+    std::shared_ptr<details::websocket_session> _session;
+};
+
+/// <summary>
+/// Opens a WebSocket to a ws or wss URI through the given client, over one of its pooled
+/// connections when there is one. Completes with the signature
+/// <c>void(boost::system::error_code, restpp::websocket)</c>; the server not switching
+/// protocols fails it with <c>websocket_handshake_failed</c>.
+/// </summary>
+template<typename CompletionToken>
+auto async_connect_websocket(client& _client, uri _path, websocket_options _options, CompletionToken&& token)
+{
+    return boost::asio::async_initiate<CompletionToken, void(boost::system::error_code, websocket)>(
+        [&_client](auto handler, uri _path, websocket_options _options) {
+            auto& io_context = _client.io_context();
+            auto executor = boost::asio::get_associated_executor(handler, io_context.get_executor());
+            auto work = boost::asio::make_work_guard(executor);
+            auto holder = std::make_shared<decltype(handler)>(std::move(handler));
+            details::start_websocket(
+                _client,
+                _path,
+                _options,
+                [&_client, holder, work](boost::system::error_code ec, std::shared_ptr<details::websocket_session> session) {
+                    boost::asio::post(work.get_executor(), [&_client, holder, work, ec, session = std::move(session)]() mutable {
+                        (*holder)(ec, session ? websocket(_client, std::move(session)) : websocket());
+                    });
+                });
+        },
+        token,
+        std::move(_path),
+        std::move(_options));
+}
+
+/// <summary>
+/// Opens a WebSocket to a ws or wss URI through the given client, blocking until the handshake
+/// completed.
+/// </summary>
+inline boost::system::error_code connect_websocket(client& _client,
+                                                   const uri& _path,
+                                                   const websocket_options& _options,
+                                                   websocket& result)
+{
+    boost::system::error_code error;
+    details::run_blocking(_client, [&](auto done) {
+        details::start_websocket(
+            _client, _path, _options, [&, done](boost::system::error_code ec, std::shared_ptr<details::websocket_session> session) {
+                error = ec;
+                result = session ? websocket(_client, std::move(session)) : websocket();
+                done();
+            });
+    });
+    return error;
+}
+
+} // namespace restpp
+
+#endif // RESTPP_WEBSOCKET_HPP
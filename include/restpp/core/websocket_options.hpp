@@ -0,0 +1,114 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Settings of a WebSocket connection, and the messages read from one.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_WEBSOCKET_OPTIONS_HPP
+#define RESTPP_WEBSOCKET_OPTIONS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <restpp/core/abort_signal.hpp>
+#include <restpp/core/headers.hpp>
+#include <restpp/core/options.hpp>
+
+namespace restpp
+{
+
+struct websocket_options
+{
+    /// <summary>
+    /// Headers sent with the opening handshake on top of those it needs, such as Origin,
+    /// Authorization or Cookie.
+    /// </summary>
+    restpp::headers headers;
+
+    /// <summary>
+    /// Subprotocols offered to the server, in order of preference. The one it picked, if any,
+    /// is <c>websocket::protocol()</c>.
+    /// </summary>
+    std::vector<std::string> protocols;
+
+    /// <summary>
+    /// Limits on, and a way to abort, the opening handshake, which goes through the resolve,
+    /// connect, TLS and first byte phases of an HTTP request.
+    /// </summary>
+    restpp::timeouts timeouts;
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    abort_signal signal;
+
+    /// <summary>
+    /// Offer permessage-deflate, so that messages are compressed both ways when the server
+    /// accepts it. Builds defining RESTPP_EXCLUDE_COMPRESSION never offer it.
+    /// </summary>
+    bool compression = true;
+
+    /// <summary>
+    /// Let each end keep its compression window from one message to the next, which makes
+    /// streams of small, similar messages compress far better, for about 300 KiB per
+    /// connection. When false, every message is compressed on its own.
+    /// </summary>
+    bool context_takeover = true;
+
+    /// <summary>
+    /// The zlib level, from 1 to 9, messages are compressed with.
+    /// </summary>
+    int compression_level = 6;
+
+    /// <summary>
+    /// Messages shorter than this are sent uncompressed, deflate costing more than it saves
+    /// on them.
+    /// </summary>
+    std::size_t compress_threshold = 64;
+
+    /// <summary>
+    /// The largest message accepted, after decompression. A larger one fails the connection
+    /// with <c>message_too_large</c>.
+    /// </summary>
+    std::size_t max_message_size = 16 * 1024 * 1024;
+
+    /// <summary>
+    /// How long a close waits for the server to answer with its own close frame before the
+    /// connection is dropped.
+    /// </summary>
+    std::chrono::steady_clock::duration close_timeout = std::chrono::seconds(5);
+};
+
+enum class websocket_message_type
+{
+    text,
+    binary
+};
+
+/// <summary>
+/// A message read from a WebSocket. A message that came in a single uncompressed frame is a
+/// view into the receive buffer of the connection, without being copied; fragmented and
+/// compressed ones are assembled in <c>storage</c>, which keeps its capacity from one read to
+/// the next. Either way <c>data</c> is valid until the next read.
+/// </summary>
+struct websocket_message
+{
+    websocket_message_type type = websocket_message_type::text;
+    std::string_view data;
+    std::string storage;
+
+    bool is_text() const { return type == websocket_message_type::text; }
+};
+
+} // namespace restpp
+
+#endif // RESTPP_WEBSOCKET_OPTIONS_HPP
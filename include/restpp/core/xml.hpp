@@ -0,0 +1,799 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Streaming pull reader for XML documents, such as response bodies, as they arrive.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#pragma once
+#ifndef RESTPP_XML_HPP
+#define RESTPP_XML_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <restpp/core/body_sink.hpp>
+#include <restpp/core/details/utf8.hpp>
+
+namespace restpp
+{
+
+/// <summary>
+/// Errors in XML text.
+/// </summary>
+class xml_exception : public std::exception
+{
+public:
+    xml_exception(std::string msg) : _msg{std::move(msg)} {}
+
+    ~xml_exception() noexcept {}
+
+    const char* what() const noexcept override { return _msg.c_str(); }
+
+private:
+    std::string _msg;
+};
+
+namespace details
+{
+inline bool is_xml_space(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+inline bool is_xml_blank(std::string_view text)
+{
+    for (const char c : text)
+    {
+        if (!is_xml_space(c))
+            return false;
+    }
+    return true;
+}
+
+inline bool is_xml_name_start(char c)
+{
+    const auto u = static_cast<unsigned char>(c);
+    return (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') || u == '_' || u == ':' || u >= 0x80;
+}
+
+inline bool is_xml_name_char(char c) { return is_xml_name_start(c) || (c >= '0' && c <= '9') || c == '-' || c == '.'; }
+
+inline std::size_t skip_xml_name(std::string_view text, std::size_t at)
+{
+    while (at < text.size() && is_xml_name_char(text[at]))
+        ++at;
+    return at;
+}
+
+inline std::size_t skip_xml_space(std::string_view text, std::size_t at)
+{
+    while (at < text.size() && is_xml_space(text[at]))
+        ++at;
+    return at;
+}
+
+inline std::string_view trim_xml_space(std::string_view text)
+{
+    const std::size_t begin = skip_xml_space(text, 0);
+    std::size_t end = text.size();
+    while (end > begin && is_xml_space(text[end - 1]))
+        --end;
+    return text.substr(begin, end - begin);
+}
+} // namespace details
+
+/// <summary>
+/// Appends text with its character and entity references (<c>&amp;lt;</c>, <c>&amp;#233;</c>,
+/// ...) replaced to <c>out</c>.
+/// </summary>
+/// <returns>False when a reference is malformed or names an entity other than the five
+/// predefined ones.</returns>
+inline bool xml_unescape(std::string_view raw, std::string& out)
+{
+    std::size_t done = 0;
+    std::size_t amp = raw.find('&');
+    while (amp != std::string_view::npos)
+    {
+        out.append(raw.data() + done, amp - done);
+        const std::size_t semicolon = raw.find(';', amp + 1);
+        if (semicolon == std::string_view::npos)
+            return false;
+
+        const std::string_view name = raw.substr(amp + 1, semicolon - amp - 1);
+        if (name == "lt")
+            out.push_back('<');
+        else if (name == "gt")
+            out.push_back('>');
+        else if (name == "amp")
+            out.push_back('&');
+        else if (name == "quot")
+            out.push_back('"');
+        else if (name == "apos")
+            out.push_back('\'');
+        else if (name.size() > 1 && name[0] == '#')
+        {
+            const bool hex = name[1] == 'x';
+            std::uint32_t code_point = 0;
+            std::size_t i = hex ? 2 : 1;
+            if (i == name.size())
+                return false;
+            for (; i < name.size(); ++i)
+            {
+                const char c = name[i];
+                std::uint32_t digit;
+                if (c >= '0' && c <= '9')
+                    digit = static_cast<std::uint32_t>(c - '0');
+                else if (hex && c >= 'a' && c <= 'f')
+                    digit = static_cast<std::uint32_t>(c - 'a' + 10);
+                else if (hex && c >= 'A' && c <= 'F')
+                    digit = static_cast<std::uint32_t>(c - 'A' + 10);
+                else
+                    return false;
+                code_point = code_point * (hex ? 16 : 10) + digit;
+                if (code_point > 0x10FFFF)
+                    return false;
+            }
+            if (code_point == 0 || (code_point >= 0xD800 && code_point < 0xE000))
+                return false;
+            details::append_utf8(out, code_point);
+        }
+        else
+            return false;
+
+        done = semicolon + 1;
+        amp = raw.find('&', done);
+    }
+    out.append(raw.data() + done, raw.size() - done);
+    return true;
+}
+
+/// <summary>
+/// An attribute of an element, with its value as it appears in the text.
+/// </summary>
+struct xml_attribute
+{
+    std::string_view name;
+    std::string_view raw_value;
+
+    /// <summary>
+    /// The value with its references replaced. Throws <c>xml_exception</c> when one is malformed.
+    /// </summary>
+    std::string value() const
+    {
+        std::string out;
+        out.reserve(raw_value.size());
+        if (!xml_unescape(raw_value, out))
+            throw xml_exception("invalid XML: malformed reference in attribute value");
+        return out;
+    }
+};
+
+/// <summary>
+/// Walks the attributes of a start tag. They were checked when the tag was read.
+/// </summary>
+class xml_attribute_iterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = xml_attribute;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const xml_attribute*;
+    using reference = const xml_attribute&;
+
+    xml_attribute_iterator() = default;
+
+    explicit xml_attribute_iterator(std::string_view text) : _rest(text) { advance(); }
+
+    const xml_attribute& operator*() const { return _current; }
+    const xml_attribute* operator->() const { return &_current; }
+
+    xml_attribute_iterator& operator++()
+    {
+        advance();
+        return *this;
+    }
+
+    xml_attribute_iterator operator++(int)
+    {
+        auto previous = *this;
+        advance();
+        return previous;
+    }
+
+    bool operator==(const xml_attribute_iterator& other) const { return _rest.data() == other._rest.data(); }
+    bool operator!=(const xml_attribute_iterator& other) const { return !(*this == other); }
+
+private:
+    void advance()
+    {
+        std::size_t at = details::skip_xml_space(_rest, 0);
+        if (at >= _rest.size())
+        {
+            _rest = {};
+            return;
+        }
+        const std::size_t name_end = details::skip_xml_name(_rest, at);
+        _current.name = _rest.substr(at, name_end - at);
+        at = details::skip_xml_space(_rest, details::skip_xml_space(_rest, name_end) + 1);
+        const char quote = _rest[at];
+        const std::size_t close = _rest.find(quote, at + 1);
+        _current.raw_value = _rest.substr(at + 1, close - at - 1);
+        _rest.remove_prefix(close + 1);
+    }
+
+    std::string_view _rest;
+    xml_attribute _current;
+};
+
+enum class xml_event_type
+{
+    start_element,
+    end_element,
+    text,
+    cdata,
+    comment,
+    processing_instruction,
+    doctype
+};
+
+/// <summary>
+/// What the reader found next. The views point into the input, or into the reader when the
+/// markup was split across two pieces of it, and are valid until the next call to the reader.
+/// </summary>
+struct xml_event
+{
+    xml_event_type type = xml_event_type::text;
+
+    /// <summary>
+    /// The name of the element, or the target of a processing instruction.
+    /// </summary>
+    std::string_view name;
+
+    /// <summary>
+    /// The contents of text, CDATA sections, comments, processing instructions and doctype
+    /// declarations, as they appear in the input. Long runs of text may come in several
+    /// consecutive text events.
+    /// </summary>
+    std::string_view text;
+
+    /// <summary>
+    /// The attributes of a start tag, as they appear in the input.
+    /// </summary>
+    std::string_view raw_attributes;
+
+    std::pair<xml_attribute_iterator, xml_attribute_iterator> attributes() const
+    {
+        return {xml_attribute_iterator(raw_attributes), xml_attribute_iterator()};
+    }
+
+    /// <summary>
+    /// The raw value of the attribute with the given name, if the start tag has one.
+    /// </summary>
+    std::optional<std::string_view> attribute(std::string_view attribute_name) const
+    {
+        for (auto it = xml_attribute_iterator(raw_attributes); it != xml_attribute_iterator(); ++it)
+        {
+            if (it->name == attribute_name)
+                return it->raw_value;
+        }
+        return std::nullopt;
+    }
+
+    /// <summary>
+    /// The text with its references replaced; CDATA sections are returned as they are. Throws
+    /// <c>xml_exception</c> when a reference is malformed.
+    /// </summary>
+    std::string decoded_text() const
+    {
+        if (type != xml_event_type::text)
+            return std::string(text);
+        std::string out;
+        out.reserve(text.size());
+        if (!xml_unescape(text, out))
+            throw xml_exception("invalid XML: malformed reference in text");
+        return out;
+    }
+};
+
+inline xml_attribute_iterator begin(const std::pair<xml_attribute_iterator, xml_attribute_iterator>& range) { return range.first; }
+inline xml_attribute_iterator end(const std::pair<xml_attribute_iterator, xml_attribute_iterator>& range) { return range.second; }
+
+/// <summary>
+/// Reads an XML document one event at a time, as it is fed piece by piece. The reader keeps no
+/// tree: events view the input where it lies, and only markup split across two pieces, such as
+/// a start tag cut in the middle, is copied, so its memory stays flat whatever the size of the
+/// document. <c>next()</c> throws <c>xml_exception</c> when the document is not well-formed.
+///
+/// Whitespace-only text between tags is skipped unless <c>preserve_whitespace</c> is set.
+/// Entity references are left as they are in the views; <c>xml_event::decoded_text()</c> and
+/// <c>xml_attribute::value()</c> replace them. Doctype declarations are reported but not
+/// processed.
+///
+/// The reader can also be set as the sink of a request, with <c>sink()</c>, and then hands each
+/// event to a handler as the body streams in.
+/// </summary>
+class xml_reader
+{
+public:
+    using event_handler = std::function<bool(const xml_event& event)>;
+
+    /// <summary>
+    /// A reader to be fed with <c>feed()</c> and <c>finish()</c>.
+    /// </summary>
+    xml_reader() = default;
+
+    /// <summary>
+    /// A reader over a whole document, which must outlive it.
+    /// </summary>
+    explicit xml_reader(std::string_view document)
+    {
+        feed(document);
+        finish();
+    }
+
+    xml_reader(const xml_reader&) = delete;
+    xml_reader& operator=(const xml_reader&) = delete;
+
+    bool preserve_whitespace = false;
+
+    /// <summary>
+    /// Adds the next piece of the document, which must stay valid until <c>next()</c> returns
+    /// false.
+    /// </summary>
+    void feed(std::string_view data)
+    {
+        if (!_input.empty())
+            _carry.append(_input.data(), _input.size());
+        _input = data;
+    }
+
+    /// <summary>
+    /// Tells the reader the document is complete. With a handler set through <c>sink()</c>, the
+    /// events still pending are handed to it, and the error that aborted the transfer, if any,
+    /// is thrown as <c>xml_exception</c>.
+    /// </summary>
+    void finish()
+    {
+        if (!_error.empty())
+            throw xml_exception(_error);
+        _final = true;
+        if (_handler)
+        {
+            while (next())
+            {
+                if (!_handler(_event))
+                    break;
+            }
+        }
+    }
+
+    /// <summary>
+    /// Moves to the next event.
+    /// </summary>
+    /// <returns>False when the reader needs more input, or once the document is over.</returns>
+    bool next()
+    {
+        if (_done)
+            return false;
+        if (_pending_end)
+        {
+            _pending_end = false;
+            _event.type = xml_event_type::end_element;
+            _event.raw_attributes = {};
+            if (_open.empty())
+                _root_closed = true;
+            return true;
+        }
+        if (_carry_used != 0)
+        {
+            _carry.erase(0, _carry_used);
+            _carry_used = 0;
+        }
+
+        for (;;)
+        {
+            if (!_carry.empty())
+            {
+                const std::size_t used = scan(_carry, _final && _input.empty());
+                if (used != 0)
+                {
+                    _offset += used;
+                    if (_emitted)
+                    {
+                        _carry_used = used;
+                        return true;
+                    }
+                    _carry.erase(0, used);
+                    continue;
+                }
+                if (_input.empty())
+                    return false;
+                extend_carry();
+                continue;
+            }
+
+            if (_input.empty())
+            {
+                if (_final)
+                    end_of_document();
+                return false;
+            }
+
+            const std::size_t used = scan(_input, _final);
+            if (used == 0)
+            {
+                _carry.assign(_input.data(), _input.size());
+                _input = {};
+                return false;
+            }
+            _input.remove_prefix(used);
+            _offset += used;
+            if (_emitted)
+                return true;
+        }
+    }
+
+    const xml_event& event() const { return _event; }
+
+    /// <summary>
+    /// The number of elements open around the current event.
+    /// </summary>
+    std::size_t depth() const { return _open.size(); }
+
+    /// <summary>
+    /// Whether the whole document was read.
+    /// </summary>
+    bool done() const { return _done; }
+
+    /// <summary>
+    /// A sink feeding the body of a response to this reader, which must outlive the request.
+    /// Each event is handed to <c>handler</c> as soon as it is complete; returning false, or a
+    /// malformed document, aborts the transfer. Call <c>finish()</c> once the request completed
+    /// to get the last events and the error, if any.
+    /// </summary>
+    body_sink sink(event_handler handler)
+    {
+        _handler = std::move(handler);
+        return body_sink([this](std::string_view data) {
+            if (!_error.empty())
+                return false;
+            try
+            {
+                feed(data);
+                while (next())
+                {
+                    if (!_handler(_event))
+                        return false;
+                }
+                return true;
+            }
+            catch (const xml_exception& e)
+            {
+                _error = e.what();
+                return false;
+            }
+        });
+    }
+
+private:
+    [[noreturn]] void fail(const char* what) const
+    {
+        throw xml_exception("invalid XML at byte " + std::to_string(_offset) + ": " + what);
+    }
+
+    /// <summary>
+    /// Reads the token at the start of <c>text</c>, unless it is incomplete and more of the
+    /// document is to come.
+    /// </summary>
+    /// <returns>The length of the token, or 0 when more input is needed. <c>_emitted</c> tells
+    /// whether the token produced an event.</returns>
+    std::size_t scan(std::string_view text, bool final)
+    {
+        _emitted = false;
+        const std::size_t used = text[0] == '<' ? scan_markup(text) : scan_text(text, final);
+        if (used == 0 && final)
+            fail("unterminated markup");
+        return used;
+    }
+
+    std::size_t scan_text(std::string_view text, bool final)
+    {
+        // A byte order mark may precede the document
+        if (_offset == 0 && !_root_seen)
+        {
+            const int bom = starts_with(text, "\xEF\xBB\xBF");
+            if (bom > 0)
+                return 3;
+            if (bom < 0 && !final)
+                return 0;
+        }
+
+        const std::size_t lt = text.find('<');
+        const bool complete = lt != std::string_view::npos || final;
+        std::size_t end = lt == std::string_view::npos ? text.size() : lt;
+
+        // A reference cut in the middle is left for the next piece
+        if (!complete)
+        {
+            const std::size_t amp = text.rfind('&');
+            if (amp != std::string_view::npos && text.find(';', amp) == std::string_view::npos)
+                end = amp;
+            if (end == 0)
+                return 0;
+        }
+
+        const std::string_view run = text.substr(0, end);
+        const bool blank = details::is_xml_blank(run);
+        if (_open.empty() && !blank)
+            fail("text outside the root element");
+
+        // Whitespace to be skipped is held back until it is known to have nothing after it
+        const bool skip = blank && !_in_text && (_open.empty() || !preserve_whitespace);
+        if (skip && !complete)
+            return 0;
+
+        _in_text = !complete && !skip;
+        if (!skip)
+            emit(xml_event_type::text, {}, run);
+        return end;
+    }
+
+    std::size_t scan_markup(std::string_view text)
+    {
+        _in_text = false;
+        if (text.size() < 2)
+            return 0;
+
+        switch (text[1])
+        {
+            case '/': return scan_end_tag(text);
+            case '?':
+            {
+                const std::size_t close = text.find("?>", 2);
+                if (close == std::string_view::npos)
+                    return 0;
+                const std::size_t target_end = details::skip_xml_name(text, 2);
+                if (target_end == 2 || !details::is_xml_name_start(text[2]))
+                    fail("malformed processing instruction");
+                emit(xml_event_type::processing_instruction, text.substr(2, target_end - 2),
+                     details::trim_xml_space(text.substr(target_end, close - std::min(close, target_end))));
+                return close + 2;
+            }
+            case '!': return scan_declaration(text);
+            default: return scan_start_tag(text);
+        }
+    }
+
+    /// <summary>
+    /// Whether <c>text</c> starts with <c>prefix</c>: 1 when it does, 0 when it does not, -1 when
+    /// it is too short to tell.
+    /// </summary>
+    static int starts_with(std::string_view text, std::string_view prefix)
+    {
+        const std::size_t n = std::min(text.size(), prefix.size());
+        if (text.substr(0, n) != prefix.substr(0, n))
+            return 0;
+        return n == prefix.size() ? 1 : -1;
+    }
+
+    std::size_t scan_declaration(std::string_view text)
+    {
+        int match = starts_with(text, "<!--");
+        if (match < 0)
+            return 0;
+        if (match > 0)
+        {
+            const std::size_t close = text.find("-->", 4);
+            if (close == std::string_view::npos)
+                return 0;
+            emit(xml_event_type::comment, {}, text.substr(4, close - 4));
+            return close + 3;
+        }
+
+        match = starts_with(text, "<![CDATA[");
+        if (match < 0)
+            return 0;
+        if (match > 0)
+        {
+            const std::size_t close = text.find("]]>", 9);
+            if (close == std::string_view::npos)
+                return 0;
+            if (_open.empty())
+                fail("CDATA section outside the root element");
+            emit(xml_event_type::cdata, {}, text.substr(9, close - 9));
+            return close + 3;
+        }
+
+        match = starts_with(text, "<!DOCTYPE");
+        if (match < 0)
+            return 0;
+        if (match == 0 || _root_seen)
+            fail("malformed markup");
+
+        // The internal subset, between brackets, may hold '>' of its own
+        std::size_t depth = 0;
+        char quote = 0;
+        for (std::size_t i = 9; i < text.size(); ++i)
+        {
+            const char c = text[i];
+            if (quote != 0)
+            {
+                if (c == quote)
+                    quote = 0;
+            }
+            else if (c == '"' || c == '\'')
+                quote = c;
+            else if (c == '[')
+                ++depth;
+            else if (c == ']' && depth > 0)
+                --depth;
+            else if (c == '>' && depth == 0)
+            {
+                emit(xml_event_type::doctype, {}, details::trim_xml_space(text.substr(9, i - 9)));
+                return i + 1;
+            }
+        }
+        return 0;
+    }
+
+    std::size_t scan_start_tag(std::string_view text)
+    {
+        if (!details::is_xml_name_start(text[1]))
+            fail("malformed markup");
+        const std::size_t name_end = details::skip_xml_name(text, 1);
+        std::size_t at = name_end;
+        for (;;)
+        {
+            const std::size_t space = at;
+            at = details::skip_xml_space(text, at);
+            if (at >= text.size())
+                return 0;
+
+            const char c = text[at];
+            if (c == '>' || c == '/')
+            {
+                if (c == '/' && at + 1 >= text.size())
+                    return 0;
+                if (c == '/' && text[at + 1] != '>')
+                    fail("malformed start tag");
+                open_element(text.substr(1, name_end - 1), text.substr(name_end, at - name_end), c == '/');
+                return c == '/' ? at + 2 : at + 1;
+            }
+            if (at == space || !details::is_xml_name_start(c))
+                fail("malformed attribute");
+
+            at = details::skip_xml_space(text, details::skip_xml_name(text, at));
+            if (at >= text.size())
+                return 0;
+            if (text[at] != '=')
+                fail("attribute without a value");
+            at = details::skip_xml_space(text, at + 1);
+            if (at >= text.size())
+                return 0;
+
+            const char quote = text[at];
+            if (quote != '"' && quote != '\'')
+                fail("unquoted attribute value");
+            const std::size_t close = text.find(quote, at + 1);
+            if (close == std::string_view::npos)
+            {
+                if (text.find('<', at + 1) != std::string_view::npos)
+                    fail("'<' in attribute value");
+                return 0;
+            }
+            if (text.substr(at + 1, close - at - 1).find('<') != std::string_view::npos)
+                fail("'<' in attribute value");
+            at = close + 1;
+        }
+    }
+
+    std::size_t scan_end_tag(std::string_view text)
+    {
+        const std::size_t name_end = details::skip_xml_name(text, 2);
+        const std::size_t close = details::skip_xml_space(text, name_end);
+        if (close >= text.size())
+            return 0;
+        if (name_end == 2 || text[close] != '>')
+            fail("malformed end tag");
+
+        const std::string_view name = text.substr(2, name_end - 2);
+        if (_open.empty() || std::string_view(_names).substr(_open.back()) != name)
+            fail("end tag does not match the start tag");
+        _names.resize(_open.back());
+        _open.pop_back();
+        if (_open.empty())
+            _root_closed = true;
+        emit(xml_event_type::end_element, name, {});
+        return close + 1;
+    }
+
+    void open_element(std::string_view name, std::string_view attributes, bool empty)
+    {
+        if (_root_closed)
+            fail("more than one root element");
+        _root_seen = true;
+        if (empty)
+            _pending_end = true;
+        else
+        {
+            _open.push_back(_names.size());
+            _names.append(name.data(), name.size());
+        }
+        emit(xml_event_type::start_element, name, {});
+        _event.raw_attributes = attributes;
+    }
+
+    void emit(xml_event_type type, std::string_view name, std::string_view text)
+    {
+        _emitted = true;
+        _event.type = type;
+        _event.name = name;
+        _event.text = text;
+        _event.raw_attributes = {};
+    }
+
+    /// <summary>
+    /// Moves input to the end of the carried token, up to where it may be complete.
+    /// </summary>
+    void extend_carry()
+    {
+        std::size_t end;
+        if (_carry[0] == '<')
+            end = _input.find('>');
+        else if (details::is_xml_blank(_carry))
+            end = _input.find_first_not_of(" \t\r\n");
+        else
+            end = _input.find_first_of("<;");
+        end = end == std::string_view::npos ? _input.size() : end + 1;
+        _carry.append(_input.data(), end);
+        _input.remove_prefix(end);
+    }
+
+    void end_of_document()
+    {
+        if (!_open.empty())
+            fail("unclosed element");
+        if (!_root_seen)
+            fail("no root element");
+        _done = true;
+    }
+
+    std::string_view _input;
+
+    // The start of the input, when a token was split across two pieces of it
+    std::string _carry;
+    std::size_t _carry_used = 0;
+
+    // The names of the open elements, end to end, with the offset of each
+    std::string _names;
+    std::vector<std::size_t> _open;
+
+    xml_event _event;
+    event_handler _handler;
+    std::string _error;
+    std::size_t _offset = 0;
+    bool _final = false;
+    bool _done = false;
+    bool _emitted = false;
+    bool _pending_end = false;
+    bool _in_text = false;
+    bool _root_seen = false;
+    bool _root_closed = false;
+};
+
+} // namespace restpp
+
+#endif // RESTPP_XML_HPP
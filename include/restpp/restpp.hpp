@@ -15,10 +15,30 @@
 #ifndef RESTPP_HPP
 #define RESTPP_HPP
 
+#include <restpp/core/abort_signal.hpp>
+#include <restpp/core/body_sink.hpp>
+#include <restpp/core/client.hpp>
+#include <restpp/core/error.hpp>
+#include <restpp/core/executor.hpp>
+#include <restpp/core/headers.hpp>
+#include <restpp/core/http_cache.hpp>
+#include <restpp/core/json.hpp>
+#include <restpp/core/json_decode.hpp>
+#include <restpp/core/observer.hpp>
 #include <restpp/core/options.hpp>
+#include <restpp/core/policy.hpp>
+#include <restpp/core/request_body.hpp>
 #include <restpp/core/response.hpp>
 #include <restpp/core/uri.hpp>
 #include <restpp/core/fetch.hpp>
+#include <restpp/core/fetch_all.hpp>
 #include <restpp/core/version.hpp>
+#include <restpp/core/websocket.hpp>
+#include <restpp/core/xml.hpp>
+
+#ifndef RESTPP_EXCLUDE_FRAMEWORK
+#include <restpp/core/router.hpp>
+#include <restpp/core/server.hpp>
+#endif
 
 #endif // RESTPP_HPP
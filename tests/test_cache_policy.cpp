@@ -0,0 +1,190 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests of what the HTTP cache stores, and of how fresh it holds responses to be.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#include <chrono>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <restpp/core/details/cache_policy.hpp>
+
+namespace
+{
+using namespace std::chrono;
+using restpp::field;
+using restpp::headers;
+using restpp::details::cached_response;
+
+const system_clock::time_point now{seconds(1700000000)};
+
+cached_response received(headers fields, int status_code = 200, seconds delay = seconds(0))
+{
+    cached_response r;
+    r.status_code = status_code;
+    r.headers = std::move(fields);
+    r.request_time = now - delay;
+    r.response_time = now;
+    return r;
+}
+
+std::string date(seconds from_now) { return restpp::details::format_http_date(now + from_now); }
+
+TEST(cache_policy, max_age)
+{
+    auto r = received({{"Date", date(seconds(0))}, {"Cache-Control", "public, max-age=60"}});
+    r.derive(false);
+    EXPECT_EQ(r.lifetime, seconds(60));
+    EXPECT_EQ(r.initial_age, seconds(0));
+    EXPECT_EQ(r.current_age(now + seconds(45)), seconds(45));
+    EXPECT_FALSE(r.no_cache);
+    EXPECT_FALSE(r.must_revalidate);
+}
+
+TEST(cache_policy, s_maxage_is_for_shared_caches)
+{
+    auto r = received({{"Cache-Control", "max-age=60, s-maxage=600"}});
+    r.derive(false);
+    EXPECT_EQ(r.lifetime, seconds(60));
+    EXPECT_FALSE(r.must_revalidate);
+    r.derive(true);
+    EXPECT_EQ(r.lifetime, seconds(600));
+    EXPECT_TRUE(r.must_revalidate);
+}
+
+TEST(cache_policy, age)
+{
+    // The larger of the Age the response carries plus the round trip, and of the apparent age
+    auto r = received({{"Date", date(seconds(0))}, {"Age", "30"}, {"Cache-Control", "max-age=60"}}, 200, seconds(2));
+    r.derive(false);
+    EXPECT_EQ(r.initial_age, seconds(32));
+
+    r = received({{"Date", date(seconds(-100))}, {"Age", "30"}, {"Cache-Control", "max-age=60"}});
+    r.derive(false);
+    EXPECT_EQ(r.initial_age, seconds(100));
+
+    // A Date in the future is no negative age
+    r = received({{"Date", date(seconds(100))}, {"Cache-Control", "max-age=60"}});
+    r.derive(false);
+    EXPECT_EQ(r.initial_age, seconds(0));
+}
+
+TEST(cache_policy, expires)
+{
+    auto r = received({{"Date", date(seconds(0))}, {"Expires", date(seconds(300))}});
+    r.derive(false);
+    EXPECT_EQ(r.lifetime, seconds(300));
+
+    // Relative to the Date of the response, not to the clock of the client
+    r = received({{"Date", date(seconds(-1000))}, {"Expires", date(seconds(-700))}});
+    r.derive(false);
+    EXPECT_EQ(r.lifetime, seconds(300));
+
+    r = received({{"Date", date(seconds(0))}, {"Expires", "0"}});
+    r.derive(false);
+    EXPECT_EQ(r.lifetime, seconds(0));
+
+    // max-age wins over Expires
+    r = received({{"Date", date(seconds(0))}, {"Expires", date(seconds(300))}, {"Cache-Control", "max-age=5"}});
+    r.derive(false);
+    EXPECT_EQ(r.lifetime, seconds(5));
+}
+
+TEST(cache_policy, heuristic_lifetime)
+{
+    auto r = received({{"Date", date(seconds(0))}, {"Last-Modified", date(-hours(5))}});
+    r.derive(false);
+    EXPECT_EQ(r.lifetime, minutes(30));
+
+    r = received({{"Date", date(seconds(0))}, {"Last-Modified", date(-hours(24 * 30))}});
+    r.derive(false);
+    EXPECT_EQ(r.lifetime, hours(24));
+
+    r = received({{"Date", date(seconds(0))}, {"Last-Modified", date(-hours(5))}}, 302);
+    r.derive(false);
+    EXPECT_EQ(r.lifetime, seconds(0));
+}
+
+TEST(cache_policy, malformed_directives_are_stale)
+{
+    auto r = received({{"Cache-Control", "max-age=abc, no-cache, must-revalidate"}});
+    r.derive(false);
+    EXPECT_EQ(r.lifetime, seconds(0));
+    EXPECT_TRUE(r.no_cache);
+    EXPECT_TRUE(r.must_revalidate);
+
+    r = received({{"Cache-Control", "max-age=99999999999999999999"}});
+    r.derive(false);
+    EXPECT_EQ(r.lifetime, seconds(2147483648));
+}
+
+TEST(cache_policy, storable)
+{
+    using restpp::details::is_storable;
+    restpp::options get;
+    EXPECT_TRUE(is_storable(get, 200, {}, false));
+    EXPECT_TRUE(is_storable(get, 404, {}, false));
+    EXPECT_FALSE(is_storable(get, 302, {}, false));
+    EXPECT_TRUE(is_storable(get, 302, {{"Cache-Control", "max-age=10"}}, false));
+    EXPECT_FALSE(is_storable(get, 206, {{"Cache-Control", "max-age=10"}}, false));
+    EXPECT_FALSE(is_storable(get, 304, {{"Cache-Control", "max-age=10"}}, false));
+    EXPECT_FALSE(is_storable(get, 200, {{"Cache-Control", "no-store"}}, false));
+    EXPECT_FALSE(is_storable(get, 200, {{"Vary", "Accept, *"}}, false));
+    EXPECT_TRUE(is_storable(get, 200, {{"Vary", "Accept"}}, false));
+
+    EXPECT_TRUE(is_storable(get, 200, {{"Cache-Control", "private"}}, false));
+    EXPECT_FALSE(is_storable(get, 200, {{"Cache-Control", "private"}}, true));
+
+    restpp::options authorized;
+    authorized.headers.set(field::authorization, "Bearer x");
+    EXPECT_TRUE(is_storable(authorized, 200, {}, false));
+    EXPECT_FALSE(is_storable(authorized, 200, {}, true));
+    EXPECT_TRUE(is_storable(authorized, 200, {{"Cache-Control", "public"}}, true));
+
+    restpp::options no_store;
+    no_store.headers.set(field::cache_control, "no-store");
+    EXPECT_FALSE(is_storable(no_store, 200, {}, false));
+
+    restpp::options post;
+    post.method = "POST";
+    EXPECT_FALSE(is_storable(post, 200, {{"Cache-Control", "max-age=10"}}, false));
+
+    restpp::options conditional;
+    conditional.headers.set(field::if_none_match, "\"a\"");
+    EXPECT_FALSE(is_storable(conditional, 200, {{"Cache-Control", "max-age=10"}}, false));
+}
+
+TEST(cache_policy, pragma_no_cache)
+{
+    auto r = received({{"Pragma", "no-cache"}});
+    r.derive(false);
+    EXPECT_TRUE(r.no_cache);
+
+    r = received({{"Pragma", "no-cache"}, {"Cache-Control", "max-age=10"}});
+    r.derive(false);
+    EXPECT_FALSE(r.no_cache);
+}
+
+TEST(cache_policy, merge_not_modified)
+{
+    const headers stored{{"Content-Length", "10"},
+                         {"ETag", "\"a\""},
+                         {"Cache-Control", "max-age=60"},
+                         {"Content-Encoding", "gzip"},
+                         {"X-Old", "1"}};
+    const headers update{{"ETag", "\"b\""}, {"Cache-Control", "max-age=120"}, {"Content-Length", "0"}, {"X-New", "2"}};
+    const headers merged = restpp::details::merge_not_modified(stored, update);
+    EXPECT_EQ(merged.to_string(),
+              "Content-Length: 10\r\nContent-Encoding: gzip\r\nX-Old: 1\r\n"
+              "ETag: \"b\"\r\nCache-Control: max-age=120\r\nX-New: 2\r\n");
+}
+} // namespace
@@ -0,0 +1,165 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests of how fetches check their options before doing any I/O.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <gtest/gtest.h>
+
+#include <restpp/core/client.hpp>
+#include <restpp/core/fetch.hpp>
+
+namespace
+{
+// Answers the requests of each connection after a wait, keeping the connection open, up to a
+// number of them past which it closes the connection on reading the next one; counts the
+// connections it accepted and the requests it read
+class test_server
+{
+public:
+    explicit test_server(std::chrono::milliseconds delay, int answered_per_connection = 0)
+        : _acceptor(_io_context, {boost::asio::ip::make_address("127.0.0.1"), 0})
+        , _delay(delay)
+        , _answered_per_connection(answered_per_connection)
+    {
+        accept();
+        _thread = std::thread([this] { _io_context.run(); });
+    }
+
+    ~test_server()
+    {
+        _io_context.stop();
+        _thread.join();
+        for (auto& t : _connections)
+            t.join();
+    }
+
+    restpp::uri target() const
+    {
+        return restpp::uri("http://127.0.0.1:" + std::to_string(_acceptor.local_endpoint().port()) + "/");
+    }
+
+    std::atomic<int> accepted{0};
+    std::atomic<int> requests{0};
+
+private:
+    void accept()
+    {
+        _acceptor.async_accept([this](boost::system::error_code ec, boost::asio::ip::tcp::socket socket) {
+            if (ec)
+                return;
+            ++accepted;
+            _connections.emplace_back([this, socket = std::move(socket)]() mutable { serve(socket); });
+            accept();
+        });
+    }
+
+    void serve(boost::asio::ip::tcp::socket& socket)
+    {
+        std::string buffer;
+        boost::system::error_code ec;
+        for (int answered = 0;; ++answered)
+        {
+            const auto end = boost::asio::read_until(socket, boost::asio::dynamic_buffer(buffer), "\r\n\r\n", ec);
+            if (ec)
+                return;
+            buffer.erase(0, end);
+            ++requests;
+            if (_answered_per_connection != 0 && answered == _answered_per_connection)
+            {
+                socket.close(ec);
+                return;
+            }
+            std::this_thread::sleep_for(_delay);
+            boost::asio::write(socket, boost::asio::buffer(std::string_view("HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok")), ec);
+            if (ec)
+                return;
+        }
+    }
+
+    boost::asio::io_context _io_context;
+    boost::asio::ip::tcp::acceptor _acceptor;
+    const std::chrono::milliseconds _delay;
+    const int _answered_per_connection;
+    std::thread _thread;
+    std::vector<std::thread> _connections;
+};
+
+TEST(fetch, zero_chunk_size_is_refused)
+{
+    restpp::client client;
+    restpp::options opts;
+    opts.chunk_size = 0;
+
+    // The port is never connected to: the options are refused first
+    restpp::response res;
+    EXPECT_EQ(restpp::fetch(client, restpp::uri("http://127.0.0.1:1/"), opts, res),
+              boost::asio::error::invalid_argument);
+
+    const std::string path = ::testing::TempDir() + "restpp_chunk_size.txt";
+    std::ofstream(path) << "some text";
+    opts.sink = restpp::body_sink([](std::string_view) { return true; });
+    EXPECT_EQ(restpp::fetch(client, restpp::uri("file://" + path), opts, res), boost::asio::error::invalid_argument);
+}
+
+TEST(fetch, max_connections_per_host)
+{
+    test_server server(std::chrono::milliseconds(20));
+    restpp::client_config config;
+    config.max_connections_per_host = 2;
+    restpp::client client(config);
+    const restpp::uri target = server.target();
+
+    // Eight requests at once share the two connections allowed, one request each at a time
+    std::atomic<int> succeeded{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i)
+        threads.emplace_back([&] {
+            restpp::response res;
+            if (!restpp::fetch(client, target, restpp::options(), res) && res.body == "ok")
+                ++succeeded;
+        });
+    for (auto& t : threads)
+        t.join();
+    EXPECT_EQ(succeeded, 8);
+    EXPECT_LE(server.accepted, 2);
+}
+
+TEST(fetch, only_idempotent_requests_are_resent_after_a_stale_connection)
+{
+    // The server closes every connection on reading its second request, without answering it
+    test_server server(std::chrono::milliseconds(0), 1);
+    restpp::client client;
+    const restpp::uri target = server.target();
+    restpp::response res;
+
+    // A GET lost that way goes again over a new connection
+    ASSERT_FALSE(restpp::fetch(client, target, restpp::options(), res));
+    ASSERT_FALSE(restpp::fetch(client, target, restpp::options(), res));
+    EXPECT_EQ(res.body, "ok");
+    EXPECT_EQ(server.accepted, 2);
+    EXPECT_EQ(server.requests, 3);
+
+    // A POST may have been acted upon, and fails
+    restpp::options post;
+    post.method = "POST";
+    EXPECT_TRUE(restpp::fetch(client, target, post, res));
+    EXPECT_EQ(server.accepted, 2);
+    EXPECT_EQ(server.requests, 4);
+}
+} // namespace
@@ -0,0 +1,83 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests of what the retry and concurrency policies of a client keep of each host.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#include <chrono>
+#include <cstddef>
+
+#include <gtest/gtest.h>
+
+#include <restpp/core/details/fetch_policy.hpp>
+
+namespace
+{
+using namespace std::chrono;
+using restpp::details::host_policy;
+
+restpp::concurrency_policy adaptive(std::size_t initial, std::size_t min, std::size_t max)
+{
+    restpp::concurrency_policy policy;
+    policy.adaptive = true;
+    policy.initial_limit = initial;
+    policy.min_limit = min;
+    policy.max_limit = max;
+    return policy;
+}
+
+TEST(fetch_policy, limits_stay_in_range_whatever_the_bounds)
+{
+    // A lower bound past the upper one, or an upper bound of zero, still leaves one slot
+    for (const auto& policy : {adaptive(16, 10, 0), adaptive(16, 0, 0), adaptive(0, 0, 0), adaptive(4, 8, 2)})
+    {
+        host_policy host(policy, 0);
+        const std::size_t high = policy.max_limit == 0 ? 1 : policy.max_limit;
+        EXPECT_GE(host.limit(), 1u);
+        EXPECT_LE(host.limit(), high);
+
+        for (int i = 0; i < 50; ++i)
+        {
+            ASSERT_TRUE(host.try_acquire());
+            host.release(policy, true, i % 3 == 0, milliseconds(1));
+            EXPECT_GE(host.limit(), 1u);
+            EXPECT_LE(host.limit(), high);
+        }
+    }
+}
+
+TEST(fetch_policy, max_in_flight_caps_the_limit)
+{
+    restpp::concurrency_policy fixed;
+    host_policy host(fixed, 2);
+    EXPECT_EQ(host.limit(), 2u);
+    EXPECT_TRUE(host.try_acquire());
+    EXPECT_TRUE(host.try_acquire());
+    EXPECT_FALSE(host.try_acquire());
+
+    // The request waiting gets the slot given back
+    bool granted = false;
+    EXPECT_NE(host.acquire([&] { granted = true; }), 0u);
+    host.release(fixed, true, false, milliseconds(1));
+    EXPECT_TRUE(granted);
+
+    host_policy capped(adaptive(16, 1, 1000), 4);
+    EXPECT_EQ(capped.limit(), 4u);
+}
+
+TEST(fetch_policy, idempotent_methods)
+{
+    using restpp::details::is_idempotent;
+    for (const char* method : {"GET", "HEAD", "OPTIONS", "TRACE", "PUT", "DELETE"})
+        EXPECT_TRUE(is_idempotent(method)) << method;
+    for (const char* method : {"POST", "PATCH", "CONNECT", "get"})
+        EXPECT_FALSE(is_idempotent(method)) << method;
+}
+} // namespace
@@ -0,0 +1,42 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests of the HTTP/2 framing helpers.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <restpp/core/details/h2_session.hpp>
+
+namespace
+{
+namespace h2 = restpp::details::h2;
+
+TEST(h2, status_is_three_digits)
+{
+    EXPECT_EQ(h2::parse_status("200"), 200);
+    EXPECT_EQ(h2::parse_status("103"), 103);
+    EXPECT_EQ(h2::parse_status("999"), 999);
+
+    for (const char* value : {"", "20", "2000", "2x0", "-20", " 200", "20 ", "99999999999999999999"})
+        EXPECT_EQ(h2::parse_status(value), -1) << value;
+}
+
+TEST(h2, frame_header)
+{
+    std::string out;
+    h2::append_frame_header(out, 0x012345, h2::headers_frame, h2::end_headers_flag, 0x80000007);
+    ASSERT_EQ(out.size(), h2::frame_header_size);
+    EXPECT_EQ(out, std::string("\x01\x23\x45\x01\x04\x00\x00\x00\x07", 9));
+    EXPECT_EQ(h2::read_u32(reinterpret_cast<const std::uint8_t*>(out.data()) + 5), 7u);
+}
+} // namespace
@@ -0,0 +1,152 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests of the header collection and of how it keeps its text as fields change.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <restpp/core/headers.hpp>
+#include <restpp/core/options.hpp>
+#include <restpp/core/response.hpp>
+
+namespace
+{
+using restpp::field;
+using restpp::headers;
+
+TEST(headers, lookup_ignores_case)
+{
+    headers h{{"Content-Type", "text/plain"}, {"X-Custom", "1"}};
+    EXPECT_EQ(h.get("content-type"), "text/plain");
+    EXPECT_EQ(h.get(field::content_type), "text/plain");
+    EXPECT_EQ(h.get("x-CUSTOM"), "1");
+    EXPECT_FALSE(h.get("X-Missing"));
+    EXPECT_TRUE(h.contains("X-CUSTOM"));
+}
+
+TEST(headers, add_keeps_and_set_replaces)
+{
+    headers h;
+    h.add("Accept", "a");
+    h.add("X-Custom", "1");
+    h.add("accept", "b");
+    ASSERT_EQ(h.size(), 3u);
+    EXPECT_EQ(h.get(field::accept), "a");
+
+    h.set("ACCEPT", "c");
+    ASSERT_EQ(h.size(), 2u);
+    EXPECT_EQ(h.at(0).first, "X-Custom");
+    EXPECT_EQ(h.at(1).second, "c");
+    EXPECT_EQ(h.get(field::accept), "c");
+}
+
+TEST(headers, erase_keeps_the_order_of_the_rest)
+{
+    headers h{{"A-One", "1"}, {"Host", "x"}, {"A-Two", "2"}, {"host", "y"}, {"A-Three", "3"}};
+    EXPECT_EQ(h.erase(field::host), 2u);
+    EXPECT_EQ(h.erase("a-two"), 1u);
+    EXPECT_EQ(h.erase("A-Missing"), 0u);
+    EXPECT_EQ(h.to_string(), "A-One: 1\r\nA-Three: 3\r\n");
+    EXPECT_FALSE(h.contains(field::host));
+}
+
+TEST(headers, content_length)
+{
+    headers h;
+    EXPECT_FALSE(h.content_length());
+    h.set(field::content_length, "42");
+    EXPECT_EQ(h.content_length(), 42u);
+    h.set(field::content_length, "4x");
+    EXPECT_FALSE(h.content_length());
+    h.set(field::content_length, "99999999999999999999");
+    EXPECT_FALSE(h.content_length());
+}
+
+TEST(headers, repeated_set_keeps_its_text_bounded)
+{
+    headers h;
+    h.set("X-Kept", "kept");
+    for (int i = 0; i < 100000; ++i)
+    {
+        h.set("X-Large", std::string(1000, static_cast<char>('a' + i % 26)));
+        h.set(field::etag, std::to_string(i));
+    }
+    ASSERT_EQ(h.size(), 3u);
+    EXPECT_EQ(h.get("X-Kept"), "kept");
+    EXPECT_EQ(h.get("X-Large"), std::string(1000, static_cast<char>('a' + 99999 % 26)));
+    EXPECT_EQ(h.get(field::etag), "99999");
+
+    // Everything removed was reclaimed along the way: the serialized fields are about as large
+    const std::string text = h.to_string();
+    EXPECT_LT(text.size(), 1100u);
+}
+
+TEST(headers, iteration_follows_insertion_order)
+{
+    headers h{{"B", "2"}, {"A", "1"}, {"C", "3"}};
+    h.erase("A");
+    h.add("A", "4");
+    std::string seen;
+    for (const auto& [name, value] : h)
+        seen.append(name).append(value);
+    EXPECT_EQ(seen, "B2C3A4");
+}
+
+// Counts the bytes allocated through it, from the default resource
+class counting_resource : public std::pmr::memory_resource
+{
+public:
+    std::size_t allocated = 0;
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override
+    {
+        allocated += bytes;
+        return std::pmr::get_default_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+    {
+        std::pmr::get_default_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+TEST(headers, memory_resource)
+{
+    counting_resource resource;
+    headers h(&resource);
+    EXPECT_EQ(h.resource(), &resource);
+    for (int i = 0; i < 40; ++i)
+        h.add("X-Field-" + std::to_string(i), std::string(40, 'v'));
+    EXPECT_GE(resource.allocated, 40u * 50);
+    EXPECT_EQ(h.get("x-field-39"), std::string(40, 'v'));
+
+    // Copies use the default resource, and assignments keep that of the target
+    const headers copy = h;
+    EXPECT_EQ(copy.resource(), std::pmr::get_default_resource());
+    EXPECT_EQ(copy.size(), 40u);
+    headers assigned(&resource);
+    assigned = headers{{"A", "1"}};
+    EXPECT_EQ(assigned.resource(), &resource);
+    EXPECT_EQ(assigned.get("A"), "1");
+
+    EXPECT_EQ(restpp::response(&resource).headers.resource(), &resource);
+    const restpp::options opts(&resource);
+    EXPECT_EQ(opts.headers.resource(), &resource);
+    EXPECT_EQ(opts.headers.get(field::user_agent), restpp::options().headers.get(field::user_agent));
+}
+} // namespace
@@ -0,0 +1,207 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests of the HPACK codec against the examples of RFC 7541, appendix C.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <restpp/core/details/hpack.hpp>
+
+namespace
+{
+namespace hpack = restpp::details::hpack;
+
+using fields = std::vector<std::pair<std::string, std::string>>;
+
+std::vector<std::uint8_t> from_hex(const std::string& hex)
+{
+    std::vector<std::uint8_t> bytes;
+    std::string digits;
+    for (char c : hex)
+    {
+        if (c != ' ')
+            digits.push_back(c);
+    }
+    for (std::size_t i = 0; i + 1 < digits.size(); i += 2)
+        bytes.push_back(static_cast<std::uint8_t>(std::stoi(digits.substr(i, 2), nullptr, 16)));
+    return bytes;
+}
+
+bool decode(hpack::decoder& decoder, const std::vector<std::uint8_t>& block, fields& out)
+{
+    out.clear();
+    return decoder.decode(block.data(), block.size(), [&](std::string_view name, std::string_view value) {
+        out.emplace_back(std::string(name), std::string(value));
+    });
+}
+
+bool decode_integer(const std::vector<std::uint8_t>& bytes, int prefix_bits, std::uint64_t& value)
+{
+    const std::uint8_t* p = bytes.data();
+    return hpack::decode_integer(p, bytes.data() + bytes.size(), prefix_bits, value) &&
+           p == bytes.data() + bytes.size();
+}
+
+const fields first_request = {{":method", "GET"}, {":scheme", "http"}, {":path", "/"}, {":authority", "www.example.com"}};
+const fields second_request = {{":method", "GET"},
+                               {":scheme", "http"},
+                               {":path", "/"},
+                               {":authority", "www.example.com"},
+                               {"cache-control", "no-cache"}};
+const fields third_request = {{":method", "GET"},
+                              {":scheme", "https"},
+                              {":path", "/index.html"},
+                              {":authority", "www.example.com"},
+                              {"custom-key", "custom-value"}};
+
+// C.1.1 to C.1.3
+TEST(hpack, integers)
+{
+    std::uint64_t value = 0;
+    ASSERT_TRUE(decode_integer(from_hex("0a"), 5, value));
+    EXPECT_EQ(value, 10u);
+    ASSERT_TRUE(decode_integer(from_hex("1f9a0a"), 5, value));
+    EXPECT_EQ(value, 1337u);
+    ASSERT_TRUE(decode_integer(from_hex("2a"), 8, value));
+    EXPECT_EQ(value, 42u);
+
+    std::string out;
+    hpack::encode_integer(out, 0x00, 5, 10);
+    hpack::encode_integer(out, 0x00, 5, 1337);
+    hpack::encode_integer(out, 0x00, 8, 42);
+    EXPECT_EQ(out, "\x0a\x1f\x9a\x0a\x2a");
+}
+
+TEST(hpack, integers_beyond_32_bits_are_refused)
+{
+    std::uint64_t value = 0;
+    EXPECT_TRUE(decode_integer(from_hex("1f e0 ff ff ff 0f"), 5, value));
+    EXPECT_EQ(value, 0xFFFFFFFFu);
+    EXPECT_FALSE(decode_integer(from_hex("1f e1 ff ff ff 0f"), 5, value));
+    EXPECT_FALSE(decode_integer(from_hex("ff 80 80 80 80 80 80 80 80 80 80 80 00"), 8, value));
+    EXPECT_FALSE(decode_integer(from_hex("1f 80 80 80 80 80 01"), 5, value));
+
+    // Truncated
+    EXPECT_FALSE(decode_integer(from_hex("1f 9a"), 5, value));
+
+    hpack::decoder decoder;
+    fields out;
+    EXPECT_FALSE(decode(decoder, from_hex("ff 80 80 80 80 80 80 80 80 80 80 80 00"), out));
+}
+
+// C.3
+TEST(hpack, requests_without_huffman_coding)
+{
+    hpack::decoder decoder;
+    fields out;
+    ASSERT_TRUE(decode(decoder, from_hex("8286 8441 0f77 7777 2e65 7861 6d70 6c65 2e63 6f6d"), out));
+    EXPECT_EQ(out, first_request);
+    EXPECT_EQ(decoder.table().size(), 57u);
+
+    ASSERT_TRUE(decode(decoder, from_hex("8286 84be 5808 6e6f 2d63 6163 6865"), out));
+    EXPECT_EQ(out, second_request);
+    EXPECT_EQ(decoder.table().size(), 110u);
+
+    ASSERT_TRUE(decode(decoder,
+                       from_hex("8287 85bf 400a 6375 7374 6f6d 2d6b 6579 0c63 7573 746f 6d2d 7661 6c75 65"),
+                       out));
+    EXPECT_EQ(out, third_request);
+    EXPECT_EQ(decoder.table().size(), 164u);
+}
+
+// C.4
+TEST(hpack, requests_with_huffman_coding)
+{
+    hpack::decoder decoder;
+    fields out;
+    ASSERT_TRUE(decode(decoder, from_hex("8286 8441 8cf1 e3c2 e5f2 3a6b a0ab 90f4 ff"), out));
+    EXPECT_EQ(out, first_request);
+
+    ASSERT_TRUE(decode(decoder, from_hex("8286 84be 5886 a8eb 1064 9cbf"), out));
+    EXPECT_EQ(out, second_request);
+
+    ASSERT_TRUE(decode(decoder, from_hex("8287 85bf 4088 25a8 49e9 5ba9 7d7f 8925 a849 e95b b8e8 b4bf"), out));
+    EXPECT_EQ(out, third_request);
+    EXPECT_EQ(decoder.table().size(), 164u);
+}
+
+// C.5.1 and C.5.2, with a 256-byte table that evicts as responses come
+TEST(hpack, responses_with_eviction)
+{
+    hpack::decoder decoder(256);
+    fields out;
+    ASSERT_TRUE(decode(decoder,
+                       from_hex("4803 3330 3258 0770 7269 7661 7465 611d 4d6f 6e2c 2032 3120 4f63 7420 3230 3133"
+                                "2032 303a 3133 3a32 3120 474d 546e 1768 7474 7073 3a2f 2f77 7777 2e65 7861 6d70"
+                                "6c65 2e63 6f6d"),
+                       out));
+    const fields first = {{":status", "302"},
+                          {"cache-control", "private"},
+                          {"date", "Mon, 21 Oct 2013 20:13:21 GMT"},
+                          {"location", "https://www.example.com"}};
+    EXPECT_EQ(out, first);
+    EXPECT_EQ(decoder.table().size(), 222u);
+
+    ASSERT_TRUE(decode(decoder, from_hex("4803 3330 37c1 c0bf"), out));
+    fields second = first;
+    second[0].second = "307";
+    EXPECT_EQ(out, second);
+    EXPECT_EQ(decoder.table().size(), 222u);
+    EXPECT_EQ(decoder.table().count(), 4u);
+}
+
+TEST(hpack, encoder_round_trip)
+{
+    hpack::encoder encoder;
+    hpack::decoder decoder;
+    for (const fields* request : {&first_request, &second_request, &third_request, &third_request})
+    {
+        std::string block;
+        encoder.begin_block(block);
+        for (const auto& [name, value] : *request)
+            encoder.encode(block, name, value);
+
+        fields out;
+        ASSERT_TRUE(decode(decoder, std::vector<std::uint8_t>(block.begin(), block.end()), out));
+        EXPECT_EQ(out, *request);
+        EXPECT_EQ(decoder.table().size(), encoder.table().size());
+    }
+}
+
+TEST(hpack, table_size_update_only_starts_a_block)
+{
+    hpack::decoder decoder;
+    fields out;
+    ASSERT_TRUE(decode(decoder, from_hex("3fe1 1f 82"), out));
+    EXPECT_EQ(decoder.table().max_size(), 4096u);
+    ASSERT_TRUE(decode(decoder, from_hex("20 3f 61 82"), out));
+    EXPECT_EQ(decoder.table().max_size(), 128u);
+    EXPECT_EQ(out, (fields{{":method", "GET"}}));
+
+    EXPECT_FALSE(decode(decoder, from_hex("82 20"), out));
+
+    // Above the size we advertised
+    EXPECT_FALSE(decode(decoder, from_hex("3fe2 1f"), out));
+}
+
+TEST(hpack, invalid_indexes_are_refused)
+{
+    hpack::decoder decoder;
+    fields out;
+    EXPECT_FALSE(decode(decoder, from_hex("80"), out));
+    EXPECT_FALSE(decode(decoder, from_hex("be"), out));
+}
+} // namespace
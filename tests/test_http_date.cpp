@@ -0,0 +1,132 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests of parsing and formatting HTTP dates and ISO 8601 timestamps.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#include <chrono>
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include <restpp/core/details/http_date.hpp>
+
+namespace
+{
+using namespace std::chrono;
+using restpp::details::date_ticks;
+
+// Sun, 06 Nov 1994 08:49:37 GMT, the example of RFC 9110
+constexpr seconds example{784111777};
+
+std::string write(date_ticks since_epoch)
+{
+    char text[restpp::details::max_date_size];
+    return std::string(text, restpp::details::write_http_date(text, since_epoch));
+}
+
+std::string write_iso8601(date_ticks since_epoch)
+{
+    char text[restpp::details::max_date_size];
+    return std::string(text, restpp::details::write_iso8601_date(text, since_epoch));
+}
+
+date_ticks civil(std::int64_t year, unsigned month, unsigned day)
+{
+    return seconds(restpp::details::days_from_civil(year, month, day) * 86400);
+}
+
+TEST(http_date, three_formats)
+{
+    using restpp::details::parse_http_date_ticks;
+    EXPECT_EQ(parse_http_date_ticks("Sun, 06 Nov 1994 08:49:37 GMT"), date_ticks(example));
+    EXPECT_EQ(parse_http_date_ticks("Sunday, 06-Nov-94 08:49:37 GMT"), date_ticks(example));
+    EXPECT_EQ(parse_http_date_ticks("Sun Nov  6 08:49:37 1994"), date_ticks(example));
+    EXPECT_EQ(parse_http_date_ticks("Sun Nov 16 08:49:37 1994"), date_ticks(example + hours(240)));
+    EXPECT_EQ(parse_http_date_ticks("  Sun, 06 Nov 1994 08:49:37 GMT\t"), date_ticks(example));
+
+    // Two-digit years below 70 are in this century
+    EXPECT_EQ(parse_http_date_ticks("Tuesday, 01-Jan-30 00:00:00 GMT"), civil(2030, 1, 1));
+    EXPECT_EQ(parse_http_date_ticks("Thursday, 01-Jan-70 00:00:00 GMT"), civil(1970, 1, 1));
+}
+
+TEST(http_date, malformed)
+{
+    using restpp::details::parse_http_date_ticks;
+    for (std::string_view text : {"", "0", "-1", "Sun", "Sun,", "Sun, 32 Nov 1994 08:49:37 GMT",
+                                  "Sun, 00 Nov 1994 08:49:37 GMT", "Sun, 06 Foo 1994 08:49:37 GMT",
+                                  "Sun, 06 Nov 1994 24:00:00 GMT", "Sun, 06 Nov 1994 08:60:00 GMT",
+                                  "Sun, 06 Nov 1994 08:49:37 UTC", "Sun, 06 Nov 1994 08:49:37 GMT+1",
+                                  "Sun, 6 Nov 1994 08:49:37 GMT", "Sun, 06 Nov 94 08:49:37 GMT"})
+        EXPECT_FALSE(parse_http_date_ticks(text)) << text;
+
+    // Nor does any part of a date read past its end
+    for (std::string_view text :
+         {"Sun, 06 Nov 1994 08:49:37 GMT", "Sunday, 06-Nov-94 08:49:37 GMT", "Sun Nov  6 08:49:37 1994"})
+        for (std::size_t size = 0; size < text.size(); ++size)
+            EXPECT_FALSE(parse_http_date_ticks(text.substr(0, size))) << text.substr(0, size);
+}
+
+TEST(http_date, round_trip)
+{
+    EXPECT_EQ(write(example), "Sun, 06 Nov 1994 08:49:37 GMT");
+    EXPECT_EQ(write(date_ticks(0)), "Thu, 01 Jan 1970 00:00:00 GMT");
+    EXPECT_EQ(write(date_ticks(-1)), "Wed, 31 Dec 1969 23:59:59 GMT");
+    EXPECT_EQ(write(civil(2000, 2, 29) + hours(12)), "Tue, 29 Feb 2000 12:00:00 GMT");
+
+    const system_clock::time_point time(example + milliseconds(999));
+    EXPECT_EQ(restpp::details::format_http_date(time), "Sun, 06 Nov 1994 08:49:37 GMT");
+    EXPECT_EQ(restpp::details::parse_http_date(restpp::details::format_http_date(time)),
+              system_clock::time_point(example));
+
+    // Every four-digit year
+    for (std::int64_t day = -719000; day < 2932896; day += 7919)
+    {
+        const date_ticks since_epoch = seconds(day * 86400 + (day < 0 ? -day : day) % 86400);
+        EXPECT_EQ(restpp::details::parse_http_date_ticks(write(since_epoch)), since_epoch) << write(since_epoch);
+    }
+}
+
+TEST(http_date, out_of_range_years)
+{
+    // Years are written with four digits at least, and those system_clock cannot hold are clamped
+    EXPECT_EQ(write(civil(9999, 12, 31) + seconds(86399)), "Fri, 31 Dec 9999 23:59:59 GMT");
+    EXPECT_EQ(write(civil(1, 1, 1)), "Mon, 01 Jan 0001 00:00:00 GMT");
+    EXPECT_EQ(write(civil(10000, 1, 1)), "Sat, 01 Jan 10000 00:00:00 GMT");
+
+    const auto last = restpp::details::parse_http_date("Fri, 31 Dec 9999 23:59:59 GMT");
+    ASSERT_TRUE(last);
+    EXPECT_GE(*last, system_clock::time_point::max() - seconds(1));
+    const auto first = restpp::details::parse_http_date("Mon, 01 Jan 0001 00:00:00 GMT");
+    ASSERT_TRUE(first);
+    EXPECT_LE(*first, system_clock::time_point::min() + seconds(1));
+}
+
+TEST(http_date, iso8601)
+{
+    using restpp::details::parse_iso8601_date_ticks;
+    EXPECT_EQ(write_iso8601(example), "1994-11-06T08:49:37Z");
+    EXPECT_EQ(write_iso8601(date_ticks(example) + date_ticks(1234500)), "1994-11-06T08:49:37.12345Z");
+    EXPECT_EQ(write_iso8601(civil(1, 1, 1)), "0001-01-01T00:00:00Z");
+
+    EXPECT_EQ(parse_iso8601_date_ticks("1994-11-06T08:49:37Z"), date_ticks(example));
+    EXPECT_EQ(parse_iso8601_date_ticks("1994-11-06t08:49:37z"), date_ticks(example));
+    EXPECT_EQ(parse_iso8601_date_ticks("1994-11-06T10:49:37+02:00"), date_ticks(example));
+    EXPECT_EQ(parse_iso8601_date_ticks("1994-11-06T07:49:37-0100"), date_ticks(example));
+    EXPECT_EQ(parse_iso8601_date_ticks("1994-11-06T08:49:37.5Z"), date_ticks(example) + milliseconds(500));
+    EXPECT_EQ(parse_iso8601_date_ticks("1994-11-06T08:49:37.123456789Z"), date_ticks(example) + date_ticks(1234567));
+    EXPECT_EQ(parse_iso8601_date_ticks("1994-11-06"), civil(1994, 11, 6));
+
+    for (std::string_view text : {"", "1994", "1994-11", "1994-13-06", "1994-11-06T", "1994-11-06T08:49:37",
+                                  "1994-11-06T08:49:37.Z", "1994-11-06T08:49:37+2", "1994-11-06T08:49:37Zx"})
+        EXPECT_FALSE(parse_iso8601_date_ticks(text)) << text;
+}
+} // namespace
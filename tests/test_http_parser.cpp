@@ -0,0 +1,248 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests of how the HTTP/1.1 parser frames messages, and of how response bodies are sized.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+#include <restpp/core/error.hpp>
+#include <restpp/core/details/fetch_op.hpp>
+#include <restpp/core/details/http_parser.hpp>
+
+namespace
+{
+using restpp::details::body_framing;
+
+/// <summary>
+/// Parses a whole message, collecting its body.
+/// </summary>
+template<typename Parser>
+boost::system::error_code parse(Parser& parser, std::string_view message, std::string& body, std::size_t* used = nullptr)
+{
+    boost::system::error_code ec;
+    const std::size_t n = parser.parse(message.data(), message.size(), ec, [&](std::string_view data) {
+        body.append(data);
+        return true;
+    });
+    if (used)
+        *used = n;
+    return ec;
+}
+
+TEST(http_parser, content_length_request)
+{
+    restpp::details::request_parser parser;
+    std::string body;
+    std::size_t used = 0;
+    const std::string_view message = "POST /items HTTP/1.1\r\nHost: x\r\nContent-Length: 5\r\n\r\nhelloGET";
+    ASSERT_FALSE(parse(parser, message, body, &used));
+    EXPECT_TRUE(parser.is_done());
+    EXPECT_EQ(parser.method(), "POST");
+    EXPECT_EQ(parser.target(), "/items");
+    EXPECT_EQ(parser.framing(), body_framing::content_length);
+    EXPECT_EQ(body, "hello");
+    EXPECT_TRUE(parser.keep_alive());
+
+    // A pipelined request that follows is left in the buffer
+    EXPECT_EQ(message.substr(used), "GET");
+}
+
+TEST(http_parser, chunked_request)
+{
+    restpp::details::request_parser parser;
+    std::string body;
+    ASSERT_FALSE(parse(parser,
+                       "POST / HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked\r\n\r\n"
+                       "5\r\nhello\r\n6;ext=1\r\n world\r\n0\r\nTrailer: x\r\n\r\n",
+                       body));
+    EXPECT_TRUE(parser.is_done());
+    EXPECT_EQ(parser.framing(), body_framing::chunked);
+    EXPECT_EQ(body, "hello world");
+}
+
+TEST(http_parser, request_with_content_length_and_transfer_encoding_is_refused)
+{
+    restpp::details::request_parser parser;
+    std::string body;
+    EXPECT_EQ(parse(parser,
+                    "POST / HTTP/1.1\r\nHost: x\r\nContent-Length: 5\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n",
+                    body),
+              restpp::error::invalid_header);
+
+    parser.reset();
+    EXPECT_EQ(parse(parser,
+                    "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\nHost: x\r\nContent-Length: 0\r\n\r\n0\r\n\r\n",
+                    body),
+              restpp::error::invalid_header);
+}
+
+TEST(http_parser, request_with_unknown_final_coding_is_refused)
+{
+    restpp::details::request_parser parser;
+    std::string body;
+    EXPECT_EQ(parse(parser, "POST / HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked, gzip\r\n\r\n", body),
+              restpp::error::invalid_header);
+}
+
+TEST(http_parser, response_with_content_length_and_transfer_encoding_is_not_reused)
+{
+    restpp::details::response_parser parser;
+    std::string body;
+    ASSERT_FALSE(parse(parser,
+                       "HTTP/1.1 200 OK\r\nContent-Length: 100\r\nTransfer-Encoding: chunked\r\n\r\n"
+                       "2\r\nok\r\n0\r\n\r\n",
+                       body));
+    EXPECT_TRUE(parser.is_done());
+    EXPECT_EQ(parser.framing(), body_framing::chunked);
+    EXPECT_EQ(body, "ok");
+    EXPECT_FALSE(parser.keep_alive());
+}
+
+TEST(http_parser, conflicting_content_lengths_are_refused)
+{
+    restpp::details::response_parser parser;
+    std::string body;
+    EXPECT_EQ(parse(parser, "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nContent-Length: 3\r\n\r\nok", body),
+              restpp::error::invalid_header);
+
+    // The same length twice is one length
+    parser.reset();
+    EXPECT_FALSE(parse(parser, "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nContent-Length: 2\r\n\r\nok", body));
+    EXPECT_TRUE(parser.is_done());
+}
+
+TEST(http_parser, malformed_content_length_is_refused)
+{
+    for (const char* length : {"-1", "1e3", "0x10", "", "99999999999999999999"})
+    {
+        restpp::details::response_parser parser;
+        std::string body;
+        const std::string message = std::string("HTTP/1.1 200 OK\r\nContent-Length: ") + length + "\r\n\r\n";
+        EXPECT_EQ(parse(parser, message, body), restpp::error::invalid_header) << length;
+    }
+}
+
+TEST(http_parser, huge_content_length_is_parsed_without_sizing_anything)
+{
+    restpp::details::response_parser parser;
+    std::string body;
+    ASSERT_FALSE(parse(parser, "HTTP/1.1 200 OK\r\nContent-Length: 900000000000000\r\n\r\nabc", body));
+    EXPECT_EQ(parser.content_length(), 900000000000000u);
+    EXPECT_EQ(parser.body_remaining(), 900000000000000u - 3);
+    EXPECT_EQ(body, "abc");
+
+    boost::system::error_code ec;
+    parser.finish(ec);
+    EXPECT_EQ(ec, restpp::error::partial_message);
+}
+
+TEST(http_parser, bodiless_responses)
+{
+    for (const char* head : {"HTTP/1.1 204 No Content\r\nContent-Length: 10\r\n\r\n",
+                             "HTTP/1.1 304 Not Modified\r\nContent-Length: 10\r\n\r\n"})
+    {
+        restpp::details::response_parser parser;
+        std::string body;
+        EXPECT_FALSE(parse(parser, head, body));
+        EXPECT_TRUE(parser.is_done()) << head;
+        EXPECT_EQ(parser.framing(), body_framing::none);
+    }
+
+    restpp::details::response_parser parser;
+    parser.reset(true);
+    std::string body;
+    EXPECT_FALSE(parse(parser, "HTTP/1.1 200 OK\r\nContent-Length: 10\r\n\r\n", body));
+    EXPECT_TRUE(parser.is_done());
+}
+
+TEST(http_parser, response_without_length_ends_with_the_connection)
+{
+    restpp::details::response_parser parser;
+    std::string body;
+    ASSERT_FALSE(parse(parser, "HTTP/1.1 200 OK\r\n\r\nsome", body));
+    EXPECT_EQ(parser.framing(), body_framing::until_eof);
+    EXPECT_FALSE(parser.keep_alive());
+    EXPECT_FALSE(parser.is_done());
+
+    boost::system::error_code ec;
+    parser.finish(ec);
+    EXPECT_FALSE(ec);
+    EXPECT_TRUE(parser.is_done());
+    EXPECT_EQ(body, "some");
+}
+
+TEST(http_parser, interim_responses_are_skipped)
+{
+    restpp::details::response_parser parser;
+    std::string body;
+    ASSERT_FALSE(parse(parser, "HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok", body));
+    EXPECT_EQ(parser.status_code(), 200);
+    EXPECT_EQ(body, "ok");
+}
+
+TEST(http_parser, head_larger_than_the_limit_is_refused)
+{
+    restpp::details::response_parser parser(64);
+    std::string body;
+    const std::string message = "HTTP/1.1 200 OK\r\nX-Padding: " + std::string(100, 'a') + "\r\n\r\n";
+    EXPECT_EQ(parse(parser, message, body), restpp::error::header_too_large);
+}
+
+TEST(http_parser, invalid_chunk_size_is_refused)
+{
+    restpp::details::response_parser parser;
+    std::string body;
+    EXPECT_EQ(parse(parser, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n", body),
+              restpp::error::invalid_chunk);
+}
+
+TEST(grow_body, grows_by_capped_steps)
+{
+    const auto unlimited = std::numeric_limits<std::uint64_t>::max();
+    std::string body;
+    boost::system::error_code ec;
+
+    restpp::details::grow_body(body, 900000000000000u, unlimited, ec);
+    ASSERT_FALSE(ec);
+    EXPECT_EQ(body.size(), restpp::details::max_body_presize);
+
+    // Then it doubles, up to what remains
+    restpp::details::grow_body(body, 900000000000000u, unlimited, ec);
+    ASSERT_FALSE(ec);
+    EXPECT_EQ(body.size(), 2 * restpp::details::max_body_presize);
+
+    restpp::details::grow_body(body, 10, unlimited, ec);
+    ASSERT_FALSE(ec);
+    EXPECT_EQ(body.size(), 2 * restpp::details::max_body_presize + 10);
+}
+
+TEST(grow_body, refuses_bodies_over_the_limit)
+{
+    std::string body;
+    boost::system::error_code ec;
+    restpp::details::grow_body(body, 900000000000000u, 1024, ec);
+    EXPECT_EQ(ec, restpp::error::body_too_large);
+    EXPECT_TRUE(body.empty());
+
+    std::string data(1000, 'a');
+    ec = {};
+    EXPECT_TRUE(restpp::details::append_body(body, data, 1024, ec));
+    EXPECT_FALSE(ec);
+    EXPECT_FALSE(restpp::details::append_body(body, data, 1024, ec));
+    EXPECT_EQ(ec, restpp::error::body_too_large);
+    EXPECT_EQ(body.size(), 1000u);
+}
+} // namespace
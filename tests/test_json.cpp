@@ -0,0 +1,167 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests of the JSON structural index and of the document built on it.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <restpp/core/json.hpp>
+
+namespace
+{
+using restpp::json_document;
+using restpp::json_exception;
+
+/// <summary>
+/// The structural index, found one character at a time.
+/// </summary>
+std::vector<std::uint32_t> reference_index(const std::string& text)
+{
+    std::vector<std::uint32_t> index;
+    bool in_string = false;
+    bool escaped = false;
+    bool in_scalar = false;
+    for (std::uint32_t i = 0; i < text.size(); ++i)
+    {
+        const char c = text[i];
+        if (in_string)
+        {
+            if (escaped)
+                escaped = false;
+            else if (c == '\\')
+                escaped = true;
+            else if (c == '"')
+                in_string = false;
+            continue;
+        }
+        const bool op = c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',';
+        const bool space = c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        if (c == '"')
+        {
+            in_string = true;
+            index.push_back(i);
+        }
+        else if (op)
+        {
+            index.push_back(i);
+        }
+        else if (!space && !in_scalar)
+        {
+            index.push_back(i);
+        }
+        in_scalar = !op && !space && c != '"';
+    }
+    return index;
+}
+
+TEST(json_index, matches_a_scan_across_block_boundaries)
+{
+    // Quotes, escapes and runs of backslashes landing on every offset around the 64-byte edges
+    const std::vector<std::string> pieces = {"\"a\\\"b\"", "\"\\\\\"", "\"\\\\\\\"x\"", "12.5e3", "true", "\"\\u00e9\"", "[]", "{}"};
+    for (const auto& piece : pieces)
+    {
+        for (std::size_t pad = 0; pad < 130; ++pad)
+        {
+            const std::string text = "[" + std::string(pad, ' ') + piece + ", " + piece + ",\"" + std::string(pad, 'x') + "\"]";
+            std::vector<std::uint32_t> index;
+            ASSERT_TRUE(restpp::details::index_json(text, index)) << text;
+            EXPECT_EQ(index, reference_index(text)) << text;
+
+            const json_document doc(text);
+            EXPECT_EQ(doc.root().size(), 3u) << text;
+            EXPECT_EQ(doc[2].get_string(), std::string(pad, 'x'));
+        }
+    }
+}
+
+TEST(json_index, unterminated_strings_are_found)
+{
+    for (std::size_t pad = 0; pad < 130; ++pad)
+    {
+        std::vector<std::uint32_t> index;
+        const std::string text = "[\"" + std::string(pad, 'a') + "\\\"]";
+        EXPECT_FALSE(restpp::details::index_json(text, index)) << pad;
+    }
+}
+
+TEST(json, values)
+{
+    const json_document doc(R"({"name": "restpp", "count": -42, "ratio": 0.5, "ok": true, "none": null,
+                                "list": [1, [2, 3], {"k": "v"}], "empty": {}, "nothing": []})");
+    const auto root = doc.root();
+    EXPECT_TRUE(root.is_object());
+    EXPECT_EQ(root.size(), 8u);
+    EXPECT_EQ(root["name"].get_string(), "restpp");
+    EXPECT_EQ(root["count"].get_int64(), -42);
+    EXPECT_DOUBLE_EQ(root["ratio"].get_double(), 0.5);
+    EXPECT_TRUE(root["ok"].get_bool());
+    EXPECT_TRUE(root["none"].is_null());
+    EXPECT_EQ(root["list"].size(), 3u);
+    EXPECT_EQ(root["list"][1][1].get_int64(), 3);
+    EXPECT_EQ(root.at_pointer("/list/2/k").get_string(), "v");
+    EXPECT_EQ(root["empty"].size(), 0u);
+    EXPECT_EQ(root["nothing"].size(), 0u);
+    EXPECT_FALSE(root.find("missing"));
+    EXPECT_EQ(root["list"].raw_json(), R"([1, [2, 3], {"k": "v"}])");
+}
+
+TEST(json, escapes)
+{
+    const json_document doc(R"(["a\"b", "\\", "\/\b\f\n\r\t", "\u00e9\u20ac", "\ud83d\ude00", {"k\"ey": 1}])");
+    const auto item = [&doc](std::size_t i) { return doc[i]; };
+    EXPECT_EQ(item(0).get_string(), "a\"b");
+    EXPECT_EQ(item(1).get_string(), "\\");
+    EXPECT_EQ(item(2).get_string(), "/\b\f\n\r\t");
+    EXPECT_EQ(item(3).get_string(), "\xC3\xA9\xE2\x82\xAC");
+    EXPECT_EQ(item(4).get_string(), "\xF0\x9F\x98\x80");
+    EXPECT_EQ(item(3).get_raw_string(), "\\u00e9\\u20ac");
+    EXPECT_EQ(item(5)["k\"ey"].get_int64(), 1);
+
+    EXPECT_THROW(json_document(R"(["\x"])").at_pointer("/0").get_string(), json_exception);
+    EXPECT_THROW(json_document(R"(["\ud83d"])").at_pointer("/0").get_string(), json_exception);
+    EXPECT_THROW(json_document(R"(["\u12"])").at_pointer("/0").get_string(), json_exception);
+}
+
+/// <summary>
+/// Reads every value of a document, which is where the grammar beyond brackets is checked.
+/// </summary>
+void walk(const restpp::json_value& value)
+{
+    switch (value.type())
+    {
+        case restpp::json_type::array:
+            for (const auto element : value.elements())
+                walk(element);
+            break;
+        case restpp::json_type::object:
+            for (const auto member : value.members())
+                walk(member.value);
+            break;
+        case restpp::json_type::string: value.get_string(); break;
+        case restpp::json_type::number: value.get_double(); break;
+        default: break;
+    }
+}
+
+TEST(json, malformed_documents_are_refused)
+{
+    for (const char* text : {"", "   ", "{", "[1, 2", "\"abc", "]", "[1]]", "{\"a\" 1}", "1 2", "[1,]", "[,1]",
+                             "{\"a\":}", "[\"x\":]", "{\"a\":1,}", "{,}", "{\"a\":1 \"b\":2}", "[1 2]", "{1:2}",
+                             "[tru]", "[nul]", "{\"a\":]", "[:]", "[-]", "[01x]"})
+    {
+        EXPECT_THROW(walk(json_document(text).root()), json_exception) << text;
+    }
+}
+} // namespace
@@ -0,0 +1,146 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests of routing requests of the embedded server to their handlers.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <restpp/core/router.hpp>
+
+namespace
+{
+// Names the handler that served the request in the body, followed by its parameters
+restpp::request_handler named(std::string name)
+{
+    return [name](restpp::server_request& req, restpp::server_response& res) {
+        res.body = name;
+        for (const auto& [key, value] : req.params)
+            res.body.append(" ").append(key).append("=").append(value);
+    };
+}
+
+restpp::server_response serve(const restpp::router& r, std::string method, std::string target)
+{
+    restpp::server_request req;
+    req.method = std::move(method);
+    req.target = std::move(target);
+    restpp::server_response res;
+    r(req, res);
+    return res;
+}
+
+std::string body(const restpp::router& r, std::string target)
+{
+    return serve(r, "GET", std::move(target)).body;
+}
+
+TEST(router, literal_beats_parameter_beats_rest)
+{
+    // Added from the least to the most specific, which must not matter
+    restpp::router r;
+    r.get("/files/{path...}", named("rest"));
+    r.get("/files/{name}", named("parameter"));
+    r.get("/files/readme", named("literal"));
+
+    EXPECT_EQ(body(r, "/files/readme"), "literal");
+    EXPECT_EQ(body(r, "/files/notes"), "parameter name=notes");
+    EXPECT_EQ(body(r, "/files/a/b/c"), "rest path=a/b/c");
+    EXPECT_EQ(body(r, "/files/readme?x=1"), "literal");
+}
+
+TEST(router, parameters)
+{
+    restpp::router r;
+    r.get("/", named("root"));
+    r.get("/users/{id}/orders/{order}", named("order"));
+    EXPECT_EQ(body(r, "/"), "root");
+    EXPECT_EQ(body(r, "/users/42/orders/7"), "order id=42 order=7");
+    EXPECT_EQ(serve(r, "GET", "/users/42/orders").status_code, 404);
+    EXPECT_EQ(serve(r, "GET", "/users//orders/7").status_code, 404);
+}
+
+TEST(router, backtracks_from_literals_leading_nowhere)
+{
+    restpp::router r;
+    r.get("/users/me/settings", named("settings"));
+    r.get("/users/{id}/orders", named("orders"));
+    r.get("/static/{path...}", named("static"));
+    r.get("/static/{version}/app.js", named("app"));
+
+    EXPECT_EQ(body(r, "/users/me/settings"), "settings");
+    EXPECT_EQ(body(r, "/users/me/orders"), "orders id=me");
+    EXPECT_EQ(body(r, "/static/v2/app.js"), "app version=v2");
+
+    // The parameter taken on the way to a dead end is dropped
+    EXPECT_EQ(body(r, "/static/v2/app.css"), "static path=v2/app.css");
+}
+
+TEST(router, method_not_allowed)
+{
+    restpp::router r;
+    r.get("/items", named("list"));
+    r.post("/items", named("create"));
+    r.del("/items/{id}", named("delete"));
+
+    EXPECT_EQ(serve(r, "POST", "/items").body, "create");
+
+    auto res = serve(r, "PUT", "/items");
+    EXPECT_EQ(res.status_code, 405);
+    EXPECT_EQ(res.headers.get("Allow"), "GET, POST");
+    EXPECT_TRUE(res.body.empty());
+
+    res = serve(r, "GET", "/items/3");
+    EXPECT_EQ(res.status_code, 405);
+    EXPECT_EQ(res.headers.get("Allow"), "DELETE");
+
+    EXPECT_EQ(serve(r, "GET", "/nothing").status_code, 404);
+}
+
+TEST(router, head_falls_back_to_get)
+{
+    restpp::router r;
+    r.get("/a", named("get a"));
+    r.get("/b", named("get b"));
+    r.add("HEAD", "/b", named("head b"));
+    r.post("/c", named("post c"));
+
+    EXPECT_EQ(serve(r, "HEAD", "/a").body, "get a");
+    EXPECT_EQ(serve(r, "HEAD", "/b").body, "head b");
+    EXPECT_EQ(serve(r, "HEAD", "/c").status_code, 405);
+}
+
+TEST(router, fallback)
+{
+    restpp::router r;
+    r.get("/users/{id}", named("user"));
+    r.fallback(named("fallback"));
+    EXPECT_EQ(body(r, "/users/1/extra"), "fallback");
+    EXPECT_EQ(serve(r, "POST", "/users/1").status_code, 405);
+}
+
+TEST(router, malformed_routes)
+{
+    restpp::router r;
+    r.get("/users/{id}", named("user"));
+    EXPECT_THROW(r.get("users", named("x")), std::invalid_argument);
+    EXPECT_THROW(r.get("", named("x")), std::invalid_argument);
+    EXPECT_THROW(r.get("/a{b}", named("x")), std::invalid_argument);
+    EXPECT_THROW(r.get("/{}", named("x")), std::invalid_argument);
+    EXPECT_THROW(r.get("/{id", named("x")), std::invalid_argument);
+    EXPECT_THROW(r.get("/{path...}/more", named("x")), std::invalid_argument);
+    EXPECT_THROW(r.get("/users/{name}", named("x")), std::invalid_argument);
+    EXPECT_THROW(r.get("/users/{id}", named("x")), std::invalid_argument);
+    EXPECT_NO_THROW(r.put("/users/{id}", named("x")));
+}
+} // namespace
@@ -0,0 +1,79 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests of parsing and normalizing URIs.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <restpp/core/uri.hpp>
+
+namespace
+{
+using restpp::uri;
+
+TEST(uri, components)
+{
+    const uri u("https://user@api.example.com:8443/v1/items?page=2#top");
+    EXPECT_EQ(u.scheme(), "https");
+    EXPECT_EQ(u.user_info(), "user");
+    EXPECT_EQ(u.host(), "api.example.com");
+    EXPECT_EQ(u.port(), 8443);
+    EXPECT_EQ(u.path(), "/v1/items");
+    EXPECT_EQ(u.query(), "page=2");
+    EXPECT_EQ(u.fragment(), "top");
+    EXPECT_EQ(u.resource(), "/v1/items?page=2");
+}
+
+TEST(uri, default_ports_and_path)
+{
+    EXPECT_EQ(uri("http://example.com").port(), 80);
+    EXPECT_EQ(uri("https://example.com").port(), 443);
+    EXPECT_EQ(uri("ws://example.com").port(), 80);
+    EXPECT_EQ(uri("wss://example.com").port(), 443);
+    EXPECT_EQ(uri("ftp://example.com").port(), -1);
+    EXPECT_EQ(uri("http://example.com").path(), "/");
+    EXPECT_EQ(uri("http://example.com?q=1").resource(), "?q=1");
+}
+
+TEST(uri, scheme_and_host_are_lower_cased)
+{
+    const uri u("HTTP://Example.COM/Some/Path?Q=A");
+    EXPECT_EQ(u.to_string(), "http://example.com/Some/Path?Q=A");
+    EXPECT_EQ(u, uri("http://example.com/Some/Path?Q=A"));
+    EXPECT_NE(u, uri("http://example.com/some/path?Q=A"));
+}
+
+TEST(uri, http_unix_socket_path_keeps_its_case)
+{
+    const uri u("HTTP+UNIX://%2Ftmp%2FMySock.sock/Path");
+    EXPECT_EQ(u.scheme(), "http+unix");
+    EXPECT_EQ(u.host(), "%2Ftmp%2FMySock.sock");
+    EXPECT_EQ(uri::decode(std::string(u.host())), "/tmp/MySock.sock");
+    EXPECT_EQ(u.path(), "/Path");
+}
+
+TEST(uri, invalid_uris_are_refused)
+{
+    EXPECT_THROW(uri(""), restpp::uri_exception);
+    EXPECT_THROW(uri("http://exa mple.com/"), restpp::uri_exception);
+    EXPECT_FALSE(uri::validate("http://exa mple.com/"));
+    EXPECT_TRUE(uri::validate("http://example.com/"));
+    EXPECT_TRUE(uri::validate(std::string_view("http://example.com/a b").substr(0, 20)));
+}
+
+TEST(uri, encode_and_decode)
+{
+    EXPECT_EQ(uri::encode_component("a b/c?d"), "a%20b%2Fc%3Fd");
+    EXPECT_EQ(uri::decode("a%20b%2Fc%3fd"), "a b/c?d");
+}
+} // namespace
@@ -0,0 +1,245 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests of WebSocket frame headers, masking and the keys of the opening handshake.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <restpp/core/details/websocket_frame.hpp>
+
+namespace
+{
+namespace ws = restpp::details::ws;
+
+std::string bytes(std::initializer_list<unsigned> values)
+{
+    std::string out;
+    for (unsigned v : values)
+        out.push_back(static_cast<char>(v));
+    return out;
+}
+
+std::string hex(const std::uint8_t* data, std::size_t size)
+{
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string out;
+    for (std::size_t i = 0; i < size; ++i)
+        out.append({digits[data[i] >> 4], digits[data[i] & 15]});
+    return out;
+}
+
+std::string sha1(std::string_view message)
+{
+    std::uint8_t digest[20];
+    ws::sha1(message, digest);
+    return hex(digest, sizeof(digest));
+}
+
+TEST(websocket_frame, rfc6455_examples)
+{
+    // Section 5.7: a single-frame unmasked text message, and the same masked
+    std::string frame = bytes({0x81, 0x05}) + "Hello";
+    ws::frame_header h;
+    bool valid = false;
+    ASSERT_TRUE(ws::read_frame_header(frame.data(), frame.size(), h, valid));
+    EXPECT_TRUE(valid);
+    EXPECT_TRUE(h.fin);
+    EXPECT_EQ(h.opcode, ws::text);
+    EXPECT_FALSE(h.masked);
+    EXPECT_EQ(h.length, 5u);
+    EXPECT_EQ(h.size, 2u);
+
+    frame = bytes({0x81, 0x85, 0x37, 0xfa, 0x21, 0x3d, 0x7f, 0x9f, 0x4d, 0x51, 0x58});
+    ASSERT_TRUE(ws::read_frame_header(frame.data(), frame.size(), h, valid));
+    EXPECT_TRUE(valid);
+    EXPECT_TRUE(h.masked);
+    EXPECT_EQ(h.length, 5u);
+    EXPECT_EQ(h.size, 6u);
+    char payload[5];
+    ws::mask_copy(payload, frame.data() + h.size, 5, h.key, 0);
+    EXPECT_EQ(std::string(payload, 5), "Hello");
+
+    char header[ws::max_header_size];
+    const std::size_t size = ws::write_frame_header(header, true, false, ws::text, 5, h.key);
+    EXPECT_EQ(std::string(header, size), frame.substr(0, 6));
+
+    // A fragmented message, and a ping
+    frame = bytes({0x01, 0x03}) + "Hel";
+    ASSERT_TRUE(ws::read_frame_header(frame.data(), frame.size(), h, valid));
+    EXPECT_FALSE(h.fin);
+    EXPECT_EQ(h.opcode, ws::text);
+    frame = bytes({0x80, 0x02}) + "lo";
+    ASSERT_TRUE(ws::read_frame_header(frame.data(), frame.size(), h, valid));
+    EXPECT_TRUE(h.fin);
+    EXPECT_EQ(h.opcode, ws::continuation);
+    frame = bytes({0x89, 0x05}) + "Hello";
+    ASSERT_TRUE(ws::read_frame_header(frame.data(), frame.size(), h, valid));
+    EXPECT_TRUE(ws::is_control(h.opcode));
+
+    // 256 bytes and 64 KiB of binary data
+    frame = bytes({0x82, 0x7E, 0x01, 0x00});
+    ASSERT_TRUE(ws::read_frame_header(frame.data(), frame.size(), h, valid));
+    EXPECT_TRUE(valid);
+    EXPECT_EQ(h.length, 256u);
+    frame = bytes({0x82, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00});
+    ASSERT_TRUE(ws::read_frame_header(frame.data(), frame.size(), h, valid));
+    EXPECT_TRUE(valid);
+    EXPECT_EQ(h.length, 65536u);
+}
+
+TEST(websocket_frame, header_round_trip)
+{
+    const std::uint8_t key[4] = {0x01, 0x80, 0xFE, 0x7F};
+    for (std::uint64_t length : {0ull, 1ull, 125ull, 126ull, 127ull, 0xFFFFull, 0x10000ull, 1ull << 40, (1ull << 63) - 1})
+    {
+        for (bool rsv1 : {false, true})
+        {
+            char header[ws::max_header_size];
+            const std::size_t size = ws::write_frame_header(header, !rsv1, rsv1, ws::binary, length, key);
+            EXPECT_EQ(size, length < 126 ? 6u : length <= 0xFFFF ? 8u : 14u);
+
+            ws::frame_header h;
+            bool valid = false;
+            for (std::size_t partial = 0; partial < size; ++partial)
+                EXPECT_FALSE(ws::read_frame_header(header, partial, h, valid)) << length << " " << partial;
+            ASSERT_TRUE(ws::read_frame_header(header, size, h, valid));
+            EXPECT_TRUE(valid) << length;
+            EXPECT_EQ(h.fin, !rsv1);
+            EXPECT_EQ(h.rsv1, rsv1);
+            EXPECT_EQ(h.opcode, ws::binary);
+            EXPECT_TRUE(h.masked);
+            EXPECT_EQ(h.length, length);
+            EXPECT_EQ(h.size, size);
+            EXPECT_EQ(std::memcmp(h.key, key, 4), 0);
+        }
+    }
+}
+
+TEST(websocket_frame, invalid_headers)
+{
+    ws::frame_header h;
+    bool valid = true;
+
+    // Lengths not in their shortest form, or with the top bit set
+    std::string frame = bytes({0x82, 0x7E, 0x00, 0x7D});
+    ASSERT_TRUE(ws::read_frame_header(frame.data(), frame.size(), h, valid));
+    EXPECT_FALSE(valid);
+    frame = bytes({0x82, 0x7F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF});
+    ASSERT_TRUE(ws::read_frame_header(frame.data(), frame.size(), h, valid));
+    EXPECT_FALSE(valid);
+    frame = bytes({0x82, 0x7F, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+    ASSERT_TRUE(ws::read_frame_header(frame.data(), frame.size(), h, valid));
+    EXPECT_FALSE(valid);
+
+    // RSV2 and RSV3; RSV1 is that of permessage-deflate
+    for (unsigned bits : {0x20u, 0x10u})
+    {
+        frame = bytes({0x82 | bits, 0x00});
+        ASSERT_TRUE(ws::read_frame_header(frame.data(), frame.size(), h, valid));
+        EXPECT_FALSE(valid);
+    }
+    frame = bytes({0xC2, 0x00});
+    ASSERT_TRUE(ws::read_frame_header(frame.data(), frame.size(), h, valid));
+    EXPECT_TRUE(valid);
+    EXPECT_TRUE(h.rsv1);
+}
+
+TEST(websocket_frame, mask_copy_at_every_offset)
+{
+    // Every size across the vector widths, at every payload offset and misalignment of the buffers
+    const std::uint8_t key[4] = {0x37, 0xFA, 0x21, 0x3D};
+    std::vector<char> in(128 + 8);
+    for (std::size_t i = 0; i < in.size(); ++i)
+        in[i] = static_cast<char>(i * 7 + 3);
+
+    for (std::size_t size = 0; size <= 128; ++size)
+    {
+        for (std::uint64_t offset = 0; offset < 8; ++offset)
+        {
+            for (std::size_t align = 0; align < 4; ++align)
+            {
+                const char* source = in.data() + align;
+                std::vector<char> out(size + 8, '\x5A');
+                ws::mask_copy(out.data() + align, source, size, key, offset);
+                for (std::size_t i = 0; i < size; ++i)
+                    ASSERT_EQ(out[align + i], static_cast<char>(source[i] ^ key[(offset + i) & 3]))
+                        << size << " " << offset << " " << align << " " << i;
+                for (std::size_t i = align + size; i < out.size(); ++i)
+                    ASSERT_EQ(out[i], '\x5A');
+
+                // In place, and back again
+                std::vector<char> copy(source, source + size);
+                ws::mask_copy(copy.data(), copy.data(), size, key, offset);
+                EXPECT_TRUE(std::equal(copy.begin(), copy.end(), out.begin() + static_cast<std::ptrdiff_t>(align)));
+                ws::mask_copy(copy.data(), copy.data(), size, key, offset);
+                EXPECT_TRUE(std::equal(copy.begin(), copy.end(), source));
+            }
+        }
+    }
+
+    // Offsets past 32 bits
+    char masked[3];
+    ws::mask_copy(masked, "abc", 3, key, (1ull << 40) + 2);
+    EXPECT_EQ(masked[0], static_cast<char>('a' ^ key[2]));
+    EXPECT_EQ(masked[2], static_cast<char>('c' ^ key[0]));
+}
+
+TEST(websocket_frame, sha1)
+{
+    EXPECT_EQ(sha1(""), "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+    EXPECT_EQ(sha1("abc"), "a9993e364706816aba3e25717850c26c9cd0d89d");
+    EXPECT_EQ(sha1("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+              "84983e441c3bd26ebaae4aa1f95129e5e54670f1");
+    EXPECT_EQ(sha1(std::string(1000, 'a')), "291e9a6c66994949b57ba5e650361e98fc36b1ba");
+}
+
+TEST(websocket_frame, base64)
+{
+    const auto encode = [](std::string_view text) {
+        return ws::base64_encode(reinterpret_cast<const std::uint8_t*>(text.data()), text.size());
+    };
+    EXPECT_EQ(encode(""), "");
+    EXPECT_EQ(encode("f"), "Zg==");
+    EXPECT_EQ(encode("fo"), "Zm8=");
+    EXPECT_EQ(encode("foo"), "Zm9v");
+    EXPECT_EQ(encode("foob"), "Zm9vYg==");
+    EXPECT_EQ(encode("fooba"), "Zm9vYmE=");
+    EXPECT_EQ(encode("foobar"), "Zm9vYmFy");
+}
+
+TEST(websocket_frame, accept_key)
+{
+    // The example of RFC 6455, section 1.3
+    EXPECT_EQ(ws::accept_key("dGhlIHNhbXBsZSBub25jZQ=="), "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+}
+
+TEST(websocket_frame, random_bytes)
+{
+    // Fills exactly what it is asked for, whatever the size
+    for (std::size_t size = 0; size <= 20; ++size)
+    {
+        std::vector<std::uint8_t> out(size + 8, 0xA5);
+        ws::random_bytes(out.data(), size);
+        for (std::size_t i = size; i < out.size(); ++i)
+            ASSERT_EQ(out[i], 0xA5) << size;
+    }
+
+    std::uint8_t first[16], second[16];
+    ws::random_bytes(first, sizeof(first));
+    ws::random_bytes(second, sizeof(second));
+    EXPECT_NE(std::memcmp(first, second, sizeof(first)), 0);
+}
+} // namespace
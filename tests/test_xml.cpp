@@ -0,0 +1,160 @@
+/***
+ * Copyright (C) 2024-present Mário A. Moiane (connect at imariom dot com)
+ * Licensed under the MIT license. See LICENSE.txt file in the project root for full license information.
+ *
+ * =+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
+ *
+ * Tests of the XML pull reader.
+ *
+ * For the latest on this and related APIs, please see: https://github.com/imariom/restpp
+ *
+ * =-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-=-
+ ****/
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <restpp/core/xml.hpp>
+
+namespace
+{
+using restpp::xml_event_type;
+using restpp::xml_exception;
+using restpp::xml_reader;
+
+std::string describe(const restpp::xml_event& e)
+{
+    switch (e.type)
+    {
+        case xml_event_type::start_element:
+        {
+            std::string out = "<" + std::string(e.name);
+            for (const auto& attribute : e.attributes())
+                out += " " + std::string(attribute.name) + "=" + attribute.value();
+            return out + ">";
+        }
+        case xml_event_type::end_element: return "</" + std::string(e.name) + ">";
+        case xml_event_type::text: return "text:" + e.decoded_text();
+        case xml_event_type::cdata: return "cdata:" + std::string(e.text);
+        case xml_event_type::comment: return "comment:" + std::string(e.text);
+        case xml_event_type::processing_instruction: return "pi:" + std::string(e.name);
+        case xml_event_type::doctype: return "doctype:" + std::string(e.text);
+    }
+    return {};
+}
+
+std::vector<std::string> read_all(std::string_view document)
+{
+    std::vector<std::string> events;
+    xml_reader reader(document);
+    while (reader.next())
+        events.push_back(describe(reader.event()));
+    EXPECT_TRUE(reader.done());
+    return events;
+}
+
+/// <summary>
+/// Reads a document fed a piece of the given size at a time, joining consecutive text events.
+/// </summary>
+std::vector<std::string> read_in_pieces(const std::string& document, std::size_t piece)
+{
+    std::vector<std::string> events;
+    std::vector<std::string> pieces;
+    for (std::size_t at = 0; at < document.size(); at += piece)
+        pieces.push_back(document.substr(at, piece));
+
+    xml_reader reader;
+    const auto drain = [&] {
+        while (reader.next())
+        {
+            std::string event = describe(reader.event());
+            if (!events.empty() && event.rfind("text:", 0) == 0 && events.back().rfind("text:", 0) == 0)
+                events.back() += event.substr(5);
+            else
+                events.push_back(std::move(event));
+        }
+    };
+    for (const auto& p : pieces)
+    {
+        reader.feed(p);
+        drain();
+    }
+    reader.finish();
+    drain();
+    EXPECT_TRUE(reader.done());
+    return events;
+}
+
+const std::string sample = R"(<?xml version="1.0"?>
+<!DOCTYPE feed [<!ENTITY e "x>y"> <!ELEMENT feed ANY>]>
+<!-- a comment -->
+<feed lang="en&amp;fr" note='a &lt;b&gt;'>
+  <title>Tom &amp; Jerry &#169; &#x1F600;</title>
+  <empty/>
+  <code><![CDATA[if (a < b && c > d) { x = "]]"; }]]></code>
+  <?render fast?>
+</feed>
+)";
+
+TEST(xml_reader, events)
+{
+    const std::vector<std::string> expected = {"pi:xml",
+                                               R"(doctype:feed [<!ENTITY e "x>y"> <!ELEMENT feed ANY>])",
+                                               "comment: a comment ",
+                                               "<feed lang=en&fr note=a <b>>",
+                                               "<title>",
+                                               "text:Tom & Jerry \xC2\xA9 \xF0\x9F\x98\x80",
+                                               "</title>",
+                                               "<empty>",
+                                               "</empty>",
+                                               "<code>",
+                                               R"(cdata:if (a < b && c > d) { x = "]]"; })",
+                                               "</code>",
+                                               "pi:render",
+                                               "</feed>"};
+    EXPECT_EQ(read_all(sample), expected);
+}
+
+TEST(xml_reader, pieces_of_any_size)
+{
+    const auto whole = read_all(sample);
+    for (std::size_t piece = 1; piece < 40; ++piece)
+        EXPECT_EQ(read_in_pieces(sample, piece), whole) << piece;
+}
+
+TEST(xml_reader, whitespace)
+{
+    xml_reader reader("<a> <b/> </a>");
+    reader.preserve_whitespace = true;
+    std::vector<std::string> events;
+    while (reader.next())
+        events.push_back(describe(reader.event()));
+    EXPECT_EQ(events, (std::vector<std::string>{"<a>", "text: ", "<b>", "</b>", "text: ", "</a>"}));
+}
+
+TEST(xml_reader, entities)
+{
+    std::string out;
+    EXPECT_TRUE(restpp::xml_unescape("&lt;&gt;&amp;&quot;&apos;&#65;&#x42;", out));
+    EXPECT_EQ(out, "<>&\"'AB");
+
+    for (const char* raw : {"&nbsp;", "&#;", "&#x;", "&#0;", "&#xD800;", "&#x110000;", "&amp", "&#12a;"})
+    {
+        out.clear();
+        EXPECT_FALSE(restpp::xml_unescape(raw, out)) << raw;
+    }
+    EXPECT_THROW(read_all("<a>&bogus;</a>"), xml_exception);
+}
+
+TEST(xml_reader, malformed_documents_are_refused)
+{
+    for (const char* document : {"", "<a>", "<a></b>", "<a/><b/>", "text", "<a><b></a></b>", "<![CDATA[x]]><a/>",
+                                 "<a/><!DOCTYPE a>", "<a b=c/>", "<a><!-- open</a>", "</a>"})
+    {
+        EXPECT_THROW(read_all(document), xml_exception) << document;
+    }
+}
+} // namespace